@@ -24,6 +24,7 @@
 #define  AUTOWAH_DECAY_MAX      (1.0)
 #define  AUTOWAH_Q_MIN          (0.0)
 #define  AUTOWAH_Q_MAX          (1.0)
+#define  AUTOWAH_MIN_BF_FREQ    (300.0)
 #define  AUTOWAH_MAX_BF_FREQ    (800.0)
 
 /**
@@ -189,6 +190,26 @@ RESULT_AUTOWAH autowah_modify_q(AUTOWAH * c, float q_new) {
 	return res;
 }
 
+/**
+ * @brief Set the center frequency of the bandpass filter
+ *
+ * autowah_read() sets this itself from the amplitude of the input; it's for
+ * sweeping the filter from elsewhere with autowah_read_filter().
+ *
+ * @param c Pointer to instance structure
+ * @param freq_hz New center frequency (Hz)
+ *
+ * @return Autowah result (enumeration)
+ */
+RESULT_AUTOWAH autowah_modify_freq(AUTOWAH * c, float freq_hz) {
+
+	filter_modify_freq(&c->bpf1, freq_hz);
+	filter_modify_freq(&c->bpf2, freq_hz);
+	filter_modify_freq(&c->bpf3, freq_hz);
+
+	return AUTOWAH_OK;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -218,9 +239,33 @@ void autowah_read(AUTOWAH * c, float * audio_in, float * audio_out,
 		env_freq = AUTOWAH_MAX_BF_FREQ;
 
 	// Update filter center frequency based on amplitude
-	filter_modify_freq(&c->bpf1, 300.0 + env_freq);
-	filter_modify_freq(&c->bpf2, 300.0 + env_freq);
-	filter_modify_freq(&c->bpf3, 300.0 + env_freq);
+	autowah_modify_freq(c, AUTOWAH_MIN_BF_FREQ + env_freq);
+
+	autowah_read_filter(c, audio_in, audio_out, audio_block_size);
+}
+
+/**
+ * @brief Apply the filters to a block of audio data without following the input
+ *
+ * The center frequency is left wherever autowah_modify_freq() last set it,
+ * so something else (e.g. a modulation matrix, see modulation_matrix.c) can
+ * sweep the filter.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out Pointer to floating point output buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+void autowah_read_filter(AUTOWAH * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
 
 	// Apply band pass filters in series to create a 6th order filter
 	filter_read(&c->bpf1, audio_in, audio_out, audio_block_size);
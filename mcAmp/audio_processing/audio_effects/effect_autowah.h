@@ -50,9 +50,14 @@ RESULT_AUTOWAH autowah_modify_depth(AUTOWAH * c, float depth_new);
 
 RESULT_AUTOWAH autowah_modify_q(AUTOWAH * c, float q_new);
 
+RESULT_AUTOWAH autowah_modify_freq(AUTOWAH * c, float freq_hz);
+
 void autowah_read(AUTOWAH * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
+void autowah_read_filter(AUTOWAH * c, float * audio_in, float * audio_out,
+		uint32_t audio_block_size);
+
 // Wrapper allows C code to be called from C++ files
 #ifdef __cplusplus
 }
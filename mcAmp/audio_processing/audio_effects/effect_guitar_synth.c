@@ -6,12 +6,18 @@
  * determining the frequency being played using a zero-crossing detector.
  * Based on the detected frequency, it synthesis additional waveforms.
  *
+ * Notes can also be played on the synth voices from MIDI with
+ * guitar_synth_note_on() / guitar_synth_note_off().  While a MIDI note is
+ * held, it replaces the detected note and the voices play at the note's
+ * velocity rather than following the amplitude of the instrument.
+ *
  * This audio effect also serves as an example of how to utilize the
  * zero_crossing_detector, simple synth and biquad filter audio elements.
  */
 
 #include "effect_guitar_synth.h"
 #include "../audio_elements/audio_utilities.h"
+#include "../audio_elements/scratch_arena.h"
 
 // Min/max limits and other constants
 #define  GUITAR_SYNTH_CLEAN_MIX_MIN      (0.0)
@@ -70,6 +76,10 @@ RESULT_GUITAR_SYNTH guitar_synth_setup(GUITAR_SYNTH * c, float clean_mix,
 
 	c->lock_cntr = 0;
 
+	c->midi_note_playing = false;
+	c->midi_note = 0;
+	c->midi_volume = 0.0;
+
 	// Instance was successfully initialized
 	c->initialized = true;
 	return GUITAR_SYNTH_OK;
@@ -141,6 +151,52 @@ RESULT_GUITAR_SYNTH guitar_synth_modify_synth_mix(GUITAR_SYNTH * c,
 	return res;
 }
 
+/**
+ * @brief Plays a note on the synth voices
+ *
+ * @param c Pointer to instance structure
+ * @param note MIDI note number
+ * @param velocity Note velocity (0.0 -> 1.0)
+ */
+void guitar_synth_note_on(GUITAR_SYNTH * c, uint32_t note, float velocity) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	c->midi_note_playing = true;
+	c->midi_note = note;
+	c->midi_volume = velocity;
+
+	// The lower voices play one and two octaves down, as for a detected note
+	synth_play_note(&c->synth, note, c->synth_volume);
+	synth_play_note(&c->synth_octave_low_1, (note >= 12) ? note - 12 : note,
+			c->synth_volume);
+	synth_play_note(&c->synth_octave_low_2, (note >= 24) ? note - 24 : note,
+			c->synth_volume);
+}
+
+/**
+ * @brief Releases a note played with guitar_synth_note_on()
+ *
+ * Releasing any note other than the last one played is ignored.
+ *
+ * @param c Pointer to instance structure
+ * @param note MIDI note number
+ */
+void guitar_synth_note_off(GUITAR_SYNTH * c, uint32_t note) {
+
+	if (c == NULL || !c->midi_note_playing || note != c->midi_note) {
+		return;
+	}
+
+	c->midi_note_playing = false;
+
+	synth_stop_note(&c->synth);
+	synth_stop_note(&c->synth_octave_low_1);
+	synth_stop_note(&c->synth_octave_low_2);
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -160,8 +216,19 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 		return;
 	}
 
-	float synth_out_1[MAX_AUDIO_BLOCK_SIZE], synth_out_2[MAX_AUDIO_BLOCK_SIZE],
-			synth_out_3[MAX_AUDIO_BLOCK_SIZE];
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * synth_out_1 = scratch_alloc(audio_block_size);
+	float * synth_out_2 = scratch_alloc(audio_block_size);
+	float * synth_out_3 = scratch_alloc(audio_block_size);
+
+	if (synth_out_1 == NULL || synth_out_2 == NULL || synth_out_3 == NULL) {
+		scratch_release(scratch);
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
 
 	c->current_lock = zero_crossing_read(&c->zc_detect, audio_in,
 			audio_block_size, &c->detected_frequency);
@@ -175,27 +242,33 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 		c->lock_cntr--;
 	}
 
-	// Beginning of a new note event
-	if (c->current_lock && !c->last_lock) {
-		synth_play_note_freq(&c->synth, c->detected_frequency, c->synth_volume);
-		synth_play_note_freq(&c->synth_octave_low_1,
-				c->detected_frequency * 0.5, c->synth_volume);
-		synth_play_note_freq(&c->synth_octave_low_2,
-				c->detected_frequency * 0.25, c->synth_volume);
-	}
+	// A MIDI note drives the voices until it is released
+	if (!c->midi_note_playing) {
+
+		// Beginning of a new note event
+		if (c->current_lock && !c->last_lock) {
+			synth_play_note_freq(&c->synth, c->detected_frequency,
+					c->synth_volume);
+			synth_play_note_freq(&c->synth_octave_low_1,
+					c->detected_frequency * 0.5, c->synth_volume);
+			synth_play_note_freq(&c->synth_octave_low_2,
+					c->detected_frequency * 0.25, c->synth_volume);
+		}
 
-	// End of note
-	else if (!c->lock_cntr) {
-		synth_stop_note(&c->synth);
-		synth_stop_note(&c->synth_octave_low_1);
-		synth_stop_note(&c->synth_octave_low_2);
-	}
+		// End of note
+		else if (!c->lock_cntr) {
+			synth_stop_note(&c->synth);
+			synth_stop_note(&c->synth_octave_low_1);
+			synth_stop_note(&c->synth_octave_low_2);
+		}
 
-	// Update current note frequency in case note has been bent
-	synth_update_note_freq(&c->synth, c->detected_frequency);
-	synth_update_note_freq(&c->synth_octave_low_1, c->detected_frequency * 0.5);
-	synth_update_note_freq(&c->synth_octave_low_2,
-			c->detected_frequency * 0.25);
+		// Update current note frequency in case note has been bent
+		synth_update_note_freq(&c->synth, c->detected_frequency);
+		synth_update_note_freq(&c->synth_octave_low_1,
+				c->detected_frequency * 0.5);
+		synth_update_note_freq(&c->synth_octave_low_2,
+				c->detected_frequency * 0.25);
+	}
 
 	// Read audio blocks from synth engine
 	synth_read(&c->synth, synth_out_1, audio_block_size);
@@ -203,12 +276,14 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 	synth_read(&c->synth_octave_low_2, synth_out_3, audio_block_size);
 
 	// Mix it together
-	float amplitude;
+	float synth_level;
 	for (int i = 0; i < audio_block_size; i++) {
 		measure_amp_peak(audio_in[i], &c->measured_ampitude, 0.9999);
+		synth_level = c->midi_note_playing ?
+				c->midi_volume : 4.0 * c->measured_ampitude;
 		audio_out[i] = (audio_in[i] * c->clean_mix * 2.0)
 				+ (synth_out_1[i] * 0.5 + synth_out_2[i] * 0.95
-						+ synth_out_3[i] * 0.5) * 4.0 * c->measured_ampitude
+						+ synth_out_3[i] * 0.5) * synth_level
 						* c->synth_mix;
 
 	}
@@ -222,6 +297,8 @@ void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 
 	filter_read(&c->env_filter, audio_out, audio_out, audio_block_size);
 
+	scratch_release(scratch);
+
 	c->last_lock = c->current_lock;
 
 }
@@ -56,6 +56,11 @@ typedef struct {
 
 	uint32_t lock_cntr;
 
+	// Note played from MIDI (overrides the detected note while held)
+	bool midi_note_playing;
+	uint32_t midi_note;
+	float midi_volume;
+
 } GUITAR_SYNTH;
 
 #if __cplusplus
@@ -71,6 +76,10 @@ RESULT_GUITAR_SYNTH guitar_synth_modify_clean_mix(GUITAR_SYNTH * c,
 RESULT_GUITAR_SYNTH guitar_synth_modify_synth_mix(GUITAR_SYNTH * c,
 		float synth_mix_new);
 
+void guitar_synth_note_on(GUITAR_SYNTH * c, uint32_t note, float velocity);
+
+void guitar_synth_note_off(GUITAR_SYNTH * c, uint32_t note);
+
 void guitar_synth_read(GUITAR_SYNTH * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 
 #include "effect_multiband_compressor.h"
+#include "../audio_elements/scratch_arena.h"
 
 // Min/max limits and other constants
 #define MULTIBAND_COMP_CROSSOVER_MIN    (100.0)
@@ -206,8 +207,18 @@ void multiband_comp_read(MULTIBAND_COMPRESSOR * c, float * audio_in,
 		return;
 	}
 
-	float temp_audio_low[MAX_AUDIO_BLOCK_SIZE];
-	float temp_audio_high[MAX_AUDIO_BLOCK_SIZE];
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * temp_audio_low = scratch_alloc(audio_block_size);
+	float * temp_audio_high = scratch_alloc(audio_block_size);
+
+	if (temp_audio_low == NULL || temp_audio_high == NULL) {
+		scratch_release(scratch);
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
 
 	// Apply lpf / hpf
 	filter_read(&c->lpf, audio_in, temp_audio_low, audio_block_size);
@@ -225,4 +236,6 @@ void multiband_comp_read(MULTIBAND_COMPRESSOR * c, float * audio_in,
 
 	mix_2x1(temp_audio_low, temp_audio_high, audio_out, audio_block_size);
 
+	scratch_release(scratch);
+
 }
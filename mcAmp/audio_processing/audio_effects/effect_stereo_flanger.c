@@ -3,6 +3,7 @@
  */
 
 #include "effect_stereo_flanger.h"
+#include "../audio_elements/scratch_arena.h"
 
 // Min/max limits and other constants
 #define FLANGER_DEPTH_MIN      (0.0)
@@ -187,7 +188,19 @@ void flanger_read(STEREO_FLANGER * c, float * audio_in, float * audio_out_left,
 		return;
 	}
 
-	float lfo_left[MAX_AUDIO_BLOCK_SIZE], lfo_right[MAX_AUDIO_BLOCK_SIZE];
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * lfo_left = scratch_alloc(audio_block_size);
+	float * lfo_right = scratch_alloc(audio_block_size);
+
+	if (lfo_left == NULL || lfo_right == NULL) {
+		scratch_release(scratch);
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out_left[i] = audio_in[i];
+			audio_out_right[i] = audio_in[i];
+		}
+		return;
+	}
 
 	// Generate LFO signal
 	float t_l = c->lfo_t_left;
@@ -205,5 +218,40 @@ void flanger_read(STEREO_FLANGER * c, float * audio_in, float * audio_out_left,
 	variable_delay_read(&c->var_del_right, audio_in, audio_out_right, lfo_right,
 			audio_block_size);
 
+	scratch_release(scratch);
+
 }
 
+/**
+ * @brief Apply effect/process to a block of audio data with external LFOs
+ *
+ * Instead of running its own LFOs, the flanger is modulated by the signals
+ * passed in (e.g. the ramps of a modulation matrix, see modulation_matrix.c).
+ * The flanger rate then has no effect.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_out_left Pointer to floating point output buffer (left mono)
+ * @param audio_out_right Pointer to floating point output buffer (right mono)
+ * @param lfo_left Modulation of the left delay (-1.0 -> 1.0)
+ * @param lfo_right Modulation of the right delay (-1.0 -> 1.0)
+ * @param audio_block_size The number of floating-point words to process
+ */
+void flanger_read_modulated(STEREO_FLANGER * c, float * audio_in,
+		float * audio_out_left, float * audio_out_right, float * lfo_left,
+		float * lfo_right, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass audio through
+	if (c == NULL || !c->initialized) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out_left[i] = audio_in[i];
+			audio_out_right[i] = audio_in[i];
+		}
+		return;
+	}
+
+	variable_delay_read(&c->var_del_left, audio_in, audio_out_left, lfo_left,
+			audio_block_size);
+	variable_delay_read(&c->var_del_right, audio_in, audio_out_right, lfo_right,
+			audio_block_size);
+}
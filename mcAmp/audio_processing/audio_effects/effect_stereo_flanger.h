@@ -57,6 +57,10 @@ RESULT_FLANGER flanger_modify_feedback(STEREO_FLANGER * c, float new_feedback);
 void flanger_read(STEREO_FLANGER * c, float * audio_in, float * audio_out_left,
 		float * audio_out_right, uint32_t audio_block_size);
 
+void flanger_read_modulated(STEREO_FLANGER * c, float * audio_in,
+		float * audio_out_left, float * audio_out_right, float * lfo_left,
+		float * lfo_right, uint32_t audio_block_size);
+
 // Wrapper allows C code to be called from C++ files
 #if __cplusplus
 }
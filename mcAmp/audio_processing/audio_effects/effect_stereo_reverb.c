@@ -14,6 +14,42 @@
 #define     REVERB_LP_DAMP_MIN   (0.0)
 #define     REVERB_LP_DAMP_MAX   (1.0)
 
+/**
+ * @brief Allocates the all-pass and comb filter buffers for a reverb instance
+ *
+ * Buffers are only allocated the first time an instance is set up, so the
+ * instance must start out zeroed (e.g. declared as a global).
+ *
+ * @param c Pointer to instance structure
+ * @return true if all of the buffers are available
+ */
+static bool reverb_allocate_buffers(STEREO_REVERB * c) {
+
+	if (c->allpass_buffers_left == NULL) {
+		c->allpass_buffers_left = (float (*)[REVERB_MAX_ALLPASS_SIZE]) mem_alloc(
+				sizeof(float) * REVERB_ALLPASS_ELEMENTS * REVERB_MAX_ALLPASS_SIZE,
+				MEM_HINT_HOT, "reverb all-pass L");
+	}
+	if (c->allpass_buffers_right == NULL) {
+		c->allpass_buffers_right = (float (*)[REVERB_MAX_ALLPASS_SIZE]) mem_alloc(
+				sizeof(float) * REVERB_ALLPASS_ELEMENTS * REVERB_MAX_ALLPASS_SIZE,
+				MEM_HINT_HOT, "reverb all-pass R");
+	}
+	if (c->delay_buffers_left == NULL) {
+		c->delay_buffers_left = (float (*)[REVERB_MAX_DELAY_SIZE]) mem_alloc(
+				sizeof(float) * REVERB_DELAY_ELEMENTS * REVERB_MAX_DELAY_SIZE,
+				MEM_HINT_COLD, "reverb combs L");
+	}
+	if (c->delay_buffers_right == NULL) {
+		c->delay_buffers_right = (float (*)[REVERB_MAX_DELAY_SIZE]) mem_alloc(
+				sizeof(float) * REVERB_DELAY_ELEMENTS * REVERB_MAX_DELAY_SIZE,
+				MEM_HINT_COLD, "reverb combs R");
+	}
+
+	return (c->allpass_buffers_left != NULL && c->allpass_buffers_right != NULL
+			&& c->delay_buffers_left != NULL && c->delay_buffers_right != NULL);
+}
+
 /**
  * @brief Initializes instance of a stereo reverb
  *
@@ -33,6 +69,11 @@ RESULT_STEREO_REVERB reverb_setup(STEREO_REVERB * c, float wet_mix,
 
 	c->initialized = false;
 
+	// Place the buffers in the memory tier that suits how often they are accessed
+	if (!reverb_allocate_buffers(c)) {
+		return REVERB_OUT_OF_MEMORY;
+	}
+
 	// Modify these delay lenghts to change the characteristics of the reverb
 	uint32_t delay_lens_left[8] = { 1557, 1617, 1491, 1422, 1277, 1356, 1118,
 			1116 };
@@ -62,6 +103,10 @@ RESULT_STEREO_REVERB reverb_setup(STEREO_REVERB * c, float wet_mix,
 	c->lp_damp = lp_damp;
 	c->feedback = feedback;
 
+	c->quality = QUALITY_TIER_FULL;
+	c->active_delay_elements = REVERB_DELAY_ELEMENTS;
+	c->active_allpass_elements = REVERB_ALLPASS_ELEMENTS;
+
 	// Instance was successfully initialized
 	c->initialized = true;
 	return REVERB_OK;
@@ -215,6 +260,62 @@ RESULT_STEREO_REVERB reverb_change_lp_damp_coeff(STEREO_REVERB * c,
 
 }
 
+/**
+ * @brief Set the quality tier used for load shedding
+ *
+ * Lower tiers run fewer comb (delay LPF) and all-pass filters per side.  The
+ * bypass tier passes the dry signal only.  Filters that are switched back on
+ * are cleared first so stale content from before they were switched off
+ * isn't heard.
+ *
+ * @param c Pointer to instance structure
+ * @param tier Quality tier
+ * @return Reverb result (enumerated)
+ */
+RESULT_STEREO_REVERB reverb_set_quality(STEREO_REVERB * c, QUALITY_TIER tier) {
+
+	// The buffers aren't allocated until the instance has been set up
+	if (c == NULL || !c->initialized) {
+		return REVERB_INVALID_INSTANCE_POINTER;
+	}
+
+	uint32_t delay_elements, allpass_elements;
+	switch (tier) {
+	case QUALITY_TIER_FULL:
+		delay_elements = REVERB_DELAY_ELEMENTS;
+		allpass_elements = REVERB_ALLPASS_ELEMENTS;
+		break;
+	case QUALITY_TIER_REDUCED:
+		delay_elements = REVERB_DELAY_ELEMENTS_REDUCED;
+		allpass_elements = REVERB_ALLPASS_ELEMENTS;
+		break;
+	case QUALITY_TIER_MINIMAL:
+		delay_elements = REVERB_DELAY_ELEMENTS_MINIMAL;
+		allpass_elements = REVERB_ALLPASS_ELEMENTS_MINIMAL;
+		break;
+	default:
+		delay_elements = 0;
+		allpass_elements = 0;
+		break;
+	}
+
+	// Clear any filters that are being switched back on
+	for (int i = c->active_delay_elements; i < delay_elements; i++) {
+		clear_buffer(c->delay_buffers_left[i], REVERB_MAX_DELAY_SIZE);
+		clear_buffer(c->delay_buffers_right[i], REVERB_MAX_DELAY_SIZE);
+	}
+	for (int i = c->active_allpass_elements; i < allpass_elements; i++) {
+		clear_buffer(c->allpass_buffers_left[i], REVERB_MAX_ALLPASS_SIZE);
+		clear_buffer(c->allpass_buffers_right[i], REVERB_MAX_ALLPASS_SIZE);
+	}
+
+	c->quality = tier;
+	c->active_delay_elements = delay_elements;
+	c->active_allpass_elements = allpass_elements;
+
+	return REVERB_OK;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -237,34 +338,56 @@ void reverb_read(STEREO_REVERB * c, float * audio_in, float * audio_out_left,
 	}
 
 	int i;
-	float temp_audio1[MAX_AUDIO_BLOCK_SIZE], temp_audio2[MAX_AUDIO_BLOCK_SIZE];
+
+	uint32_t delay_elements = c->active_delay_elements;
+	uint32_t allpass_elements = c->active_allpass_elements;
+
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * temp_audio1 = scratch_alloc(audio_block_size);
+	float * temp_audio2 = scratch_alloc(audio_block_size);
+
+	// Bypass tier (load shedding) or no scratch memory - dry signal only
+	if (delay_elements == 0 || temp_audio1 == NULL || temp_audio2 == NULL) {
+		scratch_release(scratch);
+		for (i = 0; i < audio_block_size; i++) {
+			audio_out_left[i] = audio_in[i] * c->dry_mix;
+			audio_out_right[i] = audio_in[i] * c->dry_mix;
+		}
+		return;
+	}
+
+	// Keep the wet level roughly constant regardless of how many combs are running
+	float wet_gain = c->wet_mix * (1.0 / (2 * delay_elements));
 
 	clear_buffer(temp_audio1, audio_block_size);
-	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
+	for (int i = 0; i < delay_elements; i++) {
 		delay_read(&c->lpcf_left[i], audio_in, temp_audio2, audio_block_size);
 		mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
 	}
 
 	// run through all-pass filters
-	for (int i = 0; i < REVERB_ALLPASS_ELEMENTS; i++) {
+	for (int i = 0; i < allpass_elements; i++) {
 		allpass_read(&c->allpass_outputs_left[i], temp_audio1, temp_audio1,
 				audio_block_size);
 	}
-	mix_2x1_gain(temp_audio1, c->wet_mix * (1.0 / (2 * REVERB_DELAY_ELEMENTS)),
-			audio_in, c->dry_mix, audio_out_left, audio_block_size);
+	mix_2x1_gain(temp_audio1, wet_gain, audio_in, c->dry_mix, audio_out_left,
+			audio_block_size);
 
 	clear_buffer(temp_audio1, audio_block_size);
-	for (int i = 0; i < REVERB_DELAY_ELEMENTS; i++) {
+	for (int i = 0; i < delay_elements; i++) {
 		delay_read(&c->lpcf_right[i], audio_in, temp_audio2, audio_block_size);
 		mix_2x1(temp_audio1, temp_audio2, temp_audio1, audio_block_size);
 	}
 
 	// run through all-pass filters
-	for (int i = 0; i < REVERB_ALLPASS_ELEMENTS; i++) {
+	for (int i = 0; i < allpass_elements; i++) {
 		allpass_read(&c->allpass_outputs_right[i], temp_audio1, temp_audio1,
 				audio_block_size);
 	}
-	mix_2x1_gain(temp_audio1, c->wet_mix * (1.0 / (2 * REVERB_DELAY_ELEMENTS)),
-			audio_in, c->dry_mix, audio_out_right, audio_block_size);
+	mix_2x1_gain(temp_audio1, wet_gain, audio_in, c->dry_mix, audio_out_right,
+			audio_block_size);
+
+	scratch_release(scratch);
 
 }
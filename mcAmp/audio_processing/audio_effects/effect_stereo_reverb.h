@@ -17,6 +17,8 @@
 #include "../audio_elements/integer_delay_lpf.h"
 #include "../audio_elements/allpass_filter.h"
 #include "../audio_elements/audio_utilities.h"
+#include "../audio_elements/scratch_arena.h"
+#include "../audio_elements/memory_placement.h"
 
 #define REVERB_MAX_DELAY_SIZE   1700
 #define REVERB_MAX_ALLPASS_SIZE 556
@@ -24,6 +26,11 @@
 #define REVERB_ALLPASS_ELEMENTS (4)
 #define REVERB_DELAY_ELEMENTS   (8)
 
+// Number of comb / all-pass filters used at the reduced and minimal quality tiers
+#define REVERB_DELAY_ELEMENTS_REDUCED   (4)
+#define REVERB_DELAY_ELEMENTS_MINIMAL   (2)
+#define REVERB_ALLPASS_ELEMENTS_MINIMAL (2)
+
 // Result enumerations
 typedef enum {
 	REVERB_OK,
@@ -31,7 +38,8 @@ typedef enum {
 	REVERB_INVALID_WET_MIX,
 	REVERB_INVALID_DRY_MIX,
 	REVERB_INVALID_FEEDBACK,
-	REVERB_INVALID_LP_DAMP
+	REVERB_INVALID_LP_DAMP,
+	REVERB_OUT_OF_MEMORY
 } RESULT_STEREO_REVERB;
 
 // C struct with parameters and state information
@@ -44,15 +52,24 @@ typedef struct {
 	float wet_mix;
 	float dry_mix;
 
+	// Load shedding
+	QUALITY_TIER quality;
+	uint32_t active_delay_elements;
+	uint32_t active_allpass_elements;
+
 	ALLPASS_FILTER allpass_outputs_left[REVERB_ALLPASS_ELEMENTS];
 	ALLPASS_FILTER allpass_outputs_right[REVERB_ALLPASS_ELEMENTS];
-	float allpass_buffers_left[REVERB_ALLPASS_ELEMENTS][REVERB_MAX_ALLPASS_SIZE];
-	float allpass_buffers_right[REVERB_ALLPASS_ELEMENTS][REVERB_MAX_ALLPASS_SIZE];
+
+	// Short all-pass buffers are accessed every sample so are placed in L1
+	float (*allpass_buffers_left)[REVERB_MAX_ALLPASS_SIZE];
+	float (*allpass_buffers_right)[REVERB_MAX_ALLPASS_SIZE];
 
 	DELAY_LPF lpcf_left[REVERB_DELAY_ELEMENTS];
 	DELAY_LPF lpcf_right[REVERB_DELAY_ELEMENTS];
-	float delay_buffers_left[REVERB_DELAY_ELEMENTS][REVERB_MAX_DELAY_SIZE];
-	float delay_buffers_right[REVERB_DELAY_ELEMENTS][REVERB_MAX_DELAY_SIZE];
+
+	// The comb filter delay lines make up the bulk of the memory so are placed in SDRAM
+	float (*delay_buffers_left)[REVERB_MAX_DELAY_SIZE];
+	float (*delay_buffers_right)[REVERB_MAX_DELAY_SIZE];
 
 } STEREO_REVERB;
 
@@ -74,6 +91,8 @@ RESULT_STEREO_REVERB reverb_change_feedback(STEREO_REVERB * c,
 RESULT_STEREO_REVERB reverb_change_lp_damp_coeff(STEREO_REVERB * c,
 		float lp_damp_new);
 
+RESULT_STEREO_REVERB reverb_set_quality(STEREO_REVERB * c, QUALITY_TIER tier);
+
 void reverb_read(STEREO_REVERB * c, float * audio_in, float * audio_out_left,
 		float * audio_out_right, uint32_t audio_block_size);
 
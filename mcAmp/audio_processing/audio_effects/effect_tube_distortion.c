@@ -15,6 +15,7 @@
  */
 
 #include "effect_tube_distortion.h"
+#include "../audio_elements/scratch_arena.h"
 
 // Min/max limits and other constants
 #define  TUBE_DISTORTION_CONTOUR_MIN      (0.0)
@@ -216,6 +217,28 @@ RESULT_TUBE_DISTORTION tube_distortion_modify_contour(TUBE_DISTORTION * c,
 
 }
 
+/**
+ * @brief Set the quality tier used for load shedding
+ *
+ * The oversampling around the clipper is the bulk of the processing so the
+ * tier is passed on to the clipper (8x, 4x, then no oversampling).
+ *
+ * @param c Pointer to instance structure
+ * @param tier Quality tier
+ * @return Tube distortion result (enumeration)
+ */
+RESULT_TUBE_DISTORTION tube_distortion_set_quality(TUBE_DISTORTION * c,
+		QUALITY_TIER tier) {
+
+	if (c == NULL) {
+		return TUBE_DISTORTION_INVALID_INSTANCE_POINTER;
+	}
+
+	clipper_set_quality(&c->clipper, tier);
+
+	return TUBE_DISTORTION_OK;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -235,8 +258,16 @@ void tube_distortion_read(TUBE_DISTORTION * c, float * audio_in,
 		return;
 	}
 
-	float temp_audio_1[MAX_AUDIO_BLOCK_SIZE],
-			temp_audio_2[MAX_AUDIO_BLOCK_SIZE];
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * temp_audio_1 = scratch_alloc(audio_block_size);
+
+	if (temp_audio_1 == NULL) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
 
 	// Apply input filter
 	filter_read(&c->input_filter, audio_in, temp_audio_1, audio_block_size);
@@ -257,4 +288,6 @@ void tube_distortion_read(TUBE_DISTORTION * c, float * audio_in,
 	// Apply output filter
 	filter_read(&c->output_filter, audio_out, audio_out, audio_block_size);
 
+	scratch_release(scratch);
+
 }
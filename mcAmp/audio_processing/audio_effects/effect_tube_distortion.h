@@ -59,6 +59,9 @@ RESULT_TUBE_DISTORTION tube_distortion_modify_threshold(TUBE_DISTORTION * c,
 RESULT_TUBE_DISTORTION tube_distortion_modify_contour(TUBE_DISTORTION * c,
 		float contour);
 
+RESULT_TUBE_DISTORTION tube_distortion_set_quality(TUBE_DISTORTION * c,
+		QUALITY_TIER tier);
+
 // Wrapper allows C code to be called from C++ files
 #if __cplusplus
 }
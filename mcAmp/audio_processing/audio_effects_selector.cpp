@@ -11,9 +11,30 @@
 
 #include "common/audio_system_config.h"
 #include "common/multicore_shared_memory.h"
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+#include <sysreg.h>
 
 #include "audio_effects_selector.h"
 
+// Number of core cycles available per audio block
+#define EFFECTS_BLOCK_CYCLES    ((uint32_t)(((uint64_t)CORE_CLOCK_FREQ_HZ * AUDIO_BLOCK_SIZE) / AUDIO_SAMPLE_RATE))
+
+// Load shedding controller and the tier currently applied to the effects on this core
+static LOAD_SHEDDING effects_load_shedding;
+static QUALITY_TIER effects_quality_tier = QUALITY_TIER_FULL;
+
+// Core cycles the effect chain on this core took for the last block
+static uint32_t effects_chain_cycles = 0;
+
+// Quality tier and idle state of the effects on this core, published for the ARM
+static BM_METRIC effects_quality_tier_metric;
+static BM_METRIC effects_idle_metric;
+
+// Silence detection on the input and output of the effect chain on this core
+static SILENCE_DETECTOR effects_silence_in_l, effects_silence_in_r;
+static SILENCE_DETECTOR effects_silence_out_l, effects_silence_out_r;
+
 // Audio buffers to pass audio to and from the effects
 float audio_effects_left_in[AUDIO_BLOCK_SIZE];
 float audio_effects_right_in[AUDIO_BLOCK_SIZE];
@@ -21,19 +42,136 @@ float audio_effects_right_in[AUDIO_BLOCK_SIZE];
 float audio_effects_left_out[AUDIO_BLOCK_SIZE];
 float audio_effects_right_out[AUDIO_BLOCK_SIZE];
 
+/*
+ * Controls read by the presets on core 1.  Each preset run starts from the
+ * values at the start of the block and the control events posted for the
+ * block update them at their offsets as the block is run.
+ */
+static float effect_controls[EFFECT_CONTROLS];
+static float effect_controls_block_start[EFFECT_CONTROLS];
+
+// Last pot values seen, so a pot only takes over a control when it moves
+static float effect_pots_last[EFFECT_CONTROLS];
+
+/*
+ * Parameters the preset setup routines read.  The background loop runs the
+ * setup while the audio callback may refresh shared_parameters, so it takes
+ * a copy first (see audio_effects_background_core1()).
+ */
+static SHARED_PARAMETERS preset_setup_parameters;
+
+// Event ID EFFECT_EVENT_NOTE + n is MIDI note n (lower IDs are controls)
+#define EFFECT_EVENT_NOTE       (EFFECT_CONTROLS)
+
+// Control changes and notes posted for the current block on core 1
+static BLOCK_SPLITTER effects_splitter;
+
+/**
+ * @brief Sets up the load shedding controller for this core
+ *
+ * @param lowest_tier Cheapest tier the effects on this core support
+ */
+static void effects_load_shedding_setup(QUALITY_TIER lowest_tier) {
+
+	load_shedding_setup(&effects_load_shedding, EFFECTS_BLOCK_CYCLES,
+			LOAD_SHEDDING_STEP_DOWN_PERCENT * 0.01,
+			LOAD_SHEDDING_STEP_UP_PERCENT * 0.01,
+			LOAD_SHEDDING_HOLD_BLOCKS, lowest_tier);
+
+	effects_quality_tier = QUALITY_TIER_FULL;
+	effects_chain_cycles = 0;
+}
+
+/**
+ * @brief Sets how long the chain's output must stay silent before it is skipped
+ *
+ * @param tail_ms Time for the longest tail of the effects to decay
+ */
+static void effects_silence_set_tail(float tail_ms) {
+
+	silence_detector_modify_hangover(&effects_silence_out_l, tail_ms,
+	AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	silence_detector_modify_hangover(&effects_silence_out_r, tail_ms,
+	AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+}
+
+/**
+ * @brief Sets up the silence detectors on the effect chain for this core
+ *
+ * @param tail_ms Time for the longest tail of the effects to decay
+ */
+static void effects_silence_setup(float tail_ms) {
+
+	// Any non-silent input block wakes the chain up again straight away
+	silence_detector_setup(&effects_silence_in_l, SILENCE_THRESHOLD_DB, 0.0,
+	AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	silence_detector_setup(&effects_silence_in_r, SILENCE_THRESHOLD_DB, 0.0,
+	AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+
+	// The output must stay silent for a while so we know the tails have decayed
+	silence_detector_setup(&effects_silence_out_l, SILENCE_THRESHOLD_DB,
+			tail_ms, AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	silence_detector_setup(&effects_silence_out_r, SILENCE_THRESHOLD_DB,
+			tail_ms, AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+}
+
+/**
+ * @brief Checks whether the effect chain can be skipped for this block
+ *
+ * The chain is idle when its input is silent and its output has been silent
+ * long enough for any tails (reverb, delay feedback) to have decayed, which
+ * on core 1 is the active preset's tail_ms.  When
+ * the chain is idle, the output buffers are cleared instead of running the
+ * effects.  As the effects' internal state has decayed below the silence
+ * threshold, they pick up again without a discontinuity when audio resumes.
+ *
+ * @return true if the chain is idle and the effects shouldn't be run
+ */
+#pragma optimize_for_speed
+static bool effects_chain_idle(void) {
+
+	// Check both channels so neither detector misses a block
+	bool silent_l = silence_detector_read(&effects_silence_in_l,
+			audio_effects_left_in, AUDIO_BLOCK_SIZE);
+	bool silent_r = silence_detector_read(&effects_silence_in_r,
+			audio_effects_right_in, AUDIO_BLOCK_SIZE);
+
+	if (!silent_l || !silent_r
+			|| !silence_detector_is_silent(&effects_silence_out_l)
+			|| !silence_detector_is_silent(&effects_silence_out_r)) {
+		return false;
+	}
+
+	clear_buffer(audio_effects_left_out, AUDIO_BLOCK_SIZE);
+	clear_buffer(audio_effects_right_out, AUDIO_BLOCK_SIZE);
+	return true;
+}
+
+/**
+ * @brief Updates the output silence detectors after the effect chain has run
+ */
+#pragma optimize_for_speed
+static void effects_chain_update_tails(void) {
+
+	silence_detector_read(&effects_silence_out_l, audio_effects_left_out,
+	AUDIO_BLOCK_SIZE);
+	silence_detector_read(&effects_silence_out_r, audio_effects_right_out,
+	AUDIO_BLOCK_SIZE);
+}
+
 /**
  * @brief Audio bypass routine
  *
  * The effect bypass routine will simply pass audio from the input buffers to
  * the output buffers.
  */
-static void effect_bypass(void) {
+static void effect_bypass(uint32_t offset, uint32_t length) {
 
 	// Copy input buffers to output buffers, thereby bypassing effects
-	copy_buffer(audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
-	copy_buffer(audio_effects_right_in, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	copy_buffer(audio_effects_left_in + offset, audio_effects_left_out + offset,
+			length);
+	copy_buffer(audio_effects_right_in + offset,
+			audio_effects_right_out + offset, length);
 
 }
 
@@ -64,12 +202,11 @@ static void effect_bypass(void) {
 // Declare instances and buffers
 DELAY_LPF integer_delay_l, integer_delay_r;
 
-// declare delay buffers in SDRAM with a max length of 32000 (2/3 of a second each
+// delay buffers with a max length of 32000 (2/3 of a second each), allocated
+// from SDRAM in audio_effects_allocate_core1()
 #define INT_DELAY_LEN	(32000)
-#pragma section("seg_sdram")
-float integer_delay_line_l[INT_DELAY_LEN];
-#pragma section("seg_sdram")
-float integer_delay_line_r[INT_DELAY_LEN];
+float * integer_delay_line_l;
+float * integer_delay_line_r;
 
 /**
  * @brief Setup routine to initialize instances of the delay line
@@ -86,38 +223,45 @@ static void effect_echo_setup() {
 }
 
 /**
- * @brief  Process audio and update some modifiable parameters via the pots
+ * @brief  Process audio
  */
-static void effect_echo_process() {
+static void effect_echo_process(uint32_t offset, uint32_t length) {
 
 	// Apply effect
-	delay_read(&integer_delay_l, audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
-	delay_read(&integer_delay_r, audio_effects_left_in, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	delay_read(&integer_delay_l, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
+	delay_read(&integer_delay_r, audio_effects_left_in + offset,
+			audio_effects_right_out + offset, length);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_echo_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to modify the dampening factor in feeedback path of delay
-	delay_modify_dampening(&integer_delay_l,
-			multicore_data->audioproj_fin_pot_hadc0 * 0.3 + 0.1);
-	delay_modify_dampening(&integer_delay_r,
-			multicore_data->audioproj_fin_pot_hadc0 * 0.3 + 0.1);
+	case EFFECT_CONTROL_HADC0:
+		delay_modify_dampening(&integer_delay_l, value * 0.3 + 0.1);
+		delay_modify_dampening(&integer_delay_r, value * 0.3 + 0.1);
+		break;
 
 	// Use pot (HADC1) to modify the lenght of the delay
-	delay_modify_length(&integer_delay_l,
-			INT_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc1 * INT_DELAY_LEN
-							/ 2);
-	delay_modify_length(&integer_delay_r,
-			INT_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc1 * INT_DELAY_LEN
-							/ 2);
+	case EFFECT_CONTROL_HADC1:
+		delay_modify_length(&integer_delay_l,
+				INT_DELAY_LEN / 2 + value * INT_DELAY_LEN / 2);
+		delay_modify_length(&integer_delay_r,
+				INT_DELAY_LEN / 2 + value * INT_DELAY_LEN / 2);
+		break;
 
 	// Use pot (HADC2) to modify the feedback value
-	delay_modify_feedback(&integer_delay_l,
-			multicore_data->audioproj_fin_pot_hadc2);
-	delay_modify_feedback(&integer_delay_r,
-			multicore_data->audioproj_fin_pot_hadc2);
-
+	case EFFECT_CONTROL_HADC2:
+		delay_modify_feedback(&integer_delay_l, value);
+		delay_modify_feedback(&integer_delay_r, value);
+		break;
+	}
 }
 
 /**
@@ -143,10 +287,8 @@ static void effect_echo_process() {
 // Declare instances and buffers
 MULTITAP_DELAY integer_mt_delay_l, integer_mt_delay_r;
 #define INT_DELAY_LEN	(32000)
-#pragma section("seg_sdram")
-float integer_mt_delay_line_l[INT_DELAY_LEN]; // Delay line in SDRAM
-#pragma section("seg_sdram")
-float integer_mt_delay_line_r[INT_DELAY_LEN]; // Delay line in SDRAM
+float * integer_mt_delay_line_l; // Delay line in SDRAM
+float * integer_mt_delay_line_r; // Delay line in SDRAM
 
 uint32_t tap_offsets_l[3] = { 10000, 20000, 28000 };
 uint32_t tap_offsets_r[3] = { 8000, 22000, 29000 };
@@ -167,18 +309,16 @@ static void effect_multitap_delay_setup() {
 }
 
 /**
- * @brief  Process audio and update some modifiable parameters via the pots
+ * @brief  Process audio (this effect has no modifiable parameters)
  */
-static void effect_multitap_delay_process() {
+static void effect_multitap_delay_process(uint32_t offset, uint32_t length) {
 
 	// Apply effect
-	multitap_delay_read(&integer_mt_delay_l, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	multitap_delay_read(&integer_mt_delay_l, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
-	multitap_delay_read(&integer_mt_delay_r, audio_effects_left_in,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	multitap_delay_read(&integer_mt_delay_r, audio_effects_left_in + offset,
+			audio_effects_right_out + offset, length);
 }
 
 /**
@@ -212,37 +352,48 @@ static void effect_tube_distortion_setup(void) {
 
 	// Initialize effect instance
 	tube_distortion_setup(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0,
-			multicore_data->audioproj_fin_pot_hadc0 * 1.0,
-			multicore_data->audioproj_fin_pot_hadc2,
+			preset_setup_parameters.audioproj_fin_pot_hadc1 * 64.0,
+			preset_setup_parameters.audioproj_fin_pot_hadc0 * 1.0,
+			preset_setup_parameters.audioproj_fin_pot_hadc2,
 			AUDIO_SAMPLE_RATE);
 }
 
 /**
- * @briend Process audio and update some modifiable parameters via the pots
+ * @briend Process audio
  */
-static void effect_tube_distortion_process(void) {
-	tube_distortion_read(&tube_dist, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+static void effect_tube_distortion_process(uint32_t offset, uint32_t length) {
+	tube_distortion_read(&tube_dist, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
 	// Make stereo
-	for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
+	for (uint32_t i = offset; i < offset + length; i++) {
 		audio_effects_right_out[i] = audio_effects_left_out[i];
 	}
+}
 
-	// Use pot (HADC0) to modify the output gain of the distortion
-	tube_distortion_modify_gain(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc2 * 0.5);
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_tube_distortion_apply(void * context, uint32_t control,
+		float value) {
 
-	// Use pot (HADC1) to modify the input drive into the clipping function of the distortion
-	tube_distortion_modify_drive(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0);
+	switch (control) {
+
+	// Use pot (HADC2) to modify the output gain of the distortion
+	case EFFECT_CONTROL_HADC2:
+		tube_distortion_modify_gain(&tube_dist, value * 0.5);
+		break;
 
-	// Use pot (HADC2) to modify the bandpass filter after the clipper to change the tone
-	tube_distortion_modify_contour(&tube_dist,
-			multicore_data->audioproj_fin_pot_hadc0);
+	// Use pot (HADC1) to modify the input drive into the clipping function of the distortion
+	case EFFECT_CONTROL_HADC1:
+		tube_distortion_modify_drive(&tube_dist, value * 64.0);
+		break;
 
+	// Use pot (HADC0) to modify the bandpass filter after the clipper to change the tone
+	case EFFECT_CONTROL_HADC0:
+		tube_distortion_modify_contour(&tube_dist, value);
+		break;
+	}
 }
 
 /**
@@ -285,36 +436,44 @@ static void effect_multiband_compressor_setup(void) {
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Process audio
  */
-static void effect_multiband_compressor_process(void) {
+static void effect_multiband_compressor_process(uint32_t offset,
+		uint32_t length) {
 
-	multiband_comp_read(&multiband_comp_l, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	multiband_comp_read(&multiband_comp_l, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
-	multiband_comp_read(&multiband_comp_r, audio_effects_right_in,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	multiband_comp_read(&multiband_comp_r, audio_effects_right_in + offset,
+			audio_effects_right_out + offset, length);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_multiband_compressor_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) set the cross-over frequency in Hz
-	multiband_comp_change_xover(&multiband_comp_l,
-			100.0 + 600.0 * multicore_data->audioproj_fin_pot_hadc0);
-	multiband_comp_change_xover(&multiband_comp_r,
-			100.0 + 600.0 * multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		multiband_comp_change_xover(&multiband_comp_l, 100.0 + 600.0 * value);
+		multiband_comp_change_xover(&multiband_comp_r, 100.0 + 600.0 * value);
+		break;
 
 	// Use pot (HADC1) to set compressor threshold (dB)
-	multiband_comp_change_thresh(&multiband_comp_l,
-			-50.0 * multicore_data->audioproj_fin_pot_hadc1);
-	multiband_comp_change_thresh(&multiband_comp_r,
-			-50.0 * multicore_data->audioproj_fin_pot_hadc1);
+	case EFFECT_CONTROL_HADC1:
+		multiband_comp_change_thresh(&multiband_comp_l, -50.0 * value);
+		multiband_comp_change_thresh(&multiband_comp_r, -50.0 * value);
+		break;
 
 	// Use pot (HADC2) to modify the output gain of the compressors
-	multiband_comp_change_gain(&multiband_comp_l,
-			4.0 * multicore_data->audioproj_fin_pot_hadc2);
-	multiband_comp_change_gain(&multiband_comp_r,
-			4.0 * multicore_data->audioproj_fin_pot_hadc2);
-
+	case EFFECT_CONTROL_HADC2:
+		multiband_comp_change_gain(&multiband_comp_l, 4.0 * value);
+		multiband_comp_change_gain(&multiband_comp_r, 4.0 * value);
+		break;
+	}
 }
 
 /**
@@ -326,16 +485,48 @@ static void effect_multiband_compressor_process(void) {
  * vibrato effect and a phaser effect.  In this case, it is configured
  * as a flanger but could be easily modified to realize these other effects.
  *
- * POT/HADC0 : the cross-over frequency (Hz) ranging from 100-600Hz
- * POT/HADC1 : the compressor threshold
- * POT/HADC2 : the output gain of the compressor
+ * The LFOs and the pots are sources in a modulation matrix (see
+ * modulation_matrix.c) that's evaluated once per span, and the delays are
+ * swept by its per-sample ramps rather than by LFOs computed in the flanger.
+ *
+ * POT/HADC0 : the flanger rate (Hz)
+ * POT/HADC1 : the flanger depth
+ * POT/HADC2 : the flanger feedback
  *
  * Some fun things to try:
  *  - Try reducing the delay length to create more of a phaser effect
+ *  - Route an envelope follower to the depth as well as the pot
  *
  */
 
 STEREO_FLANGER flanger;
+MOD_MATRIX flanger_modulation;
+
+// Sources and destinations in flanger_modulation (in the order they're added)
+enum {
+	FLANGER_MOD_LFO_LEFT,
+	FLANGER_MOD_LFO_RIGHT,
+	FLANGER_MOD_DEPTH_POT,
+	FLANGER_MOD_FEEDBACK_POT
+};
+enum {
+	FLANGER_MOD_DELAY_LEFT,
+	FLANGER_MOD_DELAY_RIGHT,
+	FLANGER_MOD_DEPTH,
+	FLANGER_MOD_FEEDBACK
+};
+
+// Per-sample sweep of each delay over the current span
+static float flanger_sweep_left[AUDIO_BLOCK_SIZE];
+static float flanger_sweep_right[AUDIO_BLOCK_SIZE];
+
+static void flanger_apply_depth(void * instance, float value) {
+	flanger_modify_depth((STEREO_FLANGER *) instance, value);
+}
+
+static void flanger_apply_feedback(void * instance, float value) {
+	flanger_modify_feedback((STEREO_FLANGER *) instance, value);
+}
 
 /**
  * @brief Setup routine to initialize instance of the stereo flanger
@@ -345,29 +536,73 @@ static void effect_flanger_setup(void) {
 	// Initialize effect instance
 	flanger_setup(&flanger, 0.5, 0.5, 0.5, AUDIO_SAMPLE_RATE);
 
+	// LFOs 180 degrees out of phase sweep the left and right delays
+	mod_matrix_setup(&flanger_modulation, AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	mod_matrix_add_lfo(&flanger_modulation, MOD_LFO_SINE, 0.5, 0.0, NULL);
+	mod_matrix_add_lfo(&flanger_modulation, MOD_LFO_SINE, 0.5, 0.5, NULL);
+	mod_matrix_add_control(&flanger_modulation, 0.5, NULL);
+	mod_matrix_add_control(&flanger_modulation, 0.5, NULL);
+
+	mod_matrix_add_destination(&flanger_modulation, 0.0, -1.0, 1.0, NULL,
+			NULL, flanger_sweep_left, NULL);
+	mod_matrix_add_destination(&flanger_modulation, 0.0, -1.0, 1.0, NULL,
+			NULL, flanger_sweep_right, NULL);
+	mod_matrix_add_destination(&flanger_modulation, 0.0, 0.0, 1.0,
+			flanger_apply_depth, &flanger, NULL, NULL);
+	mod_matrix_add_destination(&flanger_modulation, -1.0, -1.0, 1.0,
+			flanger_apply_feedback, &flanger, NULL, NULL);
+
+	mod_matrix_add_route(&flanger_modulation, FLANGER_MOD_LFO_LEFT,
+			FLANGER_MOD_DELAY_LEFT, 1.0, NULL);
+	mod_matrix_add_route(&flanger_modulation, FLANGER_MOD_LFO_RIGHT,
+			FLANGER_MOD_DELAY_RIGHT, 1.0, NULL);
+	mod_matrix_add_route(&flanger_modulation, FLANGER_MOD_DEPTH_POT,
+			FLANGER_MOD_DEPTH, 1.0, NULL);
+	mod_matrix_add_route(&flanger_modulation, FLANGER_MOD_FEEDBACK_POT,
+			FLANGER_MOD_FEEDBACK, 2.0, NULL);
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Process audio
  */
-static void effect_flanger_process(void) {
+static void effect_flanger_process(uint32_t offset, uint32_t length) {
+
+	mod_matrix_update(&flanger_modulation, length);
 
 	// Apply effect
-	flanger_read(&flanger, audio_effects_left_in, audio_effects_left_out,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	flanger_read_modulated(&flanger, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, audio_effects_right_out + offset,
+			flanger_sweep_left, flanger_sweep_right, length);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_flanger_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to set the flanger rate in Hz
-	flanger_modify_rate(&flanger,
-			2.0 * multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		mod_matrix_modify_lfo_rate(&flanger_modulation, FLANGER_MOD_LFO_LEFT,
+				2.0 * value);
+		mod_matrix_modify_lfo_rate(&flanger_modulation, FLANGER_MOD_LFO_RIGHT,
+				2.0 * value);
+		break;
 
 	// Use pot (HADC1) to set the flanger depth (0 -> 1.0)
-	flanger_modify_depth(&flanger, multicore_data->audioproj_fin_pot_hadc1);
+	case EFFECT_CONTROL_HADC1:
+		mod_matrix_set_control(&flanger_modulation, FLANGER_MOD_DEPTH_POT,
+				value);
+		break;
 
 	// Use pot (HADC2) to set the flanger feedback (-1.0 -> 0 -> 1.0)
-	flanger_modify_feedback(&flanger,
-			2.0 * multicore_data->audioproj_fin_pot_hadc2 - 1.0);
-
+	case EFFECT_CONTROL_HADC2:
+		mod_matrix_set_control(&flanger_modulation, FLANGER_MOD_FEEDBACK_POT,
+				value);
+		break;
+	}
 }
 
 /**
@@ -403,26 +638,48 @@ static void effect_guitar_synth_setup(void) {
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Process audio
  */
-static void effect_guitar_synth_process(void) {
+static void effect_guitar_synth_process(uint32_t offset, uint32_t length) {
 
 	// Apply effect
-	guitar_synth_read(&guitar_synth, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	guitar_synth_read(&guitar_synth, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	copy_buffer(audio_effects_left_out + offset,
+			audio_effects_right_out + offset, length);
+}
+
+/**
+ * Play notes received over MIDI on the synth voices
+ */
+static void effect_guitar_synth_note(uint32_t note, float velocity) {
+
+	if (velocity > 0.0) {
+		guitar_synth_note_on(&guitar_synth, note, velocity);
+	} else {
+		guitar_synth_note_off(&guitar_synth, note);
+	}
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_guitar_synth_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to set the clean mix
-	guitar_synth_modify_clean_mix(&guitar_synth,
-			multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		guitar_synth_modify_clean_mix(&guitar_synth, value);
+		break;
 
 	// Use pot (HADC1) to set the synth mix
-	guitar_synth_modify_synth_mix(&guitar_synth,
-			multicore_data->audioproj_fin_pot_hadc1);
-
+	case EFFECT_CONTROL_HADC1:
+		guitar_synth_modify_synth_mix(&guitar_synth, value);
+		break;
+	}
 }
 
 /**
@@ -434,15 +691,42 @@ static void effect_guitar_synth_process(void) {
  * When the amplitude decreases, the filter sweeps towards lower frequencies.
  * The filter characteristics and range are similar to a traditional Wah pedal.
  *
+ * The envelope follower is a source in a modulation matrix (see
+ * modulation_matrix.c) routed to the filter frequency, so the filter is only
+ * recomputed when the envelope has moved.
+ *
  * POT/HADC0 : depth of frequency sweep
  * POT/HADC1 : decay time
  * POT/HADC2 : width of filter (Q)
  *
  * Some fun things to try:
  *  - Try changing the effect so the filter moves in the opposite direction than amplitude
+ *    (a negative depth on the envelope route)
+ *  - Add an LFO source and route it to the filter frequency too
  *
  */
 AUTOWAH autowah;
+MOD_MATRIX autowah_modulation;
+
+// Sources, destinations and routes in autowah_modulation (in the order they're added)
+enum {
+	AUTOWAH_MOD_ENVELOPE
+};
+enum {
+	AUTOWAH_MOD_FREQ
+};
+enum {
+	AUTOWAH_MOD_ENVELOPE_FREQ
+};
+
+// Filter sweep (Hz) from AUTOWAH_SWEEP_MIN_HZ up by the envelope times the depth
+#define AUTOWAH_SWEEP_MIN_HZ        (300.0)
+#define AUTOWAH_SWEEP_MAX_HZ        (1100.0)
+#define AUTOWAH_SWEEP_DEPTH_HZ      (10000.0)
+
+static void autowah_apply_freq(void * instance, float value) {
+	autowah_modify_freq((AUTOWAH *) instance, value);
+}
 
 /**
  * @brief Setup routine to initialize instance of the autowah
@@ -450,33 +734,65 @@ AUTOWAH autowah;
 static void effect_autowah_setup(void) {
 
 	// Initialize effect instance
-	autowah_setup(&autowah, multicore_data->audioproj_fin_pot_hadc0,
-			multicore_data->audioproj_fin_pot_hadc1,
+	autowah_setup(&autowah, preset_setup_parameters.audioproj_fin_pot_hadc0,
+			preset_setup_parameters.audioproj_fin_pot_hadc1,
 			AUDIO_SAMPLE_RATE);
 
+	mod_matrix_setup(&autowah_modulation, AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	mod_matrix_add_envelope(&autowah_modulation,
+			0.999 + 0.001 * preset_setup_parameters.audioproj_fin_pot_hadc1, NULL);
+	mod_matrix_add_destination(&autowah_modulation, AUTOWAH_SWEEP_MIN_HZ,
+			AUTOWAH_SWEEP_MIN_HZ, AUTOWAH_SWEEP_MAX_HZ, autowah_apply_freq,
+			&autowah, NULL, NULL);
+	mod_matrix_add_route(&autowah_modulation, AUTOWAH_MOD_ENVELOPE,
+			AUTOWAH_MOD_FREQ,
+			AUTOWAH_SWEEP_DEPTH_HZ * preset_setup_parameters.audioproj_fin_pot_hadc0,
+			NULL);
 }
 
 /**
- * Process audio and update some modifiable parameters via the pots
+ * Process audio
  */
-static void effect_autowah_process(void) {
+static void effect_autowah_process(uint32_t offset, uint32_t length) {
+
+	// Follow the input and sweep the filter
+	mod_matrix_follow(&autowah_modulation, AUTOWAH_MOD_ENVELOPE,
+			audio_effects_left_in + offset, length);
+	mod_matrix_update(&autowah_modulation, length);
 
 	// Apply effect
-	autowah_read(&autowah, audio_effects_left_in, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
+	autowah_read_filter(&autowah, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	copy_buffer(audio_effects_left_out + offset,
+			audio_effects_right_out + offset, length);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_autowah_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to set the depth (i.e. frequency range of sweep)
-	autowah_modify_depth(&autowah, multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		mod_matrix_modify_depth(&autowah_modulation, AUTOWAH_MOD_ENVELOPE_FREQ,
+				AUTOWAH_SWEEP_DEPTH_HZ * value);
+		break;
 
-	// Use pot (HADC0) to set the decay time
-	autowah_modify_decay(&autowah, multicore_data->audioproj_fin_pot_hadc1);
+	// Use pot (HADC1) to set the decay time
+	case EFFECT_CONTROL_HADC1:
+		mod_matrix_modify_envelope_decay(&autowah_modulation,
+				AUTOWAH_MOD_ENVELOPE, 0.999 + 0.001 * value);
+		break;
 
 	// Use pot (HADC2) to set the width of the filter
-	autowah_modify_q(&autowah, multicore_data->audioproj_fin_pot_hadc2);
-
+	case EFFECT_CONTROL_HADC2:
+		autowah_modify_q(&autowah, value);
+		break;
+	}
 }
 
 /**
@@ -498,10 +814,8 @@ STEREO_FLANGER flanger_fx1;
 TUBE_DISTORTION tube_dist_fx1;
 DELAY_LPF delay_l_fx1, delay_r_fx1;
 #define FX_DELAY_LEN	(32000)
-#pragma section("seg_sdram")
-float delay_line_l_fx1[INT_DELAY_LEN];	// Delay line in SDRAM
-#pragma section("seg_sdram")
-float delay_line_r_fx1[INT_DELAY_LEN];	// Delay line in SDRAM
+float * delay_line_l_fx1;	// Delay line in SDRAM
+float * delay_line_r_fx1;	// Delay line in SDRAM
 
 /**
  * @brief Setup routine to initialize instances for the multli-effects example
@@ -513,7 +827,7 @@ static void multifx_1_test_setup(void) {
 	flanger_setup(&flanger_fx1, 0.3, 0.2, -0.35, AUDIO_SAMPLE_RATE);
 
 	tube_distortion_setup(&tube_dist_fx1,
-			multicore_data->audioproj_fin_pot_hadc1 * 128.0, 0.20, 0.9,
+			preset_setup_parameters.audioproj_fin_pot_hadc1 * 128.0, 0.20, 0.9,
 			AUDIO_SAMPLE_RATE);
 
 	delay_setup(&delay_l_fx1, delay_line_l_fx1,
@@ -526,46 +840,62 @@ static void multifx_1_test_setup(void) {
 }
 
 /**
- * @brief: Process audio and update some modifiable parameters via the pots
+ * @brief: Process audio
  */
-static void multifx_1_test_process(void) {
+static void multifx_1_test_process(uint32_t offset, uint32_t length) {
+
+	float * left_out = audio_effects_left_out + offset;
+	float * right_out = audio_effects_right_out + offset;
 
-	// Apply effects
-	float temp_1[AUDIO_BLOCK_SIZE], temp_2[AUDIO_BLOCK_SIZE];
+	// Apply effects (temporaries come from the per-block scratch arena)
+	SCRATCH_MARK scratch = scratch_mark();
+	float * temp_1 = scratch_alloc(length);
+	if (temp_1 == NULL) {
+		effect_bypass(offset, length);
+		return;
+	}
 
 	// Apply distortion
-	tube_distortion_read(&tube_dist_fx1, audio_effects_left_in, temp_1,
-	AUDIO_BLOCK_SIZE);
+	tube_distortion_read(&tube_dist_fx1, audio_effects_left_in + offset,
+			temp_1, length);
 
 	// Apply tremelo
-	flanger_read(&flanger_fx1, temp_1, audio_effects_left_out,
-			audio_effects_right_out,
-			AUDIO_BLOCK_SIZE);
+	flanger_read(&flanger_fx1, temp_1, left_out, right_out, length);
 
 	// Apply delay / echo
-	delay_read(&delay_l_fx1, audio_effects_left_out, audio_effects_left_out,
-	AUDIO_BLOCK_SIZE);
+	delay_read(&delay_l_fx1, left_out, left_out, length);
 
-	delay_read(&delay_r_fx1, audio_effects_right_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	delay_read(&delay_r_fx1, right_out, right_out, length);
+
+	scratch_release(scratch);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void multifx_1_test_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to modify the flanger depth
-	flanger_modify_depth(&flanger_fx1, multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		flanger_modify_depth(&flanger_fx1, value);
+		break;
 
 	// Use pot (HADC1) to modify the distortion drive
-	tube_distortion_modify_drive(&tube_dist_fx1,
-			multicore_data->audioproj_fin_pot_hadc1 * 64.0);
+	case EFFECT_CONTROL_HADC1:
+		tube_distortion_modify_drive(&tube_dist_fx1, value * 64.0);
+		break;
 
 	// Use pot (HADC2) to modify the length of the delay
-	delay_modify_length(&delay_l_fx1,
-			FX_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc2 * FX_DELAY_LEN
-							/ 2);
-	delay_modify_length(&delay_r_fx1,
-			FX_DELAY_LEN / 2
-					+ multicore_data->audioproj_fin_pot_hadc2 * FX_DELAY_LEN / 2
-					- 1000);
-
+	case EFFECT_CONTROL_HADC2:
+		delay_modify_length(&delay_l_fx1,
+				FX_DELAY_LEN / 2 + value * FX_DELAY_LEN / 2);
+		delay_modify_length(&delay_r_fx1,
+				FX_DELAY_LEN / 2 + value * FX_DELAY_LEN / 2 - 1000);
+		break;
+	}
 }
 
 /**
@@ -601,26 +931,356 @@ static void effect_ringmod_setup(void) {
 }
 
 /**
- * @brief Process audio and update some modifiable parameters via the pots
+ * @brief Process audio
  */
-static void effect_ringmod_process(void) {
+static void effect_ringmod_process(uint32_t offset, uint32_t length) {
 
 	// Apply effect
-	ring_modulator_read(&ring_mod, audio_effects_left_in,
-			audio_effects_left_out,
-			AUDIO_BLOCK_SIZE);
+	ring_modulator_read(&ring_mod, audio_effects_left_in + offset,
+			audio_effects_left_out + offset, length);
 
-	copy_buffer(audio_effects_left_out, audio_effects_right_out,
-	AUDIO_BLOCK_SIZE);
+	copy_buffer(audio_effects_left_out + offset,
+			audio_effects_right_out + offset, length);
+}
+
+/**
+ * @brief Applies a pot / control that has moved (see param_binding.c)
+ */
+static void effect_ringmod_apply(void * context, uint32_t control,
+		float value) {
+
+	switch (control) {
 
 	// Use pot (HADC0) to set the modulation frequency
-	ring_modulator_modify_freq(&ring_mod,
-			50.0 + 300.0 * multicore_data->audioproj_fin_pot_hadc0);
+	case EFFECT_CONTROL_HADC0:
+		ring_modulator_modify_freq(&ring_mod, 50.0 + 300.0 * value);
+		break;
 
 	// Use pot (HADC1) to set the depth / mix of the effect
-	ring_modulator_modify_depth(&ring_mod,
-			multicore_data->audioproj_fin_pot_hadc1);
+	case EFFECT_CONTROL_HADC1:
+		ring_modulator_modify_depth(&ring_mod, value);
+		break;
+	}
+}
+
+/******************************************************************************
+ * Preset table and transition manager for SHARC core 1
+ *
+ * Switching straight from one preset to the next causes a discontinuity in
+ * the output, and the incoming effect starts with whatever stale state it had
+ * in its delay lines and filters.  Re-running the setup routine from the audio
+ * callback isn't an option either (e.g. delay_setup() clears 32000 words of
+ * SDRAM).
+ *
+ * Instead, a preset change goes through the following steps:
+ *
+ *  1) PREPARING - the background loop (processaudio_background_loop) runs the
+ *     setup routine of the incoming preset outside the real-time path.
+ *  2) WARMING - the incoming preset is run in parallel with the outgoing one
+ *     for PRESET_TRANSITION_WARMUP_BLOCKS blocks (its output is discarded) so
+ *     delay lines, envelopes and filters hold realistic state.
+ *  3) CROSSFADING - the outputs of both presets are mixed with an equal-power
+ *     crossfade over PRESET_TRANSITION_CROSSFADE_MS.
+ *
+ * Steps 2 and 3 only run when the measured peak cycle counts of both presets
+ * fit within PRESET_TRANSITION_BUDGET_PERCENT of the block.  If they don't,
+ * or the incoming preset hasn't run yet so its cost isn't known, the manager
+ * falls back to fading the outgoing preset out and then the incoming preset
+ * in, which never costs more than a single preset.  The first change to each
+ * preset therefore fades out and in; once it has run, its peak is known and
+ * later changes to it crossfade when they fit.
+ *****************************************************************************/
+
+/*
+ * process runs the preset over a span of the block, apply applies a control
+ * that has moved (see preset_params) and note plays a MIDI note (velocity 0
+ * releases it).  apply and note are optional.  tail_ms is how long the
+ * preset's output must stay silent before its tail has decayed and the chain
+ * can be skipped (see effects_chain_idle()).  tiers are the load shedding
+ * tiers the preset has a cheaper fallback for (see load_shedding_set_tiers()).
+ */
+typedef struct {
+	void (*setup)(void);
+	void (*process)(uint32_t offset, uint32_t length);
+	PARAM_BINDING_APPLY_FN apply;
+	void (*note)(uint32_t note, float velocity);
+	float tail_ms;
+	uint32_t tiers;
+} EFFECT_PRESET;
+
+// Presets without a cheaper fallback go straight from full quality to bypass
+#define EFFECT_TIERS_NONE       (0)
+#define EFFECT_TIERS_ALL        (QUALITY_TIER_MASK_ALL)
+
+// Preset numbers match multicore_data->effects_preset; 0 is bypass
+static const EFFECT_PRESET effect_presets[EFFECTS_PRESETS_CORE1] = {
+	{ NULL, effect_bypass, NULL, NULL, SILENCE_TAIL_HANGOVER_MS, EFFECT_TIERS_NONE },
+	{ effect_echo_setup, effect_echo_process, effect_echo_apply, NULL,
+			SILENCE_DELAY_TAIL_MS(INT_DELAY_LEN), EFFECT_TIERS_NONE },
+	{ effect_multitap_delay_setup, effect_multitap_delay_process, NULL, NULL,
+			SILENCE_DELAY_TAIL_MS(INT_DELAY_LEN), EFFECT_TIERS_NONE },
+	{ effect_tube_distortion_setup, effect_tube_distortion_process,
+			effect_tube_distortion_apply, NULL, SILENCE_TAIL_HANGOVER_MS,
+			EFFECT_TIERS_ALL },
+	{ effect_multiband_compressor_setup, effect_multiband_compressor_process,
+			effect_multiband_compressor_apply, NULL, SILENCE_TAIL_HANGOVER_MS,
+			EFFECT_TIERS_NONE },
+	{ effect_flanger_setup, effect_flanger_process, effect_flanger_apply,
+			NULL, SILENCE_TAIL_HANGOVER_MS, EFFECT_TIERS_NONE },
+	{ effect_guitar_synth_setup, effect_guitar_synth_process,
+			effect_guitar_synth_apply, effect_guitar_synth_note,
+			SILENCE_TAIL_HANGOVER_MS, EFFECT_TIERS_NONE },
+	{ effect_autowah_setup, effect_autowah_process, effect_autowah_apply,
+			NULL, SILENCE_TAIL_HANGOVER_MS, EFFECT_TIERS_NONE },
+	{ multifx_1_test_setup, multifx_1_test_process, multifx_1_test_apply,
+			NULL, SILENCE_DELAY_TAIL_MS(FX_DELAY_LEN), EFFECT_TIERS_ALL },
+	{ effect_ringmod_setup, effect_ringmod_process, effect_ringmod_apply,
+			NULL, SILENCE_TAIL_HANGOVER_MS, EFFECT_TIERS_NONE }
+};
+
+/*
+ * Binds each preset's apply function to the controls, so a preset's
+ * parameters are only modified when a control has moved rather than every
+ * block (see param_binding.c).
+ */
+static PARAM_BINDING preset_params[EFFECTS_PRESETS_CORE1];
+
+typedef enum {
+	PRESET_TRANSITION_IDLE,
+	PRESET_TRANSITION_PREPARING,
+	PRESET_TRANSITION_PREPARED,
+	PRESET_TRANSITION_WARMING,
+	PRESET_TRANSITION_CROSSFADING,
+	PRESET_TRANSITION_FADE_OUT,
+	PRESET_TRANSITION_FADE_IN
+} PRESET_TRANSITION_STATE;
 
+#define PRESET_BUDGET_CYCLES    ((EFFECTS_BLOCK_CYCLES / 100) * PRESET_TRANSITION_BUDGET_PERCENT)
+
+// Shared between the audio callback and the background loop
+static volatile PRESET_TRANSITION_STATE preset_transition_state = PRESET_TRANSITION_IDLE;
+static volatile uint32_t preset_active = 0;
+static volatile uint32_t preset_incoming = 0;
+
+static uint32_t preset_warmup_count = 0;
+static uint32_t preset_peak_cycles[EFFECTS_PRESETS_CORE1];
+static CROSSFADE preset_crossfade;
+
+// Holds the output of the outgoing preset while both presets are running
+static float preset_outgoing_left[AUDIO_BLOCK_SIZE];
+static float preset_outgoing_right[AUDIO_BLOCK_SIZE];
+
+/**
+ * @brief Maps a requested preset number to an index into the preset table
+ *
+ * @param preset Requested preset (from multicore_data->effects_preset)
+ * @return Preset index (out-of-range presets map to bypass)
+ */
+static uint32_t effect_preset_index(uint32_t preset) {
+	return (preset < EFFECTS_PRESETS_CORE1) ? preset : 0;
+}
+
+/**
+ * @brief Runs a preset over one span of the block (see block_splitter_run())
+ */
+static void effect_preset_span(void * context, uint32_t offset,
+		uint32_t length) {
+	((const EFFECT_PRESET *) context)->process(offset, length);
+}
+
+/**
+ * @brief Applies a control change or note to a preset (see block_splitter_run())
+ */
+static void effect_preset_event(void * context, uint32_t id, float value) {
+
+	const EFFECT_PRESET * p = (const EFFECT_PRESET *) context;
+
+	if (id < EFFECT_CONTROLS) {
+		effect_controls[id] = value;
+		param_binding_update(&preset_params[p - effect_presets]);
+	} else if (p->note != NULL) {
+		p->note(id - EFFECT_EVENT_NOTE, value);
+	}
+}
+
+/**
+ * @brief Runs a preset over the block, applying this block's events at their offsets
+ *
+ * Every preset run in a block starts from the controls at the start of the
+ * block, so the outgoing and incoming presets of a transition see the same
+ * control changes at the same samples.
+ *
+ * @param preset Preset index
+ */
+#pragma optimize_for_speed
+static void effect_preset_split(uint32_t preset) {
+
+	const EFFECT_PRESET * p = &effect_presets[preset];
+
+	for (int i = 0; i < EFFECT_CONTROLS; i++) {
+		effect_controls[i] = effect_controls_block_start[i];
+	}
+	param_binding_update(&preset_params[preset]);
+
+	block_splitter_run(&effects_splitter, effect_preset_span,
+			effect_preset_event, (void *) p);
+}
+
+/**
+ * @brief Runs one preset and tracks its peak cycle count
+ *
+ * @param preset Preset index
+ */
+#pragma optimize_for_speed
+static void effect_preset_run(uint32_t preset) {
+
+	uint64_t start_cycles = __builtin_emuclk();
+
+	// When shedding load, the bypass tier replaces the effect entirely
+	if (effects_quality_tier == QUALITY_TIER_BYPASS) {
+		CYCLE_PROFILE(PROFILE_NODE_PRESET, effect_bypass(0, AUDIO_BLOCK_SIZE));
+		return;
+	}
+
+	CYCLE_PROFILE(PROFILE_NODE_PRESET + preset, effect_preset_split(preset));
+
+	uint32_t cycles = (uint32_t) (__builtin_emuclk() - start_cycles);
+	if (cycles > preset_peak_cycles[preset]) {
+		preset_peak_cycles[preset] = cycles;
+	}
+}
+
+/**
+ * @brief Checks whether two presets can run in the same block
+ *
+ * A preset that hasn't run yet has no measured cost, so it never fits.
+ * Presets are never run in parallel while the load shedding controller has
+ * stepped down from full quality.
+ *
+ * @param outgoing Outgoing preset index
+ * @param incoming Incoming preset index
+ * @return true if both presets fit within the transition cycle budget
+ */
+static bool effect_preset_pair_fits_budget(uint32_t outgoing, uint32_t incoming) {
+
+	// Never run two presets in parallel while shedding load
+	if (effects_quality_tier != QUALITY_TIER_FULL) {
+		return false;
+	}
+
+	uint32_t outgoing_cycles = preset_peak_cycles[outgoing];
+	uint32_t incoming_cycles = preset_peak_cycles[incoming];
+
+	// Nothing is known about a preset that hasn't run yet (the outgoing
+	// preset being cheap, e.g. bypass, says nothing about it), so it's
+	// faded in on its own the first time and measured while it runs
+	if (incoming_cycles == 0) {
+		return false;
+	}
+
+	return (outgoing_cycles + incoming_cycles) <= PRESET_BUDGET_CYCLES;
+}
+
+/**
+ * @brief Reads the pots into the controls at the start of a block
+ *
+ * A pot only takes over a control when it moves, so a control set over
+ * MIDI holds until the pot is turned.
+ */
+static void effect_controls_read_pots(void) {
+
+	float pots[EFFECT_CONTROLS] = { shared_parameters.audioproj_fin_pot_hadc0,
+			shared_parameters.audioproj_fin_pot_hadc1,
+			shared_parameters.audioproj_fin_pot_hadc2 };
+
+	for (int i = 0; i < EFFECT_CONTROLS; i++) {
+		if (pots[i] != effect_pots_last[i]) {
+			effect_pots_last[i] = pots[i];
+			effect_controls_block_start[i] = pots[i];
+		}
+	}
+}
+
+/**
+ * @brief Carries this block's control changes over to the next block and clears its events
+ */
+static void effect_controls_end_block(void) {
+
+	for (uint32_t i = 0; i < effects_splitter.count; i++) {
+		if (effects_splitter.events[i].id < EFFECT_CONTROLS) {
+			effect_controls_block_start[effects_splitter.events[i].id] =
+					effects_splitter.events[i].value;
+		}
+	}
+
+	block_splitter_clear(&effects_splitter);
+}
+
+/**
+ * This routine can be called from the audio callback on SHARC core 1 before
+ * audio_effects_process_audio_core1() to change a control at a given sample
+ * of the block about to be processed (e.g. from a MIDI controller).
+ *
+ * @param control Control (EFFECT_CONTROL)
+ * @param value New value (0.0 -> 1.0, as for the pots)
+ * @param offset Sample in the block at which the change is applied
+ * @return true if the change was posted
+ */
+bool audio_effects_post_control_core1(uint32_t control, float value,
+		uint32_t offset) {
+
+	if (control >= EFFECT_CONTROLS) {
+		return false;
+	}
+	return block_splitter_post(&effects_splitter, offset, control, value);
+}
+
+/**
+ * This routine can be called from the audio callback on SHARC core 1 before
+ * audio_effects_process_audio_core1() to play or release a note at a given
+ * sample of the block about to be processed.  Presets that don't play notes
+ * ignore it.
+ *
+ * @param note MIDI note number
+ * @param velocity Note velocity (0.0 -> 1.0), 0 to release the note
+ * @param offset Sample in the block at which the note starts / stops
+ * @return true if the note was posted
+ */
+bool audio_effects_post_note_core1(uint32_t note, float velocity,
+		uint32_t offset) {
+	return block_splitter_post(&effects_splitter, offset,
+			EFFECT_EVENT_NOTE + (note & 0x7F), velocity);
+}
+
+/**
+ * @brief Allocates the buffers used by the effects on core 1
+ *
+ * Buffers are placed by the memory placement allocator according to how
+ * often they're accessed.  The long delay lines are cold and go to SDRAM.
+ * This is only done once as the preset setup routines are re-run on every
+ * preset change.
+ */
+static void audio_effects_allocate_core1(void) {
+
+	static bool allocated = false;
+	if (allocated) {
+		return;
+	}
+
+	integer_delay_line_l = (float *) mem_alloc(sizeof(float) * INT_DELAY_LEN,
+			MEM_HINT_COLD, "echo delay L");
+	integer_delay_line_r = (float *) mem_alloc(sizeof(float) * INT_DELAY_LEN,
+			MEM_HINT_COLD, "echo delay R");
+	integer_mt_delay_line_l = (float *) mem_alloc(sizeof(float) * INT_DELAY_LEN,
+			MEM_HINT_COLD, "multi-tap delay L");
+	integer_mt_delay_line_r = (float *) mem_alloc(sizeof(float) * INT_DELAY_LEN,
+			MEM_HINT_COLD, "multi-tap delay R");
+	delay_line_l_fx1 = (float *) mem_alloc(sizeof(float) * FX_DELAY_LEN,
+			MEM_HINT_COLD, "multi-fx delay L");
+	delay_line_r_fx1 = (float *) mem_alloc(sizeof(float) * FX_DELAY_LEN,
+			MEM_HINT_COLD, "multi-fx delay R");
+
+	allocated = true;
 }
 
 /**
@@ -628,6 +1288,24 @@ static void effect_ringmod_process(void) {
  */
 void audio_effects_setup_core1(void) {
 
+	// Set the effects up with the parameters the ARM has published so far
+	shared_parameters_refresh();
+	preset_setup_parameters = shared_parameters;
+
+	audio_effects_allocate_core1();
+
+	// Start the controls from the pots
+	effect_pots_last[EFFECT_CONTROL_HADC0] = shared_parameters.audioproj_fin_pot_hadc0;
+	effect_pots_last[EFFECT_CONTROL_HADC1] = shared_parameters.audioproj_fin_pot_hadc1;
+	effect_pots_last[EFFECT_CONTROL_HADC2] = shared_parameters.audioproj_fin_pot_hadc2;
+	for (int i = 0; i < EFFECT_CONTROLS; i++) {
+		effect_controls_block_start[i] = effect_pots_last[i];
+		effect_controls[i] = effect_pots_last[i];
+	}
+
+	// Split blocks at control changes and notes, no finer than EFFECTS_MIN_SPAN
+	block_splitter_setup(&effects_splitter, EFFECTS_MIN_SPAN, AUDIO_BLOCK_SIZE);
+
 	effect_echo_setup();
 	effect_multitap_delay_setup();
 	effect_multiband_compressor_setup();
@@ -638,55 +1316,276 @@ void audio_effects_setup_core1(void) {
 	multifx_1_test_setup();
 	effect_ringmod_setup();
 
+	// Apply the controls to each preset's parameters when they move
+	for (int i = 0; i < EFFECTS_PRESETS_CORE1; i++) {
+		if (effect_presets[i].apply == NULL) {
+			continue;
+		}
+		param_binding_setup(&preset_params[i], effect_presets[i].apply, NULL,
+				NULL);
+		for (int j = 0; j < EFFECT_CONTROLS; j++) {
+			param_binding_add(&preset_params[i], j, &effect_controls[j],
+			EFFECT_CONTROL_STEP);
+		}
+	}
+
+	// Set up the preset transition manager
+	crossfade_setup(&preset_crossfade, PRESET_TRANSITION_CROSSFADE_MS,
+	AUDIO_SAMPLE_RATE);
+
+	for (int i = 0; i < EFFECTS_PRESETS_CORE1; i++) {
+		preset_peak_cycles[i] = 0;
+	}
+
+	preset_active = effect_preset_index(multicore_data->effects_preset);
+	preset_incoming = preset_active;
+	preset_transition_state = PRESET_TRANSITION_IDLE;
+	multicore_data->effects_preset_active = preset_active;
+
+	// Set up load shedding (distortion oversampling, then bypass)
+	effects_load_shedding_setup(QUALITY_TIER_BYPASS);
+	load_shedding_set_tiers(&effects_load_shedding,
+			effect_presets[preset_active].tiers);
+	effects_quality_tier_metric = metrics_gauge("effects.quality_tier");
+
+	// Skip the effects while the input is silent and their tails have decayed
+	effects_silence_setup(effect_presets[preset_active].tail_ms);
+	effects_idle_metric = metrics_gauge("effects.idle");
+
+	// Time each node in the callback and publish the results for the ARM
+#if (CYCLE_PROFILER_ENABLED)
+	multicore_data->sharc_core1_profile = cycle_profiler_setup();
+#endif
 }
 
 /**
- * This routine should be called every time a new block of audio arrives (in the callback
- * function) in SHARC core 1.
+ * @brief Applies a load shedding quality tier to the effects on core 1
+ *
+ * The controller skips tiers the active preset has no fallback for (see
+ * EFFECT_PRESET), so presets without one go straight from full quality to
+ * bypass (see effect_preset_run()).
+ *
+ * @param tier Quality tier
  */
-void audio_effects_process_audio_core1(void) {
+static void audio_effects_set_quality_core1(QUALITY_TIER tier) {
 
-	/**
-	 * On core 1, we'll apply various audio effects and on core 2, we'll do just reverb
-	 */
+	tube_distortion_set_quality(&tube_dist, tier);
+	tube_distortion_set_quality(&tube_dist_fx1, tier);
 
-	static int32_t core_1_effect_preset = 0;
-	uint32_t core_1_total_presets = 10;
+	effects_quality_tier = tier;
+	metric_set(effects_quality_tier_metric, tier);
+}
 
-	switch (multicore_data->effects_preset) {
-	case 1:
-		effect_echo_process();
-		break;
-	case 2:
-		effect_multitap_delay_process();
-		break;
-	case 3:
-		effect_tube_distortion_process();
+/**
+ * This routine should be called from processaudio_mips_overflow() on SHARC
+ * core 1.  It steps the effects down a quality tier for the next block and
+ * records which profiled node ran longest in the block that overran.
+ */
+void audio_effects_overrun_core1(void) {
+	load_shedding_report_overrun(&effects_load_shedding);
+
+	// Record which node the overrun should be blamed on
+	CYCLE_PROFILE_OVERRUN();
+}
+
+/**
+ * This routine should be called from the background loop on SHARC core 1.  It
+ * prepares the incoming preset outside of the audio callback when a preset
+ * change has been requested.
+ */
+void audio_effects_background_core1(void) {
+
+	if (preset_transition_state == PRESET_TRANSITION_PREPARING) {
+
+		// Copy the parameters for the setup with the callback held off, so it
+		// can't refresh them part way through
+		uint32_t interrupts_enabled = sysreg_read(sysreg_MODE1) & IRPTEN;
+		sysreg_bit_clr(sysreg_MODE1, IRPTEN);
+		preset_setup_parameters = shared_parameters;
+		if (interrupts_enabled) {
+			sysreg_bit_set(sysreg_MODE1, IRPTEN);
+		}
+
+		// The incoming preset isn't being run by the callback in this state
+		if (effect_presets[preset_incoming].setup != NULL) {
+			effect_presets[preset_incoming].setup();
+		}
+
+		// Setup put the parameters back to their defaults, so re-apply the controls
+		param_binding_invalidate(&preset_params[preset_incoming]);
+
+		preset_transition_state = PRESET_TRANSITION_PREPARED;
+	}
+}
+
+/**
+ * @brief Runs the effect chain on core 1 for one block
+ */
+static void effects_chain_run_core1(void) {
+
+	uint32_t preset_requested = effect_preset_index(
+			multicore_data->effects_preset);
+
+	effect_controls_read_pots();
+
+	// Skip the chain while idle, unless a preset change or an event needs to run
+	bool idle = false;
+	if (preset_transition_state == PRESET_TRANSITION_IDLE
+			&& preset_requested == preset_active
+			&& block_splitter_pending(&effects_splitter) == 0) {
+		CYCLE_PROFILE(PROFILE_NODE_SILENCE, idle = effects_chain_idle());
+	}
+	metric_set(effects_idle_metric, idle);
+	if (idle) {
+		return;
+	}
+
+	switch (preset_transition_state) {
+
+	case PRESET_TRANSITION_IDLE:
+
+		// Hand off the incoming preset to the background loop for setup
+		if (preset_requested != preset_active) {
+			preset_incoming = preset_requested;
+			preset_transition_state = PRESET_TRANSITION_PREPARING;
+		}
+		effect_preset_run(preset_active);
 		break;
-	case 4:
-		effect_multiband_compressor_process();
+
+	case PRESET_TRANSITION_PREPARING:
+		effect_preset_run(preset_active);
 		break;
-	case 5:
-		effect_flanger_process();
+
+	case PRESET_TRANSITION_PREPARED:
+
+		if (preset_requested != preset_incoming) {
+
+			// Request changed while preparing, start over
+			preset_transition_state = PRESET_TRANSITION_IDLE;
+		} else if (effect_preset_pair_fits_budget(preset_active,
+				preset_incoming)) {
+			preset_warmup_count = 0;
+			preset_transition_state = PRESET_TRANSITION_WARMING;
+		} else {
+
+			// Not enough headroom to run both presets; fade out then in
+			crossfade_start(&preset_crossfade);
+			preset_transition_state = PRESET_TRANSITION_FADE_OUT;
+		}
+		effect_preset_run(preset_active);
 		break;
-	case 6:
-		effect_guitar_synth_process();
+
+	case PRESET_TRANSITION_WARMING:
+
+		// Run the incoming preset first, its output is discarded
+		effect_preset_run(preset_incoming);
+		effect_preset_run(preset_active);
+
+		if (preset_requested != preset_incoming) {
+			preset_transition_state = PRESET_TRANSITION_IDLE;
+		} else if (!effect_preset_pair_fits_budget(preset_active,
+				preset_incoming)) {
+			crossfade_start(&preset_crossfade);
+			preset_transition_state = PRESET_TRANSITION_FADE_OUT;
+		} else if (++preset_warmup_count >= PRESET_TRANSITION_WARMUP_BLOCKS) {
+			crossfade_start(&preset_crossfade);
+			preset_transition_state = PRESET_TRANSITION_CROSSFADING;
+		}
 		break;
-	case 7:
-		effect_autowah_process();
+
+	case PRESET_TRANSITION_CROSSFADING:
+
+		effect_preset_run(preset_active);
+
+		CYCLE_PROFILE_NODE_START(PROFILE_NODE_TRANSITION);
+		copy_buffer(audio_effects_left_out, preset_outgoing_left,
+		AUDIO_BLOCK_SIZE);
+		copy_buffer(audio_effects_right_out, preset_outgoing_right,
+		AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE_NODE_END();
+
+		effect_preset_run(preset_incoming);
+
+		CYCLE_PROFILE(PROFILE_NODE_TRANSITION,
+				crossfade_read(&preset_crossfade, preset_outgoing_left,
+						preset_outgoing_right, audio_effects_left_out,
+						audio_effects_right_out, audio_effects_left_out,
+						audio_effects_right_out, AUDIO_BLOCK_SIZE));
+
+		if (crossfade_complete(&preset_crossfade)) {
+			preset_active = preset_incoming;
+			multicore_data->effects_preset_active = preset_active;
+			effects_silence_set_tail(effect_presets[preset_active].tail_ms);
+			load_shedding_set_tiers(&effects_load_shedding,
+					effect_presets[preset_active].tiers);
+			preset_transition_state = PRESET_TRANSITION_IDLE;
+		}
 		break;
-	case 8:
-		multifx_1_test_process();
+
+	case PRESET_TRANSITION_FADE_OUT:
+
+		effect_preset_run(preset_active);
+		CYCLE_PROFILE(PROFILE_NODE_TRANSITION,
+				crossfade_read(&preset_crossfade, audio_effects_left_out,
+						audio_effects_right_out, NULL, NULL,
+						audio_effects_left_out, audio_effects_right_out,
+						AUDIO_BLOCK_SIZE));
+
+		if (crossfade_complete(&preset_crossfade)) {
+			preset_active = preset_incoming;
+			multicore_data->effects_preset_active = preset_active;
+			effects_silence_set_tail(effect_presets[preset_active].tail_ms);
+			load_shedding_set_tiers(&effects_load_shedding,
+					effect_presets[preset_active].tiers);
+			crossfade_start(&preset_crossfade);
+			preset_transition_state = PRESET_TRANSITION_FADE_IN;
+		}
 		break;
-	case 9:
-		effect_ringmod_process();
+
+	case PRESET_TRANSITION_FADE_IN:
+
+		effect_preset_run(preset_active);
+		CYCLE_PROFILE(PROFILE_NODE_TRANSITION,
+				crossfade_read(&preset_crossfade, NULL, NULL,
+						audio_effects_left_out, audio_effects_right_out,
+						audio_effects_left_out, audio_effects_right_out,
+						AUDIO_BLOCK_SIZE));
+
+		if (crossfade_complete(&preset_crossfade)) {
+			preset_transition_state = PRESET_TRANSITION_IDLE;
+		}
 		break;
 
 	default:
-		effect_bypass();
+		effect_preset_run(preset_active);
 		break;
 	}
 
+	effect_controls_end_block();
+
+	CYCLE_PROFILE(PROFILE_NODE_SILENCE, effects_chain_update_tails());
+}
+
+/**
+ * This routine should be called every time a new block of audio arrives (in the callback
+ * function) in SHARC core 1.
+ */
+void audio_effects_process_audio_core1(void) {
+
+	/**
+	 * On core 1, we'll apply various audio effects and on core 2, we'll do just reverb
+	 */
+
+	// Step quality tiers up or down based on what the chain took for the last block
+	QUALITY_TIER tier = load_shedding_update(&effects_load_shedding,
+			effects_chain_cycles);
+	if (tier != effects_quality_tier) {
+		audio_effects_set_quality_core1(tier);
+	}
+
+	uint64_t start_cycles = __builtin_emuclk();
+	effects_chain_run_core1();
+	effects_chain_cycles = (uint32_t) (__builtin_emuclk() - start_cycles);
 }
 
 /******************************************************************************
@@ -714,39 +1613,93 @@ void audio_effects_setup_core2(void) {
 	// Stereo reverb
 	reverb_setup(&reverb_stereo, 0.3, 1.0, 0.92, 0.2);
 
+	// Set up load shedding (fewer reverb combs, then dry only)
+	effects_load_shedding_setup(QUALITY_TIER_BYPASS);
+	effects_quality_tier_metric = metrics_gauge("effects.quality_tier");
+
+	// Skip the reverb while the input is silent and its tail has decayed
+	effects_silence_setup(SILENCE_TAIL_HANGOVER_MS);
+	effects_idle_metric = metrics_gauge("effects.idle");
+
+	// Time each node in the callback and publish the results for the ARM
+#if (CYCLE_PROFILER_ENABLED)
+	multicore_data->sharc_core2_profile = cycle_profiler_setup();
+#endif
 }
 
 /**
- * @brief  Called every time a new block of audio arrives (in the callback
- * function) in SHARC core 2.
+ * This routine should be called from processaudio_mips_overflow() on SHARC
+ * core 2.  It steps the effects down a quality tier for the next block and
+ * records which profiled node ran longest in the block that overran.
  */
-void audio_effects_process_audio_core2(void) {
+void audio_effects_overrun_core2(void) {
+	load_shedding_report_overrun(&effects_load_shedding);
+
+	// Record which node the overrun should be blamed on
+	CYCLE_PROFILE_OVERRUN();
+}
+
+/**
+ * @brief Runs the effect chain on core 2 for one block
+ */
+static void effects_chain_run_core2(void) {
 
 	float reverb_feedback[10] = { 0.0, 0.9, 0.8, 0.95, 0.8, 0.9, 0.95, 0.7, 0.9,
 			0.97 };
 	float reverb_dampening[10] = { 0.0, 0.1, 0.2, 0.2, 0.3, 0.3, 0.3, 0.4, 0.4,
 			0.4 };
 
+	bool idle;
+	CYCLE_PROFILE(PROFILE_NODE_SILENCE, idle = effects_chain_idle());
+	metric_set(effects_idle_metric, idle);
+	if (idle) {
+		return;
+	}
+
 	reverb_change_feedback(&reverb_stereo,
 			reverb_feedback[multicore_data->reverb_preset]);
 	reverb_change_lp_damp_coeff(&reverb_stereo,
 			reverb_dampening[multicore_data->reverb_preset]);
 
 	if (multicore_data->reverb_preset == 0) {
-		effect_bypass();
+		effect_bypass(0, AUDIO_BLOCK_SIZE);
 	} else {
 
 		// Apply limiter at -6dB to avoid clipping from earlier stage effects
-		compressor_read(&limiter_l, audio_effects_left_out,
-				audio_effects_left_out, AUDIO_BLOCK_SIZE);
-		compressor_read(&limiter_r, audio_effects_left_out,
-				audio_effects_left_out, AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE(PROFILE_NODE_LIMITER,
+				compressor_read(&limiter_l, audio_effects_left_out,
+						audio_effects_left_out, AUDIO_BLOCK_SIZE));
+		CYCLE_PROFILE(PROFILE_NODE_LIMITER,
+				compressor_read(&limiter_r, audio_effects_left_out,
+						audio_effects_left_out, AUDIO_BLOCK_SIZE));
 
 		// Apply stereo reverb effect
-		reverb_read(&reverb_stereo, audio_effects_left_in,
-				audio_effects_left_out, audio_effects_right_out,
-				AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE(PROFILE_NODE_REVERB,
+				reverb_read(&reverb_stereo, audio_effects_left_in,
+						audio_effects_left_out, audio_effects_right_out,
+						AUDIO_BLOCK_SIZE));
+
+	}
+
+	CYCLE_PROFILE(PROFILE_NODE_SILENCE, effects_chain_update_tails());
+}
+
+/**
+ * @brief  Called every time a new block of audio arrives (in the callback
+ * function) in SHARC core 2.
+ */
+void audio_effects_process_audio_core2(void) {
 
+	// Step the reverb quality up or down based on what the chain took for the last block
+	QUALITY_TIER tier = load_shedding_update(&effects_load_shedding,
+			effects_chain_cycles);
+	if (tier != effects_quality_tier) {
+		reverb_set_quality(&reverb_stereo, tier);
+		effects_quality_tier = tier;
+		metric_set(effects_quality_tier_metric, tier);
 	}
 
+	uint64_t start_cycles = __builtin_emuclk();
+	effects_chain_run_core2();
+	effects_chain_cycles = (uint32_t) (__builtin_emuclk() - start_cycles);
 }
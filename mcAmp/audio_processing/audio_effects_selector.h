@@ -17,11 +17,20 @@
 #include "audio_processing/audio_elements/allpass_filter.h"
 #include "audio_processing/audio_elements/amplitude_modulation.h"
 #include "audio_processing/audio_elements/biquad_filter.h"
+#include "audio_processing/audio_elements/block_splitter.h"
 #include "audio_processing/audio_elements/clickless_volume_ctrl.h"
 #include "audio_processing/audio_elements/compressor.h"
+#include "audio_processing/audio_elements/crossfade.h"
+#include "audio_processing/audio_elements/cycle_profiler.h"
 #include "audio_processing/audio_elements/integer_delay_lpf.h"
 #include "audio_processing/audio_elements/integer_delay_multitap.h"
+#include "audio_processing/audio_elements/load_shedding.h"
+#include "audio_processing/audio_elements/memory_placement.h"
+#include "audio_processing/audio_elements/modulation_matrix.h"
 #include "audio_processing/audio_elements/oscillators.h"
+#include "audio_processing/audio_elements/param_binding.h"
+#include "audio_processing/audio_elements/scratch_arena.h"
+#include "audio_processing/audio_elements/silence_detector.h"
 #include "audio_processing/audio_elements/simple_synth.h"
 #include "audio_processing/audio_elements/variable_delay.h"
 #include "audio_processing/audio_elements/zero_crossing_detector.h"
@@ -36,6 +45,87 @@
 #include "audio_processing/audio_effects/effect_tremelo.h"
 #include "audio_processing/audio_effects/effect_ring_modulator.h"
 
+// Number of presets on core 1 (including bypass as preset 0)
+#define EFFECTS_PRESETS_CORE1                 (10)
+
+/*
+ * Preset transitions on core 1: number of blocks the incoming preset is run
+ * in parallel before the crossfade, crossfade duration, and the share of the
+ * block (in percent) both presets may use while running in parallel.
+ */
+#define PRESET_TRANSITION_WARMUP_BLOCKS       (16)
+#define PRESET_TRANSITION_CROSSFADE_MS        (20.0)
+#define PRESET_TRANSITION_BUDGET_PERCENT      (60)
+
+/*
+ * Sample-accurate control on core 1: control changes and notes posted with
+ * audio_effects_post_control_core1() / audio_effects_post_note_core1() are
+ * applied at their offset in the block by splitting it into spans (see
+ * block_splitter.c).  Spans are never shorter than EFFECTS_MIN_SPAN samples
+ * (which must divide AUDIO_BLOCK_SIZE), so a block is run in at most
+ * AUDIO_BLOCK_SIZE / EFFECTS_MIN_SPAN pieces.
+ */
+#if (AUDIO_BLOCK_SIZE < 8)
+#define EFFECTS_MIN_SPAN                      (AUDIO_BLOCK_SIZE)
+#else
+#define EFFECTS_MIN_SPAN                      (8)
+#endif
+
+// Controls shared by the presets on core 1 (set by the Audio Project Fin pots or over MIDI)
+typedef enum {
+	EFFECT_CONTROL_HADC0,
+	EFFECT_CONTROL_HADC1,
+	EFFECT_CONTROL_HADC2,
+	EFFECT_CONTROLS
+} EFFECT_CONTROL;
+
+// Smallest change of a control (0.0 -> 1.0) that is applied to the presets
+#define EFFECT_CONTROL_STEP                   (1.0 / 1024)
+
+/*
+ * Load shedding: when the measured cycles for a block exceed
+ * LOAD_SHEDDING_STEP_DOWN_PERCENT of the block deadline (or a block is
+ * dropped), the effects on that core step down a quality tier.  They step
+ * back up once the load stays under LOAD_SHEDDING_STEP_UP_PERCENT for
+ * LOAD_SHEDDING_HOLD_BLOCKS blocks.
+ */
+#define LOAD_SHEDDING_STEP_DOWN_PERCENT       (90)
+#define LOAD_SHEDDING_STEP_UP_PERCENT         (60)
+#define LOAD_SHEDDING_HOLD_BLOCKS             (AUDIO_SAMPLE_RATE / AUDIO_BLOCK_SIZE / 2)
+
+/*
+ * Silence detection: the effects on each core are skipped while their input
+ * is below SILENCE_THRESHOLD_DB and their output has stayed below it for
+ * SILENCE_TAIL_HANGOVER_MS (i.e. reverb / delay tails have decayed).  A
+ * preset with a delay line must also stay silent for a full trip around its
+ * longest delay (SILENCE_DELAY_TAIL_MS), so that no echo is still in flight.
+ */
+#define SILENCE_THRESHOLD_DB                  (-90.0)
+#define SILENCE_TAIL_HANGOVER_MS              (250.0)
+#define SILENCE_DELAY_TAIL_MS(samples)        ((samples) * 1000.0 / AUDIO_SAMPLE_RATE + SILENCE_TAIL_HANGOVER_MS)
+
+/*
+ * Nodes timed by the cycle profiler on the SHARC cores (see cycle_profiler.c).
+ * Node IDs are reported in the event log and in the snapshots published in
+ * MULTICORE_DATA; overruns outside of any node are reported as node -1.
+ */
+typedef enum {
+	PROFILE_NODE_PRESET = 0,        // core 1 preset n is node PROFILE_NODE_PRESET + n
+	PROFILE_NODE_SILENCE = PROFILE_NODE_PRESET + EFFECTS_PRESETS_CORE1, // effect chain silence detectors
+	PROFILE_NODE_TRANSITION,        // core 1 preset crossfades
+	PROFILE_NODE_LIMITER,           // core 2 output limiter (one run per channel)
+	PROFILE_NODE_REVERB,            // core 2 stereo reverb
+	PROFILE_NODE_ROUTING,           // buffer copies and channel routing in the callbacks
+	PROFILE_NODE_MCAMP_IDLE,        // core 1 MA12040P idle detection
+	PROFILE_NODE_MCAMP_EQ,          // core 1 mcAmp output EQ
+	PROFILE_NODE_AUDIO_CAPTURE,     // core 1 audio capture tap (starting its MDMA)
+	PROFILE_NODES
+} PROFILE_NODE;
+
+// The profiler ignores node IDs it has no room for, so fail the build instead
+typedef char PROFILE_NODES_FIT_IN_PROFILER[
+		(PROFILE_NODES <= CYCLE_PROFILER_MAX_NODES) ? 1 : -1];
+
 // Audio buffers to pass audio to and from the effects
 extern float audio_effects_left_in[];
 extern float audio_effects_right_in[];
@@ -51,6 +141,15 @@ void audio_effects_setup_core1();
 void audio_effects_setup_core2();
 
 void audio_effects_process_audio_core1();
+void audio_effects_background_core1();
+
+bool audio_effects_post_control_core1(uint32_t control, float value,
+		uint32_t offset);
+bool audio_effects_post_note_core1(uint32_t note, float velocity,
+		uint32_t offset);
+
+void audio_effects_overrun_core1();
+void audio_effects_overrun_core2();
 void audio_effects_process_audio_core2();
 
 #ifdef __cplusplus
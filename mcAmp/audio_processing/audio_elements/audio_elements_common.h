@@ -16,11 +16,23 @@
 #endif
 
 /**
- * To avoid use of the heap, this preprocessor variable
- * allows functions to declare a local scratch variable
- * that will always be smaller than the current audio
- * block size.
+ * Audio elements no longer declare local scratch arrays sized by a maximum
+ * block size.  Temporary buffers are taken from the per-core scratch arena
+ * (see scratch_arena.c) so the block size is only limited by memory.
  */
-#define MAX_AUDIO_BLOCK_SIZE    (128)
+
+/**
+ * Quality tiers used for load shedding.  Elements and effects that have
+ * cheaper fallbacks (fewer delay lines, less oversampling, etc.) accept one
+ * of these tiers.  Elements clamp tiers below their cheapest fallback to that
+ * fallback.
+ */
+typedef enum {
+	QUALITY_TIER_FULL = 0,
+	QUALITY_TIER_REDUCED,
+	QUALITY_TIER_MINIMAL,
+	QUALITY_TIER_BYPASS,
+	QUALITY_TIERS
+} QUALITY_TIER;
 
 #endif  //_AUDIO_ELEMENTS_COMMON_H
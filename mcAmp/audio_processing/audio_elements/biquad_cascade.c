@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element runs a cascade of second order sections (biquads) from
+ * a table of coefficients.
+ *
+ * Unlike the biquad filter element, which designs its own coefficients from
+ * a type, frequency and Q, the coefficients here are designed elsewhere
+ * (e.g. on a PC and uploaded over the control link) and used as they are.
+ * Each section is { b0, b1, b2, a1, a2 } with a0 normalized to 1:
+ *
+ *   H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ *
+ * which is the layout of a row of a SciPy "sos" array with a0 dropped.  The
+ * sections are run in transposed direct form II.
+ *
+ * The instance only points at the coefficients, so the owner can replace
+ * them between blocks (the filter state is kept, so a small change doesn't
+ * click).
+ */
+#include <stdlib.h>
+
+#include "biquad_cascade.h"
+
+/**
+ * @brief Initializes instance of a biquad cascade
+ *
+ * @param c Pointer to instance structure
+ * @param coeffs Coefficients, BIQUAD_CASCADE_COEFFS_PER_STAGE for each stage
+ * @param stages Number of second order sections
+ *
+ * @return Biquad cascade result (enumeration)
+ */
+RESULT_BIQUAD_CASCADE biquad_cascade_setup(BIQUAD_CASCADE * c,
+		const float * coeffs, uint32_t stages) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL || coeffs == NULL) {
+		return BIQUAD_CASCADE_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (stages == 0 || stages > BIQUAD_CASCADE_MAX_STAGES) {
+		return BIQUAD_CASCADE_INVALID_STAGES;
+	}
+
+	c->coeffs = coeffs;
+	c->stages = stages;
+	biquad_cascade_reset(c);
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return BIQUAD_CASCADE_OK;
+}
+
+/**
+ * @brief Filters a block of audio (in place is fine)
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer
+ * @param audio_out Pointer to floating point audio output buffer
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void biquad_cascade_read(BIQUAD_CASCADE * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, pass the audio through
+	if (c == NULL || !c->initialized) {
+		if (audio_out != audio_in) {
+			for (int i = 0; i < audio_block_size; i++) {
+				audio_out[i] = audio_in[i];
+			}
+		}
+		return;
+	}
+
+	const float * coeffs = c->coeffs;
+	float * in = audio_in;
+
+	for (int stage = 0; stage < c->stages; stage++) {
+
+		float b0 = coeffs[0];
+		float b1 = coeffs[1];
+		float b2 = coeffs[2];
+		float a1 = coeffs[3];
+		float a2 = coeffs[4];
+		float s1 = c->state[stage][0];
+		float s2 = c->state[stage][1];
+
+		for (int i = 0; i < audio_block_size; i++) {
+			float x = in[i];
+			float y = b0 * x + s1;
+			s1 = b1 * x - a1 * y + s2;
+			s2 = b2 * x - a2 * y;
+			audio_out[i] = y;
+		}
+
+		c->state[stage][0] = s1;
+		c->state[stage][1] = s2;
+
+		// Later stages work on the output in place
+		coeffs += BIQUAD_CASCADE_COEFFS_PER_STAGE;
+		in = audio_out;
+	}
+}
+
+/**
+ * @brief Clears the filter state
+ *
+ * @param c Pointer to instance structure
+ */
+void biquad_cascade_reset(BIQUAD_CASCADE * c) {
+
+	if (c != NULL) {
+		for (int stage = 0; stage < BIQUAD_CASCADE_MAX_STAGES; stage++) {
+			c->state[stage][0] = 0.0;
+			c->state[stage][1] = 0.0;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _BIQUAD_CASCADE_H
+#define _BIQUAD_CASCADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Maximum number of second order sections in a cascade
+#define BIQUAD_CASCADE_MAX_STAGES		(8)
+
+// Coefficients per section: b0, b1, b2, a1, a2
+#define BIQUAD_CASCADE_COEFFS_PER_STAGE	(5)
+
+// Result enumerations
+typedef enum {
+	BIQUAD_CASCADE_OK,
+	BIQUAD_CASCADE_INVALID_INSTANCE_POINTER,
+	BIQUAD_CASCADE_INVALID_STAGES
+} RESULT_BIQUAD_CASCADE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	const float * coeffs;          // stages x { b0, b1, b2, a1, a2 }, owned by the caller
+	uint32_t stages;
+
+	float state[BIQUAD_CASCADE_MAX_STAGES][2];
+
+} BIQUAD_CASCADE;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_BIQUAD_CASCADE biquad_cascade_setup(BIQUAD_CASCADE * c,
+		const float * coeffs, uint32_t stages);
+
+void biquad_cascade_read(BIQUAD_CASCADE * c, float * audio_in,
+		float * audio_out, uint32_t audio_block_size);
+
+void biquad_cascade_reset(BIQUAD_CASCADE * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_BIQUAD_CASCADE_H
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This element applies timestamped events (parameter changes, notes) at
+ * their sample offset within an audio block rather than at the start of the
+ * block.  The block is split at the events and the processing is run over
+ * each span in turn, with the events due at the start of a span applied
+ * just before it.  This gives sample-accurate control without shrinking
+ * AUDIO_BLOCK_SIZE, which would add its per-block overhead to every block
+ * whether or not anything changed.  A block with no events is processed in
+ * a single span.
+ *
+ * Event offsets are rounded down to a multiple of the minimum span size,
+ * which bounds the number of spans (and so the per-span overhead) to
+ * audio_block_size / min_span, and keeps every span aligned and a whole
+ * number of min_span samples long for the vectorized elements.  An event
+ * is therefore applied up to min_span - 1 samples early.  Events from the
+ * MIDI parser are already a block late (see midi_parser.c), so they are
+ * still never applied before their time in the input stream.
+ *
+ * Events are kept for the whole block, so block_splitter_run() can be
+ * called more than once per block (e.g. for an outgoing and an incoming
+ * preset during a crossfade) and each run sees the same events.  Call
+ * block_splitter_clear() once the block has been processed.  As each run
+ * sees the events again, events should set absolute values rather than
+ * step values.
+ *
+ * Note that elements which move towards a new parameter value a step per
+ * call (e.g. biquad_filter transitions) move faster when a block is split.
+ */
+#include <stdlib.h>
+
+#include "block_splitter.h"
+
+/**
+ * @brief Initializes instance of a block splitter
+ *
+ * @param c Pointer to instance structure
+ * @param min_span Shortest span the block is split into (must divide audio_block_size)
+ * @param audio_block_size The number of samples in each block
+ * @return Block splitter result (enumeration)
+ */
+RESULT_BLOCK_SPLITTER block_splitter_setup(BLOCK_SPLITTER * c,
+		uint32_t min_span, uint32_t audio_block_size) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return BLOCK_SPLITTER_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (min_span == 0 || min_span > audio_block_size
+			|| audio_block_size % min_span) {
+		return BLOCK_SPLITTER_INVALID_SPAN;
+	}
+
+	c->audio_block_size = audio_block_size;
+	c->min_span = min_span;
+
+	c->count = 0;
+	c->dropped = 0;
+	c->spans = 0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return BLOCK_SPLITTER_OK;
+}
+
+/**
+ * @brief Posts an event for the current block
+ *
+ * Events at the same offset are applied in the order they were posted.
+ *
+ * @param c Pointer to instance structure
+ * @param offset Sample in the block at which the event is due (later offsets are applied at the last span)
+ * @param id Event identifier passed to the apply function
+ * @param value Event value passed to the apply function
+ * @return true if the event was posted, false if the list is full
+ */
+bool block_splitter_post(BLOCK_SPLITTER * c, uint32_t offset, uint32_t id,
+		float value) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	if (c->count >= BLOCK_SPLITTER_MAX_EVENTS) {
+		c->dropped++;
+		return false;
+	}
+
+	if (offset >= c->audio_block_size) {
+		offset = c->audio_block_size - 1;
+	}
+	offset -= offset % c->min_span;
+
+	// Events mostly arrive in time order, so this rarely moves anything
+	uint32_t i = c->count;
+	while (i > 0 && c->events[i - 1].offset > offset) {
+		c->events[i] = c->events[i - 1];
+		i--;
+	}
+
+	c->events[i].offset = offset;
+	c->events[i].id = id;
+	c->events[i].value = value;
+	c->count++;
+
+	return true;
+}
+
+/**
+ * @brief Returns the number of events posted for the current block
+ *
+ * @param c Pointer to instance structure
+ * @return Number of events
+ */
+uint32_t block_splitter_pending(BLOCK_SPLITTER * c) {
+	return (c == NULL) ? 0 : c->count;
+}
+
+/**
+ * @brief Processes a block, applying each event at its offset
+ *
+ * @param c Pointer to instance structure
+ * @param process Called for each span of the block
+ * @param apply Called for each event, before the span starting at its offset
+ * @param context Passed to process and apply
+ */
+#pragma optimize_for_speed
+void block_splitter_run(BLOCK_SPLITTER * c, BLOCK_SPLITTER_SPAN_FN process,
+		BLOCK_SPLITTER_EVENT_FN apply, void * context) {
+
+	uint32_t block_size = c->audio_block_size;
+	uint32_t start = 0;
+	uint32_t next = 0;
+
+	c->spans = 0;
+
+	while (start < block_size) {
+
+		// Apply everything due at the start of this span
+		while (next < c->count && c->events[next].offset <= start) {
+			apply(context, c->events[next].id, c->events[next].value);
+			next++;
+		}
+
+		// Run up to the next event, or to the end of the block
+		uint32_t end = (next < c->count) ? c->events[next].offset : block_size;
+
+		process(context, start, end - start);
+		c->spans++;
+
+		start = end;
+	}
+}
+
+/**
+ * @brief Clears the events once the block has been processed
+ *
+ * @param c Pointer to instance structure
+ */
+void block_splitter_clear(BLOCK_SPLITTER * c) {
+	if (c != NULL) {
+		c->count = 0;
+	}
+}
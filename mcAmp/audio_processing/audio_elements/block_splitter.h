@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _BLOCK_SPLITTER_H
+#define _BLOCK_SPLITTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Events that can be posted for a single block
+#define BLOCK_SPLITTER_MAX_EVENTS       (32)
+
+// Result enumerations
+typedef enum {
+	BLOCK_SPLITTER_OK,
+	BLOCK_SPLITTER_INVALID_INSTANCE_POINTER,
+	BLOCK_SPLITTER_INVALID_SPAN
+} RESULT_BLOCK_SPLITTER;
+
+// Applies an event (id and value are whatever the code posting it chose)
+typedef void (*BLOCK_SPLITTER_EVENT_FN)(void * context, uint32_t id,
+		float value);
+
+// Processes the samples from offset to offset + length - 1 of the block
+typedef void (*BLOCK_SPLITTER_SPAN_FN)(void * context, uint32_t offset,
+		uint32_t length);
+
+typedef struct {
+	uint32_t offset;               // sample in the block (rounded down to the span size)
+	uint32_t id;
+	float value;
+} BLOCK_SPLITTER_EVENT;
+
+// Instance struct with parameters and the events posted for this block
+typedef struct {
+
+	bool initialized;
+
+	uint32_t audio_block_size;
+	uint32_t min_span;             // shortest span the block is split into
+
+	uint32_t count;                // events posted for this block, in time order
+	uint32_t dropped;              // events lost because the list was full
+	uint32_t spans;                // spans run by the last call to block_splitter_run()
+
+	BLOCK_SPLITTER_EVENT events[BLOCK_SPLITTER_MAX_EVENTS];
+
+} BLOCK_SPLITTER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_BLOCK_SPLITTER block_splitter_setup(BLOCK_SPLITTER * c,
+		uint32_t min_span, uint32_t audio_block_size);
+
+bool block_splitter_post(BLOCK_SPLITTER * c, uint32_t offset, uint32_t id,
+		float value);
+
+uint32_t block_splitter_pending(BLOCK_SPLITTER * c);
+
+void block_splitter_run(BLOCK_SPLITTER * c, BLOCK_SPLITTER_SPAN_FN process,
+		BLOCK_SPLITTER_EVENT_FN apply, void * context);
+
+void block_splitter_clear(BLOCK_SPLITTER * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_BLOCK_SPLITTER_H
@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element checks the wiring, level and latency of a set of output
+ * channels.
+ *
+ * Every output channel plays its own sine tone and one or more inputs (a
+ * loopback cable or a reference microphone) listen to them.  The tones sit
+ * exactly on bins of the measurement window, so they don't leak into each
+ * other and all of the outputs can be checked at once.  Each input has a
+ * Goertzel bank (see goertzel_bank.c) with one bin per tone, so for every
+ * output we learn which input heard it, how loud it was and how late it
+ * arrived.  A channel that is dead, or wired to a different slot, shows up
+ * as a missing tone or a tone on the wrong input.
+ *
+ * A test runs in windows of window_ms:
+ *
+ *   settling - outputs silent while the previous audio dies away (and muted
+ *              amplifiers are woken up)
+ *   noise    - outputs silent while the noise floor of each bin is measured
+ *   tones    - every output plays its tone at once.  The last window gives
+ *              the routing map: which input heard each output, and how loud.
+ *   latency  - each output that was heard plays its tone again on its own,
+ *              after a gap of silence
+ *
+ * Latency comes from how much of a tone made it into the tone windows.
+ * Adding the phasors of all of the tone windows gives one long measurement
+ * whose size is proportional to the number of samples of the tone that
+ * arrived; dividing by the phasor of a full window turns that into samples,
+ * and the latency is the rest.  The tone fades in over its first window so
+ * the measurement doesn't depend on where the onset lands.  Tones are timed
+ * one output at a time because the onset of one tone spreads into the bins
+ * of the others.  The result is good to about sample rate / (4 * PI * tone
+ * frequency) samples (10 samples at 400Hz) as long as the latency is shorter
+ * than CHANNEL_TEST_GAP_WINDOWS windows.  The latency includes the audio
+ * framework's own buffering.
+ *
+ * With 20 outputs and 20ms windows a test takes about 7 seconds.
+ *
+ * The outputs are only written while a test is running, so the element can
+ * be left in the audio callback and started when needed.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "channel_test.h"
+
+// Windows spent in each part of the test
+#define CHANNEL_TEST_SETTLE_WINDOWS     (12)
+#define CHANNEL_TEST_NOISE_WINDOWS      (4)
+#define CHANNEL_TEST_TONE_WINDOWS       (8)
+#define CHANNEL_TEST_GAP_WINDOWS        (8)
+
+// A tone is heard if it is this far above the noise floor of its bin (12 dB)
+#define CHANNEL_TEST_DETECT_RATIO       (4.0)
+
+// Tones and detection floor
+#define CHANNEL_TEST_LEVEL_DB_MIN       (-60.0)
+#define CHANNEL_TEST_LEVEL_DB_MAX       (0.0)
+#define CHANNEL_TEST_FLOOR              (1.0e-5)
+
+// A tone is steady if its last two windows are within this fraction of each other
+#define CHANNEL_TEST_STEADY_TOLERANCE   (0.1)
+
+/**
+ * @brief Initializes instance of a channel test
+ *
+ * Tone n is placed on the window bin closest to first_frequency + n * frequency_spacing.
+ *
+ * @param c Pointer to instance structure
+ * @param outputs The number of output channels to test
+ * @param inputs The number of inputs to listen to
+ * @param tone_level_db Peak level (dBFS) of each tone
+ * @param first_frequency Frequency (Hz) of the tone on the first output
+ * @param frequency_spacing Spacing (Hz) between the tones
+ * @param window_ms Length of each measurement (rounded up to whole blocks)
+ * @param audio_block_size The number of samples in each block
+ * @param audio_sample_rate The audio sample rate
+ *
+ * @return Channel test result (enumeration)
+ */
+RESULT_CHANNEL_TEST channel_test_setup(CHANNEL_TEST * c, uint32_t outputs,
+		uint32_t inputs, float tone_level_db, float first_frequency,
+		float frequency_spacing, float window_ms, uint32_t audio_block_size,
+		float audio_sample_rate) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return CHANNEL_TEST_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (outputs == 0 || outputs > CHANNEL_TEST_MAX_OUTPUTS || inputs == 0
+			|| inputs > CHANNEL_TEST_MAX_INPUTS) {
+		return CHANNEL_TEST_INVALID_CHANNELS;
+	}
+
+	if (window_ms <= 0.0 || audio_block_size == 0) {
+		return CHANNEL_TEST_INVALID_WINDOW;
+	}
+
+	if (tone_level_db < CHANNEL_TEST_LEVEL_DB_MIN) {
+		tone_level_db = CHANNEL_TEST_LEVEL_DB_MIN;
+	}
+	if (tone_level_db > CHANNEL_TEST_LEVEL_DB_MAX) {
+		tone_level_db = CHANNEL_TEST_LEVEL_DB_MAX;
+	}
+	c->tone_amplitude = powf(10.0, tone_level_db * 0.05);
+
+	// Windows are whole blocks, so the tones always start at the start of a block
+	uint32_t window_blocks = (uint32_t) ceilf(
+			window_ms * 0.001 * audio_sample_rate / audio_block_size);
+	c->window_samples = window_blocks * audio_block_size;
+
+	// Put each tone on a bin so the tones are orthogonal over a window
+	float bin_hz = audio_sample_rate / c->window_samples;
+	for (int i = 0; i < outputs; i++) {
+		float bin = roundf((first_frequency + i * frequency_spacing) / bin_hz);
+		c->frequency[i] = bin * bin_hz;
+		if (bin < 1.0 || c->frequency[i] >= audio_sample_rate * 0.5) {
+			return CHANNEL_TEST_INVALID_FREQUENCY;
+		}
+		if (i > 0 && c->frequency[i] <= c->frequency[i - 1]) {
+			return CHANNEL_TEST_INVALID_FREQUENCY;
+		}
+
+		float w = PI2 * c->frequency[i] / audio_sample_rate;
+		c->rot_re[i] = cosf(w);
+		c->rot_im[i] = sinf(w);
+	}
+
+	for (int i = 0; i < inputs; i++) {
+		if (goertzel_bank_setup(&c->bank[i], c->frequency, outputs,
+				c->window_samples, audio_sample_rate) != GOERTZEL_BANK_OK) {
+			return CHANNEL_TEST_INVALID_FREQUENCY;
+		}
+	}
+
+	c->outputs = outputs;
+	c->inputs = inputs;
+	c->windows = 0;
+	c->runs = 0;
+	c->start_requested = false;
+	c->state = CHANNEL_TEST_IDLE;
+
+	for (int i = 0; i < CHANNEL_TEST_MAX_OUTPUTS; i++) {
+		c->result[i].found = false;
+	}
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return CHANNEL_TEST_OK;
+}
+
+/**
+ * @brief Starts a test at the next call to channel_test_process()
+ *
+ * Safe to call from outside the audio callback.
+ *
+ * @param c Pointer to instance structure
+ */
+void channel_test_start(CHANNEL_TEST * c) {
+
+	if (c != NULL && c->initialized) {
+		c->start_requested = true;
+	}
+}
+
+/**
+ * @brief Starts the tone of an output (faded in over the next window)
+ *
+ * @param c Pointer to instance structure
+ * @param output Index of the output channel
+ */
+static void channel_test_start_tone(CHANNEL_TEST * c, uint32_t output) {
+
+	c->osc_re[output] = 0.0;
+	c->osc_im[output] = 1.0;
+}
+
+/**
+ * @brief Moves on to the next output whose latency can be measured
+ *
+ * @param c Pointer to instance structure
+ * @param output First output to consider
+ */
+static void channel_test_next_latency(CHANNEL_TEST * c, uint32_t output) {
+
+	while (output < c->outputs && !c->result[output].found) {
+		output++;
+	}
+
+	c->windows = 0;
+	c->latency_output = output;
+	if (output >= c->outputs) {
+		c->runs++;
+		c->state = CHANNEL_TEST_DONE;
+		return;
+	}
+
+	c->latency_sum_re = 0.0;
+	c->latency_sum_im = 0.0;
+	c->latency_last = 0.0;
+	c->latency_prev = 0.0;
+	channel_test_start_tone(c, output);
+	c->state = CHANNEL_TEST_LATENCY;
+}
+
+/**
+ * @brief Works out which input heard each output, and how loud it was
+ *
+ * @param c Pointer to instance structure
+ */
+static void channel_test_routing(CHANNEL_TEST * c) {
+
+	for (int o = 0; o < c->outputs; o++) {
+
+		CHANNEL_TEST_RESULT * r = &c->result[o];
+		r->found = false;
+		r->input = 0;
+		r->frequency = c->frequency[o];
+		r->level_db = -144.0;
+		r->latency_samples = -1.0;
+
+		// Find the input that heard this tone best
+		uint32_t best = 0;
+		for (int i = 1; i < c->inputs; i++) {
+			if (goertzel_bank_amplitude(&c->bank[i], o)
+					> goertzel_bank_amplitude(&c->bank[best], o)) {
+				best = i;
+			}
+		}
+
+		float level = goertzel_bank_amplitude(&c->bank[best], o);
+		if (level < CHANNEL_TEST_FLOOR
+				|| level < CHANNEL_TEST_DETECT_RATIO * c->noise[best][o]) {
+			continue;
+		}
+
+		r->found = true;
+		r->input = best;
+		r->level_db = 20.0 * log10f(level / c->tone_amplitude);
+	}
+}
+
+/**
+ * @brief Works out the latency of the output being measured
+ *
+ * @param c Pointer to instance structure
+ */
+static void channel_test_latency(CHANNEL_TEST * c) {
+
+	CHANNEL_TEST_RESULT * r = &c->result[c->latency_output];
+	float full = c->latency_last;
+
+	// Only trust the latency if the tone had reached its full level by the end
+	if (full < CHANNEL_TEST_FLOOR || fabsf(full - c->latency_prev)
+			> CHANNEL_TEST_STEADY_TOLERANCE * full) {
+		return;
+	}
+
+	// The tone fades in over one window, which counts as half a window of samples
+	float sum = sqrtf(c->latency_sum_re * c->latency_sum_re
+			+ c->latency_sum_im * c->latency_sum_im);
+	float received = sum / full * c->window_samples;
+	float latency = (CHANNEL_TEST_TONE_WINDOWS - 0.5) * c->window_samples
+			- received;
+	r->latency_samples = latency > 0.0 ? latency : 0.0;
+}
+
+/**
+ * @brief Moves the test along at the end of each window
+ *
+ * @param c Pointer to instance structure
+ */
+static void channel_test_end_window(CHANNEL_TEST * c) {
+
+	c->windows++;
+
+	switch (c->state) {
+
+	case CHANNEL_TEST_SETTLING:
+		if (c->windows >= CHANNEL_TEST_SETTLE_WINDOWS) {
+			for (int i = 0; i < c->inputs; i++) {
+				for (int o = 0; o < c->outputs; o++) {
+					c->noise[i][o] = 0.0;
+				}
+			}
+			c->windows = 0;
+			c->state = CHANNEL_TEST_NOISE;
+		}
+		break;
+
+	case CHANNEL_TEST_NOISE:
+		for (int i = 0; i < c->inputs; i++) {
+			for (int o = 0; o < c->outputs; o++) {
+				c->noise[i][o] += goertzel_bank_amplitude(&c->bank[i], o)
+						* (1.0 / CHANNEL_TEST_NOISE_WINDOWS);
+			}
+		}
+		if (c->windows >= CHANNEL_TEST_NOISE_WINDOWS) {
+			for (int o = 0; o < c->outputs; o++) {
+				channel_test_start_tone(c, o);
+			}
+			c->windows = 0;
+			c->state = CHANNEL_TEST_TONES;
+		}
+		break;
+
+	case CHANNEL_TEST_TONES:
+		if (c->windows >= CHANNEL_TEST_TONE_WINDOWS) {
+			channel_test_routing(c);
+			channel_test_next_latency(c, 0);
+		}
+		break;
+
+	case CHANNEL_TEST_LATENCY:
+
+		// Silence (while the last tone dies away), then the tone of this output
+		if (c->windows > CHANNEL_TEST_GAP_WINDOWS) {
+			float re, im;
+			GOERTZEL_BANK * bank =
+					&c->bank[c->result[c->latency_output].input];
+			goertzel_bank_phasor(bank, c->latency_output, &re, &im);
+			c->latency_sum_re += re;
+			c->latency_sum_im += im;
+			c->latency_prev = c->latency_last;
+			c->latency_last = goertzel_bank_amplitude(bank, c->latency_output);
+		}
+		if (c->windows >= CHANNEL_TEST_GAP_WINDOWS + CHANNEL_TEST_TONE_WINDOWS) {
+			channel_test_latency(c);
+			channel_test_next_latency(c, c->latency_output + 1);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Writes the tone of one output for this block
+ *
+ * @param c Pointer to instance structure
+ * @param output Index of the output channel
+ * @param audio_out Output buffer
+ * @param fade_in true during the first window of the tone
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+static void channel_test_tone(CHANNEL_TEST * c, uint32_t output,
+		float * audio_out, bool fade_in, uint32_t audio_block_size) {
+
+	// Raised cosine fade over the first window, so the onset doesn't spread into other bins
+	float start_gain = c->tone_amplitude;
+	float end_gain = c->tone_amplitude;
+	if (fade_in) {
+		uint32_t fade = c->bank[0].samples;
+		start_gain *= 0.5 - 0.5 * cosf(PI * fade / c->window_samples);
+		end_gain *= 0.5 - 0.5 * cosf(PI * (fade + audio_block_size)
+				/ c->window_samples);
+	}
+	float gain_step = (end_gain - start_gain) / audio_block_size;
+
+	// Sine tone from a phasor rotated by one sample's worth of phase each sample
+	float re = c->osc_re[output];
+	float im = c->osc_im[output];
+	float rot_re = c->rot_re[output];
+	float rot_im = c->rot_im[output];
+	float gain = start_gain;
+	for (int i = 0; i < audio_block_size; i++) {
+		audio_out[i] = gain * re;
+		gain += gain_step;
+		float next_re = re * rot_re - im * rot_im;
+		im = re * rot_im + im * rot_re;
+		re = next_re;
+	}
+
+	// Keep the phasor on the unit circle
+	float norm = 1.5 - 0.5 * (re * re + im * im);
+	c->osc_re[output] = re * norm;
+	c->osc_im[output] = im * norm;
+}
+
+/**
+ * @brief Plays the test tones and listens for them - call once per audio block
+ *
+ * While a test is running the output buffers are overwritten (with silence
+ * or the tones).  Otherwise they are left alone.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_out Output channel buffers, one per output under test
+ * @param audio_in Input channel buffers, one per input listened to
+ * @param audio_block_size The number of floating-point words to process
+ * @return true if a test is running (and the outputs were overwritten)
+ */
+#pragma optimize_for_speed
+bool channel_test_process(CHANNEL_TEST * c, float ** audio_out,
+		float ** audio_in, uint32_t audio_block_size) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	if (c->start_requested) {
+		c->start_requested = false;
+		for (int i = 0; i < c->inputs; i++) {
+			goertzel_bank_reset(&c->bank[i]);
+		}
+		c->windows = 0;
+		c->state = CHANNEL_TEST_SETTLING;
+	}
+
+	uint32_t state = c->state;
+	if (state == CHANNEL_TEST_IDLE || state == CHANNEL_TEST_DONE) {
+		return false;
+	}
+
+	for (int o = 0; o < c->outputs; o++) {
+		if (state == CHANNEL_TEST_TONES) {
+			channel_test_tone(c, o, audio_out[o], c->windows == 0,
+					audio_block_size);
+		} else if (state == CHANNEL_TEST_LATENCY && o == c->latency_output
+				&& c->windows >= CHANNEL_TEST_GAP_WINDOWS) {
+			channel_test_tone(c, o, audio_out[o],
+					c->windows == CHANNEL_TEST_GAP_WINDOWS, audio_block_size);
+		} else {
+			float * out = audio_out[o];
+			for (int i = 0; i < audio_block_size; i++) {
+				out[i] = 0.0;
+			}
+		}
+	}
+
+	// Banks are reset together, so their windows all end in the same block
+	bool window_done = false;
+	for (int i = 0; i < c->inputs; i++) {
+		window_done |= goertzel_bank_read(&c->bank[i], audio_in[i],
+				audio_block_size);
+	}
+	if (window_done) {
+		channel_test_end_window(c);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Returns true while a test is running
+ *
+ * @param c Pointer to instance structure
+ */
+bool channel_test_running(CHANNEL_TEST * c) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+	return c->start_requested || (c->state != CHANNEL_TEST_IDLE
+			&& c->state != CHANNEL_TEST_DONE);
+}
+
+/**
+ * @brief Returns what was heard from an output in the last completed test
+ *
+ * @param c Pointer to instance structure
+ * @param output Index of the output channel
+ * @return Pointer to the result, or NULL if there is no result for this output
+ */
+const CHANNEL_TEST_RESULT * channel_test_result(CHANNEL_TEST * c,
+		uint32_t output) {
+
+	if (c == NULL || !c->initialized || c->runs == 0 || output >= c->outputs) {
+		return NULL;
+	}
+	return &c->result[output];
+}
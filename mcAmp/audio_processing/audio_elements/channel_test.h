@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CHANNEL_TEST_H
+#define _CHANNEL_TEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+#include "goertzel_bank.h"
+
+// Maximum number of output channels under test (each gets its own tone)
+#define CHANNEL_TEST_MAX_OUTPUTS   (GOERTZEL_BANK_MAX_BINS)
+
+// Maximum number of loopback / reference inputs listened to
+#define CHANNEL_TEST_MAX_INPUTS    (4)
+
+// Result enumerations
+typedef enum {
+	CHANNEL_TEST_OK,
+	CHANNEL_TEST_INVALID_INSTANCE_POINTER,
+	CHANNEL_TEST_INVALID_CHANNELS,
+	CHANNEL_TEST_INVALID_WINDOW,
+	CHANNEL_TEST_INVALID_FREQUENCY
+} RESULT_CHANNEL_TEST;
+
+// Test progress
+typedef enum {
+	CHANNEL_TEST_IDLE,             // not running, outputs are left alone
+	CHANNEL_TEST_SETTLING,         // outputs silent while the previous audio dies away
+	CHANNEL_TEST_NOISE,            // outputs silent while the noise floor is measured
+	CHANNEL_TEST_TONES,            // every output playing its tone (routing and level)
+	CHANNEL_TEST_LATENCY,          // one output at a time playing its tone (latency)
+	CHANNEL_TEST_DONE              // results ready, outputs are left alone
+} CHANNEL_TEST_STATE;
+
+// What was heard from one output channel
+typedef struct {
+	bool found;                    // the tone was heard on one of the inputs
+	uint32_t input;                // input where it was loudest
+	float frequency;               // frequency of the tone (Hz)
+	float level_db;                // level on that input relative to the level played
+	float latency_samples;         // output to input delay (negative if it couldn't be measured)
+} CHANNEL_TEST_RESULT;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	volatile uint32_t state;       // CHANNEL_TEST_STATE
+	volatile bool start_requested;
+	volatile uint32_t runs;        // completed tests since setup
+
+	uint32_t outputs;
+	uint32_t inputs;
+	uint32_t window_samples;
+	uint32_t windows;              // windows spent in the current state
+	float tone_amplitude;
+
+	// Tone oscillators (rotating phasors)
+	float frequency[CHANNEL_TEST_MAX_OUTPUTS];
+	float osc_re[CHANNEL_TEST_MAX_OUTPUTS];
+	float osc_im[CHANNEL_TEST_MAX_OUTPUTS];
+	float rot_re[CHANNEL_TEST_MAX_OUTPUTS];
+	float rot_im[CHANNEL_TEST_MAX_OUTPUTS];
+
+	// One detector bank per input, one bin per output tone
+	GOERTZEL_BANK bank[CHANNEL_TEST_MAX_INPUTS];
+
+	float noise[CHANNEL_TEST_MAX_INPUTS][CHANNEL_TEST_MAX_OUTPUTS];
+
+	// Latency of the output currently playing on its own
+	uint32_t latency_output;
+	float latency_sum_re;
+	float latency_sum_im;
+	float latency_last;
+	float latency_prev;
+
+	CHANNEL_TEST_RESULT result[CHANNEL_TEST_MAX_OUTPUTS];
+
+} CHANNEL_TEST;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_CHANNEL_TEST channel_test_setup(CHANNEL_TEST * c, uint32_t outputs,
+		uint32_t inputs, float tone_level_db, float first_frequency,
+		float frequency_spacing, float window_ms, uint32_t audio_block_size,
+		float audio_sample_rate);
+
+void channel_test_start(CHANNEL_TEST * c);
+
+bool channel_test_process(CHANNEL_TEST * c, float ** audio_out,
+		float ** audio_in, uint32_t audio_block_size);
+
+bool channel_test_running(CHANNEL_TEST * c);
+
+const CHANNEL_TEST_RESULT * channel_test_result(CHANNEL_TEST * c,
+		uint32_t output);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_CHANNEL_TEST_H
@@ -8,6 +8,9 @@
  * can be used to eliminate the audio artifacts that can occur with clipping using
  * polynomial expansion.
  *
+ * For load shedding, the oversampling factor can be reduced from 8x to 4x, or
+ * oversampling can be disabled entirely (see clipper_set_quality()).
+ *
  */
 
 #include <math.h>
@@ -16,13 +19,17 @@
 
 #include "audio_utilities.h"
 #include "clipper.h"
+#include "scratch_arena.h"
 
 // Min/max limits and other constants
 #define CLIPPER_INTERP_FACTOR       (8)
+#define CLIPPER_INTERP_FACTOR_REDUCED (4)
 #define CLIPPER_MAX_THRESHOLD       (1.0)
 #define CLIPPER_MIN_THRESHOLD       (0.001)
 
 // Static function prototypes
+static float pm * clipper_resample_coeffs(CLIPPER * c);
+
 static void upsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
@@ -65,6 +72,7 @@ RESULT_CLIPPER clipper_setup(CLIPPER *c, float threshold,
 	// Set parameters
 	c->clip_threshold = threshold;
 	c->upsample = upsample;
+	c->interp_factor = upsample ? CLIPPER_INTERP_FACTOR : 1;
 
 	// Instance was successfully initialized
 	c->initialized = true;
@@ -107,6 +115,49 @@ RESULT_CLIPPER modify_clipper_threshold(CLIPPER *c, float threshold_new) {
 	return res;
 }
 
+/**
+ * @brief Set the quality tier (oversampling factor) of the clipper
+ *
+ * Only applies to clippers that were set up with upsampling enabled.  Tiers
+ * below QUALITY_TIER_MINIMAL are treated as QUALITY_TIER_MINIMAL since the
+ * clipper is what gives the effect its character.
+ *
+ * @param c Pointer to instance structure
+ * @param tier Quality tier
+ * @return Clipper result (enumeration)
+ */
+RESULT_CLIPPER clipper_set_quality(CLIPPER *c, QUALITY_TIER tier) {
+
+	if (c == NULL) {
+		return CLIPPER_INVALID_INSTANCE_POINTER;
+	}
+
+	uint32_t interp_factor;
+	if (!c->upsample) {
+		interp_factor = 1;
+	} else if (tier == QUALITY_TIER_FULL) {
+		interp_factor = CLIPPER_INTERP_FACTOR;
+	} else if (tier == QUALITY_TIER_REDUCED) {
+		interp_factor = CLIPPER_INTERP_FACTOR_REDUCED;
+	} else {
+		interp_factor = 1;
+	}
+
+	// If nothing has changed, return
+	if (interp_factor == c->interp_factor) {
+		return CLIPPER_OK;
+	}
+
+	// Filter state from a different rate is meaningless, so clear it
+	for (int i = 0; i < CLIPPER_INTERP_TAPS + 1; i++) {
+		c->fir_upsample_state[i] = 0.0;
+		c->fir_downsample_state[i] = 0.0;
+	}
+	c->interp_factor = interp_factor;
+
+	return CLIPPER_OK;
+}
+
 /**
  * @brief Apply effect/process to a block of audio data
  *
@@ -130,12 +181,22 @@ void clipper_read(CLIPPER *c, float * audio_in, float * audio_out,
 		return;
 	}
 
-	float clipper_read_temp[MAX_AUDIO_BLOCK_SIZE * CLIPPER_INTERP_FACTOR];
-	int buffer_size_multipler = 1;
+	int buffer_size_multipler = c->interp_factor;
+
+	// The oversampled signal lives in the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * clipper_read_temp = scratch_alloc(
+			audio_block_size * buffer_size_multipler);
 
-	if (c->upsample) {
+	if (clipper_read_temp == NULL) {
+		for (int i = 0; i < audio_block_size; i++) {
+			audio_out[i] = audio_in[i];
+		}
+		return;
+	}
+
+	if (buffer_size_multipler > 1) {
 		upsample_signal(c, audio_in, clipper_read_temp, audio_block_size);
-		buffer_size_multipler = CLIPPER_INTERP_FACTOR;
 	} else {
 		copy_buffer(audio_in, clipper_read_temp, audio_block_size);
 	}
@@ -155,12 +216,14 @@ void clipper_read(CLIPPER *c, float * audio_in, float * audio_out,
 		break;
 	}
 
-	if (c->upsample) {
+	if (buffer_size_multipler > 1) {
 		downsample_signal(c, clipper_read_temp, audio_out, audio_block_size);
 	} else {
 		copy_buffer(clipper_read_temp, audio_out, audio_block_size);
 	}
 
+	scratch_release(scratch);
+
 }
 
 // Coefficients used for upsampling/downsampling
@@ -176,6 +239,30 @@ float pm fir_resample_x_8[CLIPPER_INTERP_TAPS] = { -3.88257917522e-19,
 		-0.0035491808885, -0.00184171525988, -0.000718555656558,
 		-3.88257917522e-19 };
 
+// Same design (Hamming windowed sinc) for 4x resampling (reduced quality tier)
+float pm fir_resample_x_4[CLIPPER_INTERP_TAPS] = { -7.81472840002e-19,
+		-0.0013361934128, -0.00262120541617, -0.00273376615707,
+		2.09757938926e-18, 0.00583381302308, 0.0116127053037, 0.0112869709659,
+		-5.27494167001e-18, -0.0202965559832, -0.0380763811518,
+		-0.0358973374642, 8.45230395076e-18, 0.069373223511, 0.153944232061,
+		0.223615729383, 0.250589530675, 0.223615729383, 0.153944232061,
+		0.069373223511, 8.45230395076e-18, -0.0358973374642, -0.0380763811518,
+		-0.0202965559832, -5.27494167001e-18, 0.0112869709659,
+		0.0116127053037, 0.00583381302308, 2.09757938926e-18,
+		-0.00273376615707, -0.00262120541617, -0.0013361934128,
+		-7.81472840002e-19 };
+
+/**
+ * @brief Returns the resampling filter for the current oversampling factor
+ *
+ * @param c Pointer to instance structure
+ * @return Pointer to filter coefficients
+ */
+static float pm * clipper_resample_coeffs(CLIPPER * c) {
+	return (c->interp_factor == CLIPPER_INTERP_FACTOR_REDUCED) ?
+			fir_resample_x_4 : fir_resample_x_8;
+}
+
 /**
  * @brief Simple upsampling function
  *
@@ -190,17 +277,18 @@ static void upsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
 
 	int i;
 	int indx = 0;
+	uint32_t interp_factor = c->interp_factor;
 
 	// Upsample
 	for (i = 0; i < audio_block_size; i++) {
-		for (int j = 0; j < CLIPPER_INTERP_FACTOR; j++) {
+		for (int j = 0; j < interp_factor; j++) {
 			audio_out[indx++] = audio_in[i];
 		}
 	}
 
 	// Filter
-	fir(audio_out, audio_out, fir_resample_x_8, c->fir_upsample_state,
-			audio_block_size * CLIPPER_INTERP_FACTOR,
+	fir(audio_out, audio_out, clipper_resample_coeffs(c),
+			c->fir_upsample_state, audio_block_size * interp_factor,
 			CLIPPER_INTERP_TAPS);
 }
 
@@ -216,14 +304,16 @@ static void upsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
 static void downsample_signal(CLIPPER * c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size) {
 
+	uint32_t interp_factor = c->interp_factor;
+
 	// Filter
-	fir(audio_in, audio_in, fir_resample_x_8, c->fir_downsample_state,
-			audio_block_size * CLIPPER_INTERP_FACTOR,
+	fir(audio_in, audio_in, clipper_resample_coeffs(c),
+			c->fir_downsample_state, audio_block_size * interp_factor,
 			CLIPPER_INTERP_TAPS);
 
 	int indx = 0;
-	for (int i = 0; i < audio_block_size * CLIPPER_INTERP_FACTOR; i +=
-			CLIPPER_INTERP_FACTOR) {
+	for (int i = 0; i < audio_block_size * interp_factor; i +=
+			interp_factor) {
 		audio_out[indx++] = audio_in[i];
 	}
 }
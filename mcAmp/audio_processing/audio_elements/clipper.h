@@ -34,6 +34,7 @@ typedef struct {
 	POLY_CLIP_FUNC poly_clip;
 	float clip_threshold;
 	bool upsample;
+	uint32_t interp_factor;        // 8 (full), 4 (reduced) or 1 (no oversampling)
 } CLIPPER;
 
 #ifdef __cplusplus
@@ -45,6 +46,8 @@ RESULT_CLIPPER clipper_setup(CLIPPER *c, float threshold,
 
 RESULT_CLIPPER modify_clipper_threshold(CLIPPER *c, float threshold);
 
+RESULT_CLIPPER clipper_set_quality(CLIPPER *c, QUALITY_TIER tier);
+
 void clipper_read(CLIPPER *c, float * audio_in, float * audio_out,
 		uint32_t audio_block_size);
 
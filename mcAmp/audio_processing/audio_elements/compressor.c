@@ -34,6 +34,7 @@ static float calculate_threshold_coeff(float threshold_db);
 static float calculate_ratio_coeff(float ratio);
 static LP_COEFF calculate_rms_coeffs(float rms_fc, float fs);
 static LP_COEFF calculate_lp_coeffs(float timeconstant_ms, float fs);
+static void compressor_update_coeffs(COMPRESSOR * c);
 
 /**
  * @brief Initializes instance of a compressor
@@ -66,6 +67,7 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c, float threshold_db,
 		return COMPRESSOR_INVALID_THRESHOLD;
 	}
 	c->threshold_db = threshold_db;
+	c->threshold_db_last = threshold_db;
 	c->threshold_coeff = calculate_threshold_coeff(threshold_db);
 
 	// Set compressor ratio
@@ -73,6 +75,7 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c, float threshold_db,
 		return COMPRESSOR_INVALID_RATIO;
 	}
 	c->ratio = ratio;
+	c->ratio_last = ratio;
 	c->ratio_coeff = calculate_ratio_coeff(ratio);
 
 	// Set compressor attack time
@@ -81,6 +84,7 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c, float threshold_db,
 		return COMPRESSOR_INVALID_ATTACK;
 	}
 	c->attack_ms = attack_ms;
+	c->attack_ms_last = attack_ms;
 	c->attack_coeff = calculate_lp_coeffs(attack_ms, audio_sample_rate);
 
 	// Set compressor release time
@@ -89,6 +93,7 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c, float threshold_db,
 		return COMPRESSOR_INVALID_RELEASE;
 	}
 	c->release_ms = release_ms;
+	c->release_ms_last = release_ms;
 	c->release_coeff = calculate_lp_coeffs(release_ms, audio_sample_rate);
 
 	// Set RMS coefficient for 100ms
@@ -103,6 +108,9 @@ RESULT_COMPRESSOR compressor_setup(COMPRESSOR * c, float threshold_db,
 	// Set sample rate
 	c->audio_sample_rate = audio_sample_rate;
 
+	// All coefficients are up to date
+	c->coeffs_dirty = 0;
+
 	// Initialize state variables
 	c->x2_last = 0.0;
 	c->x_ar_last = 0.0;
@@ -149,9 +157,9 @@ RESULT_COMPRESSOR compressor_modify_threshold(COMPRESSOR * c,
 		c->threshold_db_last = threshold_db;
 	}
 
-	// Update parameters
+	// Update parameters (the coefficient is recomputed by the next read)
 	c->threshold_db = threshold_db;
-	c->threshold_coeff = calculate_threshold_coeff(threshold_db);
+	c->coeffs_dirty |= COMPRESSOR_DIRTY_THRESHOLD;
 
 	return res;
 
@@ -195,9 +203,9 @@ RESULT_COMPRESSOR compressor_modify_ratio(COMPRESSOR * c, float ratio_new) {
 		c->ratio_last = ratio;
 	}
 
-	// Update parameters
+	// Update parameters (the coefficient is recomputed by the next read)
 	c->ratio = ratio;
-	c->ratio_coeff = calculate_ratio_coeff(ratio);
+	c->coeffs_dirty |= COMPRESSOR_DIRTY_RATIO;
 
 	return res;
 
@@ -238,9 +246,9 @@ RESULT_COMPRESSOR compressor_modify_attack(COMPRESSOR * c, float attack_ms_new)
 		c->attack_ms_last = attack_ms;
 	}
 
-	// Update parameters
+	// Update parameters (the coefficients are recomputed by the next read)
 	c->attack_ms = attack_ms;
-	c->attack_coeff = calculate_lp_coeffs(attack_ms, c->audio_sample_rate);
+	c->coeffs_dirty |= COMPRESSOR_DIRTY_ATTACK;
 
 	return res;
 
@@ -282,9 +290,9 @@ RESULT_COMPRESSOR compressor_modify_release(COMPRESSOR * c,
 		c->release_ms_last = release_ms;
 	}
 
-	// Update parameters
+	// Update parameters (the coefficients are recomputed by the next read)
 	c->release_ms = release_ms;
-	c->release_coeff = calculate_lp_coeffs(release_ms, c->audio_sample_rate);
+	c->coeffs_dirty |= COMPRESSOR_DIRTY_RELEASE;
 
 	return res;
 
@@ -344,6 +352,11 @@ void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 		return;
 	}
 
+	// Apply any parameter changes since the last block in one go
+	if (c->coeffs_dirty) {
+		compressor_update_coeffs(c);
+	}
+
 	float x2_last = c->x2_last;
 	float x_ar_last = c->x_ar_last;
 
@@ -389,6 +402,34 @@ void compressor_read(COMPRESSOR * c, float * audio_in, float * audio_out,
 
 }
 
+/**
+ * @brief Recomputes the coefficients of the parameters that have been modified
+ *
+ * The modify functions only record the new value, so however many
+ * parameters change between blocks the coefficients are computed once.
+ *
+ * @param c Pointer to instance structure
+ */
+static void compressor_update_coeffs(COMPRESSOR * c) {
+
+	if (c->coeffs_dirty & COMPRESSOR_DIRTY_THRESHOLD) {
+		c->threshold_coeff = calculate_threshold_coeff(c->threshold_db);
+	}
+	if (c->coeffs_dirty & COMPRESSOR_DIRTY_RATIO) {
+		c->ratio_coeff = calculate_ratio_coeff(c->ratio);
+	}
+	if (c->coeffs_dirty & COMPRESSOR_DIRTY_ATTACK) {
+		c->attack_coeff = calculate_lp_coeffs(c->attack_ms,
+				c->audio_sample_rate);
+	}
+	if (c->coeffs_dirty & COMPRESSOR_DIRTY_RELEASE) {
+		c->release_coeff = calculate_lp_coeffs(c->release_ms,
+				c->audio_sample_rate);
+	}
+
+	c->coeffs_dirty = 0;
+}
+
 /**
  * @brief Calculates log2(x)
  *
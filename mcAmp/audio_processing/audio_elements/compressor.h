@@ -21,6 +21,12 @@ typedef enum {
 	COMPRESSOR_INVALID_GAIN
 } RESULT_COMPRESSOR;
 
+// Coefficients waiting to be recomputed (see compressor_read())
+#define COMPRESSOR_DIRTY_THRESHOLD		(1 << 0)
+#define COMPRESSOR_DIRTY_RATIO			(1 << 1)
+#define COMPRESSOR_DIRTY_ATTACK			(1 << 2)
+#define COMPRESSOR_DIRTY_RELEASE		(1 << 3)
+
 // Struct for LP filter
 typedef struct {
 	float ff;
@@ -52,6 +58,8 @@ typedef struct {
 	LP_COEFF attack_coeff;
 	LP_COEFF release_coeff;
 
+	uint32_t coeffs_dirty;		// COMPRESSOR_DIRTY_xxx
+
 	float cur_rms;
 
 	float x2_last, x_ar_last;
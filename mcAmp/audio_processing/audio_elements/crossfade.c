@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element performs a stereo equal-power crossfade between an
+ * outgoing and an incoming source.  It is used to switch between effect
+ * chains / presets without a discontinuity in the output.
+ *
+ * The cos / sin gain curves are generated with a rotating phasor so no
+ * trig functions are called in the audio path.  Either source can be passed
+ * as NULL, in which case it is treated as silence.  This allows the element
+ * to also be used to fade a single source out or in.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "crossfade.h"
+
+// Min/max limits
+#define     CROSSFADE_MIN_LENGTH     (1)
+#define     CROSSFADE_MAX_LENGTH     (0x100000)
+
+/**
+ * @brief Initializes instance of a crossfade
+ *
+ * @param c Pointer to instance structure
+ * @param fade_time_ms Duration of the crossfade in milliseconds
+ * @param sample_rate The audio sample rate
+ *
+ * @return Crossfade result (enumeration)
+ */
+RESULT_CROSSFADE crossfade_setup(CROSSFADE * c, float fade_time_ms,
+		float sample_rate) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return CROSSFADE_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	uint32_t fade_length = (uint32_t) (fade_time_ms * 0.001 * sample_rate);
+	if (fade_length < CROSSFADE_MIN_LENGTH
+			|| fade_length > CROSSFADE_MAX_LENGTH) {
+		return CROSSFADE_INVALID_LENGTH;
+	}
+
+	// Each sample advances the phasor by (PI/2) / fade_length radians
+	float delta = (PI * 0.5) / (float) fade_length;
+
+	c->fade_length = fade_length;
+	c->rot_cos = cosf(delta);
+	c->rot_sin = sinf(delta);
+
+	// Idle state is "fully faded in" - only the incoming source is heard
+	c->remaining_samples = 0;
+	c->gain_out = 0.0;
+	c->gain_in = 1.0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return CROSSFADE_OK;
+}
+
+/**
+ * @brief Starts a new crossfade from the outgoing to the incoming source
+ *
+ * @param c Pointer to instance structure
+ * @return Crossfade result (enumeration)
+ */
+RESULT_CROSSFADE crossfade_start(CROSSFADE * c) {
+
+	if (c == NULL) {
+		return CROSSFADE_INVALID_INSTANCE_POINTER;
+	}
+	if (!c->initialized) {
+		return CROSSFADE_NOT_INITIALIZED;
+	}
+
+	c->gain_out = 1.0;
+	c->gain_in = 0.0;
+	c->remaining_samples = c->fade_length;
+
+	return CROSSFADE_OK;
+}
+
+/**
+ * @brief Returns true once the current crossfade has completed
+ *
+ * @param c Pointer to instance structure
+ * @return true if no crossfade is in progress
+ */
+bool crossfade_complete(CROSSFADE * c) {
+
+	if (c == NULL || !c->initialized) {
+		return true;
+	}
+	return (c->remaining_samples == 0);
+}
+
+/**
+ * @brief Mixes a block of audio from the outgoing and incoming sources
+ *
+ * The output buffers may be the same as either of the input buffers.
+ *
+ * @param c Pointer to instance structure
+ * @param audio_out_l Outgoing source, left channel (NULL = silence)
+ * @param audio_out_r Outgoing source, right channel (NULL = silence)
+ * @param audio_in_l Incoming source, left channel (NULL = silence)
+ * @param audio_in_r Incoming source, right channel (NULL = silence)
+ * @param audio_mix_l Pointer to floating point audio output buffer (left)
+ * @param audio_mix_r Pointer to floating point audio output buffer (right)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void crossfade_read(CROSSFADE * c, float * audio_out_l, float * audio_out_r,
+		float * audio_in_l, float * audio_in_r, float * audio_mix_l,
+		float * audio_mix_r, uint32_t audio_block_size) {
+
+	int i;
+
+	// If this instance hasn't been properly initialized, pass the incoming source
+	if (c == NULL || !c->initialized) {
+		for (i = 0; i < audio_block_size; i++) {
+			audio_mix_l[i] = (audio_in_l == NULL) ? 0.0 : audio_in_l[i];
+			audio_mix_r[i] = (audio_in_r == NULL) ? 0.0 : audio_in_r[i];
+		}
+		return;
+	}
+
+	// Bring state variables into local variables
+	float gain_out = c->gain_out;
+	float gain_in = c->gain_in;
+	float rot_cos = c->rot_cos;
+	float rot_sin = c->rot_sin;
+	uint32_t remaining_samples = c->remaining_samples;
+
+	for (i = 0; i < audio_block_size; i++) {
+
+		float mix_l = 0.0, mix_r = 0.0;
+		if (audio_out_l != NULL) {
+			mix_l += audio_out_l[i] * gain_out;
+		}
+		if (audio_out_r != NULL) {
+			mix_r += audio_out_r[i] * gain_out;
+		}
+		if (audio_in_l != NULL) {
+			mix_l += audio_in_l[i] * gain_in;
+		}
+		if (audio_in_r != NULL) {
+			mix_r += audio_in_r[i] * gain_in;
+		}
+		audio_mix_l[i] = mix_l;
+		audio_mix_r[i] = mix_r;
+
+		if (remaining_samples) {
+
+			// Rotate the (cos, sin) phasor forward one step
+			float next_out = gain_out * rot_cos - gain_in * rot_sin;
+			float next_in = gain_in * rot_cos + gain_out * rot_sin;
+			gain_out = next_out;
+			gain_in = next_in;
+
+			// Land exactly on the end points to avoid accumulated error
+			if (--remaining_samples == 0) {
+				gain_out = 0.0;
+				gain_in = 1.0;
+			}
+		}
+	}
+
+	// store state variables back into struct
+	c->gain_out = gain_out;
+	c->gain_in = gain_in;
+	c->remaining_samples = remaining_samples;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CROSSFADE_H
+#define _CROSSFADE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum {
+	CROSSFADE_OK,
+	CROSSFADE_INVALID_INSTANCE_POINTER,
+	CROSSFADE_INVALID_LENGTH,
+	CROSSFADE_NOT_INITIALIZED
+} RESULT_CROSSFADE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t fade_length;         // length of the fade in samples
+	uint32_t remaining_samples;   // samples left in the current fade
+
+	// Equal-power gains are generated with a rotating phasor
+	float gain_out;               // gain applied to the outgoing source (cos)
+	float gain_in;                // gain applied to the incoming source (sin)
+	float rot_cos;
+	float rot_sin;
+
+} CROSSFADE;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_CROSSFADE crossfade_setup(CROSSFADE * c, float fade_time_ms,
+		float sample_rate);
+
+RESULT_CROSSFADE crossfade_start(CROSSFADE * c);
+
+bool crossfade_complete(CROSSFADE * c);
+
+void crossfade_read(CROSSFADE * c, float * audio_out_l, float * audio_out_r,
+		float * audio_in_l, float * audio_in_r, float * audio_mix_l,
+		float * audio_mix_r, uint32_t audio_block_size);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_CROSSFADE_H
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A per-node cycle profiler for the audio callback on each SHARC core.
+ *
+ * The framework only reports the load of the whole callback, so when a block
+ * overruns there is no way to tell which effect or element was responsible.
+ * Each call made from the audio callback (an effect preset, a limiter, the
+ * channel routing, etc.) can instead be wrapped in CYCLE_PROFILE() with a
+ * node ID.  For every node, the profiler keeps the number of runs, the
+ * minimum, mean and maximum cycle counts and a histogram with log2-spaced
+ * buckets.  The same statistics are kept for the whole block.
+ *
+ * When a block overruns, processaudio_mips_overflow() is called from the
+ * audio DMA interrupt while the callback is still running.  The node that
+ * has run longest so far in that block (including the node that is still
+ * running) is recorded as the cause of the overrun.
+ *
+ * The statistics live in L1.  Every CYCLE_PROFILER_PUBLISH_BLOCKS blocks, a
+ * snapshot is copied to this core's uncached L2 so the ARM can read it
+ * through the pointer published in MULTICORE_DATA.  The snapshot's sequence
+ * number is odd while it is being written; cycle_profiler_read_snapshot()
+ * retries until it gets a consistent copy.
+ *
+ * Only the lower 32 bits of the cycle counter are used (more than nine
+ * seconds at 450 MHz) and the histogram bucket comes from the exponent of
+ * the cycle count converted to a float, so each profiled node costs a few
+ * tens of cycles - well under 1% of a block for the nodes used in
+ * audio_effects_selector.cpp.  Cycles spent in interrupts are counted in
+ * whichever node they interrupt.  Setting CYCLE_PROFILER_ENABLED to false
+ * removes the profiler, and CYCLE_PROFILE() then only makes the call.
+ */
+#include <stdlib.h>
+
+#include "cycle_profiler.h"
+
+#if (CYCLE_PROFILER_ENABLED)
+
+#if defined(CORE1) || defined(CORE2)
+
+// Ensures the snapshot has been written before the sequence number is moved
+#define CYCLE_PROFILER_SYNC()   asm volatile("sync;")
+
+// Running statistics (the mean is kept as a sum until it is published)
+typedef struct {
+	uint32_t runs;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t overruns;
+	uint32_t histogram[CYCLE_PROFILER_HIST_BUCKETS];
+} CYCLE_PROFILER_COUNTERS;
+
+#pragma section("seg_l1_block1_data")
+static CYCLE_PROFILER_COUNTERS profiler_block;
+#pragma section("seg_l1_block1_data")
+static CYCLE_PROFILER_COUNTERS profiler_node[CYCLE_PROFILER_MAX_NODES];
+
+// Node that is currently running and when it (and the block) started
+static volatile uint32_t profiler_open_node = CYCLE_PROFILER_NO_NODE;
+static volatile uint32_t profiler_node_start_cycles;
+static uint32_t profiler_block_start_cycles;
+
+// Longest node that has completed in the current block
+static volatile uint32_t profiler_longest_node = CYCLE_PROFILER_NO_NODE;
+static volatile uint32_t profiler_longest_cycles;
+
+// Attribution of the last overrun
+static uint32_t profiler_overruns;
+static uint32_t profiler_overrun_node = CYCLE_PROFILER_NO_NODE;
+static uint32_t profiler_overrun_cycles;
+
+static uint32_t profiler_blocks_until_publish;
+
+/*
+ * Snapshot for the ARM in this core's uncached L2 (see the event ring in
+ * bm_event_logging.c)
+ */
+#pragma section("seg_l2_uncached")
+static CYCLE_PROFILER_SNAPSHOT profiler_snapshot;
+
+/**
+ * @brief Clears a set of running statistics
+ *
+ * @param c Pointer to statistics
+ */
+static void cycle_profiler_clear(CYCLE_PROFILER_COUNTERS * c) {
+
+	c->runs = 0;
+	c->min_cycles = 0xFFFFFFFF;
+	c->max_cycles = 0;
+	c->total_cycles = 0;
+	c->overruns = 0;
+
+	for (int i = 0; i < CYCLE_PROFILER_HIST_BUCKETS; i++) {
+		c->histogram[i] = 0;
+	}
+}
+
+/**
+ * @brief Adds one run to a set of running statistics
+ *
+ * @param c Pointer to statistics
+ * @param cycles Length of the run in core cycles
+ */
+#pragma optimize_for_speed
+static inline void cycle_profiler_add(CYCLE_PROFILER_COUNTERS * c,
+		uint32_t cycles) {
+
+	c->runs++;
+	c->total_cycles += cycles;
+	if (cycles < c->min_cycles) {
+		c->min_cycles = cycles;
+	}
+	if (cycles > c->max_cycles) {
+		c->max_cycles = cycles;
+	}
+
+	// The float exponent is floor(log2(cycles)); zero has an exponent of -127
+	union {
+		float f;
+		uint32_t u;
+	} value;
+	value.f = (float) cycles;
+	int32_t bucket = (int32_t) ((value.u >> 23) & 0xFF) - 127
+			- CYCLE_PROFILER_HIST_SHIFT;
+
+	if (bucket < 0) {
+		bucket = 0;
+	} else if (bucket >= CYCLE_PROFILER_HIST_BUCKETS) {
+		bucket = CYCLE_PROFILER_HIST_BUCKETS - 1;
+	}
+	c->histogram[bucket]++;
+}
+
+/**
+ * @brief Copies running statistics into a snapshot
+ *
+ * @param c Pointer to statistics
+ * @param stats Pointer to snapshot statistics
+ */
+static void cycle_profiler_copy(const CYCLE_PROFILER_COUNTERS * c,
+		CYCLE_PROFILER_STATS * stats) {
+
+	stats->runs = c->runs;
+	stats->min_cycles = c->runs ? c->min_cycles : 0;
+	stats->max_cycles = c->max_cycles;
+	stats->mean_cycles = c->runs ? (uint32_t) (c->total_cycles / c->runs) : 0;
+	stats->overruns = c->overruns;
+
+	for (int i = 0; i < CYCLE_PROFILER_HIST_BUCKETS; i++) {
+		stats->histogram[i] = c->histogram[i];
+	}
+}
+
+/**
+ * @brief Copies the statistics to the snapshot read by the ARM
+ */
+static void cycle_profiler_publish(void) {
+
+	uint32_t sequence = profiler_snapshot.sequence + 1;
+
+	// An odd sequence number tells readers the snapshot is being written
+	profiler_snapshot.sequence = sequence;
+	CYCLE_PROFILER_SYNC();
+
+	profiler_snapshot.blocks = profiler_block.runs;
+	profiler_snapshot.overruns = profiler_overruns;
+	profiler_snapshot.overrun_node = profiler_overrun_node;
+	profiler_snapshot.overrun_cycles = profiler_overrun_cycles;
+
+	cycle_profiler_copy(&profiler_block, &profiler_snapshot.block);
+	for (int i = 0; i < CYCLE_PROFILER_MAX_NODES; i++) {
+		cycle_profiler_copy(&profiler_node[i], &profiler_snapshot.node[i]);
+	}
+
+	CYCLE_PROFILER_SYNC();
+	profiler_snapshot.sequence = sequence + 1;
+}
+
+/**
+ * @brief Clears the statistics - call from the audio setup routine
+ *
+ * @return Pointer to the snapshot to publish in MULTICORE_DATA for the ARM
+ */
+CYCLE_PROFILER_SNAPSHOT * cycle_profiler_setup(void) {
+
+	cycle_profiler_clear(&profiler_block);
+	for (int i = 0; i < CYCLE_PROFILER_MAX_NODES; i++) {
+		cycle_profiler_clear(&profiler_node[i]);
+	}
+
+	profiler_open_node = CYCLE_PROFILER_NO_NODE;
+	profiler_longest_node = CYCLE_PROFILER_NO_NODE;
+	profiler_longest_cycles = 0;
+
+	profiler_overruns = 0;
+	profiler_overrun_node = CYCLE_PROFILER_NO_NODE;
+	profiler_overrun_cycles = 0;
+
+	profiler_blocks_until_publish = CYCLE_PROFILER_PUBLISH_BLOCKS;
+
+	profiler_snapshot.sequence = 0;
+	cycle_profiler_publish();
+
+	return &profiler_snapshot;
+}
+
+/**
+ * @brief Starts profiling a block - call at the start of the audio callback
+ */
+#pragma optimize_for_speed
+void cycle_profiler_block_start(void) {
+
+	profiler_longest_node = CYCLE_PROFILER_NO_NODE;
+	profiler_longest_cycles = 0;
+	profiler_block_start_cycles = (uint32_t) __builtin_emuclk();
+}
+
+/**
+ * @brief Finishes profiling a block - call at the end of the audio callback
+ *
+ * Publishes a snapshot for the ARM every CYCLE_PROFILER_PUBLISH_BLOCKS blocks.
+ */
+#pragma optimize_for_speed
+void cycle_profiler_block_end(void) {
+
+	cycle_profiler_add(&profiler_block,
+			(uint32_t) __builtin_emuclk() - profiler_block_start_cycles);
+
+	if (--profiler_blocks_until_publish == 0) {
+		profiler_blocks_until_publish = CYCLE_PROFILER_PUBLISH_BLOCKS;
+		cycle_profiler_publish();
+	}
+}
+
+/**
+ * @brief Starts timing a node
+ *
+ * @param node Node ID (0 -> CYCLE_PROFILER_MAX_NODES-1)
+ */
+#pragma optimize_for_speed
+void cycle_profiler_node_start(uint32_t node) {
+
+	profiler_open_node = node;
+	profiler_node_start_cycles = (uint32_t) __builtin_emuclk();
+}
+
+/**
+ * @brief Stops timing the node started by cycle_profiler_node_start()
+ */
+#pragma optimize_for_speed
+void cycle_profiler_node_end(void) {
+
+	uint32_t cycles = (uint32_t) __builtin_emuclk()
+			- profiler_node_start_cycles;
+	uint32_t node = profiler_open_node;
+
+	profiler_open_node = CYCLE_PROFILER_NO_NODE;
+
+	if (node >= CYCLE_PROFILER_MAX_NODES) {
+		return;
+	}
+
+	cycle_profiler_add(&profiler_node[node], cycles);
+
+	if (cycles > profiler_longest_cycles) {
+		profiler_longest_cycles = cycles;
+		profiler_longest_node = node;
+	}
+}
+
+/**
+ * @brief Records which node ran longest in a block that overran
+ *
+ * This is safe to call from the DMA interrupt (e.g. processaudio_mips_overflow())
+ * while the audio callback is still running.
+ */
+void cycle_profiler_report_overrun(void) {
+
+	uint32_t node = profiler_longest_node;
+	uint32_t cycles = profiler_longest_cycles;
+
+	// The node that is still running may be the one that is taking too long
+	uint32_t open_node = profiler_open_node;
+	if (open_node != CYCLE_PROFILER_NO_NODE) {
+		uint32_t elapsed = (uint32_t) __builtin_emuclk()
+				- profiler_node_start_cycles;
+		if (elapsed > cycles) {
+			node = open_node;
+			cycles = elapsed;
+		}
+	}
+
+	profiler_overruns++;
+	profiler_overrun_node = node;
+	profiler_overrun_cycles = cycles;
+
+	profiler_block.overruns++;
+	if (node < CYCLE_PROFILER_MAX_NODES) {
+		profiler_node[node].overruns++;
+	}
+}
+
+#endif  // defined(CORE1) || defined(CORE2)
+
+// Keeps the reads of the sequence number and the snapshot in order on the ARM
+#if defined(CORE0)
+#define CYCLE_PROFILER_READ_BARRIER()   __sync_synchronize()
+#else
+#define CYCLE_PROFILER_READ_BARRIER()
+#endif
+
+/**
+ * @brief Takes a consistent copy of a snapshot published by a SHARC core
+ *
+ * @param snapshot Pointer to the published snapshot (from MULTICORE_DATA)
+ * @param copy Pointer to the copy to fill in
+ * @return true if a consistent copy was taken
+ */
+bool cycle_profiler_read_snapshot(const volatile CYCLE_PROFILER_SNAPSHOT * snapshot,
+		CYCLE_PROFILER_SNAPSHOT * copy) {
+
+	if (snapshot == NULL || copy == NULL) {
+		return false;
+	}
+
+	// Snapshots are only written every few ms, so a few retries is plenty
+	for (int attempt = 0; attempt < 4; attempt++) {
+
+		uint32_t sequence = snapshot->sequence;
+		if (sequence & 1) {
+			continue;
+		}
+		CYCLE_PROFILER_READ_BARRIER();
+
+		*copy = *snapshot;
+
+		CYCLE_PROFILER_READ_BARRIER();
+		if (snapshot->sequence == sequence) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#endif  // CYCLE_PROFILER_ENABLED
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _CYCLE_PROFILER_H
+#define _CYCLE_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Set to false to compile the profiler (and all of its L1 / L2 memory) out
+#define CYCLE_PROFILER_ENABLED          (true)
+
+// Maximum number of profiled nodes on each core (each adds 60 bytes to the snapshot in uncached L2)
+#define CYCLE_PROFILER_MAX_NODES        (20)
+
+/*
+ * Histogram buckets.  Bucket n counts runs of 2^(n + SHIFT) to
+ * 2^(n + SHIFT + 1) - 1 cycles.  The first bucket also counts anything
+ * shorter and the last bucket anything longer.
+ */
+#define CYCLE_PROFILER_HIST_BUCKETS     (10)
+#define CYCLE_PROFILER_HIST_SHIFT       (9)
+
+// Number of audio blocks between snapshots published for the ARM
+#define CYCLE_PROFILER_PUBLISH_BLOCKS   (64)
+
+// Node ID used when an overrun happens outside of any profiled node
+#define CYCLE_PROFILER_NO_NODE          (0xFFFFFFFF)
+
+// Statistics for one node (or for the whole block)
+typedef struct {
+	uint32_t runs;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint32_t mean_cycles;
+	uint32_t overruns;                               // overruns attributed to this node
+	uint32_t histogram[CYCLE_PROFILER_HIST_BUCKETS];
+} CYCLE_PROFILER_STATS;
+
+/*
+ * Snapshot published by each SHARC core for the ARM.  sequence is odd while
+ * the snapshot is being written; readers should use
+ * cycle_profiler_read_snapshot() to get a consistent copy.
+ */
+typedef struct {
+	volatile uint32_t sequence;
+
+	uint32_t blocks;
+	uint32_t overruns;
+	uint32_t overrun_node;                           // node that ran longest in the last overrun block
+	uint32_t overrun_cycles;                         // how long that node had run for
+
+	CYCLE_PROFILER_STATS block;
+	CYCLE_PROFILER_STATS node[CYCLE_PROFILER_MAX_NODES];
+} CYCLE_PROFILER_SNAPSHOT;
+
+/*
+ * Wrap calls to profiled nodes from the audio callback in CYCLE_PROFILE(), or
+ * surround longer sections of code with CYCLE_PROFILE_NODE_START() and
+ * CYCLE_PROFILE_NODE_END().  Nodes can't be nested.  With the profiler
+ * disabled, these compile to nothing (CYCLE_PROFILE() only makes the call).
+ */
+#if (CYCLE_PROFILER_ENABLED)
+
+#define CYCLE_PROFILE_NODE_START(node)     cycle_profiler_node_start(node)
+#define CYCLE_PROFILE_NODE_END()           cycle_profiler_node_end()
+#define CYCLE_PROFILE_BLOCK_START()        cycle_profiler_block_start()
+#define CYCLE_PROFILE_BLOCK_END()          cycle_profiler_block_end()
+#define CYCLE_PROFILE_OVERRUN()            cycle_profiler_report_overrun()
+
+#else
+
+#define CYCLE_PROFILE_NODE_START(node)     ((void) 0)
+#define CYCLE_PROFILE_NODE_END()           ((void) 0)
+#define CYCLE_PROFILE_BLOCK_START()        ((void) 0)
+#define CYCLE_PROFILE_BLOCK_END()          ((void) 0)
+#define CYCLE_PROFILE_OVERRUN()            ((void) 0)
+
+#endif
+
+#define CYCLE_PROFILE(node, call)   do { \
+	CYCLE_PROFILE_NODE_START(node); \
+	call; \
+	CYCLE_PROFILE_NODE_END(); \
+} while (0)
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+CYCLE_PROFILER_SNAPSHOT * cycle_profiler_setup(void);
+
+void cycle_profiler_block_start(void);
+void cycle_profiler_block_end(void);
+
+void cycle_profiler_node_start(uint32_t node);
+void cycle_profiler_node_end(void);
+
+void cycle_profiler_report_overrun(void);
+
+bool cycle_profiler_read_snapshot(const volatile CYCLE_PROFILER_SNAPSHOT * snapshot,
+		CYCLE_PROFILER_SNAPSHOT * copy);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_CYCLE_PROFILER_H
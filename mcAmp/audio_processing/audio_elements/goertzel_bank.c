@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element measures the level of a set of frequencies on a channel.
+ *
+ * Each bin runs the Goertzel recurrence, which is one multiply and two adds
+ * per sample, over a fixed window of samples.  At the end of each window the
+ * sine amplitude of every bin is latched and the recurrence starts over, so
+ * a bank of 20 bins on two channels at 48kHz costs about 2M multiply-adds a
+ * second (well under 1% of a SHARC core).  That is cheap enough to leave
+ * running all the time.
+ *
+ * Frequencies that fall exactly on a bin of the window (k * sample rate /
+ * window samples) don't leak into each other, so a bank can pick out several
+ * tones played at once (see channel_test.c).  They also complete a whole
+ * number of cycles in each window, so the phasors of successive windows share
+ * the same phase reference and can be added together to measure over a
+ * longer time.
+ *
+ * Windows don't have to line up with audio blocks - a window that ends part
+ * way through a block is latched there and the rest of the block starts the
+ * next window.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "goertzel_bank.h"
+
+/**
+ * @brief Initializes instance of a Goertzel detector bank
+ *
+ * @param c Pointer to instance structure
+ * @param frequencies Frequency (Hz) measured by each bin
+ * @param bins The number of frequencies
+ * @param window_samples The number of samples in each measurement
+ * @param audio_sample_rate The audio sample rate
+ *
+ * @return Goertzel bank result (enumeration)
+ */
+RESULT_GOERTZEL_BANK goertzel_bank_setup(GOERTZEL_BANK * c,
+		const float * frequencies, uint32_t bins, uint32_t window_samples,
+		float audio_sample_rate) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return GOERTZEL_BANK_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (frequencies == NULL || bins == 0 || bins > GOERTZEL_BANK_MAX_BINS) {
+		return GOERTZEL_BANK_INVALID_BINS;
+	}
+
+	if (window_samples < 2) {
+		return GOERTZEL_BANK_INVALID_WINDOW;
+	}
+
+	for (int i = 0; i < bins; i++) {
+		if (frequencies[i] <= 0.0 || frequencies[i] >= audio_sample_rate * 0.5) {
+			return GOERTZEL_BANK_INVALID_FREQUENCY;
+		}
+		c->coeff[i] = 2.0 * cosf(PI2 * frequencies[i] / audio_sample_rate);
+		c->sin_w[i] = sinf(PI2 * frequencies[i] / audio_sample_rate);
+	}
+
+	c->bins = bins;
+	c->window_samples = window_samples;
+
+	goertzel_bank_reset(c);
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return GOERTZEL_BANK_OK;
+}
+
+/**
+ * @brief Latches the amplitude of each bin and starts a new window
+ *
+ * @param c Pointer to instance structure
+ */
+#pragma optimize_for_speed
+static void goertzel_bank_end_window(GOERTZEL_BANK * c) {
+
+	float scale = 2.0 / c->window_samples;
+
+	// The phasor is s1 - s2 * e^-jw (the DFT bin, up to a fixed phase)
+	for (int i = 0; i < c->bins; i++) {
+		float s1 = c->s1[i];
+		float s2 = c->s2[i];
+		float re = (s1 - 0.5 * c->coeff[i] * s2) * scale;
+		float im = c->sin_w[i] * s2 * scale;
+		c->re[i] = re;
+		c->im[i] = im;
+		c->amplitude[i] = sqrtf(re * re + im * im);
+		c->s1[i] = 0.0;
+		c->s2[i] = 0.0;
+	}
+
+	c->samples = 0;
+	c->windows++;
+}
+
+/**
+ * @brief Runs the detector bank over a block of audio
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer
+ * @param audio_block_size The number of floating-point words to process
+ * @return true if a window was completed in this block
+ */
+#pragma optimize_for_speed
+bool goertzel_bank_read(GOERTZEL_BANK * c, float * audio_in,
+		uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, never report a window
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	bool window_done = false;
+
+	while (audio_block_size > 0) {
+
+		// Samples up to the end of the block or the window, whichever is first
+		uint32_t run = c->window_samples - c->samples;
+		if (run > audio_block_size) {
+			run = audio_block_size;
+		}
+
+		for (int i = 0; i < c->bins; i++) {
+			float coeff = c->coeff[i];
+			float s1 = c->s1[i];
+			float s2 = c->s2[i];
+			for (int j = 0; j < run; j++) {
+				float s0 = audio_in[j] + coeff * s1 - s2;
+				s2 = s1;
+				s1 = s0;
+			}
+			c->s1[i] = s1;
+			c->s2[i] = s2;
+		}
+
+		c->samples += run;
+		if (c->samples == c->window_samples) {
+			goertzel_bank_end_window(c);
+			window_done = true;
+		}
+
+		audio_in += run;
+		audio_block_size -= run;
+	}
+
+	return window_done;
+}
+
+/**
+ * @brief Returns the sine amplitude of a bin in the last complete window
+ *
+ * @param c Pointer to instance structure
+ * @param bin Index of the frequency passed to goertzel_bank_setup()
+ * @return Peak amplitude of a sine at the bin frequency (0.0 if unavailable)
+ */
+float goertzel_bank_amplitude(GOERTZEL_BANK * c, uint32_t bin) {
+
+	if (c == NULL || !c->initialized || bin >= c->bins) {
+		return 0.0;
+	}
+	return c->amplitude[bin];
+}
+
+/**
+ * @brief Returns the phasor of a bin in the last complete window
+ *
+ * The magnitude of the phasor is the amplitude of the bin.
+ *
+ * @param c Pointer to instance structure
+ * @param bin Index of the frequency passed to goertzel_bank_setup()
+ * @param re Real part of the phasor
+ * @param im Imaginary part of the phasor
+ */
+void goertzel_bank_phasor(GOERTZEL_BANK * c, uint32_t bin, float * re,
+		float * im) {
+
+	if (c == NULL || !c->initialized || bin >= c->bins) {
+		*re = 0.0;
+		*im = 0.0;
+		return;
+	}
+	*re = c->re[bin];
+	*im = c->im[bin];
+}
+
+/**
+ * @brief Discards the current window so the next one starts with the next sample
+ *
+ * @param c Pointer to instance structure
+ */
+void goertzel_bank_reset(GOERTZEL_BANK * c) {
+
+	if (c == NULL) {
+		return;
+	}
+
+	for (int i = 0; i < GOERTZEL_BANK_MAX_BINS; i++) {
+		c->s1[i] = 0.0;
+		c->s2[i] = 0.0;
+		c->amplitude[i] = 0.0;
+		c->re[i] = 0.0;
+		c->im[i] = 0.0;
+	}
+	c->samples = 0;
+	c->windows = 0;
+}
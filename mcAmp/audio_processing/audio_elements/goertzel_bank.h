@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _GOERTZEL_BANK_H
+#define _GOERTZEL_BANK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Maximum number of frequencies measured by one bank
+#define GOERTZEL_BANK_MAX_BINS     (24)
+
+// Result enumerations
+typedef enum {
+	GOERTZEL_BANK_OK,
+	GOERTZEL_BANK_INVALID_INSTANCE_POINTER,
+	GOERTZEL_BANK_INVALID_BINS,
+	GOERTZEL_BANK_INVALID_WINDOW,
+	GOERTZEL_BANK_INVALID_FREQUENCY
+} RESULT_GOERTZEL_BANK;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	uint32_t bins;
+	uint32_t window_samples;       // samples in each measurement
+	uint32_t samples;              // samples of the current window processed so far
+	uint32_t windows;              // complete windows measured since setup / reset
+
+	float coeff[GOERTZEL_BANK_MAX_BINS];        // 2 * cos(w) for each bin
+	float sin_w[GOERTZEL_BANK_MAX_BINS];        // sin(w) for each bin
+	float s1[GOERTZEL_BANK_MAX_BINS];
+	float s2[GOERTZEL_BANK_MAX_BINS];
+
+	float amplitude[GOERTZEL_BANK_MAX_BINS];    // sine amplitude of each bin in the last window
+	float re[GOERTZEL_BANK_MAX_BINS];           // and its phasor (same scale as the amplitude)
+	float im[GOERTZEL_BANK_MAX_BINS];
+
+} GOERTZEL_BANK;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_GOERTZEL_BANK goertzel_bank_setup(GOERTZEL_BANK * c,
+		const float * frequencies, uint32_t bins, uint32_t window_samples,
+		float audio_sample_rate);
+
+bool goertzel_bank_read(GOERTZEL_BANK * c, float * audio_in,
+		uint32_t audio_block_size);
+
+float goertzel_bank_amplitude(GOERTZEL_BANK * c, uint32_t bin);
+
+void goertzel_bank_phasor(GOERTZEL_BANK * c, uint32_t bin, float * re,
+		float * im);
+
+void goertzel_bank_reset(GOERTZEL_BANK * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_GOERTZEL_BANK_H
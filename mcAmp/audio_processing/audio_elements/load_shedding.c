@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This module implements a simple load shedding controller.  Rather than
+ * losing whole blocks of audio when the audio callback doesn't complete in
+ * time, effects that have cheaper fallbacks (see QUALITY_TIER) are stepped
+ * down to a lower quality tier when the measured cycles for a block approach
+ * the deadline, and stepped back up once there is headroom again.
+ *
+ * Stepping down happens immediately (a single block over the step-down
+ * threshold, or an overrun reported by the framework).  Stepping up requires
+ * hold_blocks consecutive blocks below the step-up threshold.  If the load
+ * climbs back over the step-down threshold shortly after stepping up, the hold
+ * time is doubled (up to a limit) so the controller doesn't oscillate between
+ * two tiers.
+ *
+ * Tiers the chain doesn't implement (see load_shedding_set_tiers()) are
+ * skipped, since stepping into them wouldn't reduce the load.
+ */
+#include <stdlib.h>
+
+#include "load_shedding.h"
+
+// Min/max limits and other constants
+#define     LOAD_SHEDDING_HOLD_BACKOFF_MAX   (16)
+
+/**
+ * @brief Initializes instance of a load shedding controller
+ *
+ * @param c Pointer to instance structure
+ * @param budget_cycles Number of core cycles available per block (deadline)
+ * @param step_down_ratio Fraction of the budget above which we step down (e.g. 0.9)
+ * @param step_up_ratio Fraction of the budget below which we may step up (e.g. 0.6)
+ * @param hold_blocks Blocks the load must stay below step_up_ratio before stepping up
+ * @param lowest_tier Cheapest tier the controller is allowed to select
+ *
+ * @return Load shedding result (enumeration)
+ */
+RESULT_LOAD_SHEDDING load_shedding_setup(LOAD_SHEDDING * c,
+		uint32_t budget_cycles, float step_down_ratio, float step_up_ratio,
+		uint32_t hold_blocks, QUALITY_TIER lowest_tier) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return LOAD_SHEDDING_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (budget_cycles == 0) {
+		return LOAD_SHEDDING_INVALID_BUDGET;
+	}
+
+	// Hysteresis requires the step-up threshold to sit below the step-down threshold
+	if (step_up_ratio <= 0.0 || step_down_ratio > 1.0
+			|| step_up_ratio >= step_down_ratio) {
+		return LOAD_SHEDDING_INVALID_THRESHOLD;
+	}
+
+	if (hold_blocks == 0) {
+		hold_blocks = 1;
+	}
+	if (lowest_tier >= QUALITY_TIERS) {
+		lowest_tier = QUALITY_TIER_BYPASS;
+	}
+
+	c->step_down_cycles = (uint32_t) (budget_cycles * step_down_ratio);
+	c->step_up_cycles = (uint32_t) (budget_cycles * step_up_ratio);
+
+	c->hold_blocks_min = hold_blocks;
+	c->hold_blocks_max = hold_blocks * LOAD_SHEDDING_HOLD_BACKOFF_MAX;
+	c->hold_blocks = hold_blocks;
+	c->blocks_below = 0;
+	c->blocks_since_step_up = 0xFFFFFFFF;
+
+	c->tier = QUALITY_TIER_FULL;
+	c->lowest_tier = lowest_tier;
+	c->tiers = QUALITY_TIER_MASK_ALL;
+	c->overrun_pending = false;
+	c->tier_changes = 0;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return LOAD_SHEDDING_OK;
+}
+
+/**
+ * @brief Sets which tiers the effect chain managed by the controller implements
+ *
+ * Full quality and the lowest tier are always treated as implemented.  If the
+ * current tier isn't implemented, the controller moves up to the next one
+ * that is, since that is what the chain is effectively running at.
+ *
+ * @param c Pointer to instance structure
+ * @param tiers Implemented tiers (QUALITY_TIER_MASK bits)
+ */
+void load_shedding_set_tiers(LOAD_SHEDDING * c, uint32_t tiers) {
+
+	if (c == NULL || !c->initialized) {
+		return;
+	}
+
+	c->tiers = tiers | QUALITY_TIER_MASK(QUALITY_TIER_FULL)
+			| QUALITY_TIER_MASK(c->lowest_tier);
+
+	while (!(c->tiers & QUALITY_TIER_MASK(c->tier))) {
+		c->tier = (QUALITY_TIER) (c->tier - 1);
+		c->tier_changes++;
+	}
+}
+
+/**
+ * @brief Reports an overrun (missed deadline) to the controller
+ *
+ * This is safe to call from the DMA interrupt (e.g. processaudio_mips_overflow()).
+ * The next call to load_shedding_update() will step down a tier.
+ *
+ * @param c Pointer to instance structure
+ */
+void load_shedding_report_overrun(LOAD_SHEDDING * c) {
+
+	if (c != NULL) {
+		c->overrun_pending = true;
+	}
+}
+
+/**
+ * @brief Updates the controller with the cycles measured for the last block
+ *
+ * Call once per block.  The returned tier should be applied to all effects
+ * managed by this controller.
+ *
+ * @param c Pointer to instance structure
+ * @param block_cycles Core cycles measured for the last block
+ * @return Quality tier to use for the next block
+ */
+QUALITY_TIER load_shedding_update(LOAD_SHEDDING * c, uint32_t block_cycles) {
+
+	if (c == NULL || !c->initialized) {
+		return QUALITY_TIER_FULL;
+	}
+
+	bool overrun = c->overrun_pending;
+	c->overrun_pending = false;
+
+	if (c->blocks_since_step_up != 0xFFFFFFFF) {
+		c->blocks_since_step_up++;
+	}
+
+	if (overrun || block_cycles > c->step_down_cycles) {
+
+		c->blocks_below = 0;
+
+		if (c->tier < c->lowest_tier) {
+
+			// If we just stepped up, that tier wasn't sustainable so back off
+			if (c->blocks_since_step_up < c->hold_blocks) {
+				c->hold_blocks *= 2;
+				if (c->hold_blocks > c->hold_blocks_max) {
+					c->hold_blocks = c->hold_blocks_max;
+				}
+			}
+
+			do {
+				c->tier = (QUALITY_TIER) (c->tier + 1);
+			} while (!(c->tiers & QUALITY_TIER_MASK(c->tier)));
+			c->tier_changes++;
+		}
+	} else if (block_cycles < c->step_up_cycles) {
+
+		if (c->blocks_below < c->hold_blocks_max) {
+			c->blocks_below++;
+		}
+
+		if (c->blocks_below >= c->hold_blocks && c->tier > QUALITY_TIER_FULL) {
+			do {
+				c->tier = (QUALITY_TIER) (c->tier - 1);
+			} while (!(c->tiers & QUALITY_TIER_MASK(c->tier)));
+			c->tier_changes++;
+			c->blocks_below = 0;
+			c->blocks_since_step_up = 0;
+		}
+
+		// A long stable run at full quality resets the back-off
+		if (c->tier == QUALITY_TIER_FULL && c->blocks_below >= c->hold_blocks_max) {
+			c->hold_blocks = c->hold_blocks_min;
+		}
+	} else {
+		c->blocks_below = 0;
+	}
+
+	return c->tier;
+}
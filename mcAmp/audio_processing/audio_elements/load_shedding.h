@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _LOAD_SHEDDING_H
+#define _LOAD_SHEDDING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum {
+	LOAD_SHEDDING_OK,
+	LOAD_SHEDDING_INVALID_INSTANCE_POINTER,
+	LOAD_SHEDDING_INVALID_BUDGET,
+	LOAD_SHEDDING_INVALID_THRESHOLD
+} RESULT_LOAD_SHEDDING;
+
+// Bit for a tier in a mask of the tiers an effect chain implements
+#define QUALITY_TIER_MASK(tier)     (1U << (tier))
+#define QUALITY_TIER_MASK_ALL       (QUALITY_TIER_MASK(QUALITY_TIERS) - 1)
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	QUALITY_TIER tier;             // current quality tier
+	QUALITY_TIER lowest_tier;      // cheapest tier the controller may select
+	uint32_t tiers;                // tiers the chain implements (QUALITY_TIER_MASK bits)
+
+	uint32_t step_down_cycles;     // step down as soon as a block exceeds this
+	uint32_t step_up_cycles;       // step up once blocks stay below this
+
+	uint32_t hold_blocks_min;      // blocks below step_up_cycles before stepping up
+	uint32_t hold_blocks_max;
+	uint32_t hold_blocks;          // current hold time (backs off on oscillation)
+	uint32_t blocks_below;         // consecutive blocks below step_up_cycles
+	uint32_t blocks_since_step_up;
+
+	volatile bool overrun_pending; // set from the DMA interrupt on an overrun
+
+	uint32_t tier_changes;         // total number of tier changes (diagnostics)
+
+} LOAD_SHEDDING;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_LOAD_SHEDDING load_shedding_setup(LOAD_SHEDDING * c,
+		uint32_t budget_cycles, float step_down_ratio, float step_up_ratio,
+		uint32_t hold_blocks, QUALITY_TIER lowest_tier);
+
+void load_shedding_set_tiers(LOAD_SHEDDING * c, uint32_t tiers);
+
+QUALITY_TIER load_shedding_update(LOAD_SHEDDING * c, uint32_t block_cycles);
+
+void load_shedding_report_overrun(LOAD_SHEDDING * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_LOAD_SHEDDING_H
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A simple placement-aware allocator for audio element state.
+ *
+ * Rather than choosing a linker section by hand for every buffer (e.g. adding
+ * #pragma section("seg_sdram") in front of each delay line), objects request
+ * memory with a hint describing how often they are accessed.  Hot objects
+ * are placed in L1, warm objects in L2 and cold objects in SDRAM.  If the
+ * preferred tier is full, the allocation falls back to the next tier in the
+ * order below rather than failing, and the fallback is recorded so it shows
+ * up in the boot report.
+ *
+ *    HOT  : L1 -> L2 -> SDRAM
+ *    WARM : L2 -> SDRAM
+ *    COLD : SDRAM -> L2
+ *
+ * Warm and cold objects never fall back into L1 so a large buffer can't use
+ * up the L1 needed by hot objects allocated later.
+ *
+ * Each tier is a pool in its own linker section.  Memory is only allocated,
+ * never freed, so allocations should be made once at start-up (e.g. from the
+ * effect setup routines) and not from the audio callback.  The pools are
+ * NO_INIT so objects must clear their own buffers (the delay / allpass setup
+ * routines already do this).
+ */
+#include <stdlib.h>
+
+#include "memory_placement.h"
+
+// Allocations are rounded up so every object starts on a 16-byte boundary
+#define MEM_POOL_ALIGN_WORDS    (4)
+
+#pragma alignment_region(16)
+#pragma section("seg_l1_block1_noinit_data", NO_INIT)
+static uint32_t mem_pool_l1[MEM_POOL_L1_WORDS];
+#pragma alignment_region_end
+
+#pragma alignment_region(16)
+#pragma section("seg_l2_noinit_data", NO_INIT)
+static uint32_t mem_pool_l2[MEM_POOL_L2_WORDS];
+#pragma alignment_region_end
+
+#pragma alignment_region(16)
+#pragma section("seg_sdram_noinit_data", NO_INIT)
+static uint32_t mem_pool_sdram[MEM_POOL_SDRAM_WORDS];
+#pragma alignment_region_end
+
+// Pool for each tier
+static uint32_t * const mem_pool_memory[MEM_TIERS] = { mem_pool_l1,
+		mem_pool_l2, mem_pool_sdram };
+static const uint32_t mem_pool_size[MEM_TIERS] = { MEM_POOL_L1_WORDS,
+		MEM_POOL_L2_WORDS, MEM_POOL_SDRAM_WORDS };
+static const char * const mem_pool_name[MEM_TIERS] = { "L1", "L2", "SDRAM" };
+
+// Order in which tiers are tried for each hint (MEM_TIERS ends the list)
+static const MEM_TIER mem_fallback_order[3][MEM_TIERS] = {
+		{ MEM_TIER_L1, MEM_TIER_L2, MEM_TIER_SDRAM },     // HOT
+		{ MEM_TIER_L2, MEM_TIER_SDRAM, MEM_TIERS },       // WARM
+		{ MEM_TIER_SDRAM, MEM_TIER_L2, MEM_TIERS }        // COLD
+};
+
+static uint32_t mem_pool_used[MEM_TIERS] = { 0, 0, 0 };
+static uint32_t mem_pool_objects[MEM_TIERS] = { 0, 0, 0 };
+
+static uint32_t mem_fallbacks = 0;
+static uint32_t mem_failures = 0;
+
+static MEM_ALLOC_RECORD mem_records[MEM_POOL_MAX_RECORDS];
+static uint32_t mem_records_count = 0;
+
+/**
+ * @brief Allocates memory for an object in the tier that best matches its hint
+ *
+ * @param size Size of the object (as returned by sizeof)
+ * @param hint How often the object is accessed
+ * @param name Name of the object for the boot report (may be NULL)
+ * @return Pointer to memory or NULL if no suitable tier has enough space
+ */
+void * mem_alloc(size_t size, MEM_HINT hint, const char * name) {
+
+	if (size == 0 || hint > MEM_HINT_COLD) {
+		return NULL;
+	}
+
+	uint32_t words = (size + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+	words = (words + MEM_POOL_ALIGN_WORDS - 1) & ~(MEM_POOL_ALIGN_WORDS - 1);
+
+	for (int i = 0; i < MEM_TIERS; i++) {
+
+		MEM_TIER tier = mem_fallback_order[hint][i];
+		if (tier == MEM_TIERS) {
+			break;
+		}
+
+		if (words > mem_pool_size[tier] - mem_pool_used[tier]) {
+			continue;
+		}
+
+		void * object = &mem_pool_memory[tier][mem_pool_used[tier]];
+		mem_pool_used[tier] += words;
+		mem_pool_objects[tier]++;
+
+		if (i != 0) {
+			mem_fallbacks++;
+		}
+
+		if (mem_records_count < MEM_POOL_MAX_RECORDS) {
+			mem_records[mem_records_count].name = name;
+			mem_records[mem_records_count].hint = hint;
+			mem_records[mem_records_count].tier = tier;
+			mem_records[mem_records_count].words = words;
+			mem_records[mem_records_count].fallback = (i != 0);
+			mem_records_count++;
+		}
+
+		return object;
+	}
+
+	mem_failures++;
+	return NULL;
+}
+
+/**
+ * @brief Returns the size of the pool for a tier
+ *
+ * @param tier Memory tier
+ * @return Size in 32-bit words
+ */
+uint32_t mem_tier_size_words(MEM_TIER tier) {
+	return (tier < MEM_TIERS) ? mem_pool_size[tier] : 0;
+}
+
+/**
+ * @brief Returns the amount of a tier's pool that has been allocated
+ *
+ * @param tier Memory tier
+ * @return Used space in 32-bit words
+ */
+uint32_t mem_tier_used_words(MEM_TIER tier) {
+	return (tier < MEM_TIERS) ? mem_pool_used[tier] : 0;
+}
+
+/**
+ * @brief Returns the number of objects placed in a tier
+ *
+ * @param tier Memory tier
+ * @return Number of objects
+ */
+uint32_t mem_tier_objects(MEM_TIER tier) {
+	return (tier < MEM_TIERS) ? mem_pool_objects[tier] : 0;
+}
+
+/**
+ * @brief Returns a printable name for a tier
+ *
+ * @param tier Memory tier
+ * @return Name of the tier
+ */
+const char * mem_tier_name(MEM_TIER tier) {
+	return (tier < MEM_TIERS) ? mem_pool_name[tier] : "?";
+}
+
+/**
+ * @brief Returns the number of objects not placed in the tier they asked for
+ *
+ * @return Number of fallbacks since boot
+ */
+uint32_t mem_alloc_fallbacks(void) {
+	return mem_fallbacks;
+}
+
+/**
+ * @brief Returns the number of allocations that failed because all tiers were full
+ *
+ * @return Number of failed allocations since boot
+ */
+uint32_t mem_alloc_failures(void) {
+	return mem_failures;
+}
+
+/**
+ * @brief Returns the number of allocation records available
+ *
+ * @return Number of records
+ */
+uint32_t mem_alloc_records(void) {
+	return mem_records_count;
+}
+
+/**
+ * @brief Gets an allocation record
+ *
+ * @param index Index of the record (0 -> mem_alloc_records()-1)
+ * @param record Pointer to record to fill in
+ * @return true if the record exists
+ */
+bool mem_alloc_record(uint32_t index, MEM_ALLOC_RECORD * record) {
+
+	if (record == NULL || index >= mem_records_count) {
+		return false;
+	}
+
+	*record = mem_records[index];
+	return true;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _MEMORY_PLACEMENT_H
+#define _MEMORY_PLACEMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "audio_elements_common.h"
+
+/*
+ * Size of the pool in each memory tier (32-bit words).  Each SHARC core gets
+ * its own set of pools.  Increase these if the boot report shows objects
+ * falling back to a slower tier than requested.
+ */
+#define MEM_POOL_L1_WORDS       (8 * 1024)      // 32 KB of L1 block 1
+#define MEM_POOL_L2_WORDS       (8 * 1024)      // 32 KB of the core's cached L2
+#define MEM_POOL_SDRAM_WORDS    (512 * 1024)    // 2 MB of the core's DDR
+
+// Number of allocations that are recorded for the boot report
+#define MEM_POOL_MAX_RECORDS    (32)
+
+// Memory tiers, fastest first
+typedef enum {
+	MEM_TIER_L1 = 0,
+	MEM_TIER_L2,
+	MEM_TIER_SDRAM,
+	MEM_TIERS
+} MEM_TIER;
+
+// How often an object is accessed, which determines the tier it is placed in
+typedef enum {
+	MEM_HINT_HOT = 0,   // accessed every sample (coefficients, short delay lines)
+	MEM_HINT_WARM,      // accessed every block
+	MEM_HINT_COLD       // large and / or sparsely accessed (long delay lines)
+} MEM_HINT;
+
+// Record of an allocation, used for the boot report
+typedef struct {
+	const char * name;
+	MEM_HINT hint;
+	MEM_TIER tier;
+	uint32_t words;
+	bool fallback;      // not placed in the tier the hint asked for
+} MEM_ALLOC_RECORD;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+void * mem_alloc(size_t size, MEM_HINT hint, const char * name);
+
+uint32_t mem_tier_size_words(MEM_TIER tier);
+uint32_t mem_tier_used_words(MEM_TIER tier);
+uint32_t mem_tier_objects(MEM_TIER tier);
+const char * mem_tier_name(MEM_TIER tier);
+
+uint32_t mem_alloc_fallbacks(void);
+uint32_t mem_alloc_failures(void);
+
+uint32_t mem_alloc_records(void);
+bool mem_alloc_record(uint32_t index, MEM_ALLOC_RECORD * record);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_MEMORY_PLACEMENT_H
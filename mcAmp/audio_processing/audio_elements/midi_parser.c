@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This element parses a MIDI 1.0 byte stream into timestamped events.
+ *
+ * midi_parser_byte() is meant to be called from the UART receive interrupt
+ * for each byte received.  It handles running status, system real-time
+ * bytes in the middle of other messages, SysEx and system common messages.
+ * Note on with a velocity of zero is reported as note off.  Controllers 0 -
+ * 31 and 32 - 63 are treated as MSB / LSB pairs: every controller event has
+ * a 7-bit value (data2) and a 14-bit value (value), and when an LSB follows
+ * the MSB of the same controller, the event is reported against the MSB's
+ * controller number with the combined 14-bit value.  Code that only cares
+ * about 7-bit controllers can ignore value.  Active sensing is dropped.
+ *
+ * Complete messages are pushed into a single-producer, single-consumer queue
+ * inside the parser.  The producer only writes head and the consumer only
+ * writes tail, so no locking is needed as long as the parser is fed from
+ * one interrupt and read from one (lower priority) context.  A data byte
+ * that continues a message costs a compare, a store and an increment; the
+ * rest of the work is only done once per message.
+ *
+ * Each event is stamped with the sample position passed in with its last
+ * byte, normally the number of samples the audio DMA has received (see
+ * audioframework_sample_position()).  The audio callback processes the
+ * block that finished arriving when it was called, so it takes every event
+ * that arrived before the end of that block with midi_parser_next_event()
+ * and applies it at midi_event_offset() samples into the block.  Every
+ * event is therefore delayed by exactly one block, rather than by anything
+ * from zero to one block depending on when it arrived.
+ *
+ * SysEx data is kept in the parser (see midi_parser_sysex()).  Two buffers
+ * are used alternately, so a message stays readable until two more SysEx
+ * messages have arrived - around 40ms at MIDI rates for short messages,
+ * which is far longer than an audio block.
+ */
+#include <stdlib.h>
+
+#include "midi_parser.h"
+
+#define MIDI_PARSER_QUEUE_MASK      (MIDI_PARSER_QUEUE_SIZE - 1)
+#define MIDI_PARSER_NO_CONTROLLER   (0xFF)
+
+// Number of data bytes that follow each channel message status (by high nibble)
+static const uint8_t midi_parser_channel_lengths[8] = { 2, 2, 2, 2, 1, 1, 2, 0 };
+
+/**
+ * @brief Adds an event to the queue (dropped if the queue is full)
+ */
+static void midi_parser_push(MIDI_PARSER * p, const MIDI_EVENT * event) {
+
+	uint32_t head = p->head;
+
+	if (head - p->tail >= MIDI_PARSER_QUEUE_SIZE) {
+		p->dropped++;
+		return;
+	}
+
+	// The event is complete before head moves past it
+	p->events[head & MIDI_PARSER_QUEUE_MASK] = *event;
+	p->head = head + 1;
+}
+
+/**
+ * @brief Works out the 14-bit value of a controller event
+ */
+static void midi_parser_control_change(MIDI_PARSER * p, MIDI_EVENT * event) {
+
+	uint8_t channel = event->channel;
+	uint8_t controller = event->data1;
+
+	if (controller < 32) {
+
+		// MSB - remember it for the LSB that may follow
+		p->cc_msb_controller[channel] = controller;
+		p->cc_msb_value[channel] = event->data2;
+		event->value = (uint16_t) event->data2 << 7;
+	}
+	else if (controller < 64
+			&& p->cc_msb_controller[channel] == controller - 32) {
+
+		// LSB of the last MSB - report the pair against the MSB's controller
+		event->data1 = controller - 32;
+		event->value = ((uint16_t) p->cc_msb_value[channel] << 7)
+				| event->data2;
+		event->data2 = p->cc_msb_value[channel];
+	}
+	else {
+		event->value = (uint16_t) event->data2 << 7;
+	}
+}
+
+/**
+ * @brief Turns the message that has just been completed into an event
+ */
+static void midi_parser_message(MIDI_PARSER * p, uint32_t time) {
+
+	MIDI_EVENT event;
+
+	event.time = time;
+	event.status = p->status;
+	event.channel = p->status & 0x0F;
+	event.data1 = (p->expected > 0) ? p->data[0] : 0;
+	event.data2 = (p->expected > 1) ? p->data[1] : 0;
+	event.value = ((uint16_t) event.data2 << 7) | event.data1;
+
+	switch (p->status & 0xF0) {
+	case 0x80:
+		event.type = MIDI_EVENT_NOTE_OFF;
+		break;
+	case 0x90:
+		event.type = event.data2 ? MIDI_EVENT_NOTE_ON : MIDI_EVENT_NOTE_OFF;
+		break;
+	case 0xA0:
+		event.type = MIDI_EVENT_POLY_PRESSURE;
+		break;
+	case 0xB0:
+		event.type = MIDI_EVENT_CONTROL_CHANGE;
+		midi_parser_control_change(p, &event);
+		break;
+	case 0xC0:
+		event.type = MIDI_EVENT_PROGRAM_CHANGE;
+		break;
+	case 0xD0:
+		event.type = MIDI_EVENT_CHANNEL_PRESSURE;
+		break;
+	case 0xE0:
+		event.type = MIDI_EVENT_PITCH_BEND;
+		break;
+	default:
+
+		// System common messages don't set running status
+		event.type = MIDI_EVENT_SYSTEM_COMMON;
+		event.channel = 0;
+		p->status = 0;
+		p->expected = 0;
+		break;
+	}
+
+	midi_parser_push(p, &event);
+}
+
+/**
+ * @brief Reports the SysEx message that has just ended
+ */
+static void midi_parser_sysex_end(MIDI_PARSER * p, uint32_t time) {
+
+	MIDI_EVENT event;
+
+	event.time = time;
+	event.type = MIDI_EVENT_SYSEX;
+	event.status = 0xF0;
+	event.channel = 0;
+	event.data1 = p->sysex_buffer;
+	event.data2 = p->sysex_length > MIDI_PARSER_SYSEX_SIZE;
+	event.value = (p->sysex_length > MIDI_PARSER_SYSEX_SIZE) ?
+	MIDI_PARSER_SYSEX_SIZE : p->sysex_length;
+
+	p->in_sysex = false;
+	midi_parser_push(p, &event);
+}
+
+/**
+ * @brief Handles a status byte (anything other than system real-time)
+ */
+static void midi_parser_status(MIDI_PARSER * p, uint8_t byte, uint32_t time) {
+
+	// Any status byte ends a SysEx message, although it should end with 0xF7
+	if (p->in_sysex) {
+		midi_parser_sysex_end(p, time);
+	}
+
+	// A new status also throws away any incomplete message
+	p->count = 0;
+
+	if (byte < 0xF0) {
+		p->status = byte;
+		p->expected = midi_parser_channel_lengths[(byte >> 4) & 0x07];
+		return;
+	}
+
+	// System common messages cancel running status
+	p->status = 0;
+	p->expected = 0;
+
+	switch (byte) {
+	case 0xF0:
+		p->in_sysex = true;
+		p->sysex_buffer ^= 1;
+		p->sysex_length = 0;
+		break;
+	case 0xF1:     // MIDI time code quarter frame
+	case 0xF3:     // song select
+		p->status = byte;
+		p->expected = 1;
+		break;
+	case 0xF2:     // song position pointer
+		p->status = byte;
+		p->expected = 2;
+		break;
+	case 0xF6:     // tune request
+		p->status = byte;
+		midi_parser_message(p, time);
+		break;
+	default:       // 0xF7 (handled above), or undefined
+		break;
+	}
+}
+
+/**
+ * @brief Initializes a MIDI parser and empties its queue
+ *
+ * @param p Pointer to instance structure
+ */
+void midi_parser_setup(MIDI_PARSER * p) {
+
+	p->status = 0;
+	p->expected = 0;
+	p->count = 0;
+	p->in_sysex = false;
+
+	for (int i = 0; i < 16; i++) {
+		p->cc_msb_controller[i] = MIDI_PARSER_NO_CONTROLLER;
+		p->cc_msb_value[i] = 0;
+	}
+
+	p->sysex_buffer = 0;
+	p->sysex_length = 0;
+
+	p->head = 0;
+	p->tail = 0;
+	p->dropped = 0;
+}
+
+/**
+ * @brief Parses one received byte
+ *
+ * Call this for each byte as it arrives, from a single interrupt.
+ *
+ * @param p Pointer to instance structure
+ * @param byte Received byte
+ * @param time Sample position at which the byte arrived
+ */
+#pragma optimize_for_speed
+void midi_parser_byte(MIDI_PARSER * p, uint8_t byte, uint32_t time) {
+
+	// Data byte continuing the current message (the common case)
+	if (byte < 0x80) {
+
+		if (p->in_sysex) {
+			if (p->sysex_length < MIDI_PARSER_SYSEX_SIZE) {
+				p->sysex[p->sysex_buffer][p->sysex_length] = byte;
+			}
+			p->sysex_length++;
+			return;
+		}
+
+		// Data without a status byte (e.g. we started mid-message) is ignored
+		if (p->expected == 0) {
+			return;
+		}
+
+		p->data[p->count++] = byte;
+		if (p->count == p->expected) {
+			p->count = 0;
+			midi_parser_message(p, time);
+		}
+		return;
+	}
+
+	// System real-time bytes can appear anywhere and don't affect the message being parsed
+	if (byte >= 0xF8) {
+
+		// Active sensing (every 300ms) isn't worth queuing
+		if (byte == 0xFE) {
+			return;
+		}
+
+		MIDI_EVENT event;
+		event.time = time;
+		event.type = MIDI_EVENT_REALTIME;
+		event.status = byte;
+		event.channel = 0;
+		event.data1 = 0;
+		event.data2 = 0;
+		event.value = 0;
+		midi_parser_push(p, &event);
+
+		// System reset returns the parser to its power-on state too
+		if (byte == 0xFF) {
+			p->status = 0;
+			p->expected = 0;
+			p->count = 0;
+			p->in_sysex = false;
+		}
+		return;
+	}
+
+	midi_parser_status(p, byte, time);
+}
+
+/**
+ * @brief Takes the next event that arrived before the end of a block
+ *
+ * Call this from the audio callback until it returns false.  Events that
+ * arrived after the block ended are left in the queue for the next block.
+ *
+ * @param p Pointer to instance structure
+ * @param block_end Sample position at the end of the block being processed
+ * @param event Filled in with the event
+ * @return true if an event was taken from the queue
+ */
+bool midi_parser_next_event(MIDI_PARSER * p, uint32_t block_end,
+		MIDI_EVENT * event) {
+
+	uint32_t tail = p->tail;
+
+	if (tail == p->head) {
+		return false;
+	}
+
+	const volatile MIDI_EVENT * next = &p->events[tail & MIDI_PARSER_QUEUE_MASK];
+	if ((int32_t) (next->time - block_end) >= 0) {
+		return false;
+	}
+
+	*event = *next;
+	p->tail = tail + 1;
+
+	return true;
+}
+
+/**
+ * @brief Returns the sample within a block at which an event should be applied
+ *
+ * @param event Event from midi_parser_next_event()
+ * @param block_start Sample position at the start of the block being processed
+ * @param audio_block_size The number of samples in each block
+ * @return Offset from 0 to audio_block_size - 1 (events that are late by more than a block are applied at 0)
+ */
+uint32_t midi_event_offset(const MIDI_EVENT * event, uint32_t block_start,
+		uint32_t audio_block_size) {
+
+	int32_t offset = (int32_t) (event->time - block_start);
+
+	if (offset < 0) {
+		return 0;
+	}
+	if ((uint32_t) offset >= audio_block_size) {
+		return audio_block_size - 1;
+	}
+	return offset;
+}
+
+/**
+ * @brief Returns the data of a SysEx event
+ *
+ * The data doesn't include the 0xF0 and 0xF7 bytes, and is only valid until
+ * two more SysEx messages have arrived.
+ *
+ * @param p Pointer to instance structure
+ * @param event MIDI_EVENT_SYSEX event
+ * @return Pointer to event->value bytes of data (NULL if the event isn't SysEx)
+ */
+const uint8_t * midi_parser_sysex(const MIDI_PARSER * p,
+		const MIDI_EVENT * event) {
+
+	if (event->type != MIDI_EVENT_SYSEX) {
+		return NULL;
+	}
+	return p->sysex[event->data1 & 1];
+}
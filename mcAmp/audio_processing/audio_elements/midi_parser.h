@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _MIDI_PARSER_H
+#define _MIDI_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Events held between the UART interrupt and the audio callback (a power of two)
+#define MIDI_PARSER_QUEUE_SIZE          (64)
+
+// Longest SysEx message kept (longer messages are truncated)
+#define MIDI_PARSER_SYSEX_SIZE          (64)
+
+typedef enum {
+	MIDI_EVENT_NOTE_OFF,           // data1 = note, data2 = velocity
+	MIDI_EVENT_NOTE_ON,            // data1 = note, data2 = velocity (never 0)
+	MIDI_EVENT_POLY_PRESSURE,      // data1 = note, data2 = pressure
+	MIDI_EVENT_CONTROL_CHANGE,     // data1 = controller, data2 = 7-bit value, value = 14-bit value
+	MIDI_EVENT_PROGRAM_CHANGE,     // data1 = program
+	MIDI_EVENT_CHANNEL_PRESSURE,   // data1 = pressure
+	MIDI_EVENT_PITCH_BEND,         // value = 14-bit bend (8192 = centre)
+	MIDI_EVENT_SYSEX,              // value = length, data2 = true if truncated (see midi_parser_sysex())
+	MIDI_EVENT_SYSTEM_COMMON,      // status = 0xF1 - 0xF6, data1 / data2 / value as for the other types
+	MIDI_EVENT_REALTIME            // status = 0xF8 - 0xFF (except active sensing)
+} MIDI_EVENT_TYPE;
+
+typedef struct {
+	uint32_t time;                 // sample position when the last byte arrived
+	uint8_t type;                  // MIDI_EVENT_TYPE
+	uint8_t status;                // status byte, including the channel
+	uint8_t channel;               // 0 - 15 (0 for system messages)
+	uint8_t data1;
+	uint8_t data2;
+	uint16_t value;
+} MIDI_EVENT;
+
+// Instance struct with parser state and the event queue
+typedef struct {
+
+	// Message being assembled
+	uint8_t status;                // running status (0 if none)
+	uint8_t expected;              // data bytes in the current message
+	uint8_t count;                 // data bytes received so far
+	uint8_t data[2];
+	bool in_sysex;
+
+	// Most recent MSB (controllers 0 - 31) on each channel, for 14-bit controller pairs
+	uint8_t cc_msb_controller[16]; // 0xFF if none
+	uint8_t cc_msb_value[16];
+
+	// SysEx data alternates between two buffers so the last message stays readable
+	uint8_t sysex[2][MIDI_PARSER_SYSEX_SIZE];
+	uint32_t sysex_buffer;
+	uint32_t sysex_length;
+
+	// Single producer (UART interrupt), single consumer (audio callback)
+	volatile uint32_t head;        // written by the producer only
+	volatile uint32_t tail;        // written by the consumer only
+	uint32_t dropped;              // events lost because the queue was full
+	volatile MIDI_EVENT events[MIDI_PARSER_QUEUE_SIZE];
+
+} MIDI_PARSER;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+void midi_parser_setup(MIDI_PARSER * p);
+
+void midi_parser_byte(MIDI_PARSER * p, uint8_t byte, uint32_t time);
+
+bool midi_parser_next_event(MIDI_PARSER * p, uint32_t block_end,
+		MIDI_EVENT * event);
+
+uint32_t midi_event_offset(const MIDI_EVENT * event, uint32_t block_start,
+		uint32_t audio_block_size);
+
+const uint8_t * midi_parser_sysex(const MIDI_PARSER * p,
+		const MIDI_EVENT * event);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_MIDI_PARSER_H
@@ -0,0 +1,558 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element is a modulation matrix: a set of modulation sources, a
+ * set of destinations (parameters of other audio elements) and a sparse list
+ * of routes, each of which adds a source times a depth to a destination.
+ *
+ * Sources are LFOs, envelope followers (which track the peak amplitude of an
+ * audio signal, as measure_amp_peak() does) and controls, whose value the
+ * caller sets from a pot, a MIDI CC or anything else.  A destination has a
+ * base value and a range; its value is the base plus the sum of its routes,
+ * clipped to the range.
+ *
+ * The matrix runs at control rate.  mod_matrix_update() is called once per
+ * block, or once per span when a block is split (see block_splitter.c),
+ * before the elements it modulates are run.  It steps the LFOs on by the
+ * span, evaluates every route once and then, for each destination:
+ *
+ *  - if it has a modify function (typically a wrapper around one of the
+ *    xxx_modify_yyy() functions of an element), calls it when the value has
+ *    changed since the last update, and
+ *  - if it has a ramp buffer, fills it with the value linearly interpolated
+ *    over the span, ending at the new value.  Elements that take a per-sample
+ *    modulation signal (e.g. variable_delay_read()) read the ramp instead of
+ *    computing their own.  The buffer is only rewritten while the value is
+ *    moving.
+ *
+ * So a route costs a multiply-add per span rather than per sample, and an
+ * LFO costs one waveform evaluation per span.  With spans of 8 or more
+ * samples and LFOs well below 20Hz, the interpolated ramp is
+ * indistinguishable from an LFO computed at the sample rate.
+ *
+ * Sources and destinations are numbered in the order they are added, and the
+ * numbers are returned when they're added so the caller can keep them in an
+ * enumeration.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "modulation_matrix.h"
+#include "audio_utilities.h"
+#include "oscillators.h"
+
+/**
+ * @brief Initializes instance of a modulation matrix
+ *
+ * @param m Pointer to instance structure
+ * @param max_span Longest span passed to mod_matrix_update() (length of the ramp buffers)
+ * @param audio_sample_rate The system audio sample rate
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_setup(MOD_MATRIX * m, uint32_t max_span,
+		float audio_sample_rate) {
+
+	// Ensure we don't have a null pointer
+	if (m == NULL) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	m->initialized = false;
+
+	if (max_span == 0) {
+		return MOD_MATRIX_INVALID_SPAN;
+	}
+
+	m->audio_sample_rate = audio_sample_rate;
+	m->max_span = max_span;
+
+	m->source_count = 0;
+	m->destination_count = 0;
+	m->route_count = 0;
+
+	// Instance was successfully initialized
+	m->initialized = true;
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds a source (shared by all kinds)
+ */
+static RESULT_MOD_MATRIX mod_matrix_add_source(MOD_MATRIX * m,
+		MOD_SOURCE_TYPE type, uint32_t * source) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (m->source_count >= MOD_MATRIX_MAX_SOURCES) {
+		return MOD_MATRIX_FULL;
+	}
+
+	MOD_MATRIX_SOURCE * s = &m->sources[m->source_count];
+
+	s->type = type;
+	s->value = 0.0;
+	s->shape = MOD_LFO_SINE;
+	s->phase = 0.0;
+	s->inc = 0.0;
+	s->decay = 0.0;
+
+	if (source != NULL) {
+		*source = m->source_count;
+	}
+	m->source_count++;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds an LFO source (-1.0 -> 1.0)
+ *
+ * @param m Pointer to instance structure
+ * @param shape Waveform
+ * @param rate_hz LFO frequency (Hz)
+ * @param phase Starting phase (0.0 -> 1.0, where 1.0 is a whole cycle)
+ * @param source Set to the number of the new source (may be NULL)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_add_lfo(MOD_MATRIX * m, MOD_LFO_SHAPE shape,
+		float rate_hz, float phase, uint32_t * source) {
+
+	uint32_t n;
+	RESULT_MOD_MATRIX res = mod_matrix_add_source(m, MOD_SOURCE_LFO, &n);
+	if (res != MOD_MATRIX_OK) {
+		return res;
+	}
+
+	MOD_MATRIX_SOURCE * s = &m->sources[n];
+	s->shape = shape;
+	s->phase = phase - floorf(phase);
+	mod_matrix_modify_lfo_rate(m, n, rate_hz);
+
+	if (source != NULL) {
+		*source = n;
+	}
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds an envelope follower source (fed with mod_matrix_follow())
+ *
+ * @param m Pointer to instance structure
+ * @param decay Rate of decay per sample (closer to 1.0 decays more slowly)
+ * @param source Set to the number of the new source (may be NULL)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_add_envelope(MOD_MATRIX * m, float decay,
+		uint32_t * source) {
+
+	uint32_t n;
+	RESULT_MOD_MATRIX res = mod_matrix_add_source(m, MOD_SOURCE_ENVELOPE, &n);
+	if (res != MOD_MATRIX_OK) {
+		return res;
+	}
+
+	mod_matrix_modify_envelope_decay(m, n, decay);
+
+	if (source != NULL) {
+		*source = n;
+	}
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds a control source (set with mod_matrix_set_control())
+ *
+ * @param m Pointer to instance structure
+ * @param value Starting value
+ * @param source Set to the number of the new source (may be NULL)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_add_control(MOD_MATRIX * m, float value,
+		uint32_t * source) {
+
+	uint32_t n;
+	RESULT_MOD_MATRIX res = mod_matrix_add_source(m, MOD_SOURCE_CONTROL, &n);
+	if (res != MOD_MATRIX_OK) {
+		return res;
+	}
+
+	m->sources[n].value = value;
+
+	if (source != NULL) {
+		*source = n;
+	}
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds a destination
+ *
+ * A destination should have a modify function, a ramp buffer or both.  The
+ * modify function is called with the first value from the first update.
+ *
+ * @param m Pointer to instance structure
+ * @param base Value with no modulation applied
+ * @param min Lowest value the destination is set to
+ * @param max Highest value the destination is set to
+ * @param modify Called with the new value when it changes (may be NULL)
+ * @param instance Passed to modify
+ * @param ramp Buffer of max_span floats for the per-sample value (may be NULL)
+ * @param destination Set to the number of the new destination (may be NULL)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_add_destination(MOD_MATRIX * m, float base,
+		float min, float max, MOD_MATRIX_MODIFY_FN modify, void * instance,
+		float * ramp, uint32_t * destination) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (m->destination_count >= MOD_MATRIX_MAX_DESTINATIONS) {
+		return MOD_MATRIX_FULL;
+	}
+
+	MOD_MATRIX_DESTINATION * d = &m->destinations[m->destination_count];
+
+	d->base = base;
+	d->min = min;
+	d->max = max;
+	d->modify = modify;
+	d->instance = instance;
+	d->ramp = ramp;
+	d->ramp_constant = 0;
+	d->value = base;
+	d->primed = false;
+
+	if (destination != NULL) {
+		*destination = m->destination_count;
+	}
+	m->destination_count++;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Adds a route from a source to a destination
+ *
+ * @param m Pointer to instance structure
+ * @param source Source number
+ * @param destination Destination number
+ * @param depth Amount of the source added to the destination
+ * @param route Set to the number of the new route (may be NULL)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_add_route(MOD_MATRIX * m, uint32_t source,
+		uint32_t destination, float depth, uint32_t * route) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (source >= m->source_count) {
+		return MOD_MATRIX_INVALID_SOURCE;
+	}
+
+	if (destination >= m->destination_count) {
+		return MOD_MATRIX_INVALID_DESTINATION;
+	}
+
+	if (m->route_count >= MOD_MATRIX_MAX_ROUTES) {
+		return MOD_MATRIX_FULL;
+	}
+
+	MOD_MATRIX_ROUTE * r = &m->routes[m->route_count];
+
+	r->source = source;
+	r->destination = destination;
+	r->depth = depth;
+
+	if (route != NULL) {
+		*route = m->route_count;
+	}
+	m->route_count++;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Modify the frequency of an LFO source
+ *
+ * A negative frequency is clipped to 0.0 (which holds the LFO where it is).
+ *
+ * @param m Pointer to instance structure
+ * @param source LFO source number
+ * @param rate_hz New LFO frequency (Hz)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_modify_lfo_rate(MOD_MATRIX * m, uint32_t source,
+		float rate_hz) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (source >= m->source_count
+			|| m->sources[source].type != MOD_SOURCE_LFO) {
+		return MOD_MATRIX_INVALID_SOURCE;
+	}
+
+	if (rate_hz < 0.0) {
+		rate_hz = 0.0;
+	}
+
+	m->sources[source].inc = rate_hz / m->audio_sample_rate;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Modify the decay of an envelope follower source
+ *
+ * @param m Pointer to instance structure
+ * @param source Envelope source number
+ * @param decay Rate of decay per sample (closer to 1.0 decays more slowly)
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_modify_envelope_decay(MOD_MATRIX * m,
+		uint32_t source, float decay) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (source >= m->source_count
+			|| m->sources[source].type != MOD_SOURCE_ENVELOPE) {
+		return MOD_MATRIX_INVALID_SOURCE;
+	}
+
+	if (decay < 0.0) {
+		decay = 0.0;
+	} else if (decay > 1.0) {
+		decay = 1.0;
+	}
+
+	m->sources[source].decay = decay;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Sets the value of a control source
+ *
+ * The destinations it's routed to pick the new value up at the next update.
+ *
+ * @param m Pointer to instance structure
+ * @param source Control source number
+ * @param value New value
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_set_control(MOD_MATRIX * m, uint32_t source,
+		float value) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (source >= m->source_count
+			|| m->sources[source].type != MOD_SOURCE_CONTROL) {
+		return MOD_MATRIX_INVALID_SOURCE;
+	}
+
+	m->sources[source].value = value;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Modify the base value of a destination
+ *
+ * @param m Pointer to instance structure
+ * @param destination Destination number
+ * @param base New value with no modulation applied
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_modify_base(MOD_MATRIX * m,
+		uint32_t destination, float base) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (destination >= m->destination_count) {
+		return MOD_MATRIX_INVALID_DESTINATION;
+	}
+
+	m->destinations[destination].base = base;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Modify the depth of a route
+ *
+ * @param m Pointer to instance structure
+ * @param route Route number
+ * @param depth New amount of the source added to the destination
+ * @return Modulation matrix result (enumeration)
+ */
+RESULT_MOD_MATRIX mod_matrix_modify_depth(MOD_MATRIX * m, uint32_t route,
+		float depth) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (route >= m->route_count) {
+		return MOD_MATRIX_INVALID_ROUTE;
+	}
+
+	m->routes[route].depth = depth;
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Feeds audio to an envelope follower source
+ *
+ * Call it with each span of the signal being followed before mod_matrix_update().
+ *
+ * @param m Pointer to instance structure
+ * @param source Envelope source number
+ * @param audio_in Pointer to floating point audio input buffer (mono)
+ * @param audio_block_size The number of floating-point words to process
+ */
+#pragma optimize_for_speed
+void mod_matrix_follow(MOD_MATRIX * m, uint32_t source, float * audio_in,
+		uint32_t audio_block_size) {
+
+	if (m == NULL || !m->initialized || source >= m->source_count) {
+		return;
+	}
+
+	MOD_MATRIX_SOURCE * s = &m->sources[source];
+	if (s->type != MOD_SOURCE_ENVELOPE) {
+		return;
+	}
+
+	float amplitude = s->value;
+	float decay = s->decay;
+	for (int i = 0; i < audio_block_size; i++) {
+		measure_amp_peak(audio_in[i], &amplitude, decay);
+	}
+	s->value = amplitude;
+}
+
+/**
+ * @brief Evaluates the matrix for the next span (call once per block or span)
+ *
+ * @param m Pointer to instance structure
+ * @param span Samples in the span about to be processed (up to max_span)
+ * @return Modulation matrix result (enumeration)
+ */
+#pragma optimize_for_speed
+RESULT_MOD_MATRIX mod_matrix_update(MOD_MATRIX * m, uint32_t span) {
+
+	if (m == NULL || !m->initialized) {
+		return MOD_MATRIX_INVALID_INSTANCE_POINTER;
+	}
+
+	if (span == 0 || span > m->max_span) {
+		return MOD_MATRIX_INVALID_SPAN;
+	}
+
+	// Step the LFOs on to the end of the span
+	for (uint32_t i = 0; i < m->source_count; i++) {
+
+		MOD_MATRIX_SOURCE * s = &m->sources[i];
+		if (s->type != MOD_SOURCE_LFO) {
+			continue;
+		}
+
+		float t = s->phase + s->inc * span;
+		t -= floorf(t);
+		s->phase = t;
+
+		switch (s->shape) {
+			case MOD_LFO_TRIANGLE:
+				s->value = oscillator_triangle(t);
+				break;
+			case MOD_LFO_SQUARE:
+				s->value = oscillator_square(t);
+				break;
+			case MOD_LFO_RAMP:
+				s->value = oscillator_ramp(t);
+				break;
+			default:
+				s->value = oscillator_sine(t);
+				break;
+		}
+	}
+
+	// Sum the routes into the destinations
+	float values[MOD_MATRIX_MAX_DESTINATIONS];
+	for (uint32_t i = 0; i < m->destination_count; i++) {
+		values[i] = m->destinations[i].base;
+	}
+	for (uint32_t i = 0; i < m->route_count; i++) {
+		MOD_MATRIX_ROUTE * r = &m->routes[i];
+		values[r->destination] += r->depth * m->sources[r->source].value;
+	}
+
+	// Apply the destinations that have changed
+	for (uint32_t i = 0; i < m->destination_count; i++) {
+
+		MOD_MATRIX_DESTINATION * d = &m->destinations[i];
+
+		float value = values[i];
+		if (value < d->min) {
+			value = d->min;
+		} else if (value > d->max) {
+			value = d->max;
+		}
+
+		float last = d->primed ? d->value : value;
+
+		if (d->ramp != NULL) {
+			if (value != last) {
+				float step = (value - last) / span;
+				for (int j = 0; j < span; j++) {
+					d->ramp[j] = last + step * (j + 1);
+				}
+				d->ramp_constant = 0;
+			} else if (d->ramp_constant < span) {
+				for (int j = 0; j < span; j++) {
+					d->ramp[j] = value;
+				}
+				d->ramp_constant = span;
+			}
+		}
+
+		if (d->modify != NULL && (value != last || !d->primed)) {
+			d->modify(d->instance, value);
+		}
+
+		d->value = value;
+		d->primed = true;
+	}
+
+	return MOD_MATRIX_OK;
+}
+
+/**
+ * @brief Reads the current value of a destination (the end of the last span)
+ *
+ * @param m Pointer to instance structure
+ * @param destination Destination number
+ * @return Destination value
+ */
+float mod_matrix_read(MOD_MATRIX * m, uint32_t destination) {
+
+	if (m == NULL || !m->initialized || destination >= m->destination_count) {
+		return 0.0;
+	}
+
+	return m->destinations[destination].value;
+}
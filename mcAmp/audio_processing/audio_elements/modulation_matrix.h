@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _MODULATION_MATRIX_H
+#define _MODULATION_MATRIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Maximum number of sources, destinations and routes in one instance
+#define MOD_MATRIX_MAX_SOURCES			(8)
+#define MOD_MATRIX_MAX_DESTINATIONS		(16)
+#define MOD_MATRIX_MAX_ROUTES			(32)
+
+// Kinds of modulation source
+typedef enum {
+	MOD_SOURCE_LFO,				// -1.0 to 1.0
+	MOD_SOURCE_ENVELOPE,		// peak amplitude of an audio signal (see mod_matrix_follow())
+	MOD_SOURCE_CONTROL			// set by the caller (pots, MIDI CC), usually 0.0 to 1.0
+} MOD_SOURCE_TYPE;
+
+// LFO waveforms
+typedef enum {
+	MOD_LFO_SINE,
+	MOD_LFO_TRIANGLE,
+	MOD_LFO_SQUARE,
+	MOD_LFO_RAMP
+} MOD_LFO_SHAPE;
+
+// Result enumerations
+typedef enum {
+	MOD_MATRIX_OK,
+	MOD_MATRIX_INVALID_INSTANCE_POINTER,
+	MOD_MATRIX_INVALID_SOURCE,
+	MOD_MATRIX_INVALID_DESTINATION,
+	MOD_MATRIX_INVALID_ROUTE,
+	MOD_MATRIX_INVALID_SPAN,
+	MOD_MATRIX_FULL
+} RESULT_MOD_MATRIX;
+
+// Applies a new value to an element parameter (e.g. wraps a xxx_modify_yyy() function)
+typedef void (*MOD_MATRIX_MODIFY_FN)(void * instance, float value);
+
+typedef struct {
+
+	MOD_SOURCE_TYPE type;
+	float value;
+
+	// LFO
+	MOD_LFO_SHAPE shape;
+	float phase;				// 0.0 -> 1.0
+	float inc;					// phase increment per sample
+
+	// Envelope follower
+	float decay;				// per sample, as for measure_amp_peak()
+
+} MOD_MATRIX_SOURCE;
+
+typedef struct {
+
+	float base;					// value with no modulation applied
+	float min;
+	float max;
+
+	MOD_MATRIX_MODIFY_FN modify;	// called at block rate when the value changes (optional)
+	void * instance;
+
+	float * ramp;				// per-sample values over the last span (optional)
+	uint32_t ramp_constant;		// samples of ramp already holding the value
+
+	float value;
+	bool primed;				// value has been applied at least once
+
+} MOD_MATRIX_DESTINATION;
+
+typedef struct {
+	uint32_t source;
+	uint32_t destination;
+	float depth;
+} MOD_MATRIX_ROUTE;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	float audio_sample_rate;
+	uint32_t max_span;			// longest span passed to mod_matrix_update() (ramp buffer length)
+
+	uint32_t source_count;
+	uint32_t destination_count;
+	uint32_t route_count;
+
+	MOD_MATRIX_SOURCE sources[MOD_MATRIX_MAX_SOURCES];
+	MOD_MATRIX_DESTINATION destinations[MOD_MATRIX_MAX_DESTINATIONS];
+	MOD_MATRIX_ROUTE routes[MOD_MATRIX_MAX_ROUTES];
+
+} MOD_MATRIX;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_MOD_MATRIX mod_matrix_setup(MOD_MATRIX * m, uint32_t max_span,
+		float audio_sample_rate);
+
+RESULT_MOD_MATRIX mod_matrix_add_lfo(MOD_MATRIX * m, MOD_LFO_SHAPE shape,
+		float rate_hz, float phase, uint32_t * source);
+
+RESULT_MOD_MATRIX mod_matrix_add_envelope(MOD_MATRIX * m, float decay,
+		uint32_t * source);
+
+RESULT_MOD_MATRIX mod_matrix_add_control(MOD_MATRIX * m, float value,
+		uint32_t * source);
+
+RESULT_MOD_MATRIX mod_matrix_add_destination(MOD_MATRIX * m, float base,
+		float min, float max, MOD_MATRIX_MODIFY_FN modify, void * instance,
+		float * ramp, uint32_t * destination);
+
+RESULT_MOD_MATRIX mod_matrix_add_route(MOD_MATRIX * m, uint32_t source,
+		uint32_t destination, float depth, uint32_t * route);
+
+RESULT_MOD_MATRIX mod_matrix_modify_lfo_rate(MOD_MATRIX * m, uint32_t source,
+		float rate_hz);
+
+RESULT_MOD_MATRIX mod_matrix_modify_envelope_decay(MOD_MATRIX * m,
+		uint32_t source, float decay);
+
+RESULT_MOD_MATRIX mod_matrix_set_control(MOD_MATRIX * m, uint32_t source,
+		float value);
+
+RESULT_MOD_MATRIX mod_matrix_modify_base(MOD_MATRIX * m,
+		uint32_t destination, float base);
+
+RESULT_MOD_MATRIX mod_matrix_modify_depth(MOD_MATRIX * m, uint32_t route,
+		float depth);
+
+void mod_matrix_follow(MOD_MATRIX * m, uint32_t source, float * audio_in,
+		uint32_t audio_block_size);
+
+RESULT_MOD_MATRIX mod_matrix_update(MOD_MATRIX * m, uint32_t span);
+
+float mod_matrix_read(MOD_MATRIX * m, uint32_t destination);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_MODULATION_MATRIX_H
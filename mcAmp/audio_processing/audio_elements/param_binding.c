@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element propagates controls (pots, MIDI CC, host parameters)
+ * to the parameters of other audio elements only when they change.
+ *
+ * Calling the xxx_modify_yyy() functions of an element from the audio
+ * callback every block costs cycles even when nothing has moved, and some of
+ * them recompute coefficients with transcendental math.  Instead, each
+ * parameter is bound to the float it's set from and quantized to a step
+ * (so noise in the last bits of a pot doesn't count as a change).
+ * param_binding_update() is called once per block (and again after a
+ * control event mid-block); it compares each quantized input with the one
+ * last applied and calls the apply function only for those that differ,
+ * bumping the parameter's version.  If anything was applied, the commit
+ * function (optional) is then called once, so an element whose parameters
+ * all feed one set of coefficients recomputes them once rather than once
+ * per parameter.  In steady state an update is a compare per parameter.
+ *
+ * The apply function does whatever mapping the caller wants from the
+ * control to the parameter (e.g. a pot to a frequency range) and calls the
+ * element's modify functions, so one binding typically covers a preset or
+ * element and its parameters are numbered with an enumeration.
+ *
+ * After the elements have been set up again (so they no longer hold the
+ * values last applied), param_binding_invalidate() makes the next update
+ * apply every parameter.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "param_binding.h"
+
+/**
+ * @brief Initializes instance of a parameter binding
+ *
+ * @param b Pointer to instance structure
+ * @param apply Called with each parameter that has changed
+ * @param commit Called once after an update applied anything (may be NULL)
+ * @param context Passed to apply and commit
+ *
+ * @return Parameter binding result (enumeration)
+ */
+RESULT_PARAM_BINDING param_binding_setup(PARAM_BINDING * b,
+		PARAM_BINDING_APPLY_FN apply, PARAM_BINDING_COMMIT_FN commit,
+		void * context) {
+
+	// Ensure we don't have a null pointer
+	if (b == NULL) {
+		return PARAM_BINDING_INVALID_INSTANCE_POINTER;
+	}
+
+	b->initialized = false;
+
+	if (apply == NULL) {
+		return PARAM_BINDING_INVALID_INSTANCE_POINTER;
+	}
+
+	b->apply = apply;
+	b->commit = commit;
+	b->context = context;
+
+	b->count = 0;
+	b->primed = false;
+	b->version = 0;
+
+	// Instance was successfully initialized
+	b->initialized = true;
+	return PARAM_BINDING_OK;
+}
+
+/**
+ * @brief Binds a parameter to the float it's set from
+ *
+ * The parameter is applied by the next update.
+ *
+ * @param b Pointer to instance structure
+ * @param param ID passed to the apply function
+ * @param input The float the parameter follows
+ * @param step Changes of the input smaller than this are ignored
+ *
+ * @return Parameter binding result (enumeration)
+ */
+RESULT_PARAM_BINDING param_binding_add(PARAM_BINDING * b, uint32_t param,
+		const float * input, float step) {
+
+	if (b == NULL || !b->initialized || input == NULL) {
+		return PARAM_BINDING_INVALID_INSTANCE_POINTER;
+	}
+
+	if (step <= 0.0) {
+		return PARAM_BINDING_INVALID_STEP;
+	}
+
+	if (b->count >= PARAM_BINDING_MAX_PARAMS) {
+		return PARAM_BINDING_FULL;
+	}
+
+	PARAM_BINDING_PARAM * p = &b->params[b->count++];
+
+	p->input = input;
+	p->id = param;
+	p->step = step;
+	p->quantized = 0;
+	p->version = 0;
+
+	b->primed = false;
+
+	return PARAM_BINDING_OK;
+}
+
+/**
+ * @brief Makes the next update apply every parameter
+ *
+ * @param b Pointer to instance structure
+ */
+void param_binding_invalidate(PARAM_BINDING * b) {
+
+	if (b == NULL || !b->initialized) {
+		return;
+	}
+
+	b->primed = false;
+}
+
+/**
+ * @brief Applies the parameters whose inputs have changed (call once per block)
+ *
+ * @param b Pointer to instance structure
+ * @return Number of parameters applied
+ */
+#pragma optimize_for_speed
+uint32_t param_binding_update(PARAM_BINDING * b) {
+
+	if (b == NULL || !b->initialized) {
+		return 0;
+	}
+
+	uint32_t applied = 0;
+
+	for (uint32_t i = 0; i < b->count; i++) {
+
+		PARAM_BINDING_PARAM * p = &b->params[i];
+
+		int32_t quantized = (int32_t) floorf(*p->input / p->step + 0.5);
+		if (quantized == p->quantized && b->primed) {
+			continue;
+		}
+
+		p->quantized = quantized;
+		p->version++;
+		b->apply(b->context, p->id, quantized * p->step);
+		applied++;
+	}
+
+	b->primed = true;
+
+	if (applied) {
+		b->version++;
+		if (b->commit != NULL) {
+			b->commit(b->context);
+		}
+	}
+
+	return applied;
+}
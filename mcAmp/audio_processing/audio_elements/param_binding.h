@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _PARAM_BINDING_H
+#define _PARAM_BINDING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Maximum number of parameters one instance tracks
+#define PARAM_BINDING_MAX_PARAMS		(16)
+
+// Result enumerations
+typedef enum {
+	PARAM_BINDING_OK,
+	PARAM_BINDING_INVALID_INSTANCE_POINTER,
+	PARAM_BINDING_INVALID_STEP,
+	PARAM_BINDING_FULL
+} RESULT_PARAM_BINDING;
+
+// Applies a parameter that has changed (param is the ID it was added with)
+typedef void (*PARAM_BINDING_APPLY_FN)(void * context, uint32_t param,
+		float value);
+
+// Called once after the parameters that changed in an update have been applied
+typedef void (*PARAM_BINDING_COMMIT_FN)(void * context);
+
+typedef struct {
+
+	const float * input;		// owned by the caller (e.g. a control)
+	uint32_t id;
+	float step;					// quantization of the input
+
+	int32_t quantized;			// input / step when it was last applied
+	uint32_t version;			// incremented each time it's applied
+
+} PARAM_BINDING_PARAM;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	PARAM_BINDING_APPLY_FN apply;
+	PARAM_BINDING_COMMIT_FN commit;
+	void * context;
+
+	bool primed;				// every parameter has been applied at least once
+	uint32_t version;			// incremented by each update that applied anything
+
+	uint32_t count;
+	PARAM_BINDING_PARAM params[PARAM_BINDING_MAX_PARAMS];
+
+} PARAM_BINDING;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_PARAM_BINDING param_binding_setup(PARAM_BINDING * b,
+		PARAM_BINDING_APPLY_FN apply, PARAM_BINDING_COMMIT_FN commit,
+		void * context);
+
+RESULT_PARAM_BINDING param_binding_add(PARAM_BINDING * b, uint32_t param,
+		const float * input, float step);
+
+void param_binding_invalidate(PARAM_BINDING * b);
+
+uint32_t param_binding_update(PARAM_BINDING * b);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_PARAM_BINDING_H
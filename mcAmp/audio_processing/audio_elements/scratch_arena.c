@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A per-core scratch arena for temporary buffers used within one audio block.
+ *
+ * Rather than declaring local arrays sized for the largest possible block on
+ * the stack, audio elements take their temporaries from this arena.  The arena
+ * lives in L1 and is sized from AUDIO_BLOCK_SIZE so larger block sizes don't
+ * grow the stack in the real-time path.
+ *
+ * Allocation is a simple bump pointer.  Each element takes a mark on entry
+ * and releases it before returning so nested elements (e.g. a tube distortion
+ * calling a clipper) reuse the same memory, and the arena only needs to be as
+ * large as the deepest nesting.  The arena is also reset at the start of each
+ * block by the audio callback, so a missed release can't leak across blocks.
+ *
+ * The arena must only be used from the audio callback (not the background
+ * loop) as it is not re-entrant.
+ */
+#include <stdlib.h>
+
+#include "common/audio_system_config.h"
+
+#include "scratch_arena.h"
+
+/*
+ * Size of the arena in units of AUDIO_BLOCK_SIZE.  The deepest user is the
+ * multi-FX preset: one block temporary, then tube distortion (one), then the
+ * 8x oversampled clipper (eight).  The rest is headroom for custom effects.
+ */
+#define SCRATCH_ARENA_BLOCKS        (16)
+#define SCRATCH_ARENA_WORDS         (SCRATCH_ARENA_BLOCKS * AUDIO_BLOCK_SIZE)
+
+// Allocations are rounded up so every buffer starts on a 16-byte boundary
+#define SCRATCH_ARENA_ALIGN_WORDS   (4)
+
+#pragma alignment_region(16)
+#pragma section("seg_l1_block2_noinit_data", NO_INIT)
+static float scratch_arena_memory[SCRATCH_ARENA_WORDS];
+#pragma alignment_region_end
+
+static uint32_t scratch_arena_used = 0;
+static uint32_t scratch_arena_peak = 0;
+static uint32_t scratch_arena_failed_allocs = 0;
+
+/**
+ * @brief Resets the arena - call at the start of each audio block
+ */
+void scratch_arena_reset(void) {
+	scratch_arena_used = 0;
+}
+
+/**
+ * @brief Allocates a temporary buffer from the arena
+ *
+ * @param words Number of 32-bit words (floats) needed
+ * @return Pointer to buffer or NULL if the arena is exhausted
+ */
+float * scratch_alloc(uint32_t words) {
+
+	uint32_t size = (words + SCRATCH_ARENA_ALIGN_WORDS - 1)
+			& ~(SCRATCH_ARENA_ALIGN_WORDS - 1);
+
+	if (size > SCRATCH_ARENA_WORDS - scratch_arena_used) {
+		scratch_arena_failed_allocs++;
+		return NULL;
+	}
+
+	float * buffer = &scratch_arena_memory[scratch_arena_used];
+	scratch_arena_used += size;
+
+	// Track the high-water mark so the arena can be sized appropriately
+	if (scratch_arena_used > scratch_arena_peak) {
+		scratch_arena_peak = scratch_arena_used;
+	}
+
+	return buffer;
+}
+
+/**
+ * @brief Returns the current position in the arena
+ *
+ * @return Mark to pass to scratch_release()
+ */
+SCRATCH_MARK scratch_mark(void) {
+	return scratch_arena_used;
+}
+
+/**
+ * @brief Releases everything allocated since a mark was taken
+ *
+ * @param mark Value returned by scratch_mark()
+ */
+void scratch_release(SCRATCH_MARK mark) {
+	if (mark <= scratch_arena_used) {
+		scratch_arena_used = mark;
+	}
+}
+
+/**
+ * @brief Returns the size of the arena
+ *
+ * @return Size in 32-bit words
+ */
+uint32_t scratch_arena_size_words(void) {
+	return SCRATCH_ARENA_WORDS;
+}
+
+/**
+ * @brief Returns the peak usage of the arena since boot
+ *
+ * @return Peak usage in 32-bit words
+ */
+uint32_t scratch_arena_peak_words(void) {
+	return scratch_arena_peak;
+}
+
+/**
+ * @brief Returns the number of allocations that failed because the arena was full
+ *
+ * @return Number of failed allocations since boot
+ */
+uint32_t scratch_arena_failures(void) {
+	return scratch_arena_failed_allocs;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _SCRATCH_ARENA_H
+#define _SCRATCH_ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// A position in the arena returned by scratch_mark() and passed to scratch_release()
+typedef uint32_t SCRATCH_MARK;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+void scratch_arena_reset(void);
+
+float * scratch_alloc(uint32_t words);
+
+SCRATCH_MARK scratch_mark(void);
+void scratch_release(SCRATCH_MARK mark);
+
+uint32_t scratch_arena_size_words(void);
+uint32_t scratch_arena_peak_words(void);
+uint32_t scratch_arena_failures(void);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_SCRATCH_ARENA_H
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element detects silence on a channel.
+ *
+ * A block is silent if every sample is below the threshold.  Silence is only
+ * reported once hangover_blocks consecutive silent blocks have been seen, so
+ * short gaps (e.g. between notes) don't trigger it.  As soon as a block
+ * contains a sample above the threshold, silence is cleared again.
+ *
+ * The detector is used in two ways.  Placed on the output of an effect chain,
+ * it tells us when the tails of the effects (reverb, delay feedback, etc.)
+ * have decayed so that the chain can be skipped while its input stays
+ * silent.  Placed on an output channel, it tells us when the amplifier for
+ * that channel can be muted.
+ *
+ * The scan stops at the first sample over the threshold, so the detector
+ * costs very little while there is audio.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include "silence_detector.h"
+
+// Min/max limits
+#define     SILENCE_DETECTOR_THRESHOLD_DB_MIN   (-144.0)
+#define     SILENCE_DETECTOR_THRESHOLD_DB_MAX   (0.0)
+#define     SILENCE_DETECTOR_HANGOVER_MS_MAX    (60000.0)
+
+/**
+ * @brief Initializes instance of a silence detector
+ *
+ * @param c Pointer to instance structure
+ * @param threshold_db Peak level (dBFS) below which audio is considered silent
+ * @param hangover_ms Time audio must stay below the threshold before it is reported as silent
+ * @param audio_block_size The number of samples in each block
+ * @param audio_sample_rate The audio sample rate
+ *
+ * @return Silence detector result (enumeration)
+ */
+RESULT_SILENCE_DETECTOR silence_detector_setup(SILENCE_DETECTOR * c,
+		float threshold_db, float hangover_ms, uint32_t audio_block_size,
+		float audio_sample_rate) {
+
+	// Ensure we don't have a null pointer
+	if (c == NULL) {
+		return SILENCE_DETECTOR_INVALID_INSTANCE_POINTER;
+	}
+
+	c->initialized = false;
+
+	if (threshold_db < SILENCE_DETECTOR_THRESHOLD_DB_MIN
+			|| threshold_db > SILENCE_DETECTOR_THRESHOLD_DB_MAX) {
+		return SILENCE_DETECTOR_INVALID_THRESHOLD;
+	}
+
+	if (hangover_ms < 0.0 || hangover_ms > SILENCE_DETECTOR_HANGOVER_MS_MAX
+			|| audio_block_size == 0) {
+		return SILENCE_DETECTOR_INVALID_HANGOVER;
+	}
+
+	c->threshold = powf(10.0, threshold_db * 0.05);
+
+	// Start out assuming there is audio
+	c->silent_blocks = 0;
+	c->silent = false;
+
+	// Instance was successfully initialized
+	c->initialized = true;
+	return silence_detector_modify_hangover(c, hangover_ms, audio_block_size,
+			audio_sample_rate);
+}
+
+/**
+ * @brief Changes how long audio must stay below the threshold before it is silent
+ *
+ * Blocks that have already been silent still count towards the new hangover,
+ * so a longer hangover clears silence until the extra blocks have been seen.
+ *
+ * @param c Pointer to instance structure
+ * @param hangover_ms Time audio must stay below the threshold before it is reported as silent
+ * @param audio_block_size The number of samples in each block
+ * @param audio_sample_rate The audio sample rate
+ *
+ * @return Silence detector result (enumeration)
+ */
+RESULT_SILENCE_DETECTOR silence_detector_modify_hangover(SILENCE_DETECTOR * c,
+		float hangover_ms, uint32_t audio_block_size, float audio_sample_rate) {
+
+	if (c == NULL) {
+		return SILENCE_DETECTOR_INVALID_INSTANCE_POINTER;
+	}
+
+	if (hangover_ms < 0.0 || hangover_ms > SILENCE_DETECTOR_HANGOVER_MS_MAX
+			|| audio_block_size == 0) {
+		return SILENCE_DETECTOR_INVALID_HANGOVER;
+	}
+
+	// Round up so we always wait at least the hangover time
+	c->hangover_blocks = (uint32_t) ceilf(
+			hangover_ms * 0.001 * audio_sample_rate / audio_block_size);
+	if (c->hangover_blocks == 0) {
+		c->hangover_blocks = 1;
+	}
+
+	if (c->silent_blocks > c->hangover_blocks) {
+		c->silent_blocks = c->hangover_blocks;
+	}
+	c->silent = (c->silent_blocks >= c->hangover_blocks);
+
+	return SILENCE_DETECTOR_OK;
+}
+
+/**
+ * @brief Checks a block of audio for silence
+ *
+ * @param c Pointer to instance structure
+ * @param audio_in Pointer to floating point audio input buffer
+ * @param audio_block_size The number of floating-point words to process
+ * @return true if the audio has been silent for at least the hangover time
+ */
+#pragma optimize_for_speed
+bool silence_detector_read(SILENCE_DETECTOR * c, float * audio_in,
+		uint32_t audio_block_size) {
+
+	// If this instance hasn't been properly initialized, never report silence
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+
+	float threshold = c->threshold;
+
+	for (int i = 0; i < audio_block_size; i++) {
+		if (fabsf(audio_in[i]) > threshold) {
+			c->silent_blocks = 0;
+			c->silent = false;
+			return false;
+		}
+	}
+
+	if (c->silent_blocks < c->hangover_blocks) {
+		c->silent_blocks++;
+	}
+	c->silent = (c->silent_blocks >= c->hangover_blocks);
+
+	return c->silent;
+}
+
+/**
+ * @brief Returns the result of the last call to silence_detector_read()
+ *
+ * @param c Pointer to instance structure
+ * @return true if the audio has been silent for at least the hangover time
+ */
+bool silence_detector_is_silent(SILENCE_DETECTOR * c) {
+
+	if (c == NULL || !c->initialized) {
+		return false;
+	}
+	return c->silent;
+}
+
+/**
+ * @brief Clears the detector so silence must be detected again from scratch
+ *
+ * @param c Pointer to instance structure
+ */
+void silence_detector_reset(SILENCE_DETECTOR * c) {
+
+	if (c != NULL) {
+		c->silent_blocks = 0;
+		c->silent = false;
+	}
+}
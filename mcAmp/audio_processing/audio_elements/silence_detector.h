@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _SILENCE_DETECTOR_H
+#define _SILENCE_DETECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Result enumerations
+typedef enum {
+	SILENCE_DETECTOR_OK,
+	SILENCE_DETECTOR_INVALID_INSTANCE_POINTER,
+	SILENCE_DETECTOR_INVALID_THRESHOLD,
+	SILENCE_DETECTOR_INVALID_HANGOVER
+} RESULT_SILENCE_DETECTOR;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	float threshold;               // linear peak level below which a block is silent
+	uint32_t hangover_blocks;      // silent blocks required before reporting silence
+	uint32_t silent_blocks;        // consecutive silent blocks so far (saturates)
+
+	bool silent;
+
+} SILENCE_DETECTOR;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_SILENCE_DETECTOR silence_detector_setup(SILENCE_DETECTOR * c,
+		float threshold_db, float hangover_ms, uint32_t audio_block_size,
+		float audio_sample_rate);
+
+RESULT_SILENCE_DETECTOR silence_detector_modify_hangover(SILENCE_DETECTOR * c,
+		float hangover_ms, uint32_t audio_block_size, float audio_sample_rate);
+
+bool silence_detector_read(SILENCE_DETECTOR * c, float * audio_in,
+		uint32_t audio_block_size);
+
+bool silence_detector_is_silent(SILENCE_DETECTOR * c);
+
+void silence_detector_reset(SILENCE_DETECTOR * c);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_SILENCE_DETECTOR_H
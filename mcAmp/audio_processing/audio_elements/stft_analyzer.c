@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * A short-time Fourier transform (STFT) analyzer that runs at control rate
+ * alongside the audio callback.
+ *
+ * Each audio block is copied into an overlap ring that holds the last FFT
+ * size + hop samples.  Every hop samples a new frame is started: the last
+ * FFT size samples are Hann windowed and transformed with a radix-2 real
+ * FFT (an FFT of half the size on the even / odd samples packed as complex
+ * numbers, followed by a split step).  Rather than doing the whole FFT in
+ * one block, the work is broken into small steps (window + load, butterflies
+ * and split + magnitude) and each block does a fixed share of them, sized
+ * so the frame is finished a block before the next hop starts.  The cost of
+ * the analyzer is therefore about the same in every block instead of a
+ * spike once per hop.  For example, a 1024 point FFT with a hop of 256 at
+ * a block size of 32 spreads about 3.8k steps over 7 blocks.
+ *
+ * The magnitudes are scaled so a sine wave on a bin reads as its peak
+ * amplitude, and written to one of two buffers in cached memory; the
+ * buffers are flushed as they are written and swapped once the frame is
+ * complete.  A small header in this core's uncached L2 (published in
+ * MULTICORE_DATA) says which buffer holds the latest frame, and its
+ * sequence number is odd while the buffers are being swapped.
+ * stft_analyzer_read() takes a consistent copy of the latest frame from
+ * either SHARC core or from the ARM.
+ *
+ * The analyzer can run on either SHARC core.  Both cores keep their overlap
+ * ring filled, but only the selected core runs the FFT, so the analysis can
+ * be moved between cores at a hop boundary without waiting for the ring to
+ * fill.  stft_analyzer_choose_core() picks the core from the MHz loads the
+ * audio frameworks already publish, with enough hysteresis that moving the
+ * analysis doesn't just make the other core the busier one.
+ *
+ * The ring, FFT buffer, twiddles and magnitude buffers are allocated with
+ * mem_alloc() when the analyzer is set up (up to five words per FFT point at
+ * the largest hop), so call stft_analyzer_setup() once from the audio setup
+ * routine.
+ */
+#include <math.h>
+#include <stdlib.h>
+
+#include <runtime/cache/adi_cache.h>
+
+#include "memory_placement.h"
+#include "stft_analyzer.h"
+
+#if (STFT_ANALYZER_ENABLED)
+
+// Relative cost of each step type, used to share the frame out between blocks
+#define STFT_ANALYZER_LOAD_COST      (1)
+#define STFT_ANALYZER_BUTTERFLY_COST (1)
+#define STFT_ANALYZER_SPLIT_COST     (4)
+
+#if defined(CORE1) || defined(CORE2)
+
+// Ensures the magnitudes have been written before the sequence number is moved
+#define STFT_ANALYZER_SYNC()         asm volatile("sync;")
+
+// Frame progress
+typedef enum {
+	STFT_ANALYZER_WAITING,         // waiting for the next hop
+	STFT_ANALYZER_LOAD,            // windowing and loading the FFT buffer
+	STFT_ANALYZER_BUTTERFLIES,     // running the stages of the half size FFT
+	STFT_ANALYZER_SPLIT            // splitting the real FFT and taking magnitudes
+} STFT_ANALYZER_STATE;
+
+typedef struct {
+
+	bool initialized;
+
+	uint32_t fft_size;
+	uint32_t half_size;            // points in the complex FFT
+	uint32_t half_bits;            // log2(half_size)
+	uint32_t hop_size;
+	uint32_t steps_per_block;      // share of the frame done each block
+	float scale;                   // magnitude scale (sine amplitude)
+	float frames_per_second;
+
+	// Overlap ring
+	float * ring;
+	uint32_t ring_size;
+	uint32_t ring_write;
+	uint32_t ring_filled;
+	uint32_t hop_samples;          // samples since the last frame was started
+
+	// FFT
+	float * work;                  // half_size complex points (re, im)
+	float * twiddle;               // e^(-j 2 pi k / fft_size) for k < half_size
+	float * magnitudes[2];
+	uint32_t front;                // magnitude buffer holding the latest frame
+
+	uint32_t state;                // STFT_ANALYZER_STATE
+	uint32_t frame_start;          // ring index of the first sample of the frame
+	uint32_t stage;
+	uint32_t index;                // next step within the current state
+
+	uint32_t frame_cycles;
+} STFT_ANALYZER;
+
+static STFT_ANALYZER stft;
+
+/*
+ * Spectrum header for the other cores in this core's uncached L2 (see the
+ * event ring in bm_event_logging.c)
+ */
+#pragma section("seg_l2_uncached")
+static STFT_ANALYZER_SPECTRUM stft_spectrum;
+
+/**
+ * @brief Reverses the order of the lowest bits of a value
+ */
+static uint32_t stft_analyzer_bit_reverse(uint32_t n, uint32_t bits) {
+
+	uint32_t r = 0;
+	for (int i = 0; i < bits; i++) {
+		r = (r << 1) | (n & 1);
+		n >>= 1;
+	}
+	return r;
+}
+
+/**
+ * @brief Returns the Hann window at a sample of the frame
+ *
+ * The window is 0.5 - 0.5 * cos(2 pi n / fft_size), and the cosine comes
+ * from the twiddle table (cos(x + pi) = -cos(x) for the second half).
+ */
+static inline float stft_analyzer_window(uint32_t n) {
+
+	if (n < stft.half_size) {
+		return 0.5 - 0.5 * stft.twiddle[2 * n];
+	}
+	return 0.5 + 0.5 * stft.twiddle[2 * (n - stft.half_size)];
+}
+
+/**
+ * @brief Initializes the analyzer - call once from the audio setup routine
+ *
+ * @param fft_size The FFT size (a power of two, 256 to 4096)
+ * @param hop_size Samples between frames (a multiple of the block size, up to the FFT size)
+ * @param audio_block_size The number of samples in each audio block
+ * @param audio_sample_rate The audio sample rate
+ *
+ * @return Pointer to the spectrum to publish in MULTICORE_DATA (NULL if the
+ *         sizes are invalid or there isn't enough memory)
+ */
+STFT_ANALYZER_SPECTRUM * stft_analyzer_setup(uint32_t fft_size,
+		uint32_t hop_size, uint32_t audio_block_size, float audio_sample_rate) {
+
+	stft.initialized = false;
+
+	if (fft_size < STFT_ANALYZER_MIN_SIZE || fft_size > STFT_ANALYZER_MAX_SIZE
+			|| (fft_size & (fft_size - 1)) != 0) {
+		return NULL;
+	}
+	if (audio_block_size == 0 || hop_size == 0 || hop_size > fft_size
+			|| hop_size % audio_block_size != 0) {
+		return NULL;
+	}
+
+	stft.fft_size = fft_size;
+	stft.half_size = fft_size / 2;
+	stft.half_bits = 0;
+	while ((1U << stft.half_bits) < stft.half_size) {
+		stft.half_bits++;
+	}
+	stft.hop_size = hop_size;
+	stft.scale = 4.0 / fft_size;
+	stft.frames_per_second = audio_sample_rate / hop_size;
+
+	// A frame only reads the oldest fft_size samples, so a hop's worth of new samples can't overwrite it
+	stft.ring_size = fft_size + hop_size;
+	stft.ring = (float *) mem_alloc(stft.ring_size * sizeof(float),
+			MEM_HINT_WARM, "STFT overlap ring");
+	stft.work = (float *) mem_alloc(fft_size * sizeof(float), MEM_HINT_HOT,
+			"STFT FFT buffer");
+	stft.twiddle = (float *) mem_alloc(fft_size * sizeof(float),
+			MEM_HINT_WARM, "STFT twiddles");
+	for (int i = 0; i < 2; i++) {
+		stft.magnitudes[i] = (float *) mem_alloc(
+				(stft.half_size + 1) * sizeof(float), MEM_HINT_COLD,
+				"STFT magnitudes");
+	}
+	if (stft.ring == NULL || stft.work == NULL || stft.twiddle == NULL
+			|| stft.magnitudes[0] == NULL || stft.magnitudes[1] == NULL) {
+		return NULL;
+	}
+
+	for (int k = 0; k < stft.half_size; k++) {
+		stft.twiddle[2 * k] = cosf(PI2 * k / fft_size);
+		stft.twiddle[2 * k + 1] = -sinf(PI2 * k / fft_size);
+	}
+
+	for (int i = 0; i < stft.ring_size; i++) {
+		stft.ring[i] = 0.0;
+	}
+	stft.ring_write = 0;
+	stft.ring_filled = 0;
+	stft.hop_samples = 0;
+
+	for (int i = 0; i < 2; i++) {
+		for (int k = 0; k <= stft.half_size; k++) {
+			stft.magnitudes[i][k] = 0.0;
+		}
+		flush_data_buffer(stft.magnitudes[i], stft.magnitudes[i] + stft.half_size,
+				ADI_FLUSH_DATA_NOINV);
+	}
+	stft.front = 0;
+
+	// Share the frame between the blocks of a hop, leaving the last block spare
+	uint32_t steps = stft.half_size * STFT_ANALYZER_LOAD_COST
+			+ (stft.half_size / 2) * stft.half_bits * STFT_ANALYZER_BUTTERFLY_COST
+			+ (stft.half_size / 2 + 1) * STFT_ANALYZER_SPLIT_COST;
+	uint32_t hop_blocks = hop_size / audio_block_size;
+	if (hop_blocks > 1) {
+		hop_blocks--;
+	}
+	stft.steps_per_block = (steps + hop_blocks - 1) / hop_blocks;
+
+	stft.state = STFT_ANALYZER_WAITING;
+	stft.frame_cycles = 0;
+
+	stft_spectrum.sequence = 0;
+	stft_spectrum.frames = 0;
+	stft_spectrum.late_frames = 0;
+	stft_spectrum.fft_size = fft_size;
+	stft_spectrum.hop_size = hop_size;
+	stft_spectrum.bins = stft.half_size + 1;
+	stft_spectrum.sample_rate = audio_sample_rate;
+	stft_spectrum.load_mhz = 0.0;
+	stft_spectrum.magnitudes = stft.magnitudes[stft.front];
+
+	stft.initialized = true;
+	return &stft_spectrum;
+}
+
+/**
+ * @brief Windows the frame and loads it into the FFT buffer in bit-reversed order
+ *
+ * Even samples become the real parts and odd samples the imaginary parts.
+ */
+#pragma optimize_for_speed
+static uint32_t stft_analyzer_load(uint32_t steps) {
+
+	uint32_t end = stft.index + steps;
+	if (end > stft.half_size) {
+		end = stft.half_size;
+	}
+
+	for (uint32_t n = stft.index; n < end; n++) {
+		uint32_t pos = stft.frame_start + 2 * n;
+		if (pos >= stft.ring_size) {
+			pos -= stft.ring_size;
+		}
+		float even = stft.ring[pos] * stft_analyzer_window(2 * n);
+		if (++pos >= stft.ring_size) {
+			pos -= stft.ring_size;
+		}
+		float odd = stft.ring[pos] * stft_analyzer_window(2 * n + 1);
+
+		uint32_t r = stft_analyzer_bit_reverse(n, stft.half_bits);
+		stft.work[2 * r] = even;
+		stft.work[2 * r + 1] = odd;
+	}
+
+	uint32_t done = end - stft.index;
+	stft.index = end;
+	if (stft.index == stft.half_size) {
+		stft.state = STFT_ANALYZER_BUTTERFLIES;
+		stft.stage = 0;
+		stft.index = 0;
+	}
+	return done;
+}
+
+/**
+ * @brief Runs butterflies of the half size decimation-in-time FFT
+ *
+ * Butterfly b of stage s joins points i and i + 2^s, where i is b with a
+ * zero inserted at bit s.  The twiddle for the half size FFT is every
+ * second entry of the table.
+ */
+#pragma optimize_for_speed
+static uint32_t stft_analyzer_butterflies(uint32_t steps) {
+
+	uint32_t done = 0;
+
+	while (done < steps && stft.state == STFT_ANALYZER_BUTTERFLIES) {
+
+		uint32_t s = stft.stage;
+		uint32_t span = 1U << s;
+		uint32_t end = stft.index + (steps - done);
+		if (end > stft.half_size / 2) {
+			end = stft.half_size / 2;
+		}
+
+		for (uint32_t b = stft.index; b < end; b++) {
+			uint32_t j = b & (span - 1);
+			uint32_t i = ((b >> s) << (s + 1)) + j;
+			uint32_t k = i + span;
+			uint32_t t = j << (stft.half_bits - s);
+
+			float wr = stft.twiddle[2 * t];
+			float wi = stft.twiddle[2 * t + 1];
+			float xr = stft.work[2 * k];
+			float xi = stft.work[2 * k + 1];
+			float yr = wr * xr - wi * xi;
+			float yi = wr * xi + wi * xr;
+
+			float zr = stft.work[2 * i];
+			float zi = stft.work[2 * i + 1];
+			stft.work[2 * k] = zr - yr;
+			stft.work[2 * k + 1] = zi - yi;
+			stft.work[2 * i] = zr + yr;
+			stft.work[2 * i + 1] = zi + yi;
+		}
+
+		done += end - stft.index;
+		stft.index = end;
+		if (stft.index == stft.half_size / 2) {
+			stft.index = 0;
+			if (++stft.stage == stft.half_bits) {
+				stft.state = STFT_ANALYZER_SPLIT;
+			}
+		}
+	}
+
+	return done;
+}
+
+/**
+ * @brief Swaps the magnitude buffers and lets readers know there is a new frame
+ */
+static void stft_analyzer_publish(void) {
+
+	stft.front ^= 1;
+
+	uint32_t sequence = stft_spectrum.sequence + 1;
+
+	// An odd sequence number tells readers the buffers are being swapped
+	stft_spectrum.sequence = sequence;
+	STFT_ANALYZER_SYNC();
+
+	stft_spectrum.magnitudes = stft.magnitudes[stft.front];
+	stft_spectrum.frames++;
+	stft_spectrum.load_mhz = stft.frame_cycles * stft.frames_per_second
+			/ 1000000.0;
+
+	STFT_ANALYZER_SYNC();
+	stft_spectrum.sequence = sequence + 1;
+}
+
+/**
+ * @brief Splits the half size FFT into bins of the real FFT and takes their magnitudes
+ *
+ * With Z the half size FFT and W = e^(-j 2 pi / fft_size), each step makes
+ * bins k and half_size - k from Fe = (Z[k] + Z*[half_size - k]) / 2 and
+ * Fo = (Z[k] - Z*[half_size - k]) / 2j:
+ *
+ *    X[k] = Fe + W^k Fo        X[half_size - k] = (Fe - W^k Fo)*
+ */
+#pragma optimize_for_speed
+static uint32_t stft_analyzer_split(uint32_t steps) {
+
+	uint32_t m = stft.half_size;
+	float * mag = stft.magnitudes[stft.front ^ 1];
+	float scale = stft.scale;
+
+	uint32_t first = stft.index;
+	uint32_t end = stft.index + steps;
+	if (end > m / 2 + 1) {
+		end = m / 2 + 1;
+	}
+
+	for (uint32_t k = first; k < end; k++) {
+
+		if (k == 0) {
+			// DC and Nyquist are the sum and difference of the real and imaginary parts of Z[0]
+			mag[0] = fabsf(stft.work[0] + stft.work[1]) * 0.5 * scale;
+			mag[m] = fabsf(stft.work[0] - stft.work[1]) * 0.5 * scale;
+			continue;
+		}
+
+		float zr = stft.work[2 * k];
+		float zi = stft.work[2 * k + 1];
+		float cr = stft.work[2 * (m - k)];
+		float ci = stft.work[2 * (m - k) + 1];
+
+		// Fe and Fo (the FFTs of the even and odd samples)
+		float er = 0.5 * (zr + cr);
+		float ei = 0.5 * (zi - ci);
+		float fr = 0.5 * (zi + ci);
+		float fi = -0.5 * (zr - cr);
+
+		// W^k Fo
+		float wr = stft.twiddle[2 * k];
+		float wi = stft.twiddle[2 * k + 1];
+		float pr = wr * fr - wi * fi;
+		float pi = wr * fi + wi * fr;
+
+		mag[k] = sqrtf((er + pr) * (er + pr) + (ei + pi) * (ei + pi)) * scale;
+		mag[m - k] = sqrtf((er - pr) * (er - pr) + (ei - pi) * (ei - pi)) * scale;
+	}
+
+	// Write back both ends of the spectrum covered by this step
+	if (end > first) {
+		flush_data_buffer(&mag[first], &mag[end - 1], ADI_FLUSH_DATA_NOINV);
+		flush_data_buffer(&mag[m - end + 1], &mag[m - first], ADI_FLUSH_DATA_NOINV);
+	}
+
+	uint32_t done = end - stft.index;
+	stft.index = end;
+	if (stft.index == m / 2 + 1) {
+		stft_analyzer_publish();
+		stft.state = STFT_ANALYZER_WAITING;
+	}
+	return done;
+}
+
+/**
+ * @brief Adds a block to the overlap ring and does this block's share of the FFT
+ *
+ * @param audio_in Pointer to the floating point audio to analyze
+ * @param audio_block_size The number of samples in the block
+ * @param analyze True on the core selected to run the analysis (the ring
+ *        is filled either way)
+ */
+#pragma optimize_for_speed
+void stft_analyzer_process(float * audio_in, uint32_t audio_block_size,
+		bool analyze) {
+
+	if (!stft.initialized) {
+		return;
+	}
+
+	uint32_t start_cycles = (uint32_t) __builtin_emuclk();
+
+	// Add the block to the overlap ring
+	uint32_t pos = stft.ring_write;
+	for (int i = 0; i < audio_block_size; i++) {
+		stft.ring[pos] = audio_in[i];
+		if (++pos == stft.ring_size) {
+			pos = 0;
+		}
+	}
+	stft.ring_write = pos;
+	stft.ring_filled += audio_block_size;
+	if (stft.ring_filled > stft.ring_size) {
+		stft.ring_filled = stft.ring_size;
+	}
+	stft.hop_samples += audio_block_size;
+
+	// Drop any frame in progress when the analysis moves to the other core
+	if (!analyze) {
+		stft.state = STFT_ANALYZER_WAITING;
+		return;
+	}
+
+	if (stft.hop_samples >= stft.hop_size && stft.ring_filled >= stft.fft_size) {
+		stft.hop_samples = 0;
+		if (stft.state == STFT_ANALYZER_WAITING) {
+			stft.frame_start = pos >= stft.fft_size ?
+					pos - stft.fft_size : pos + stft.ring_size - stft.fft_size;
+			stft.state = STFT_ANALYZER_LOAD;
+			stft.index = 0;
+			stft.frame_cycles = 0;
+		} else {
+			// Shouldn't happen - finish the frame in progress and skip this hop
+			stft_spectrum.late_frames++;
+		}
+	}
+
+	// Do this block's share of the frame
+	uint32_t steps = stft.steps_per_block;
+	while (steps > 0 && stft.state != STFT_ANALYZER_WAITING) {
+		switch (stft.state) {
+		case STFT_ANALYZER_LOAD:
+			steps -= stft_analyzer_load(steps / STFT_ANALYZER_LOAD_COST)
+					* STFT_ANALYZER_LOAD_COST;
+			break;
+		case STFT_ANALYZER_BUTTERFLIES:
+			steps -= stft_analyzer_butterflies(steps / STFT_ANALYZER_BUTTERFLY_COST)
+					* STFT_ANALYZER_BUTTERFLY_COST;
+			break;
+		default:
+			if (steps < STFT_ANALYZER_SPLIT_COST) {
+				steps = 0;
+				break;
+			}
+			steps -= stft_analyzer_split(steps / STFT_ANALYZER_SPLIT_COST)
+					* STFT_ANALYZER_SPLIT_COST;
+			break;
+		}
+	}
+
+	stft.frame_cycles += (uint32_t) __builtin_emuclk() - start_cycles;
+}
+
+#endif  // defined(CORE1) || defined(CORE2)
+
+/**
+ * @brief Decides which SHARC core should run the analysis
+ *
+ * The load of the core running the analysis includes it, so moving the
+ * analysis takes analyzer_load_mhz off that core and adds it to the other.
+ * The analysis only moves if the other core would still be at least
+ * STFT_ANALYZER_MOVE_MARGIN_MHZ less busy than the current core is now.
+ *
+ * @param current_core Core running the analysis now (1 or 2)
+ * @param analyzer_load_mhz load_mhz published by that core
+ * @param core1_load_mhz Current load of SHARC core 1
+ * @param core2_load_mhz Current load of SHARC core 2
+ * @return Core that should run the analysis (1 or 2)
+ */
+uint32_t stft_analyzer_choose_core(uint32_t current_core,
+		float analyzer_load_mhz, float core1_load_mhz, float core2_load_mhz) {
+
+	if (current_core == 2) {
+		if (core1_load_mhz + analyzer_load_mhz + STFT_ANALYZER_MOVE_MARGIN_MHZ
+				< core2_load_mhz) {
+			return 1;
+		}
+		return 2;
+	}
+
+	if (core2_load_mhz + analyzer_load_mhz + STFT_ANALYZER_MOVE_MARGIN_MHZ
+			< core1_load_mhz) {
+		return 2;
+	}
+	return 1;
+}
+
+// Keeps the reads of the sequence number and the magnitudes in order on the ARM
+#if defined(CORE0)
+#define STFT_ANALYZER_READ_BARRIER()    __sync_synchronize()
+#else
+#define STFT_ANALYZER_READ_BARRIER()
+#endif
+
+/**
+ * @brief Takes a consistent copy of the latest frame published by a SHARC core
+ *
+ * @param spectrum Pointer to the published spectrum (from MULTICORE_DATA)
+ * @param magnitudes Buffer for the magnitudes
+ * @param max_bins Size of the buffer (bins beyond it aren't copied)
+ * @param frame Set to the frame number that was copied (can be NULL)
+ * @return true if a consistent copy was taken
+ */
+bool stft_analyzer_read(const volatile STFT_ANALYZER_SPECTRUM * spectrum,
+		float * magnitudes, uint32_t max_bins, uint32_t * frame) {
+
+	if (spectrum == NULL || magnitudes == NULL || max_bins == 0) {
+		return false;
+	}
+
+	// A frame stays in its buffer for a whole hop, so a few retries is plenty
+	for (int attempt = 0; attempt < 4; attempt++) {
+
+		uint32_t sequence = spectrum->sequence;
+		if (sequence & 1) {
+			continue;
+		}
+		STFT_ANALYZER_READ_BARRIER();
+
+		uint32_t frames = spectrum->frames;
+		uint32_t bins = spectrum->bins < max_bins ? spectrum->bins : max_bins;
+		float * source = spectrum->magnitudes;
+
+		// Drop any stale copy of the buffer from this core's cache
+		flush_data_buffer(source, source + bins - 1, ADI_FLUSH_DATA_INV);
+		for (int i = 0; i < bins; i++) {
+			magnitudes[i] = source[i];
+		}
+
+		STFT_ANALYZER_READ_BARRIER();
+		if (spectrum->sequence == sequence) {
+			if (frame != NULL) {
+				*frame = frames;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#else
+
+STFT_ANALYZER_SPECTRUM * stft_analyzer_setup(uint32_t fft_size,
+		uint32_t hop_size, uint32_t audio_block_size, float audio_sample_rate) {
+	return NULL;
+}
+
+void stft_analyzer_process(float * audio_in, uint32_t audio_block_size,
+		bool analyze) {
+}
+
+uint32_t stft_analyzer_choose_core(uint32_t current_core,
+		float analyzer_load_mhz, float core1_load_mhz, float core2_load_mhz) {
+	return current_core;
+}
+
+bool stft_analyzer_read(const volatile STFT_ANALYZER_SPECTRUM * spectrum,
+		float * magnitudes, uint32_t max_bins, uint32_t * frame) {
+	return false;
+}
+
+#endif  // STFT_ANALYZER_ENABLED
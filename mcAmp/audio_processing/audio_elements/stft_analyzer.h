@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _STFT_ANALYZER_H
+#define _STFT_ANALYZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Set to false to compile the analyzer (and all of its memory) out
+#define STFT_ANALYZER_ENABLED           (true)
+
+// FFT size (a power of two from STFT_ANALYZER_MIN_SIZE to STFT_ANALYZER_MAX_SIZE)
+#define STFT_ANALYZER_SIZE              (1024)
+
+// Samples between frames (a multiple of the audio block size, no larger than the FFT)
+#define STFT_ANALYZER_HOP               (STFT_ANALYZER_SIZE / 4)
+
+#define STFT_ANALYZER_MIN_SIZE          (256)
+#define STFT_ANALYZER_MAX_SIZE          (4096)
+
+// How much lower (MHz) the other core's load must be before the analysis moves to it
+#define STFT_ANALYZER_MOVE_MARGIN_MHZ   (10.0)
+
+/*
+ * Spectrum published by each SHARC core.  sequence is odd while a new frame
+ * is being published; readers should use stft_analyzer_read() to get a
+ * consistent copy of the magnitudes.
+ */
+typedef struct {
+	volatile uint32_t sequence;
+
+	uint32_t frames;               // frames published since setup
+	uint32_t late_frames;          // hops that started before the previous frame was finished
+	uint32_t fft_size;
+	uint32_t hop_size;
+	uint32_t bins;                 // fft_size / 2 + 1, from DC to Nyquist
+	float sample_rate;
+	float load_mhz;                // cost of the analysis on this core while it is running
+
+	float * magnitudes;            // sine amplitude of each bin in the latest frame (cached memory)
+} STFT_ANALYZER_SPECTRUM;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+STFT_ANALYZER_SPECTRUM * stft_analyzer_setup(uint32_t fft_size,
+		uint32_t hop_size, uint32_t audio_block_size, float audio_sample_rate);
+
+void stft_analyzer_process(float * audio_in, uint32_t audio_block_size,
+		bool analyze);
+
+uint32_t stft_analyzer_choose_core(uint32_t current_core,
+		float analyzer_load_mhz, float core1_load_mhz, float core2_load_mhz);
+
+bool stft_analyzer_read(const volatile STFT_ANALYZER_SPECTRUM * spectrum,
+		float * magnitudes, uint32_t max_bins, uint32_t * frame);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_STFT_ANALYZER_H
@@ -13,6 +13,7 @@
 
 #include "../audio_elements/audio_utilities.h"
 #include "zero_crossing_detector.h"
+#include "scratch_arena.h"
 
 #include "audio_utilities.h"
 
@@ -85,14 +86,15 @@ bool zero_crossing_read(ZERO_CROSSING_DETECTOR * c, float * audio_in,
 
 	int i;
 
-	float zc_buff1[MAX_AUDIO_BLOCK_SIZE];
-	float zc_buff2[MAX_AUDIO_BLOCK_SIZE];
-	float zc_buff3[MAX_AUDIO_BLOCK_SIZE];
+	// Temporaries come from the per-block scratch arena
+	SCRATCH_MARK scratch = scratch_mark();
+	float * filtered_audio_in = scratch_alloc(audio_block_size);
+	float * dc_blocked_audio_in = scratch_alloc(audio_block_size);
 
-	float filtered_audio_in[MAX_AUDIO_BLOCK_SIZE];
-	float dc_blocked_audio_in[MAX_AUDIO_BLOCK_SIZE];
-
-	copy_buffer(audio_in, zc_buff1, audio_block_size);
+	if (filtered_audio_in == NULL || dc_blocked_audio_in == NULL) {
+		scratch_release(scratch);
+		return c->freq_lock;
+	}
 
 	// Remove DC offset
 	filter_read(&c->zero_block, audio_in, dc_blocked_audio_in,
@@ -115,6 +117,7 @@ bool zero_crossing_read(ZERO_CROSSING_DETECTOR * c, float * audio_in,
 	float vol_threshold_neg = c->peak_amplitude_neg * 0.5;
 
 	if (c->peak_amplitude_pos < 0.001) {
+		scratch_release(scratch);
 		return false;
 	}
 
@@ -180,6 +183,8 @@ bool zero_crossing_read(ZERO_CROSSING_DETECTOR * c, float * audio_in,
 	// One more since we're only iterating audio_block_size-1 times
 	c->period_counter += 1;
 
+	scratch_release(scratch);
+
 	// If the period is more than 2000 samples, it's likely not a valid waveform anymore
 	if (c->period_counter > 2000) {
 		c->freq_lock = false;
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * This audio element drives parameter "zones" (floats that an algorithm
+ * reads its parameters from, such as the zones of a Faust UI) from the
+ * controls: the pots and switches on the Audio Project Fin and parameters
+ * set by the host over the control link.
+ *
+ * Each zone is bound to one control, with the zone's range and how a pot is
+ * scaled onto it (linear, or logarithmic for frequencies and the like).
+ * zone_binding_input() is called with a control's value whenever it may
+ * have changed and sets the target of each zone bound to it, at full float
+ * resolution.  zone_binding_update() is called once per block, before the
+ * algorithm runs, and moves each zone towards its target with a one-pole
+ * smoother, so a pot turned quickly doesn't step the parameter.  Zones that
+ * only take a few values (switches, menus) can jump straight to the target.
+ *
+ * A zone is only written while it is moving, so whatever else writes it
+ * (e.g. Faust's own MIDI mapping) keeps its value until the control bound
+ * to the zone moves again.
+ */
+#include <stdlib.h>
+#include <math.h>
+
+#include "zone_binding.h"
+
+/**
+ * @brief Initializes instance of a zone binding
+ *
+ * @param b Pointer to instance structure
+ * @param sample_rate The system sample rate
+ * @param audio_block_size Samples between calls to zone_binding_update()
+ * @param smoothing_ms Time constant of the smoothing
+ *
+ * @return Zone binding result (enumeration)
+ */
+RESULT_ZONE_BINDING zone_binding_setup(ZONE_BINDING * b,
+		float sample_rate, uint32_t audio_block_size, float smoothing_ms) {
+
+	// Ensure we don't have a null pointer
+	if (b == NULL) {
+		return ZONE_BINDING_INVALID_INSTANCE_POINTER;
+	}
+
+	b->count = 0;
+
+	if (smoothing_ms > 0.0) {
+		b->smoothing_coeff = 1.0 - expf(-(float)audio_block_size / (sample_rate * smoothing_ms * 0.001));
+	} else {
+		b->smoothing_coeff = 1.0;
+	}
+
+	// Instance was successfully initialized
+	b->initialized = true;
+	return ZONE_BINDING_OK;
+}
+
+/**
+ * @brief Binds a zone to a control
+ *
+ * The zone keeps its current value until the control is first input.
+ *
+ * @param b Pointer to instance structure
+ * @param zone The float the control drives
+ * @param source Which kind of control
+ * @param index Which pot, switch or host parameter
+ * @param min Zone value at the bottom of the pot / with the switch off
+ * @param max Zone value at the top of the pot / with the switch on
+ * @param scale How a pot is scaled onto min to max
+ * @param smooth Whether the zone glides to a new value or jumps there
+ *
+ * @return Zone binding result (enumeration)
+ */
+RESULT_ZONE_BINDING zone_binding_add(ZONE_BINDING * b, float * zone,
+		ZONE_SOURCE source, uint32_t index, float min, float max,
+		ZONE_SCALE scale, bool smooth) {
+
+	if (b == NULL || !b->initialized || zone == NULL) {
+		return ZONE_BINDING_INVALID_INSTANCE_POINTER;
+	}
+
+	if (source >= ZONE_SOURCES) {
+		return ZONE_BINDING_INVALID_SOURCE;
+	}
+
+	if (b->count >= ZONE_BINDING_MAX_ZONES) {
+		return ZONE_BINDING_FULL;
+	}
+
+	ZONE_BINDING_ENTRY * e = &b->entries[b->count++];
+
+	e->zone = zone;
+	e->source = source;
+	e->index = index;
+	e->min = min;
+	e->max = max;
+
+	// A log scale needs a range that doesn't include zero
+	if (scale == ZONE_SCALE_LOG && (min <= 0.0 || max <= 0.0)) {
+		scale = ZONE_SCALE_LINEAR;
+	}
+	e->scale = scale;
+	e->smooth = smooth;
+
+	e->target = *zone;
+	e->moving = false;
+
+	return ZONE_BINDING_OK;
+}
+
+/**
+ * @brief Sets the targets of the zones bound to a control
+ *
+ * Only call it when the control may have changed; zones whose target
+ * doesn't change are left alone.
+ *
+ * @param b Pointer to instance structure
+ * @param source Which kind of control
+ * @param index Which pot, switch or host parameter
+ * @param value New value of the control (see ZONE_SOURCE)
+ */
+void zone_binding_input(ZONE_BINDING * b, ZONE_SOURCE source,
+		uint32_t index, float value) {
+
+	if (b == NULL || !b->initialized) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < b->count; i++) {
+
+		ZONE_BINDING_ENTRY * e = &b->entries[i];
+		if (e->source != source || e->index != index) {
+			continue;
+		}
+
+		float target;
+
+		switch (source) {
+
+			case ZONE_SOURCE_POT:
+				if (value < 0.0) value = 0.0;
+				if (value > 1.0) value = 1.0;
+				if (e->scale == ZONE_SCALE_LOG) {
+					target = e->min * powf(e->max / e->min, value);
+				} else {
+					target = e->min + (e->max - e->min) * value;
+				}
+				break;
+
+			case ZONE_SOURCE_SWITCH:
+				target = (value >= 0.5) ? e->max : e->min;
+				break;
+
+			default:
+				target = value;
+				if (e->min < e->max) {
+					if (target < e->min) target = e->min;
+					if (target > e->max) target = e->max;
+				}
+				break;
+		}
+
+		if (target != e->target || *e->zone != target) {
+			e->target = target;
+			e->moving = true;
+		}
+	}
+}
+
+/**
+ * @brief Moves each zone towards its target (call once per block)
+ *
+ * @param b Pointer to instance structure
+ */
+#pragma optimize_for_speed
+void zone_binding_update(ZONE_BINDING * b) {
+
+	if (b == NULL || !b->initialized) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < b->count; i++) {
+
+		ZONE_BINDING_ENTRY * e = &b->entries[i];
+		if (!e->moving) {
+			continue;
+		}
+
+		float value = *e->zone;
+		float distance = e->target - value;
+
+		// Close enough (relative to the range) is the target itself
+		if (!e->smooth || fabsf(distance) <= 1e-5 * fabsf(e->max - e->min)) {
+			*e->zone = e->target;
+			e->moving = false;
+		} else {
+			*e->zone = value + distance * b->smoothing_coeff;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * See .c file for documentation.
+ */
+
+#ifndef _ZONE_BINDING_H
+#define _ZONE_BINDING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audio_elements_common.h"
+
+// Maximum number of zones one instance drives
+#define ZONE_BINDING_MAX_ZONES			(32)
+
+// Where a zone's value comes from
+typedef enum {
+	ZONE_SOURCE_POT,			// 0.0 to 1.0, scaled onto the zone's range
+	ZONE_SOURCE_SWITCH,			// 0 or 1, the zone's minimum or maximum
+	ZONE_SOURCE_HOST,			// in the zone's own units, clamped to its range
+	ZONE_SOURCES
+} ZONE_SOURCE;
+
+// How a pot is scaled onto a zone's range
+typedef enum {
+	ZONE_SCALE_LINEAR,
+	ZONE_SCALE_LOG				// equal ratios for equal turns (the range must be above zero)
+} ZONE_SCALE;
+
+// Result enumerations
+typedef enum {
+	ZONE_BINDING_OK,
+	ZONE_BINDING_INVALID_INSTANCE_POINTER,
+	ZONE_BINDING_INVALID_SOURCE,
+	ZONE_BINDING_FULL
+} RESULT_ZONE_BINDING;
+
+typedef struct {
+
+	float * zone;				// owned by the caller (e.g. a Faust UI zone)
+	ZONE_SOURCE source;
+	uint32_t index;				// which pot, switch or host parameter
+
+	float min;
+	float max;
+	ZONE_SCALE scale;
+	bool smooth;
+
+	float target;
+	bool moving;				// still being smoothed towards target
+
+} ZONE_BINDING_ENTRY;
+
+// Instance struct with parameters and state information
+typedef struct {
+
+	bool initialized;
+
+	float smoothing_coeff;		// fraction of the remaining distance covered per block
+
+	uint32_t count;
+	ZONE_BINDING_ENTRY entries[ZONE_BINDING_MAX_ZONES];
+
+} ZONE_BINDING;
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+extern "C" {
+#endif
+
+RESULT_ZONE_BINDING zone_binding_setup(ZONE_BINDING * b,
+		float sample_rate, uint32_t audio_block_size, float smoothing_ms);
+
+RESULT_ZONE_BINDING zone_binding_add(ZONE_BINDING * b, float * zone,
+		ZONE_SOURCE source, uint32_t index, float min, float max,
+		ZONE_SCALE scale, bool smooth);
+
+void zone_binding_input(ZONE_BINDING * b, ZONE_SOURCE source,
+		uint32_t index, float value);
+
+void zone_binding_update(ZONE_BINDING * b);
+
+// Wrapper allows C code to be called from C++ files
+#if __cplusplus
+}
+#endif
+
+#endif //_ZONE_BINDING_H
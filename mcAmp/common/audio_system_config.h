@@ -64,7 +64,8 @@
  * 2. Set audio processing parameters
  ******************************************************************************/
 
-// This should be a base 2 number from 8 to 128
+// This should be a base 2 number from 8 to 1024.  Block sizes above 128 add
+// latency and are intended for high-throughput / non-interactive use.
 #define AUDIO_BLOCK_SIZE                              (32)
 
 // Set audio sample rate
@@ -201,10 +202,6 @@
 #if (FAUST_INSTALLED)
     #define   MIDI_UART_MANAGED_BY_ARM_CORE     FALSE
     #define   MIDI_UART_MANAGED_BY_SHARC1_CORE  FALSE
-
-    #if (USE_FAUST_ALGORITHM_CORE1 && USE_FAUST_ALGORITHM_CORE2)
-        #define SH1_SH2_BYTE_FIFO_SIZE              (32)
-    #endif
 #endif
 
 // Settings for events
@@ -235,8 +232,11 @@
       AUDIO_BLOCK_SIZE != (16) && \
       AUDIO_BLOCK_SIZE != (32) && \
       AUDIO_BLOCK_SIZE != (64) && \
-      AUDIO_BLOCK_SIZE != (128))
-    #error Illegal audio configuration: Illegal audio block size set.  Must be from 4 to 128 and a base-2 number.
+      AUDIO_BLOCK_SIZE != (128) && \
+      AUDIO_BLOCK_SIZE != (256) && \
+      AUDIO_BLOCK_SIZE != (512) && \
+      AUDIO_BLOCK_SIZE != (1024))
+    #error Illegal audio configuration: Illegal audio block size set.  Must be from 4 to 1024 and a base-2 number.
 #endif
 
 // Check if two cores are trying to run UART / MIDI
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Messages the host sends over the control link (see
+ * drivers/bm_control_link_driver/bm_control_link.c for the framing and
+ * acknowledgement).  They are handled on the ARM by
+ * callback_control_messages.cpp; tools/control_client.py is the host side
+ * and mirrors these values.
+ *
+ * All fields are little-endian.  The payload of each message and of its
+ * reply (after the status byte) is:
+ *
+ *   PARAM_SET      n x { u16 id, u32 value }      -> nothing
+ *   PARAM_GET      n x { u16 id }                 -> n x { u32 value }
+ *   COEFF_WRITE    u8 table, u8 0, u16 first word, n x { f32 }  -> nothing
+ *   COEFF_COMMIT   u8 table                       -> nothing
+ *   METRICS_READ   u8 core, u8 first metric       -> u8 metrics on the core, then as many
+ *                                                    CONTROL_METRIC_BYTES entries as fit
+ *
+ * A PARAM_SET is checked as a whole before any of it is applied, so a bad
+ * id or value changes nothing, and the changes it makes to one set of
+ * parameters (e.g. the EQ) are published together.  COEFF_WRITE only fills
+ * in the ARM's copy of a table; COEFF_COMMIT publishes the whole table to
+ * the SHARC cores at once.
+ */
+
+#ifndef _CONTROL_PROTOCOL_H
+#define _CONTROL_PROTOCOL_H
+
+#include "drivers/bm_control_link_driver/bm_control_link.h"
+
+// Message types (CONTROL_LINK_SYNC is 0x00)
+#define CONTROL_MSG_PARAM_SET        (0x01)
+#define CONTROL_MSG_PARAM_GET        (0x02)
+#define CONTROL_MSG_COEFF_WRITE      (0x03)
+#define CONTROL_MSG_COEFF_COMMIT     (0x04)
+#define CONTROL_MSG_METRICS_READ     (0x05)
+
+// Reply status
+#define CONTROL_STATUS_BAD_PARAM     (CONTROL_LINK_STATUS_USER + 0)    // unknown id
+#define CONTROL_STATUS_READ_ONLY     (CONTROL_LINK_STATUS_USER + 1)
+#define CONTROL_STATUS_BAD_VALUE     (CONTROL_LINK_STATUS_USER + 2)
+#define CONTROL_STATUS_BAD_TABLE     (CONTROL_LINK_STATUS_USER + 3)
+#define CONTROL_STATUS_BAD_RANGE     (CONTROL_LINK_STATUS_USER + 4)    // past the end of the table
+#define CONTROL_STATUS_BUSY          (CONTROL_LINK_STATUS_USER + 5)    // a SHARC core isn't taking messages
+
+// Parameters
+typedef enum {
+    CONTROL_PARAM_EFFECTS_PRESET     = 0x0001,    // SHARC core 1 effects preset
+    CONTROL_PARAM_REVERB_PRESET      = 0x0002,    // SHARC core 2 reverb preset
+    CONTROL_PARAM_TOTAL_PRESETS      = 0x0003,    // read only
+    CONTROL_PARAM_MCAMP_EQ_ENABLE    = 0x0010,    // bit n filters mcAmp channel n + 1
+    CONTROL_PARAM_MCAMP_AMPS_IDLE    = 0x0011,    // read only, bit n is set while amp n is muted
+    CONTROL_PARAM_SAMPLE_RATE        = 0x0020,    // read only
+    CONTROL_PARAM_BLOCK_SIZE         = 0x0021,    // read only
+    CONTROL_PARAM_CORE1_LOAD_MHZ     = 0x0022,    // read only, float
+    CONTROL_PARAM_CORE2_LOAD_MHZ     = 0x0023,    // read only, float
+    CONTROL_PARAM_FAUST_HOST         = 0x0100     // float, 0x0100 + n drives the Faust zones declared [host:n]
+} CONTROL_PARAM;
+
+// Coefficient tables (in 32-bit words)
+typedef enum {
+    CONTROL_TABLE_MCAMP_EQ           = 0          // [channel][stage][b0 b1 b2 a1 a2], MCAMP_EQ_SET.coefficients
+} CONTROL_TABLE;
+
+// A metric in a METRICS_READ reply: name[24], u8 type, u32 value, u32 count, u32 shift, u32 bucket[8]
+#define CONTROL_METRIC_BYTES         (24 + 1 + 4 * 11)
+
+#endif // _CONTROL_PROTOCOL_H
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Format strings for binary (deferred-format) event logging.
+ *
+ * Rather than building a string with sprintf, call sites log a format ID and
+ * the raw argument words with log_event_fmt().  The string is only built
+ * later: on the ARM when events are sent to the UART as text, or on the host
+ * by tools/event_log_decoder.py when they are sent as binary frames (see
+ * EVENT_LOG_BINARY_UART in bm_event_logging.h).
+ *
+ * Each entry is X(ID, number of arguments, format).  IDs are numbered in the
+ * order below, so the same table must be used by all three cores and by the
+ * decoder, which reads this file.  Add new formats at the end and keep each
+ * entry on one line.
+ *
+ * Arguments are 32-bit words.  Integer conversions (%d, %x, %c...) take
+ * integers and floating point conversions (%f, %e, %g) take floats passed
+ * through EVENT_LOG_FLOAT().  Strings (%s) aren't supported - use log_event()
+ * for those.  No more than EVENT_LOG_MAX_ARGS arguments can be used.
+ */
+
+#ifndef _EVENT_LOG_FORMATS_H
+#define _EVENT_LOG_FORMATS_H
+
+#define EVENT_LOG_FORMATS(X) \
+    X(EVENT_FMT_TEXT,                   0, "%s") \
+    X(EVENT_FMT_LOG_DROPPED,            0, "<LOGGING ERROR - TRANSMIT FIFO FULL, MESSAGE(S) DROPPED>") \
+    X(EVENT_FMT_SYSTEM_CORE_CLOCK,      1, "  Processor cores running at %.2f MHz") \
+    X(EVENT_FMT_SYSTEM_SAMPLE_RATE,     1, "  Audio sample rate set to %.2f KHz") \
+    X(EVENT_FMT_SYSTEM_BLOCK_SIZE,      1, "  Audio block size (per channel) set to %d samples / frame") \
+    X(EVENT_FMT_SHARC_DROPPED_FRAMES,   2, "SHARC core %d dropped %d audio frame(s) in the last second") \
+    X(EVENT_FMT_SHARC_QUALITY_TIER,     2, "SHARC core %d load shedding: effects now at quality tier %d") \
+    X(EVENT_FMT_SHARC_PEAK_LOAD,        3, "SHARC core %d processing peak load: %.2f MHz of %.1f MHz") \
+    X(EVENT_FMT_SHARC_SCRATCH_PEAK,     4, "SHARC core %d scratch arena peak: %d of %d words (%d failed allocations)") \
+    X(EVENT_FMT_MCAMP_I2C_CONFIG,       3, "McAmp: I2C Config, Bus: %d, Addr: 0x%.2x, Speed: %.3f KHz") \
+    X(EVENT_FMT_MCAMP_AMP_FOUND,        2, "McAmp: MA12040P amp found. I2C Mux Bus: %d; Device Address: 0x%.2x") \
+    X(EVENT_FMT_MCAMP_AMP_NOT_FOUND,    2, "McAmp: MA12040P amp not found. I2C Mux Bus: %d; Device Address: 0x%.2x") \
+    X(EVENT_FMT_MCAMP_AMP_INIT,         2, "McAmp: Bus %d, DevAddr 0x%x - initialising params") \
+    X(EVENT_FMT_MCAMP_VOLUME,           1, "\t master volume level: %.2f dBFS") \
+    X(EVENT_FMT_MCAMP_VOLUME_ERROR,     1, "\t error setting up master volume level at %.2f dBFS") \
+    X(EVENT_FMT_MCAMP_LIMITER,          1, "\t limiter threshold level: %.2f dBFS") \
+    X(EVENT_FMT_MCAMP_LIMITER_ERROR,    1, "\t error setting limiter threshold level at %.2f dBFS") \
+    X(EVENT_FMT_MCAMP_VLA_ERROR,        2, "McAmp: error enabling VLA's on bus %d, devAddr 0x%x") \
+    X(EVENT_FMT_MCAMP_MUTE_ERROR,       2, "McAmp: error muting amp on bus %d, devAddr 0x%x") \
+    X(EVENT_FMT_MCAMP_UNMUTE_ERROR,     2, "McAmp: error unmuting amp on bus %d, devAddr 0x%x") \
+    X(EVENT_FMT_MCAMP_IDLE_MUTED,       1, "McAmp: idle amps muted (mask 0x%.2x)") \
+    X(EVENT_FMT_SHARC_PROFILE_SLOWEST,  4, "SHARC core %d profiler: slowest node %d, max %d cycles (mean %d)") \
+    X(EVENT_FMT_SHARC_PROFILE_OVERRUN,  4, "SHARC core %d overrun: node %d had run for %d cycles (%d overruns)") \
+    X(EVENT_FMT_AUDIO_CAPTURE_SENT,     4, "Audio capture sent: trigger 0x%x, %d channels, %d frames (%d blocks missed)") \
+    X(EVENT_FMT_CHANNEL_TEST_HEARD,     4, "Channel test: mcamp_ch%d heard on input %d at %.1f dB, latency %.1f samples") \
+    X(EVENT_FMT_CHANNEL_TEST_MISSING,   2, "Channel test: mcamp_ch%d not heard (%.0f Hz tone)") \
+    X(EVENT_FMT_CHANNEL_TEST_SUMMARY,   4, "Channel test: %d of %d channels heard (tones %.0f Hz to %.0f Hz)") \
+    X(EVENT_FMT_STFT_MOVED,             4, "SHARC core %d: spectrum analysis moved to core %d (loads %.1f MHz / %.1f MHz)") \
+    X(EVENT_FMT_STACK_PEAK,             4, "Core %d stack high-water mark: %d of %d bytes (%d%%)") \
+    X(EVENT_FMT_TASK_DEADLINES,         4, "Scheduler: task %d missed %d deadline(s) in %d s, longest run %d us")
+
+// Format IDs
+#define EVENT_LOG_FORMAT_ID(id, args, format)   id,
+typedef enum {
+    EVENT_LOG_FORMATS(EVENT_LOG_FORMAT_ID)
+    EVENT_LOG_FORMATS_COUNT
+} BM_EVENT_LOG_FORMAT_ID;
+#undef EVENT_LOG_FORMAT_ID
+
+#endif // _EVENT_LOG_FORMATS_H
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Messages sent between the cores through the queues in MULTICORE_DATA
+ * (see drivers/bm_ipc_queue_driver/bm_ipc_queue.c).
+ *
+ * Push button presses and preset changes used to be flags in MULTICORE_DATA
+ * that the ARM set and the SHARC cores polled and cleared every block, and
+ * the presets were stepped by whichever core got to them.  Each preset is
+ * now owned by the core that runs it: the ARM sends it a message and only
+ * that core writes effects_preset / reverb_preset.
+ *
+ * Messages to the SHARC cores ring a doorbell so they are handled as they
+ * arrive rather than when the next block is polled.
+ */
+
+#ifndef _IPC_MESSAGES_H
+#define _IPC_MESSAGES_H
+
+#include <stdint.h>
+#include <sys/platform.h>
+
+#include "drivers/bm_ipc_queue_driver/bm_ipc_queue.h"
+
+// Messages each queue holds (a power of two)
+#define IPC_QUEUE_CAPACITY          (16)
+
+// Doorbells (TRU0 interrupts, INTR_TRU0_INT4 is the audio callback on SHARC core 1)
+#define IPC_DOORBELL_SHARC1         (INTR_TRU0_INT5)
+#define IPC_DOORBELL_SHARC2         (INTR_TRU0_INT6)
+
+typedef enum {
+    IPC_MESSAGE_BUTTON,              // arg = IPC_BUTTON that was pressed
+    IPC_MESSAGE_PRESET_STEP,         // arg = 1 for the next preset, -1 for the previous one
+    IPC_MESSAGE_PRESET_SET,          // arg = preset to change to (from the control link)
+    IPC_MESSAGE_MIDI                 // arg = status | data1 << 8 | data2 << 16
+} IPC_MESSAGE_TYPE;
+
+typedef enum {
+    IPC_BUTTON_SAM_PB1,
+    IPC_BUTTON_SAM_PB2,
+    IPC_BUTTON_AUDIOPROJ_FIN_SW1,
+    IPC_BUTTON_AUDIOPROJ_FIN_SW2,
+    IPC_BUTTON_AUDIOPROJ_FIN_SW3,
+    IPC_BUTTON_AUDIOPROJ_FIN_SW4
+} IPC_BUTTON;
+
+typedef struct {
+    uint32_t type;                   // IPC_MESSAGE_TYPE
+    int32_t arg;
+} IPC_MESSAGE;
+
+typedef IPC_QUEUE(IPC_MESSAGE, IPC_QUEUE_CAPACITY) IPC_MESSAGE_QUEUE;
+
+#endif // _IPC_MESSAGES_H
@@ -20,10 +20,15 @@
  */
 
 #include "multicore_shared_memory.h"
+#include "drivers/bm_metrics_driver/bm_metrics.h"
 
 // Create an instance of our structure that both cores can access in L2 Block 0
 volatile MULTICORE_DATA *multicore_data = (MULTICORE_DATA *) 0x20080000;
 
+// This core's copy of the shared parameters, and the version it was read from
+SHARED_PARAMETERS shared_parameters;
+static uint32_t shared_parameters_version = PARAM_STORE_NO_VERSION;
+
 /*
  * Since we are manually managing the memory in these shared memory segments,
  * we need to be sure that size of the structure does not exceed the size of the
@@ -31,5 +36,60 @@ volatile MULTICORE_DATA *multicore_data = (MULTICORE_DATA *) 0x20080000;
  */
 bool check_shared_memory_structure_sizes() {
     if (sizeof(MULTICORE_DATA) > 0x1000) return false;
+
+    // The metric regions of the three cores share the next segment
+    if (sizeof(BM_METRICS_REGION) % METRICS_CACHE_LINE) return false;
+    if (METRICS_CORES * sizeof(BM_METRICS_REGION) > METRICS_BUFFER_SIZE) return false;
+    return true;
+}
+
+/*
+ * Empties the queues between the cores.  This should be called by the ARM
+ * before the SHARC cores are started.
+ */
+bool initialize_shared_memory_queues() {
+    return ipc_queue_initialize(IPC_QUEUE_ARM_TO_SHARC1, sizeof(IPC_MESSAGE), IPC_QUEUE_CAPACITY)
+        && ipc_queue_initialize(IPC_QUEUE_ARM_TO_SHARC2, sizeof(IPC_MESSAGE), IPC_QUEUE_CAPACITY)
+        && ipc_queue_initialize(IPC_QUEUE_SHARC1_TO_SHARC2, sizeof(IPC_MESSAGE), IPC_QUEUE_CAPACITY);
+}
+
+/*
+ * The parameters in SHARED_PARAMETERS used to be separate fields of this
+ * structure that the ARM wrote whenever it liked, so an audio callback could
+ * see some of a group of changes and not the rest.  They are now published
+ * as a whole through a parameter store (see bm_param_store.c): the ARM
+ * changes its copy, shared_parameters, and calls shared_parameters_publish().
+ * Each SHARC core calls shared_parameters_refresh() at the start of each
+ * block, which updates its copy only when the ARM has published a new set,
+ * and reads its copy for the rest of the block.
+ */
+
+/*
+ * Publishes the ARM's initial (zeroed) parameters.  This should be called by
+ * the ARM before anything publishes parameters or the SHARC cores are started.
+ */
+bool initialize_shared_parameters() {
+    return param_store_initialize(PARAM_STORE_SHARED, &shared_parameters, sizeof(SHARED_PARAMETERS));
+}
+
+/*
+ * Publishes the ARM's copy of the parameters to the SHARC cores.
+ */
+void shared_parameters_publish() {
+    param_store_publish(PARAM_STORE_SHARED, &shared_parameters);
+}
+
+/*
+ * Updates this core's copy of the parameters if the ARM has published new
+ * ones, and returns true if it did.  This never waits for the ARM.
+ */
+bool shared_parameters_refresh() {
+
+    SHARED_PARAMETERS parameters;
+
+    if (!param_store_read(PARAM_STORE_SHARED, &parameters, &shared_parameters_version)) {
+        return false;
+    }
+    shared_parameters = parameters;
     return true;
 }
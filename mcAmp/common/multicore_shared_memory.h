@@ -10,6 +10,62 @@
 
 #include "audio_system_config.h"
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
+#include "audio_processing/audio_elements/cycle_profiler.h"
+#include "drivers/bm_audio_capture_driver/bm_audio_capture.h"
+#include "audio_processing/audio_elements/stft_analyzer.h"
+#include "drivers/bm_memory_report_driver/bm_memory_report.h"
+#include "common/ipc_messages.h"
+#include "drivers/bm_param_store_driver/bm_param_store.h"
+#include "drivers/mcAmp_drivers/mcAmp.h"
+
+// Faust parameters the host can set over the control link
+#define FAUST_HOST_PARAMS            (8)
+
+/*
+ * Parameters the ARM publishes to the SHARC cores as a whole (see the .c
+ * file).  Each core reads its own copy, shared_parameters, rather than
+ * reading the fields from shared memory.
+ */
+typedef struct
+{
+    /*
+     * If the Audio Project Fin is installed on the SHARC Audio Module board, expose
+     * additional functionality.
+     **/
+    #ifdef SAM_AUDIOPROJ_FIN_BOARD_PRESENT
+
+        // These are the POTS on the Audio Project Fin
+        float audioproj_fin_pot_hadc0;
+        float audioproj_fin_pot_hadc1;
+        float audioproj_fin_pot_hadc2;
+
+        // And these are the additional HADC input channels available on the Audio Project Fin headers
+        float audioproj_fin_aux_hadc3;
+        float audioproj_fin_aux_hadc4;
+        float audioproj_fin_aux_hadc5;
+        float audioproj_fin_aux_hadc6;
+
+    #endif
+
+    // Set by the host (CONTROL_PARAM_FAUST_HOST), bound to the Faust zones declared [host:n]
+    float faust_host_params[FAUST_HOST_PARAMS];
+    uint32_t faust_host_params_set;  // bit n is set once the host has set faust_host_params[n]
+
+    // Add any parameters the SHARC cores should see change together here
+
+} SHARED_PARAMETERS;
+
+/*
+ * Output EQ for the mcAmp channels.  The ARM builds a new set from the
+ * coefficients uploaded over the control link and publishes it as a whole
+ * when the upload is committed, so SHARC core 1 never runs a half-written
+ * filter.
+ */
+typedef struct
+{
+    uint32_t enabled;                // bit n is set to filter mcAmp channel n + 1
+    float coefficients[MCAMP_N_CHANNELS][MCAMP_EQ_STAGES][MCAMP_EQ_COEFFS_PER_STAGE];
+} MCAMP_EQ_SET;
 
 /*
  * This structure lives in L2 memory where the MCAPI memory normally live
@@ -48,12 +104,29 @@ typedef struct
     float sharc_core2_cpu_load_mhz;
     float sharc_core2_cpu_load_mhz_peak;
 
-    uint32_t sharc_core1_dropped_audio_frames;
-    uint32_t sharc_core2_dropped_audio_frames;
+    /*
+     * Dropped frames, the load shedding quality tier and the like are named
+     * metrics (see drivers/bm_metrics_driver) rather than fields here, so
+     * adding one doesn't change this structure.
+     */
+
+    // Bit n is set while all channels driven by MA12040P amp n have been silent
+    uint32_t mcamp_amps_idle;
+
+    /*
+     * Messages between the cores (see common/ipc_messages.h).  The ARM
+     * sends push button presses and preset changes to the SHARC cores, and
+     * SHARC core 1 passes MIDI on to SHARC core 2 when both run Faust.
+     */
+    IPC_MESSAGE_QUEUE arm_to_sharc1_queue;
+    IPC_MESSAGE_QUEUE arm_to_sharc2_queue;
+    IPC_MESSAGE_QUEUE sharc1_to_sharc2_queue;
 
-    // ARM captures PB events and lets rest of system know
-    uint32_t sharc_sam_pb_1_pressed;
-    uint32_t sharc_sam_pb_2_pressed;
+    // Parameters published by the ARM (read through shared_parameters)
+    PARAM_STORE(SHARED_PARAMETERS) parameters;
+
+    // mcAmp output EQ published by the ARM (see callback_control_messages.cpp)
+    PARAM_STORE(MCAMP_EQ_SET) mcamp_eq;
 
     /*
      * If the Audio Project Fin is installed on the SHARC Audio Module board, expose
@@ -61,42 +134,21 @@ typedef struct
      **/
     #ifdef SAM_AUDIOPROJ_FIN_BOARD_PRESENT
 
-        uint32_t audioproj_fin_sw_1_core1_pressed;
-        uint32_t audioproj_fin_sw_2_core1_pressed;
-        uint32_t audioproj_fin_sw_3_core1_pressed;
-        uint32_t audioproj_fin_sw_4_core1_pressed;
-        uint32_t audioproj_fin_sw_1_core2_pressed;
-        uint32_t audioproj_fin_sw_2_core2_pressed;
-        uint32_t audioproj_fin_sw_3_core2_pressed;
-        uint32_t audioproj_fin_sw_4_core2_pressed;
-
         uint32_t audioproj_fin_sw_1_state;
         uint32_t audioproj_fin_sw_2_state;
         uint32_t audioproj_fin_sw_3_state;
         uint32_t audioproj_fin_sw_4_state;
 
-        // These are the POTS on the Audio Project Fin
-        float audioproj_fin_pot_hadc0;
-        float audioproj_fin_pot_hadc1;
-        float audioproj_fin_pot_hadc2;
-
-        // And these are the additional HADC input channels available on the Audio Project Fin headers
-        float audioproj_fin_aux_hadc3;
-        float audioproj_fin_aux_hadc4;
-        float audioproj_fin_aux_hadc5;
-        float audioproj_fin_aux_hadc6;
-
-        float audio_in_amplitude;
-
         uint32_t audioproj_fin_rev_3_20_or_later;
         
     #endif
     uint32_t audio_project_fin_present;
 
-    // Effects processing presets
+    // Effects processing presets (written by SHARC core 1 and SHARC core 2 respectively)
     uint32_t	effects_preset;
     uint32_t	reverb_preset;
     uint32_t	total_effects_presets;
+    uint32_t	effects_preset_active;		// preset core 1 is running (lags effects_preset during a transition)
 
 
     /**
@@ -109,37 +161,50 @@ typedef struct
     float *sharc_core2_audio_in;
     float *sharc_core2_audio_out;
 
-    // Buffers for passing message data to ARM core
-    uint32_t sharc_core1_new_message_ready;
-    uint32_t sharc_core2_new_message_ready;
+    // Each SHARC core publishes the address of its event log ring here
+    BM_EVENT_LOG_RING *sharc_core1_event_ring;
+    BM_EVENT_LOG_RING *sharc_core2_event_ring;
 
-    uint32_t sharc_core1_event_emuclk;
-    uint32_t sharc_core1_event_emuclk2;
-    uint32_t sharc_core1_event_level;
+    // Each SHARC core publishes the address of its cycle profiler snapshot here (NULL if disabled)
+    CYCLE_PROFILER_SNAPSHOT *sharc_core1_profile;
+    CYCLE_PROFILER_SNAPSHOT *sharc_core2_profile;
 
-    uint32_t sharc_core2_event_emuclk;
-    uint32_t sharc_core2_event_emuclk2;
-    uint32_t sharc_core2_event_level;
+    // SHARC core 1 publishes the status of its audio capture here for the ARM to dump (NULL if disabled)
+    BM_AUDIO_CAPTURE_STATUS *sharc_core1_capture;
 
-    char sharc_core1_event_message[EVENT_LOG_MESSAGE_LEN];
-    char sharc_core2_event_message[EVENT_LOG_MESSAGE_LEN];
+    // Each SHARC core publishes the address of its spectrum here (NULL if disabled)
+    STFT_ANALYZER_SPECTRUM *sharc_core1_spectrum;
+    STFT_ANALYZER_SPECTRUM *sharc_core2_spectrum;
 
-    // Add any parameters that you'd like all three cores to access here
+    // SHARC core running the spectrum analysis (1 or 2), moved by core 1 to balance the load
+    uint32_t stft_analyzer_core;
 
-    /*
-     * If we're using Faust on both cores, use a simple FIFO to move MIDI notes
-     * from SHARC Core 1 to SHARC Core 2
-     */
-    #if (USE_FAUST_ALGORITHM_CORE1) && (USE_FAUST_ALGORITHM_CORE2)
+    // Memory use and stack high-water mark of each core (see bm_memory_report.c)
+    BM_MEMORY_REPORT arm_memory;
+    BM_MEMORY_REPORT sharc_core1_memory;
+    BM_MEMORY_REPORT sharc_core2_memory;
 
-        uint8_t sh1_sh2_byte_fifo[SH1_SH2_BYTE_FIFO_SIZE];
-        uint32_t sh1_sh2_fifo_read_ptr;
-        uint32_t sh1_sh2_fifo_write_ptr;
+    // Add any parameters that you'd like all three cores to access here
 
-    #endif
 } MULTICORE_DATA;
 
 extern volatile MULTICORE_DATA *multicore_data;
 bool check_shared_memory_structure_sizes(void);
+bool initialize_shared_memory_queues(void);
+
+// This core's copy of the shared parameters
+extern SHARED_PARAMETERS shared_parameters;
+bool initialize_shared_parameters(void);
+void shared_parameters_publish(void);
+bool shared_parameters_refresh(void);
+
+// Queues between the cores, as passed to the bm_ipc_queue functions
+#define IPC_QUEUE_ARM_TO_SHARC1      ((BM_IPC_QUEUE *) &multicore_data->arm_to_sharc1_queue.queue)
+#define IPC_QUEUE_ARM_TO_SHARC2      ((BM_IPC_QUEUE *) &multicore_data->arm_to_sharc2_queue.queue)
+#define IPC_QUEUE_SHARC1_TO_SHARC2   ((BM_IPC_QUEUE *) &multicore_data->sharc1_to_sharc2_queue.queue)
+
+// Store the shared parameters are published through
+#define PARAM_STORE_SHARED           ((BM_PARAM_STORE *) &multicore_data->parameters.store)
+#define PARAM_STORE_MCAMP_EQ         ((BM_PARAM_STORE *) &multicore_data->mcamp_eq.store)
 
 #endif  // _MULTICORE_AUDIO_SIMPLE_H
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Event IDs for the binary trace buffers (see bm_trace.c).
+ *
+ * Each entry is X(ID, phase, name).  The phase tells tools/trace_export.py
+ * how to draw the event on the timeline: 'B' begins a slice, 'E' ends the
+ * slice begun most recently on the same core and 'i' is an instant event.
+ * IDs are numbered in the order below, so the same table must be used by all
+ * three cores and by the exporter, which reads this file.  Add new events at
+ * the end and keep each entry on one line.
+ *
+ * The payload word stored with each event is noted after the name.
+ */
+
+#ifndef _TRACE_EVENTS_H
+#define _TRACE_EVENTS_H
+
+#define TRACE_EVENTS(X) \
+    X(TRACE_TICK,                   'i', "1ms tick") /* milliseconds */ \
+    X(TRACE_SPORT_ISR_BEGIN,        'B', "SPORT DMA ISR") /* new block count */ \
+    X(TRACE_SPORT_ISR_END,          'E', "SPORT DMA ISR") /* new block count */ \
+    X(TRACE_CALLBACK_BEGIN,         'B', "audio callback") /* processed block count */ \
+    X(TRACE_CALLBACK_END,           'E', "audio callback") /* processed block count */ \
+    X(TRACE_FRAME_DROPPED,          'i', "frame dropped") /* dropped frame count */ \
+    X(TRACE_MDMA_TO_CORE2,          'i', "MDMA to core 2 started (DMA8/9)") /* new block count */ \
+    X(TRACE_MDMA_FROM_CORE2,        'i', "MDMA from core 2 started (DMA18/19)") /* new block count */ \
+    X(TRACE_MDMA_ISR_BEGIN,         'B', "MDMA complete ISR") /* new block count */ \
+    X(TRACE_MDMA_ISR_END,           'E', "MDMA complete ISR") /* new block count */ \
+    X(TRACE_TWI_BEGIN,              'B', "TWI transaction") /* device address */ \
+    X(TRACE_TWI_END,                'E', "TWI transaction") /* result */ \
+    X(TRACE_FROZEN,                 'i', "trace frozen") /* core that froze the trace */ \
+    X(TRACE_USER,                   'i', "user") /* anything */ \
+    X(TRACE_TASK_BEGIN,             'B', "ARM task") /* task number */ \
+    X(TRACE_TASK_END,               'E', "ARM task") /* task number */
+
+// Event IDs
+#define TRACE_EVENT_ID(id, phase, name)   id,
+typedef enum {
+    TRACE_EVENTS(TRACE_EVENT_ID)
+    TRACE_EVENTS_COUNT
+} BM_TRACE_EVENT_ID;
+#undef TRACE_EVENT_ID
+
+#endif // _TRACE_EVENTS_H
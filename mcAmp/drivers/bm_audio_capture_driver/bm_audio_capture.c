@@ -0,0 +1,615 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for capturing audio on the target.
+ *
+ * Glitches are hard to find by listening to the analog outputs.  This driver
+ * records any set of channel buffers (inputs, mcamp_chN, the returns from
+ * SHARC core 2, etc.) into a large ring in SDRAM so the audio around a
+ * problem can be examined on a PC.
+ *
+ * At the end of each audio callback, audio_capture_block() starts a memory
+ * DMA (MDMA2) that copies this block of every tapped channel into the ring.
+ * The source side walks a chain of descriptors, one per channel, and the
+ * destination side uses a 2D pattern that interleaves the channels into
+ * frames, so the SHARC only writes a handful of DMA registers per block.
+ * The ring therefore holds 32-bit float frames in the same layout as a WAV
+ * file.  Channels in cached memory are flushed before the transfer; channels
+ * in L1 (where the framework keeps its audio buffers) need no cache
+ * maintenance.
+ *
+ * Once armed, the ring always holds the most recent audio.  When a trigger
+ * arrives (a call to audio_capture_trigger(), an overrun reported from
+ * processaudio_mips_overflow(), or a sample reaching a threshold on one
+ * channel), recording continues for the post-trigger time and then stops,
+ * keeping up to the pre-trigger time of history before the trigger.
+ *
+ * The ARM sends a finished capture over the event log UART from its
+ * background loop (audio_capture_dump_arm()).  Event log output is held
+ * while the dump is sent.  The dump is AUDIO_CAPTURE_DUMP_MARKER followed by
+ * a WAV file (32-bit float), which tools/capture_receive.py saves to disk.
+ * At 115200 baud, 300ms of 22 channels at 48kHz takes about two minutes to
+ * send, so keep the pre and post trigger times short or raise the baud rate.
+ * Call audio_capture_arm() again to record another capture.
+ *
+ * @file       bm_audio_capture.c
+ * @brief      on-target audio capture to SDRAM
+ */
+#include <stddef.h>
+#include <sys/platform.h>
+
+#include "bm_audio_capture.h"
+
+#if (AUDIO_CAPTURE_ENABLED)
+
+/**
+ * Builds the 44-byte header of a 32-bit float WAV file for a finished capture
+ *
+ * @param status capture status published by the SHARC core
+ * @param header buffer for the header
+ */
+void audio_capture_wav_header(const volatile BM_AUDIO_CAPTURE_STATUS *status,
+                              uint8_t header[AUDIO_CAPTURE_WAV_HEADER_BYTES]) {
+
+    uint32_t block_align = status->channels * sizeof(float);
+    uint32_t data_bytes = status->frames * block_align;
+
+    const uint32_t fields[] = {
+        0x46464952,                     // "RIFF"
+        36 + data_bytes,
+        0x45564157,                     // "WAVE"
+        0x20746d66,                     // "fmt "
+        16,
+        3 | (status->channels << 16),   // WAVE_FORMAT_IEEE_FLOAT
+        status->sample_rate,
+        status->sample_rate * block_align,
+        block_align | (32 << 16),       // 32 bits per sample
+        0x61746164,                     // "data"
+        data_bytes
+    };
+
+    // WAV is little-endian
+    for (int i = 0; i < AUDIO_CAPTURE_WAV_HEADER_BYTES / 4; i++) {
+        header[i * 4 + 0] = (uint8_t)(fields[i]);
+        header[i * 4 + 1] = (uint8_t)(fields[i] >> 8);
+        header[i * 4 + 2] = (uint8_t)(fields[i] >> 16);
+        header[i * 4 + 3] = (uint8_t)(fields[i] >> 24);
+    }
+}
+
+/**
+ * The code below is only compiled on the ARM processor not on the SHARC cores
+ */
+#if defined(CORE0)
+
+#include <stdio.h>
+#include <string.h>
+#include <runtime/cache/adi_cache.h>
+
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+
+// Largest piece of the capture sent to the UART at a time
+#define AUDIO_CAPTURE_DUMP_CHUNK     (256)
+
+// Progress of the dump in progress
+static struct {
+    bool sending;
+    uint8_t preamble[64 + AUDIO_CAPTURE_WAV_HEADER_BYTES];  // marker and WAV header
+    uint32_t preamble_bytes;
+    uint32_t total_bytes;
+    uint32_t sent_bytes;
+} audio_capture_dump;
+
+/**
+ * @brief Sends a finished capture over the event log UART
+ *
+ * Call this from the ARM background loop.  Each call sends as much of the
+ * capture as fits in the UART's transmit FIFO and returns, so the dump runs
+ * alongside everything else.  Event log output is held until it completes.
+ *
+ * @param status capture status published by the SHARC core (may be NULL)
+ */
+void audio_capture_dump_arm(volatile BM_AUDIO_CAPTURE_STATUS *status) {
+
+    if (status == NULL) {
+        return;
+    }
+
+    if (!audio_capture_dump.sending) {
+
+        if (status->state != AUDIO_CAPTURE_DONE || status->dumped) {
+            return;
+        }
+
+        uint32_t data_bytes = status->frames * status->channels * sizeof(float);
+
+        // Marker (with the size of the WAV file that follows) then the WAV header
+        char marker[64];
+        int marker_bytes = snprintf(marker, sizeof(marker), AUDIO_CAPTURE_DUMP_MARKER,
+                                    (unsigned int)(AUDIO_CAPTURE_WAV_HEADER_BYTES + data_bytes));
+        memcpy(audio_capture_dump.preamble, marker, marker_bytes);
+        audio_capture_wav_header(status, &audio_capture_dump.preamble[marker_bytes]);
+
+        audio_capture_dump.preamble_bytes = marker_bytes + AUDIO_CAPTURE_WAV_HEADER_BYTES;
+        audio_capture_dump.total_bytes = audio_capture_dump.preamble_bytes + data_bytes;
+        audio_capture_dump.sent_bytes = 0;
+        audio_capture_dump.sending = true;
+
+        event_logging_hold_uart(true);
+    }
+
+    uint32_t frame_bytes = status->channels * sizeof(float);
+
+    while (audio_capture_dump.sent_bytes < audio_capture_dump.total_bytes) {
+
+        uint8_t *chunk;
+        uint32_t length;
+
+        if (audio_capture_dump.sent_bytes < audio_capture_dump.preamble_bytes) {
+            chunk = &audio_capture_dump.preamble[audio_capture_dump.sent_bytes];
+            length = audio_capture_dump.preamble_bytes - audio_capture_dump.sent_bytes;
+        }
+        else {
+            // The capture may wrap around the end of the ring
+            uint32_t offset = audio_capture_dump.sent_bytes - audio_capture_dump.preamble_bytes;
+            uint32_t frame = (status->first_frame + offset / frame_bytes) % status->ring_frames;
+            uint32_t ring_bytes_left = (status->ring_frames - frame) * frame_bytes - offset % frame_bytes;
+
+            chunk = (uint8_t *)status->ring + frame * frame_bytes + offset % frame_bytes;
+            length = audio_capture_dump.total_bytes - audio_capture_dump.sent_bytes;
+            if (length > ring_bytes_left) {
+                length = ring_bytes_left;
+            }
+        }
+
+        if (length > AUDIO_CAPTURE_DUMP_CHUNK) {
+            length = AUDIO_CAPTURE_DUMP_CHUNK;
+        }
+        if (length > event_logging_uart_space()) {
+            return;
+        }
+
+        // The ring was written by DMA, so don't read stale lines from the ARM's cache
+        flush_data_buffer(chunk, chunk + length - 1, ADI_FLUSH_DATA_INV);
+
+        if (!event_logging_write_uart_raw(chunk, length)) {
+            return;
+        }
+        audio_capture_dump.sent_bytes += length;
+    }
+
+    audio_capture_dump.sending = false;
+    status->dumped = true;
+
+    event_logging_hold_uart(false);
+    log_event_fmt(EVENT_INFO, EVENT_FMT_AUDIO_CAPTURE_SENT, status->trigger, status->channels,
+                  status->frames, status->blocks_missed);
+}
+
+#else
+
+#include <math.h>
+#include <runtime/cache/adi_cache.h>
+
+#if defined(CORE1)
+#define AUDIO_CAPTURE_MP_OFFSET      (0x28000000)    // L1 of this core as seen by the DMA
+#else
+#define AUDIO_CAPTURE_MP_OFFSET      (0x28800000)
+#endif
+
+// Addresses below this are in L1 and have to be translated for the DMA
+#define AUDIO_CAPTURE_L1_END         (0x00400000)
+
+// Source descriptor for one channel (next descriptor, start address, config)
+typedef struct
+{
+    void *next;
+    void *start;
+    uint32_t config;
+} BM_AUDIO_CAPTURE_DESCRIPTOR;
+
+// Interleaved frames for the capture
+#pragma alignment_region(64)
+#pragma section("seg_sdram_noinit_data", NO_INIT)
+static float audio_capture_ring[AUDIO_CAPTURE_RING_WORDS];
+#pragma alignment_region_end
+
+// Source descriptor chain, one per channel
+#pragma alignment_region(32)
+#pragma section("seg_l1_block1_data")
+static BM_AUDIO_CAPTURE_DESCRIPTOR audio_capture_descriptors[AUDIO_CAPTURE_MAX_CHANNELS];
+#pragma alignment_region_end
+
+// Status for the ARM in this core's uncached L2 (see the event ring in bm_event_logging.c)
+#pragma section("seg_l2_uncached")
+static BM_AUDIO_CAPTURE_STATUS audio_capture_status;
+
+static struct {
+    float *channel[AUDIO_CAPTURE_MAX_CHANNELS];
+    bool channel_cached[AUDIO_CAPTURE_MAX_CHANNELS];
+    uint32_t channels;
+    uint32_t block_size;
+
+    uint32_t triggers;
+    uint32_t threshold_channel;
+    float threshold;
+
+    // Triggers are counted by their sources and compared with the counts already seen
+    volatile uint32_t manual_count;
+    volatile uint32_t overrun_count;
+    uint32_t manual_seen;
+    uint32_t overrun_seen;
+
+    uint32_t write_frame;            // next frame of the ring to write
+    uint32_t frames_recorded;        // frames written since the capture was armed (up to the ring size)
+    uint32_t pre_trigger_frames;
+    uint32_t post_trigger_frames;
+    uint32_t post_trigger_remaining;
+    bool finishing;                  // the last transfer of the capture has been started
+} audio_capture;
+
+/**
+ * @brief Returns the address of a buffer as seen by the DMA
+ */
+static void *audio_capture_dma_address(void *address) {
+
+    if ((uint32_t)address < AUDIO_CAPTURE_L1_END) {
+        return (void *)((uint32_t)address + AUDIO_CAPTURE_MP_OFFSET);
+    }
+    return address;
+}
+
+/**
+ * @brief Sets up the audio capture - call from the audio setup routine
+ *
+ * @param sample_rate audio sample rate (for the WAV header)
+ * @param block_size samples per channel in each audio block
+ * @return status to publish in MULTICORE_DATA for the ARM
+ */
+BM_AUDIO_CAPTURE_STATUS *audio_capture_initialize(uint32_t sample_rate,
+                                                  uint32_t block_size) {
+
+    audio_capture.channels = 0;
+    audio_capture.block_size = block_size;
+    audio_capture.triggers = 0;
+    audio_capture.threshold_channel = 0;
+    audio_capture.threshold = 1.0;
+
+    audio_capture_status.state = AUDIO_CAPTURE_IDLE;
+    audio_capture_status.trigger = 0;
+    audio_capture_status.dumped = false;
+    audio_capture_status.channels = 0;
+    audio_capture_status.sample_rate = sample_rate;
+    audio_capture_status.ring = audio_capture_ring;
+    audio_capture_status.ring_frames = 0;
+    audio_capture_status.first_frame = 0;
+    audio_capture_status.frames = 0;
+    audio_capture_status.blocks_missed = 0;
+
+    return &audio_capture_status;
+}
+
+/**
+ * @brief Adds a channel buffer to the capture
+ *
+ * Channels appear in the WAV file in the order they were added.  Add all
+ * channels before arming the capture.
+ *
+ * @param buffer channel buffer (AUDIO_BLOCK_SIZE samples), e.g. mcamp_ch1
+ * @return AUDIO_CAPTURE_SUCCESS or AUDIO_CAPTURE_TOO_MANY_CHANNELS
+ */
+BM_AUDIO_CAPTURE_RESULT audio_capture_add_channel(float *buffer) {
+
+    if (audio_capture.channels >= AUDIO_CAPTURE_MAX_CHANNELS) {
+        return AUDIO_CAPTURE_TOO_MANY_CHANNELS;
+    }
+
+    uint32_t channel = audio_capture.channels++;
+    audio_capture.channel[channel] = buffer;
+    audio_capture.channel_cached[channel] = (uint32_t)buffer >= AUDIO_CAPTURE_L1_END;
+
+    // Each descriptor copies one channel and then moves on to the next, the last one stops
+    audio_capture_descriptors[channel].start = audio_capture_dma_address(buffer);
+    audio_capture_descriptors[channel].next = NULL;
+    audio_capture_descriptors[channel].config = BITM_DMA_CFG_EN |
+                                                (0x2 << BITP_DMA_CFG_MSIZE) |
+                                                0;
+    if (channel > 0) {
+        audio_capture_descriptors[channel - 1].next =
+            audio_capture_dma_address(&audio_capture_descriptors[channel]);
+        audio_capture_descriptors[channel - 1].config |= (4 << BITP_DMA_CFG_FLOW) |   // descriptor list mode = 4
+                                                         ENUM_DMA_CFG_FETCH03;
+    }
+
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+/**
+ * @brief Sets the channel and level for AUDIO_CAPTURE_TRIGGER_THRESHOLD
+ *
+ * @param channel index of the channel (in the order channels were added)
+ * @param threshold absolute sample value that triggers the capture
+ * @return AUDIO_CAPTURE_SUCCESS or AUDIO_CAPTURE_INVALID_CHANNEL
+ */
+BM_AUDIO_CAPTURE_RESULT audio_capture_set_threshold(uint32_t channel,
+                                                    float threshold) {
+
+    if (channel >= audio_capture.channels) {
+        return AUDIO_CAPTURE_INVALID_CHANNEL;
+    }
+
+    audio_capture.threshold_channel = channel;
+    audio_capture.threshold = threshold;
+
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+/**
+ * @brief Starts recording and waits for a trigger
+ *
+ * @param triggers BM_AUDIO_CAPTURE_TRIGGER values that end the wait
+ * @param pre_trigger_ms history to keep from before the trigger
+ * @param post_trigger_ms time to record after the trigger
+ * @return AUDIO_CAPTURE_SUCCESS, AUDIO_CAPTURE_NO_CHANNELS or AUDIO_CAPTURE_TOO_LONG
+ */
+BM_AUDIO_CAPTURE_RESULT audio_capture_arm(uint32_t triggers,
+                                          uint32_t pre_trigger_ms,
+                                          uint32_t post_trigger_ms) {
+
+    if (audio_capture.channels == 0) {
+        return AUDIO_CAPTURE_NO_CHANNELS;
+    }
+
+    // Whole blocks of frames so a block never wraps around the end of the ring
+    uint32_t block_size = audio_capture.block_size;
+    uint32_t ring_frames = (AUDIO_CAPTURE_RING_WORDS / audio_capture.channels) / block_size * block_size;
+
+    uint32_t sample_rate = audio_capture_status.sample_rate;
+    uint32_t pre_trigger_frames = (uint32_t)(((uint64_t)pre_trigger_ms * sample_rate) / 1000);
+    uint32_t post_trigger_frames = (uint32_t)(((uint64_t)post_trigger_ms * sample_rate) / 1000);
+    post_trigger_frames = (post_trigger_frames + block_size - 1) / block_size * block_size;
+    if (post_trigger_frames == 0) {
+        post_trigger_frames = block_size;
+    }
+
+    if (pre_trigger_frames + post_trigger_frames > ring_frames) {
+        return AUDIO_CAPTURE_TOO_LONG;
+    }
+
+    // Stop recording while the capture is set up
+    audio_capture_status.state = AUDIO_CAPTURE_IDLE;
+
+    audio_capture.triggers = triggers;
+    audio_capture.manual_seen = audio_capture.manual_count;
+    audio_capture.overrun_seen = audio_capture.overrun_count;
+
+    audio_capture.write_frame = 0;
+    audio_capture.frames_recorded = 0;
+    audio_capture.pre_trigger_frames = pre_trigger_frames;
+    audio_capture.post_trigger_frames = post_trigger_frames;
+    audio_capture.finishing = false;
+
+    audio_capture_status.trigger = 0;
+    audio_capture_status.dumped = false;
+    audio_capture_status.channels = audio_capture.channels;
+    audio_capture_status.ring_frames = ring_frames;
+    audio_capture_status.first_frame = 0;
+    audio_capture_status.frames = 0;
+    audio_capture_status.blocks_missed = 0;
+
+    audio_capture_status.state = AUDIO_CAPTURE_ARMED;
+
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+/**
+ * @brief Triggers an armed capture (AUDIO_CAPTURE_TRIGGER_MANUAL)
+ */
+void audio_capture_trigger(void) {
+    audio_capture.manual_count++;
+}
+
+/**
+ * @brief Triggers an armed capture when a block overruns (AUDIO_CAPTURE_TRIGGER_OVERRUN)
+ *
+ * Call this from processaudio_mips_overflow().
+ */
+void audio_capture_report_overrun(void) {
+    audio_capture.overrun_count++;
+}
+
+/**
+ * @brief Checks the triggers that are enabled for this block
+ *
+ * @return the BM_AUDIO_CAPTURE_TRIGGER values that fired (0 if none)
+ */
+#pragma optimize_for_speed
+static uint32_t audio_capture_check_triggers(void) {
+
+    uint32_t fired = 0;
+
+    uint32_t manual_count = audio_capture.manual_count;
+    if (manual_count != audio_capture.manual_seen) {
+        audio_capture.manual_seen = manual_count;
+        fired |= AUDIO_CAPTURE_TRIGGER_MANUAL;
+    }
+
+    uint32_t overrun_count = audio_capture.overrun_count;
+    if (overrun_count != audio_capture.overrun_seen) {
+        audio_capture.overrun_seen = overrun_count;
+        fired |= AUDIO_CAPTURE_TRIGGER_OVERRUN;
+    }
+
+    fired &= audio_capture.triggers;
+
+    if (!fired && (audio_capture.triggers & AUDIO_CAPTURE_TRIGGER_THRESHOLD)) {
+        float *samples = audio_capture.channel[audio_capture.threshold_channel];
+        float threshold = audio_capture.threshold;
+        for (int i = 0; i < audio_capture.block_size; i++) {
+            if (fabsf(samples[i]) >= threshold) {
+                fired = AUDIO_CAPTURE_TRIGGER_THRESHOLD;
+                break;
+            }
+        }
+    }
+
+    return fired;
+}
+
+/**
+ * @brief Starts the MDMA that copies this block of every channel into the ring
+ *
+ * @param frame first ring frame of this block
+ */
+#pragma optimize_for_speed
+static void audio_capture_start_transfer(uint32_t frame) {
+
+    uint32_t channels = audio_capture.channels;
+    uint32_t block_size = audio_capture.block_size;
+
+    // Make sure the DMA sees the latest samples of any channel in cached memory
+    for (int i = 0; i < channels; i++) {
+        if (audio_capture.channel_cached[i]) {
+            flush_data_buffer(audio_capture.channel[i],
+                              audio_capture.channel[i] + block_size - 1,
+                              ADI_FLUSH_DATA_NOINV);
+        }
+    }
+
+    // Dest - write each channel's samples one frame apart, then move to the next channel
+    *pREG_DMA39_ADDRSTART = &audio_capture_ring[frame * channels];
+    *pREG_DMA39_XCNT      = block_size;
+    *pREG_DMA39_XMOD      = channels * sizeof(float);
+    *pREG_DMA39_YCNT      = channels;
+    *pREG_DMA39_YMOD      = (int32_t)sizeof(float) - (int32_t)((block_size - 1) * channels * sizeof(float));
+
+    // Source - one descriptor per channel
+    *pREG_DMA38_XCNT      = block_size;
+    *pREG_DMA38_XMOD      = sizeof(float);
+    *pREG_DMA38_DSCPTR_NXT = audio_capture_dma_address(&audio_capture_descriptors[0]);
+
+    // Kick off transfer
+    *pREG_DMA39_CFG = BITM_DMA_CFG_EN |                        // Enable DMA
+                      BITM_DMA_CFG_WNR |                       // Write mode
+                      BITM_DMA_CFG_TWOD |                      // 2D (interleave the channels)
+                      (0x2 << BITP_DMA_CFG_MSIZE) |
+                      0;
+
+    *pREG_DMA38_CFG = BITM_DMA_CFG_EN |
+                      (0x2 << BITP_DMA_CFG_MSIZE) |
+                      (4 << BITP_DMA_CFG_FLOW) |               // descriptor list mode = 4
+                      ENUM_DMA_CFG_FETCH03 |
+                      0;
+}
+
+/**
+ * @brief Captures the current block - call at the end of the audio callback
+ *
+ * The channel buffers must hold this block's audio when this is called.
+ */
+#pragma optimize_for_speed
+void audio_capture_block(void) {
+
+    uint32_t state = audio_capture_status.state;
+    if (state != AUDIO_CAPTURE_ARMED && state != AUDIO_CAPTURE_TRIGGERED) {
+        return;
+    }
+
+    uint32_t block_size = audio_capture.block_size;
+    uint32_t ring_frames = audio_capture_status.ring_frames;
+
+    // The transfer started in the last block should have finished long ago
+    bool dma_busy = (*pREG_DMA38_STAT & BITM_DMA_STAT_RUN) || (*pREG_DMA39_STAT & BITM_DMA_STAT_RUN);
+
+    if (audio_capture.finishing) {
+        if (!dma_busy) {
+            audio_capture_status.state = AUDIO_CAPTURE_DONE;
+        }
+        return;
+    }
+
+    if (state == AUDIO_CAPTURE_ARMED) {
+        uint32_t fired = audio_capture_check_triggers();
+        if (fired) {
+
+            // Keep as much history as has been recorded, up to the pre-trigger time
+            uint32_t pre_trigger_frames = audio_capture.pre_trigger_frames;
+            if (pre_trigger_frames > audio_capture.frames_recorded) {
+                pre_trigger_frames = audio_capture.frames_recorded;
+            }
+
+            audio_capture_status.first_frame = (audio_capture.write_frame + ring_frames - pre_trigger_frames) % ring_frames;
+            audio_capture_status.frames = pre_trigger_frames + audio_capture.post_trigger_frames;
+            audio_capture_status.trigger = fired;
+            audio_capture.post_trigger_remaining = audio_capture.post_trigger_frames;
+
+            audio_capture_status.state = state = AUDIO_CAPTURE_TRIGGERED;
+        }
+    }
+
+    // Keep the ring in step with the audio even if this block can't be captured
+    if (dma_busy) {
+        audio_capture_status.blocks_missed++;
+    }
+    else {
+        audio_capture_start_transfer(audio_capture.write_frame);
+    }
+
+    audio_capture.write_frame += block_size;
+    if (audio_capture.write_frame >= ring_frames) {
+        audio_capture.write_frame = 0;
+    }
+    if (audio_capture.frames_recorded < ring_frames) {
+        audio_capture.frames_recorded += block_size;
+    }
+
+    if (state == AUDIO_CAPTURE_TRIGGERED) {
+        audio_capture.post_trigger_remaining -= block_size;
+        if (audio_capture.post_trigger_remaining == 0) {
+            audio_capture.finishing = true;
+        }
+    }
+}
+
+#endif  // CORE0
+
+#else
+
+// Keep calls in place when the capture is compiled out
+void audio_capture_wav_header(const volatile BM_AUDIO_CAPTURE_STATUS *status,
+                              uint8_t header[AUDIO_CAPTURE_WAV_HEADER_BYTES]) {
+}
+
+void audio_capture_dump_arm(volatile BM_AUDIO_CAPTURE_STATUS *status) {
+}
+
+BM_AUDIO_CAPTURE_STATUS *audio_capture_initialize(uint32_t sample_rate,
+                                                  uint32_t block_size) {
+    return NULL;
+}
+
+BM_AUDIO_CAPTURE_RESULT audio_capture_add_channel(float *buffer) {
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+BM_AUDIO_CAPTURE_RESULT audio_capture_set_threshold(uint32_t channel,
+                                                    float threshold) {
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+BM_AUDIO_CAPTURE_RESULT audio_capture_arm(uint32_t triggers,
+                                          uint32_t pre_trigger_ms,
+                                          uint32_t post_trigger_ms) {
+    return AUDIO_CAPTURE_SUCCESS;
+}
+
+void audio_capture_trigger(void) {
+}
+
+void audio_capture_report_overrun(void) {
+}
+
+void audio_capture_block(void) {
+}
+
+#endif  // AUDIO_CAPTURE_ENABLED
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for audio capture
+ *
+ */
+#ifndef _BM_AUDIO_CAPTURE_H_
+#define _BM_AUDIO_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Set to false to compile the capture (and its SDRAM ring) out
+#define AUDIO_CAPTURE_ENABLED            (true)
+
+// Maximum number of tapped channels
+#define AUDIO_CAPTURE_MAX_CHANNELS       (24)
+
+/*
+ * Size of the capture ring in 32-bit words.  16MB of SHARC core 1's DDR
+ * holds about 4.3 seconds of 20 channels at 48kHz.
+ */
+#define AUDIO_CAPTURE_RING_WORDS         (4 * 1024 * 1024)
+
+// Marker sent on the event log UART ahead of each dump (the argument is the number of bytes that follow)
+#define AUDIO_CAPTURE_DUMP_MARKER        "\r\n<AUDIO CAPTURE %u BYTES>\r\n"
+
+// Size of the WAV header sent ahead of the captured audio
+#define AUDIO_CAPTURE_WAV_HEADER_BYTES   (44)
+
+typedef enum
+{
+    AUDIO_CAPTURE_IDLE,              // not recording
+    AUDIO_CAPTURE_ARMED,             // recording pre-trigger history and waiting for a trigger
+    AUDIO_CAPTURE_TRIGGERED,         // recording the audio after the trigger
+    AUDIO_CAPTURE_DONE               // capture complete and ready to be dumped
+} BM_AUDIO_CAPTURE_STATE;
+
+// Triggers (can be combined)
+typedef enum
+{
+    AUDIO_CAPTURE_TRIGGER_MANUAL    = 0x1,   // audio_capture_trigger()
+    AUDIO_CAPTURE_TRIGGER_OVERRUN   = 0x2,   // audio_capture_report_overrun() from processaudio_mips_overflow()
+    AUDIO_CAPTURE_TRIGGER_THRESHOLD = 0x4    // a sample on the threshold channel reached the threshold
+} BM_AUDIO_CAPTURE_TRIGGER;
+
+typedef enum
+{
+    AUDIO_CAPTURE_SUCCESS,
+    AUDIO_CAPTURE_TOO_MANY_CHANNELS,
+    AUDIO_CAPTURE_NO_CHANNELS,
+    AUDIO_CAPTURE_INVALID_CHANNEL,
+    AUDIO_CAPTURE_TOO_LONG           // pre + post trigger time doesn't fit in the ring
+} BM_AUDIO_CAPTURE_RESULT;
+
+/*
+ * Status published by the SHARC core for the ARM, which dumps finished
+ * captures.  The ring holds interleaved 32-bit float frames, so a capture is
+ * sent as-is after a WAV header.
+ */
+typedef struct
+{
+    volatile uint32_t state;         // BM_AUDIO_CAPTURE_STATE
+    volatile uint32_t trigger;       // trigger that started the post-trigger recording
+    volatile uint32_t dumped;        // set by the ARM once a finished capture has been sent
+    uint32_t channels;
+    uint32_t sample_rate;
+    float *ring;                     // system address of the capture ring
+    uint32_t ring_frames;
+    volatile uint32_t first_frame;   // ring frame of the oldest frame in a finished capture
+    volatile uint32_t frames;        // frames in a finished capture
+    volatile uint32_t blocks_missed; // blocks not captured because the last transfer was still running
+} BM_AUDIO_CAPTURE_STATUS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// SHARC only - sets up the capture and returns the status to publish for the ARM
+BM_AUDIO_CAPTURE_STATUS *audio_capture_initialize(uint32_t sample_rate,
+                                                  uint32_t block_size);
+
+// SHARC only - adds a channel buffer to the capture (in the order they appear in the WAV file)
+BM_AUDIO_CAPTURE_RESULT audio_capture_add_channel(float *buffer);
+
+// SHARC only - sets the channel and level for AUDIO_CAPTURE_TRIGGER_THRESHOLD
+BM_AUDIO_CAPTURE_RESULT audio_capture_set_threshold(uint32_t channel,
+                                                    float threshold);
+
+// SHARC only - starts recording and waits for one of the given triggers
+BM_AUDIO_CAPTURE_RESULT audio_capture_arm(uint32_t triggers,
+                                          uint32_t pre_trigger_ms,
+                                          uint32_t post_trigger_ms);
+
+// SHARC only - trigger sources (safe to call from any interrupt level)
+void audio_capture_trigger(void);
+void audio_capture_report_overrun(void);
+
+// SHARC only - call at the end of each audio callback
+void audio_capture_block(void);
+
+// ARM only - sends a finished capture over the event log UART (call from the background loop)
+void audio_capture_dump_arm(volatile BM_AUDIO_CAPTURE_STATUS *status);
+
+// SHARC and ARM - builds the WAV header for a finished capture
+void audio_capture_wav_header(const volatile BM_AUDIO_CAPTURE_STATUS *status,
+                              uint8_t header[AUDIO_CAPTURE_WAV_HEADER_BYTES]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_AUDIO_CAPTURE_H_
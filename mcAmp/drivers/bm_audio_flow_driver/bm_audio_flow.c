@@ -26,6 +26,26 @@ static uint32_t calculate_dma_xmod(uint32_t audio_block_size) {
     return audio_block_size * 4;
 }
 
+/**
+ * @brief      Returns how many frames the receive DMA has written to its current buffer
+ *
+ * The receive DMA counts down the frames (rows) left in the buffer it is
+ * filling, so this gives the position of the SPORT within the current block
+ * to within a sample, without an interrupt.
+ *
+ * @param      sport_dma_cfg  SPORT / DMA configuration set up by audioflow_init_sport_dma()
+ * @return     Frames received, from 0 to the block size
+ */
+uint32_t audioflow_get_rx_frames(SPORT_DMA_CONFIG *sport_dma_cfg) {
+
+    uint32_t remaining = *sport_dma_cfg->pREG_DMA_RX_YCNT_CUR;
+
+    if (remaining > sport_dma_cfg->dma_audio_block_size) {
+        return 0;
+    }
+    return sport_dma_cfg->dma_audio_block_size - remaining;
+}
+
 /**
  * @brief      Converts a block of audio from floating point to fixed point
  *
@@ -183,6 +203,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             // Used to clear the appropriate DMA interrupt
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA1_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA1_YCNT_CUR;
+
             *pREG_SPU0_SECUREP66 = 0x3;    // SPORT 0A = DMA0 = TX
             *pREG_SPU0_SECUREP67 = 0x3;    // SPORT 0B = DMA1 = RX
 
@@ -230,6 +253,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA3_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA3_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA3_YCNT_CUR;
+
             *pREG_SPU0_SECUREP68 = 0x3;    // SPORT 1A = DMA2 = TX
             *pREG_SPU0_SECUREP69 = 0x3;    // SPORT 1B = DMA3 = RX
 
@@ -277,6 +303,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA5_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA5_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA5_YCNT_CUR;
+
             *pREG_SPU0_SECUREP70 = 0x3;    // SPORT 2A = DMA4 = TX
             *pREG_SPU0_SECUREP71 = 0x3;    // SPORT 2B = DMA5 = RX
 
@@ -324,6 +353,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA7_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA7_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA7_YCNT_CUR;
+
             *pREG_SPU0_SECUREP72 = 0x3;    // SPORT 3A = DMA6 = TX
             *pREG_SPU0_SECUREP73 = 0x3;    // SPORT 3B = DMA7 = RX
 
@@ -373,6 +405,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA11_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA11_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA11_YCNT_CUR;
+
             *pREG_SPU0_SECUREP74 = 0x3;    // SPORT 4A = DMA10 = TX
             *pREG_SPU0_SECUREP75 = 0x3;    // SPORT 4B = DMA11 = RX
 
@@ -422,6 +457,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA13_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA13_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA13_YCNT_CUR;
+
             *pREG_SPU0_SECUREP76 = 0x3;    // SPORT 5A = DMA12 = TX
             *pREG_SPU0_SECUREP77 = 0x3;    // SPORT 5B = DMA13 = RX
 
@@ -471,6 +509,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA15_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA15_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA15_YCNT_CUR;
+
             *pREG_SPU0_SECUREP78 = 0x3;    // SPORT 6A = DMA14 = TX
             *pREG_SPU0_SECUREP79 = 0x3;    // SPORT 6B = DMA15 = RX
 
@@ -520,6 +561,9 @@ DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg) {
             sport_dma_cfg->pREG_DMA_RX_DSCPTR_NXT = (volatile uint32_t *)pREG_DMA17_DSCPTR_NXT;
             sport_dma_cfg->pREG_DMA_RX_STAT = pREG_DMA17_STAT;
 
+            // Used to work out how far through the current block the receive DMA is
+            sport_dma_cfg->pREG_DMA_RX_YCNT_CUR = (volatile uint32_t *)pREG_DMA17_YCNT_CUR;
+
             *pREG_SPU0_SECUREP80 = 0x3;    // SPORT 7A = DMA16 = TX
             *pREG_SPU0_SECUREP81 = 0x3;    // SPORT 7B = DMA17 = RX
 
@@ -114,6 +114,9 @@ typedef struct
     // Used to clear our interrupt in the DMA ISR
     volatile uint32_t *pREG_DMA_RX_STAT;
 
+    // Frames left in the current receive buffer (see audioflow_get_rx_frames())
+    volatile uint32_t *pREG_DMA_RX_YCNT_CUR;
+
     /**
      * If this DMA is intended to generate an interrupt upon completion, set
      * generates_interrupts to true and provide a link to the callback function
@@ -147,6 +150,9 @@ float audioflow_get_cpu_load(uint64_t previous_cycle_cntr_val,
 // Initializes the DMA using the DMA init struct
 DMA_INIT_RESULT audioflow_init_sport_dma(SPORT_DMA_CONFIG *sport_dma_cfg);
 
+// Frames written to the current receive buffer
+uint32_t audioflow_get_rx_frames(SPORT_DMA_CONFIG *sport_dma_cfg);
+
 /**
  * @brief      Returns the value of the core cycle counter
  *
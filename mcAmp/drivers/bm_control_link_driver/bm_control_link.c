@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for a binary control link with a host PC.
+ *
+ * The host sends messages (parameter changes, coefficient tables and so on)
+ * to the ARM over the event log UART and the ARM replies to each one.  The
+ * link only moves messages; what they mean is up to the handler passed to
+ * control_link_initialize() (see callback_control_messages.cpp on the ARM
+ * and tools/control_client.py on the host).
+ *
+ * Framing
+ * -------
+ * Each message is [seq][type][payload][crc16] and each reply is
+ * [seq][type | CONTROL_LINK_REPLY][status][payload][crc16].  The CRC is
+ * CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of everything
+ * before it, sent low byte first, as are all multi-byte fields.  Frames are
+ * COBS encoded, so they contain no zero bytes, and end with a zero.  The
+ * event log text that shares the UART never contains a zero either, so the
+ * host sees it as frames that fail the CRC (or prints it).  Replies also
+ * start with a zero to end any log text before them.
+ *
+ * Acknowledgement
+ * ---------------
+ * The host numbers its messages and may have CONTROL_LINK_WINDOW of them
+ * unacknowledged, so a table of coefficients goes out as a stream of frames
+ * rather than one message per round trip.  The ARM only accepts the
+ * message it is waiting for (go-back-N).  A frame that is corrupted or lost
+ * (e.g. the UART receive buffer overflowed) is never acknowledged; the
+ * frame after it gets a NAK naming the message the ARM is waiting for, and
+ * the host sends again from there.  The last CONTROL_LINK_WINDOW replies are
+ * kept, so a message sent again because its reply was lost gets the same
+ * reply without being handled twice.  A SYNC message starts a session at
+ * any sequence number.
+ *
+ * control_link_poll() runs from the ARM background loop.  Received bytes
+ * wait in the UART driver's receive buffer until then, and replies are
+ * written with the event log held so a log message can't be written into
+ * the middle of one from the 1ms tick.  While another user (an audio
+ * capture dump) holds the UART, messages wait and the host sends again.
+ *
+ * @file       bm_control_link.c
+ * @brief      COBS framed, CRC checked, windowed message link over the event log UART
+ */
+#include <stddef.h>
+
+#include "bm_control_link.h"
+
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+// Largest unencoded frame (a reply) and the most COBS can add to it, with the zeros either side
+#define CONTROL_LINK_MAX_FRAME       (CONTROL_LINK_MAX_PAYLOAD + 5)
+#define CONTROL_LINK_MAX_ENCODED     (CONTROL_LINK_MAX_FRAME + CONTROL_LINK_MAX_FRAME / 254 + 3)
+
+// Bytes read from the UART at a time
+#define CONTROL_LINK_READ_CHUNK      (64)
+
+typedef struct
+{
+    uint8_t seq;
+    uint16_t length;                 // encoded length (0 if none)
+    uint8_t frame[CONTROL_LINK_MAX_ENCODED];
+} CONTROL_LINK_REPLY_FRAME;
+
+static struct
+{
+    BM_CONTROL_LINK_HANDLER handler;
+
+    // Frame being received (still encoded)
+    uint8_t rx_frame[CONTROL_LINK_MAX_ENCODED];
+    uint16_t rx_length;
+    bool rx_overflow;
+
+    uint8_t expected_seq;
+    bool nak_sent;                   // once per gap, so a burst after a lost frame only gets one
+
+    // The last CONTROL_LINK_WINDOW replies, by sequence number
+    CONTROL_LINK_REPLY_FRAME replies[CONTROL_LINK_WINDOW];
+
+    BM_METRIC frames;
+    BM_METRIC bad_frames;
+    BM_METRIC resent;
+} control_link;
+
+/**
+ * @brief CRC-16/CCITT of a block of bytes
+ */
+static uint16_t control_link_crc16(const uint8_t *data, uint16_t length) {
+
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief COBS encodes a block (without the terminating zero)
+ *
+ * @return encoded length
+ */
+static uint16_t control_link_cobs_encode(const uint8_t *src, uint16_t length, uint8_t *dst) {
+
+    uint16_t out = 1;
+    uint16_t code_index = 0;
+    uint8_t code = 1;
+
+    for (uint16_t i = 0; i < length; i++) {
+        if (src[i] == 0) {
+            dst[code_index] = code;
+            code_index = out++;
+            code = 1;
+        }
+        else {
+            dst[out++] = src[i];
+            if (++code == 0xFF) {
+                dst[code_index] = code;
+                code_index = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[code_index] = code;
+
+    return out;
+}
+
+/**
+ * @brief Decodes a COBS block (without the terminating zero)
+ *
+ * @return decoded length, or -1 if the block isn't valid COBS
+ */
+static int32_t control_link_cobs_decode(const uint8_t *src, uint16_t length, uint8_t *dst) {
+
+    uint16_t in = 0;
+    uint16_t out = 0;
+
+    while (in < length) {
+        uint8_t code = src[in++];
+        if (code == 0 || in + code - 1 > length) {
+            return -1;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            dst[out++] = src[in++];
+        }
+        if (code < 0xFF && in < length) {
+            dst[out++] = 0;
+        }
+    }
+
+    return out;
+}
+
+/**
+ * @brief Sends an encoded frame if the UART has room (the host sends again if not)
+ */
+static void control_link_send(uint8_t *frame, uint16_t length) {
+    if (length <= event_logging_uart_space()) {
+        event_logging_write_uart_raw(frame, length);
+    }
+}
+
+/**
+ * @brief Adds the CRC to a reply, encodes it into reply and sends it
+ */
+static void control_link_send_reply(CONTROL_LINK_REPLY_FRAME *reply,
+                                    uint8_t *raw,
+                                    uint16_t length) {
+
+    uint16_t crc = control_link_crc16(raw, length);
+    raw[length++] = crc & 0xFF;
+    raw[length++] = crc >> 8;
+
+    reply->seq = raw[0];
+    reply->frame[0] = 0;
+    reply->length = control_link_cobs_encode(raw, length, &reply->frame[1]) + 1;
+    reply->frame[reply->length++] = 0;
+
+    control_link_send(reply->frame, reply->length);
+}
+
+/**
+ * @brief Handles a complete frame
+ */
+static void control_link_frame(void) {
+
+    uint8_t raw[CONTROL_LINK_MAX_FRAME];
+    int32_t length = -1;
+
+    if (!control_link.rx_overflow && control_link.rx_length <= CONTROL_LINK_MAX_FRAME) {
+        length = control_link_cobs_decode(control_link.rx_frame, control_link.rx_length, raw);
+    }
+
+    // Anything else on the UART (e.g. log text echoed back) ends up here too
+    if (length < 4 || control_link_crc16(raw, length - 2) !=
+                      (raw[length - 2] | (uint16_t) raw[length - 1] << 8)) {
+        metric_inc(control_link.bad_frames);
+        return;
+    }
+    metric_inc(control_link.frames);
+
+    uint8_t seq = raw[0];
+    uint8_t type = raw[1];
+    uint16_t payload_length = length - 4;
+
+    // A new session starts wherever the host likes
+    if (type == CONTROL_LINK_SYNC) {
+        control_link.expected_seq = seq;
+        control_link.nak_sent = false;
+        for (int i = 0; i < CONTROL_LINK_WINDOW; i++) {
+            control_link.replies[i].length = 0;
+        }
+    }
+
+    if (seq != control_link.expected_seq) {
+
+        // Already handled (its reply was lost), so send the same reply again
+        if ((uint8_t)(control_link.expected_seq - 1 - seq) < CONTROL_LINK_WINDOW) {
+            CONTROL_LINK_REPLY_FRAME *reply = &control_link.replies[seq & (CONTROL_LINK_WINDOW - 1)];
+            if (reply->length && reply->seq == seq) {
+                metric_inc(control_link.resent);
+                control_link_send(reply->frame, reply->length);
+            }
+        }
+
+        // Otherwise one went missing - ask for it once and drop everything until it arrives
+        else if (!control_link.nak_sent) {
+            CONTROL_LINK_REPLY_FRAME nak;
+            uint8_t nak_raw[5] = { control_link.expected_seq,
+                                   CONTROL_LINK_NAK | CONTROL_LINK_REPLY,
+                                   CONTROL_LINK_STATUS_OK };
+            control_link_send_reply(&nak, nak_raw, 3);
+            control_link.nak_sent = true;
+        }
+        return;
+    }
+
+    // The message is copied out so the reply can be built over it
+    uint8_t payload[CONTROL_LINK_MAX_PAYLOAD];
+    for (uint16_t i = 0; i < payload_length; i++) {
+        payload[i] = raw[2 + i];
+    }
+
+    uint16_t reply_length = 0;
+    uint8_t status;
+
+    if (type == CONTROL_LINK_SYNC) {
+        raw[3] = CONTROL_LINK_VERSION;
+        raw[4] = CONTROL_LINK_WINDOW;
+        raw[5] = CONTROL_LINK_MAX_PAYLOAD & 0xFF;
+        raw[6] = CONTROL_LINK_MAX_PAYLOAD >> 8;
+        reply_length = 4;
+        status = CONTROL_LINK_STATUS_OK;
+    }
+    else if (payload_length > CONTROL_LINK_MAX_PAYLOAD) {
+        status = CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+    else {
+        status = control_link.handler(type, payload, payload_length, &raw[3], &reply_length);
+        if (reply_length > CONTROL_LINK_MAX_PAYLOAD) {
+            reply_length = 0;
+        }
+    }
+
+    raw[0] = seq;
+    raw[1] = type | CONTROL_LINK_REPLY;
+    raw[2] = status;
+
+    control_link.expected_seq = seq + 1;
+    control_link.nak_sent = false;
+
+    control_link_send_reply(&control_link.replies[seq & (CONTROL_LINK_WINDOW - 1)],
+                            raw, 3 + reply_length);
+}
+
+/**
+ * @brief Starts the control link
+ *
+ * The event log must already be connected to the UART.
+ *
+ * @param handler called with each message from the host
+ * @return true if successful
+ */
+bool control_link_initialize(BM_CONTROL_LINK_HANDLER handler) {
+
+    if (handler == NULL) {
+        return false;
+    }
+
+    control_link.rx_length = 0;
+    control_link.rx_overflow = false;
+    control_link.expected_seq = 0;
+    control_link.nak_sent = false;
+    for (int i = 0; i < CONTROL_LINK_WINDOW; i++) {
+        control_link.replies[i].length = 0;
+    }
+
+    control_link.frames = metrics_counter("link.frames");
+    control_link.bad_frames = metrics_counter("link.bad_frames");
+    control_link.resent = metrics_counter("link.resent");
+
+    control_link.handler = handler;
+
+    return true;
+}
+
+/**
+ * @brief Handles the messages that have arrived from the host
+ *
+ * Call this from the ARM background loop.
+ */
+void control_link_poll(void) {
+
+    if (control_link.handler == NULL || event_logging_uart_held()) {
+        return;
+    }
+
+    event_logging_hold_uart(true);
+
+    uint8_t bytes[CONTROL_LINK_READ_CHUNK];
+    uint16_t count;
+
+    while ((count = event_logging_read_uart_raw(bytes, sizeof(bytes))) > 0) {
+        for (uint16_t i = 0; i < count; i++) {
+
+            if (bytes[i] == 0) {
+                if (control_link.rx_length) {
+                    control_link_frame();
+                }
+                control_link.rx_length = 0;
+                control_link.rx_overflow = false;
+            }
+            else if (control_link.rx_length < CONTROL_LINK_MAX_ENCODED) {
+                control_link.rx_frame[control_link.rx_length++] = bytes[i];
+            }
+            else {
+                control_link.rx_overflow = true;
+            }
+        }
+    }
+
+    event_logging_hold_uart(false);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for the host control link
+ *
+ */
+#ifndef _BM_CONTROL_LINK_H_
+#define _BM_CONTROL_LINK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Largest message payload in either direction (a reply's status byte is not counted)
+#define CONTROL_LINK_MAX_PAYLOAD     (240)
+
+/*
+ * Messages the host may have sent but not had acknowledged (a power of two).
+ * This many frames must fit in the UART receive buffer.
+ */
+#define CONTROL_LINK_WINDOW          (4)
+
+#define CONTROL_LINK_VERSION         (1)
+
+// Message types handled by the link itself; the others are passed to the handler
+#define CONTROL_LINK_SYNC            (0x00)    // resets the sequence, reply is version, window, max payload (u16)
+#define CONTROL_LINK_NAK             (0x7F)    // reply only: seq is the message the target is waiting for
+
+// A reply's type is the message type with this bit set
+#define CONTROL_LINK_REPLY           (0x80)
+
+// Status of a reply (the handler may add its own from CONTROL_LINK_STATUS_USER)
+#define CONTROL_LINK_STATUS_OK           (0)
+#define CONTROL_LINK_STATUS_BAD_TYPE     (1)
+#define CONTROL_LINK_STATUS_BAD_LENGTH   (2)
+#define CONTROL_LINK_STATUS_USER         (16)
+
+/*
+ * Handles one message, called from control_link_poll() in order of sequence
+ * number and only once per message.  Fill in up to CONTROL_LINK_MAX_PAYLOAD
+ * bytes of reply, set reply_length and return the status.
+ */
+typedef uint8_t (*BM_CONTROL_LINK_HANDLER)(uint8_t type,
+                                           const uint8_t *payload,
+                                           uint16_t length,
+                                           uint8_t *reply,
+                                           uint16_t *reply_length);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ARM only - the link runs over the event log UART
+bool control_link_initialize(BM_CONTROL_LINK_HANDLER handler);
+void control_link_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_CONTROL_LINK_H_
@@ -9,12 +9,20 @@
  * @brief      basic event logging functionality
  */
 #include <math.h>
+#include <stdarg.h>
 #include <services/int/adi_int.h>
 
 #include "drivers/bm_sysctrl_driver/bm_system_control.h"
 
 #include "bm_event_logging.h"
 
+// Number of argument words taken by each format in event_log_formats.h
+#define EVENT_LOG_FORMAT_ARGS(id, args, format)   args,
+static const uint8_t event_log_format_args[EVENT_LOG_FORMATS_COUNT] = {
+    EVENT_LOG_FORMATS(EVENT_LOG_FORMAT_ARGS)
+};
+#undef EVENT_LOG_FORMAT_ARGS
+
 /**
  * The code below is only compiled on the ARM processor not on the SHARC cores
  */
@@ -25,13 +33,26 @@
 // State structure that keeps track of everything related to the event monitoring
 BM_EVENT_LOGGER_STATE event_logger_state;
 
+// Format strings, used to build the text of events logged with log_event_fmt()
+#define EVENT_LOG_FORMAT_STRING(id, args, format)   format,
+static const char *const event_log_format_strings[EVENT_LOG_FORMATS_COUNT] = {
+    EVENT_LOG_FORMATS(EVENT_LOG_FORMAT_STRING)
+};
+#undef EVENT_LOG_FORMAT_STRING
+
 // Function prototypes
 static void event_logging_make_timestamp(BM_SYSTEM_EVENT *event,
                                          uint64_t millis_timestamp,
                                          uint64_t emuclk);
 static bool event_logging_send_event_to_uart(BM_SYSTEM_EVENT *event);
+static bool event_logging_send_event_to_uart_binary(BM_SYSTEM_EVENT *event);
+static void event_logging_expand_message(BM_SYSTEM_EVENT *event,
+                                         char *text,
+                                         uint32_t text_len);
 static bool event_logging_add_local_event(BM_SYSTEM_EVENT_LEVEL event_level,
                                           char *message,
+                                          uint32_t format_id,
+                                          uint32_t *args,
                                           BM_SYSTEM_EVENT_SOURCE event_source);
 static void event_logging_service_uart(void);
 
@@ -59,47 +80,31 @@ bool event_logging_set_error_callback(void (*error_callback)(uint32_t, void *))
 /**
  * @brief Initializes the event logging system on the ARM
  *
- * The event logging system uses a handful of variables in shared L2
- * memory that allows it to receive messages from the SHARC cores.
- * The various memory pointers that this function takes as arguments
- * are these shared variables.
- *
- * @param core_1_shared_message pointer to shared message text buffer (core 1)
- * @param core_2_shared_message pointer to shared message text buffer (core 2)
- * @param core_1_shared_emuclk pointer to shared emuclk value (core 1)
- * @param core_2_shared_emuclk pointer to shared emuclk value (core 2)
- * @param core_1_shared_emuclk2 pointer to shared emuclk2 value (core 1)
- * @param core_2_shared_emuclk2 pointer to shared emuclk2 value (core 2)
- * @param core_1_shared_level pointer to shared event level value (core 1)
- * @param core_2_shared_level pointer to shared event level value (core 2)
- * @param core_1_shared_semaphore pointer to shared new mssage ready semaphore (core 1)
- * @param core_2_shared_semaphore pointer to shared new mssage ready semaphore (core 2)
+ * Each SHARC core writes its events into a ring in its own uncached L2
+ * memory and publishes the address of the ring in a shared L2 variable
+ * when it starts.  The pointers that this function takes as arguments
+ * are these shared variables.  They are cleared here, so this must be
+ * called before the SHARC cores are started.
+ *
+ * @param core_1_shared_ring pointer to shared event ring address (core 1)
+ * @param core_2_shared_ring pointer to shared event ring address (core 2)
  * @param core_clock_freq_hz frequency of processor (to convert emuclk to millis)
  *
  */
-void event_logging_initialize_arm(char *core_1_shared_message,
-                                  char *core_2_shared_message,
-                                  uint32_t *core_1_shared_emuclk,
-                                  uint32_t *core_2_shared_emuclk,
-                                  uint32_t *core_1_shared_emuclk2,
-                                  uint32_t *core_2_shared_emuclk2,
-                                  uint32_t *core_1_shared_level,
-                                  uint32_t *core_2_shared_level,
-                                  uint32_t *core_1_shared_semaphore,
-                                  uint32_t *core_2_shared_semaphore,
+void event_logging_initialize_arm(BM_EVENT_LOG_RING * volatile *core_1_shared_ring,
+                                  BM_EVENT_LOG_RING * volatile *core_2_shared_ring,
                                   float core_clock_freq_hz) {
 
     // Set the various pointers in the state structure
-    event_logger_state.sharc_core_1_shared_message = core_1_shared_message;
-    event_logger_state.sharc_core_2_shared_message = core_2_shared_message;
-    event_logger_state.sharc_core_1_shared_emuclk = core_1_shared_emuclk;
-    event_logger_state.sharc_core_2_shared_emuclk = core_2_shared_emuclk;
-    event_logger_state.sharc_core_1_shared_emuclk2 = core_1_shared_emuclk2;
-    event_logger_state.sharc_core_2_shared_emuclk2 = core_2_shared_emuclk2;
-    event_logger_state.sharc_core_1_shared_level = core_1_shared_level;
-    event_logger_state.sharc_core_2_shared_level = core_2_shared_level;
-    event_logger_state.sharc_core1_shared_semaphore = core_1_shared_semaphore;
-    event_logger_state.sharc_core2_shared_semaphore = core_2_shared_semaphore;
+    event_logger_state.sharc_core_1_shared_ring = core_1_shared_ring;
+    event_logger_state.sharc_core_2_shared_ring = core_2_shared_ring;
+
+    // Rings aren't available until the SHARC cores publish them
+    *core_1_shared_ring = NULL;
+    *core_2_shared_ring = NULL;
+
+    event_logger_state.sharc_core_1_ring_dropped = 0;
+    event_logger_state.sharc_core_2_ring_dropped = 0;
 
     // Save core clock frequency so we can turn SHARC cycles to millis
     event_logger_state.core_clock_frequency_hz = core_clock_freq_hz;
@@ -107,6 +112,7 @@ void event_logging_initialize_arm(char *core_1_shared_message,
     event_logger_state.event_log_write_indx = 0;
     event_logger_state.event_log_read_indx = 0;
     event_logger_state.messages_dropped = 0;
+    event_logger_state.uart_held = false;
 }
 
 /**
@@ -133,11 +139,87 @@ bool event_logging_connect_uart(BM_UART_BAUD_RATE baud,
 
     event_logger_state.send_events_to_uart = true;
 
+    #if !(EVENT_LOG_BINARY_UART)
     uart_write_byte(&event_logger_state.uart_instance, 0x0C);      // clear the screen
+    #endif
 
     return true;
 }
 
+/**
+ * @brief Lends the event log UART to another user
+ *
+ * While the UART is held, events are still collected from the SHARC cores
+ * and queued but nothing is sent, so raw data written with
+ * event_logging_write_uart_raw() (e.g. an audio capture dump) isn't mixed
+ * with log messages.  Queued events are sent once the UART is released.
+ *
+ * @param hold true to hold the UART, false to release it
+ */
+void event_logging_hold_uart(bool hold) {
+    event_logger_state.uart_held = hold;
+}
+
+/**
+ * @brief Returns true while the event log UART is held
+ */
+bool event_logging_uart_held(void) {
+    return event_logger_state.uart_held;
+}
+
+/**
+ * @brief Writes raw bytes to the event log UART
+ *
+ * @param data bytes to send
+ * @param length number of bytes (no more than event_logging_uart_space())
+ * @return true if the bytes were queued, false if the UART isn't connected or has no room
+ */
+bool event_logging_write_uart_raw(uint8_t *data, uint16_t length) {
+
+    if (!event_logger_state.send_events_to_uart) {
+        return false;
+    }
+
+    return uart_write_block(&event_logger_state.uart_instance, data, length) == UART_SUCCESS;
+}
+
+/**
+ * @brief Returns the room in the event log UART's transmit FIFO
+ *
+ * @return bytes that can be written without blocking (0 if the UART isn't connected)
+ */
+uint16_t event_logging_uart_space(void) {
+
+    if (!event_logger_state.send_events_to_uart) {
+        return 0;
+    }
+
+    return uart_available_for_write(&event_logger_state.uart_instance);
+}
+
+/**
+ * @brief Reads bytes received on the event log UART (e.g. from the control link)
+ *
+ * @param data filled in with the bytes
+ * @param max_length size of data
+ * @return number of bytes read (0 if none have arrived or the UART isn't connected)
+ */
+uint16_t event_logging_read_uart_raw(uint8_t *data, uint16_t max_length) {
+
+    uint16_t length = 0;
+
+    if (!event_logger_state.send_events_to_uart) {
+        return 0;
+    }
+
+    while (length < max_length &&
+           uart_read_byte(&event_logger_state.uart_instance, &data[length]) == UART_SUCCESS) {
+        length++;
+    }
+
+    return length;
+}
+
 /**
  * @brief Logs an event
  *
@@ -150,72 +232,84 @@ bool event_logging_connect_uart(BM_UART_BAUD_RATE baud,
 bool log_event(BM_SYSTEM_EVENT_LEVEL level,
                char *message) {
 
-    event_logging_add_local_event(level, message, EVENT_SRC_ARM);
+    event_logging_add_local_event(level, message, EVENT_FMT_TEXT, NULL, EVENT_SRC_ARM);
 
     return true;
 }
 
 /**
- * @brief polling routine to being over messages from the SHARC cores
+ * @brief Logs an event using a format from event_log_formats.h
  *
- * This function should be periodically called to bring messages from the SHARC cores
- * over to the ARM and to manage the flow of messages to the UART if the UART is being
- * used.  Placing this function in the ISR of the 1ms timer tick within the baremetal
- * framework provides low message latency.
+ * The arguments are stored as raw 32-bit words and the text is only built
+ * when the event is sent to the UART (or on the host in binary mode).
+ *
+ * @param level See .h file for valid enumeration inputs
+ * @param format_id Format ID from event_log_formats.h
+ * @param ... Argument words for the format (use EVENT_LOG_FLOAT() for floats)
+ * @return True if successful, false if the format ID is invalid
  */
-void event_logging_poll_sharc_cores_for_new_message(void) {
+bool log_event_fmt(BM_SYSTEM_EVENT_LEVEL level,
+                   BM_EVENT_LOG_FORMAT_ID format_id,
+                   ...) {
 
-    bool increment_pointer;
-    bool call_error_callback = false;
+    uint32_t args[EVENT_LOG_MAX_ARGS] = {0};
+    va_list arg_list;
 
-    // Check if we've dropped a message and if so, display a status message
-    if (event_logger_state.send_events_to_uart && event_logger_state.messages_dropped == true) {
-        char msg[128] = "\r\n<LOGGING ERROR - TRANSMIT FIFO FULL, MESSAGE(S) DROPPED>";
-        if (uart_available_for_write(&event_logger_state.uart_instance) > strlen(msg) + 1) {
-            uart_write_block(&event_logger_state.uart_instance, (uint8_t *)msg, strlen(msg));
-            event_logger_state.messages_dropped = false;
-        }
-        event_logging_service_uart();
+    if (format_id >= EVENT_LOG_FORMATS_COUNT) {
+        return false;
     }
 
-    // Check SHARC Core 1 for messages
-    if (*event_logger_state.sharc_core1_shared_semaphore) {
+    va_start(arg_list, format_id);
+    for (uint32_t i = 0; i < event_log_format_args[format_id]; i++) {
+        args[i] = va_arg(arg_list, uint32_t);
+    }
+    va_end(arg_list);
 
-        event_logger_state.sharc_core_1_emuclk = ((uint64_t)(*event_logger_state.sharc_core_1_shared_emuclk)) +
-                                                 (((uint64_t)(*event_logger_state.sharc_core_1_shared_emuclk2)) << 32);
+    event_logging_add_local_event(level, "", format_id, args, EVENT_SRC_ARM);
 
-        if (!event_logger_state.sharc_core_1_emuclk_calib) {
-            event_logger_state.sharc_core_1_emuclk_calib = event_logger_state.sharc_core_1_emuclk;
-            uint64_t emuclk_ticks = (uint64_t)(event_logger_state.core_clock_frequency_hz / 1000.0);
-            event_logger_state.sharc_core_1_emuclk_calib -= millis() * emuclk_ticks;
-        }
-        event_logger_state.sharc_core_1_emuclk -= event_logger_state.sharc_core_1_emuclk_calib;
+    return true;
+}
 
-        // If there's a new message, copy it from the shared memory structure
-        strcpy(event_logger_state.event_log[event_logger_state.event_log_write_indx].message,
-               event_logger_state.sharc_core_1_shared_message);
-        event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level    = (BM_SYSTEM_EVENT_LEVEL)(*event_logger_state.sharc_core_1_shared_level);
-        event_logger_state.event_log[event_logger_state.event_log_write_indx].event_source   = EVENT_SRC_SHARC_CORE1;
+/**
+ * @brief Moves all events waiting in a SHARC core's ring into the event log
+ *
+ * @param ring pointer to the SHARC core's event ring
+ * @param event_source source (SHARC1, SHARC2)
+ * @param emuclk_calib pointer to emuclk calibration for this core
+ * @param ring_dropped pointer to the dropped count already reported for this core
+ * @return True if an ERROR or FATAL event was received
+ */
+static bool event_logging_drain_sharc_ring(BM_EVENT_LOG_RING *ring,
+                                           BM_SYSTEM_EVENT_SOURCE event_source,
+                                           uint64_t *emuclk_calib,
+                                           uint32_t *ring_dropped) {
 
-        // Create a timestamp for this event based on the emuclk for that core
-        event_logging_make_timestamp(&event_logger_state.event_log[event_logger_state.event_log_write_indx],
-                                     0,
-                                     event_logger_state.sharc_core_1_emuclk);
+    bool error_received = false;
 
-        // Clear the semaphore so the SHARC can post its next message
-        (*event_logger_state.sharc_core1_shared_semaphore) = false;
+    // Ring isn't published until the SHARC core is running
+    if (ring == NULL) {
+        return false;
+    }
 
-        // If an error is encountered and an error callback provided, call the user callback
-        if (event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level == EVENT_FATAL ||
-            event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level == EVENT_ERROR) {
-            call_error_callback = true;
-        }
+    // Let the UART report that the SHARC had to drop events because its ring was full
+    if (ring->dropped != *ring_dropped) {
+        *ring_dropped = ring->dropped;
+        event_logger_state.messages_dropped = true;
+    }
+
+    uint32_t tail = ring->tail;
+    uint32_t head = ring->head;
+
+    // Don't read the records until we've seen the head that published them
+    __sync_synchronize();
 
-        // If we're using the UART, only increment the write pointer if we're not going beyond the size of our FIFO
-        increment_pointer = true;
+    while (tail != head) {
+
+        // If we're using the UART, leave events in the ring until there is room in our FIFO
+        bool increment_pointer = true;
         if (event_logger_state.send_events_to_uart) {
             if ((event_logger_state.event_log_write_indx + 1) % EVENT_LOG_QUEUE_LENGTH == event_logger_state.event_log_read_indx) {
-                increment_pointer = false;
+                break;
             }
         }
         else {
@@ -224,57 +318,54 @@ void event_logging_poll_sharc_cores_for_new_message(void) {
             event_logger_state.messages_dropped = true;
         }
 
-        // Manage our queue pointer
-        if (increment_pointer) {
-            event_logger_state.event_log_write_indx++;
-            if (event_logger_state.event_log_write_indx >= EVENT_LOG_QUEUE_LENGTH) {
-                event_logger_state.event_log_write_indx = 0;
-            }
-        }
-    }
-
-    // Check SHARC Core 2 for messages
-    if (*event_logger_state.sharc_core2_shared_semaphore) {
+        BM_SYSTEM_EVENT_SHARC *record = &ring->record[tail & (EVENT_LOG_RING_LENGTH_SHARC - 1)].event;
+        BM_SYSTEM_EVENT *event = &event_logger_state.event_log[event_logger_state.event_log_write_indx];
 
-        event_logger_state.sharc_core_2_emuclk = ((uint64_t)(*event_logger_state.sharc_core_2_shared_emuclk)) +
-                                                 (((uint64_t)(*event_logger_state.sharc_core_2_shared_emuclk2)) << 32);
+        uint64_t emuclk = ((uint64_t)record->event_emuclk) + (((uint64_t)record->event_emuclk2) << 32);
 
-        if (!event_logger_state.sharc_core_2_emuclk_calib) {
-            event_logger_state.sharc_core_2_emuclk_calib = event_logger_state.sharc_core_2_emuclk;
+        if (!(*emuclk_calib)) {
+            *emuclk_calib = emuclk;
             uint64_t emuclk_ticks = (uint64_t)(event_logger_state.core_clock_frequency_hz / 1000.0);
-            event_logger_state.sharc_core_2_emuclk_calib -= millis() * emuclk_ticks;
+            *emuclk_calib -= millis() * emuclk_ticks;
         }
-        event_logger_state.sharc_core_2_emuclk -= event_logger_state.sharc_core_2_emuclk_calib;
-
-        // If there's a new message, copy it from the shared memory structure
-        strcpy(event_logger_state.event_log[event_logger_state.event_log_write_indx].message,
-               event_logger_state.sharc_core_2_shared_message);
-        event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level    = (BM_SYSTEM_EVENT_LEVEL)(*event_logger_state.sharc_core_2_shared_level);
-        event_logger_state.event_log[event_logger_state.event_log_write_indx].event_source   = EVENT_SRC_SHARC_CORE2;
+        emuclk -= *emuclk_calib;
+
+        // Copy the event from the ring, unpacking the text that follows a text event
+        uint32_t records = 1;
+        event->message[0] = 0;
+        if (record->format_id == EVENT_FMT_TEXT) {
+            uint32_t text_length = record->args[0];
+            if (text_length > EVENT_LOG_MESSAGE_LEN - 1) {
+                text_length = EVENT_LOG_MESSAGE_LEN - 1;
+            }
+            records += (text_length + EVENT_LOG_RECORD_CHARS - 1) / EVENT_LOG_RECORD_CHARS;
+            if (head - tail < records) {
+                break;
+            }
+            for (uint32_t i = 0; i < text_length; i++) {
+                uint32_t word = ring->record[(tail + 1 + i / EVENT_LOG_RECORD_CHARS) & (EVENT_LOG_RING_LENGTH_SHARC - 1)]
+                                    .text[(i % EVENT_LOG_RECORD_CHARS) / 4];
+                event->message[i] = (char)(word >> (8 * (i % 4)));
+            }
+            event->message[text_length] = 0;
+            event->format_id = EVENT_FMT_TEXT;
+        }
+        else if (record->format_id < EVENT_LOG_FORMATS_COUNT) {
+            memcpy(event->args, record->args, sizeof(event->args));
+            event->format_id = record->format_id;
+        }
+        else {
+            event->format_id = EVENT_FMT_TEXT;
+        }
+        event->event_level  = (BM_SYSTEM_EVENT_LEVEL)record->event_level;
+        event->event_source = event_source;
 
         // Create a timestamp for this event based on the emuclk for that core
-        event_logging_make_timestamp(&event_logger_state.event_log[event_logger_state.event_log_write_indx], 0, event_logger_state.sharc_core_2_emuclk);
-
-        // Clear the semaphore so the SHARC can post its next message
-        *event_logger_state.sharc_core2_shared_semaphore = false;
+        event_logging_make_timestamp(event, 0, emuclk);
 
         // If an error is encountered and an error callback provided, call the user callback
-        if (event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level == EVENT_FATAL ||
-            event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level == EVENT_ERROR) {
-            call_error_callback = true;
-        }
-
-        // If we're using the UART, only increment the write pointer if we're not go beyond the size of our FIFO
-        increment_pointer = true;
-        if (event_logger_state.send_events_to_uart) {
-            if ((event_logger_state.event_log_write_indx + 1) % EVENT_LOG_QUEUE_LENGTH == event_logger_state.event_log_read_indx) {
-                increment_pointer = false;
-            }
-        }
-        else {
-            // Handle FIFO overflow
-            increment_pointer = false;
-            event_logger_state.messages_dropped = true;
+        if (event->event_level == EVENT_FATAL || event->event_level == EVENT_ERROR) {
+            error_received = true;
         }
 
         // Manage our queue pointer
@@ -284,6 +375,68 @@ void event_logging_poll_sharc_cores_for_new_message(void) {
                 event_logger_state.event_log_write_indx = 0;
             }
         }
+
+        tail += records;
+    }
+
+    // Finish reading the records before handing their slots back to the SHARC
+    __sync_synchronize();
+    ring->tail = tail;
+
+    return error_received;
+}
+
+/**
+ * @brief polling routine to being over messages from the SHARC cores
+ *
+ * This function should be periodically called to bring messages from the SHARC cores
+ * over to the ARM and to manage the flow of messages to the UART if the UART is being
+ * used.  Placing this function in the ISR of the 1ms timer tick within the baremetal
+ * framework provides low message latency.
+ *
+ * Every event waiting in each SHARC core's ring is collected on each call, as long as
+ * there is room in the event log.
+ */
+void event_logging_poll_sharc_cores_for_new_message(void) {
+
+    bool call_error_callback = false;
+
+    // Check if we've dropped a message and if so, display a status message
+    if (event_logger_state.send_events_to_uart && !event_logger_state.uart_held &&
+        event_logger_state.messages_dropped == true) {
+        #if (EVENT_LOG_BINARY_UART)
+        BM_SYSTEM_EVENT dropped = {0};
+        dropped.event_level = EVENT_WARN;
+        dropped.event_source = EVENT_SRC_ARM;
+        dropped.format_id = EVENT_FMT_LOG_DROPPED;
+        event_logging_make_timestamp(&dropped, millis(), 0);
+        if (event_logging_send_event_to_uart_binary(&dropped)) {
+            event_logger_state.messages_dropped = false;
+        }
+        #else
+        char msg[128] = "\r\n<LOGGING ERROR - TRANSMIT FIFO FULL, MESSAGE(S) DROPPED>";
+        if (uart_available_for_write(&event_logger_state.uart_instance) > strlen(msg) + 1) {
+            uart_write_block(&event_logger_state.uart_instance, (uint8_t *)msg, strlen(msg));
+            event_logger_state.messages_dropped = false;
+        }
+        #endif
+        event_logging_service_uart();
+    }
+
+    // Check SHARC Core 1 for messages
+    if (event_logging_drain_sharc_ring(*event_logger_state.sharc_core_1_shared_ring,
+                                       EVENT_SRC_SHARC_CORE1,
+                                       &event_logger_state.sharc_core_1_emuclk_calib,
+                                       &event_logger_state.sharc_core_1_ring_dropped)) {
+        call_error_callback = true;
+    }
+
+    // Check SHARC Core 2 for messages
+    if (event_logging_drain_sharc_ring(*event_logger_state.sharc_core_2_shared_ring,
+                                       EVENT_SRC_SHARC_CORE2,
+                                       &event_logger_state.sharc_core_2_emuclk_calib,
+                                       &event_logger_state.sharc_core_2_ring_dropped)) {
+        call_error_callback = true;
     }
 
     // Send a few messages to the UART depending on how much room we have in the transmit fifo
@@ -307,7 +460,7 @@ void event_logging_poll_sharc_cores_for_new_message(void) {
 static void event_logging_service_uart(void) {
 
     // If we're sending events to the UART, see if we have room in the FIFO to send some
-    if (event_logger_state.send_events_to_uart) {
+    if (event_logger_state.send_events_to_uart && !event_logger_state.uart_held) {
         if (event_logger_state.event_log_read_indx != event_logger_state.event_log_write_indx) {
             bool result = false;
             do {
@@ -344,7 +497,13 @@ static void event_logging_service_uart(void) {
  */
 static bool event_logging_send_event_to_uart(BM_SYSTEM_EVENT *event) {
 
+    #if (EVENT_LOG_BINARY_UART)
+    return event_logging_send_event_to_uart_binary(event);
+    #else
+
     char stamp[64];
+    char expanded_message[EVENT_LOG_MESSAGE_LEN];
+    char *message = event->message;
 
     char *event_level;
     char *event_source;
@@ -399,7 +558,13 @@ static bool event_logging_send_event_to_uart(BM_SYSTEM_EVENT *event) {
     strcat(uart_message, stamp);
     strcat(uart_message, event_level);
     strcat(uart_message, event_source);
-    strcat(uart_message, event->message);
+
+    // Build the text for events that were logged as a format and arguments
+    if (event->format_id != EVENT_FMT_TEXT) {
+        event_logging_expand_message(event, expanded_message, EVENT_LOG_MESSAGE_LEN);
+        message = expanded_message;
+    }
+    strcat(uart_message, message);
 
     uint16_t string_length = strlen(uart_message);
 
@@ -411,21 +576,156 @@ static bool event_logging_send_event_to_uart(BM_SYSTEM_EVENT *event) {
 
     // Otherwise, return false and we can try again next time
     return false;
+    #endif
+}
+
+/**
+ * @brief sends a message to the UART as a binary frame
+ *
+ * See EVENT_LOG_BINARY_UART in the .h file for the frame layout.  Events
+ * logged with log_event_fmt() only send their format ID and argument words,
+ * which is many times shorter than the text.
+ *
+ * @param event A pointer to the event object (struct)
+ * @return False if no room in the UART FIFO, True if transmitted
+ */
+static bool event_logging_send_event_to_uart_binary(BM_SYSTEM_EVENT *event) {
+
+    uint8_t frame[8 + 1 + EVENT_LOG_MESSAGE_LEN];
+    uint16_t frame_length = 0;
+
+    frame[frame_length++] = EVENT_LOG_BINARY_SYNC;
+    frame[frame_length++] = (uint8_t)((event->event_source << 4) | (event->event_level & 0x0F));
+    frame[frame_length++] = (uint8_t)(event->format_id & 0xFF);
+    frame[frame_length++] = (uint8_t)(event->format_id >> 8);
+    for (int i = 0; i < 4; i++) {
+        frame[frame_length++] = (uint8_t)(event->timestamp_millis >> (8 * i));
+    }
+
+    if (event->format_id == EVENT_FMT_TEXT) {
+        uint8_t text_length = (uint8_t)strlen(event->message);
+        frame[frame_length++] = text_length;
+        memcpy(&frame[frame_length], event->message, text_length);
+        frame_length += text_length;
+    }
+    else {
+        for (uint32_t i = 0; i < event_log_format_args[event->format_id]; i++) {
+            for (int j = 0; j < 4; j++) {
+                frame[frame_length++] = (uint8_t)(event->args[i] >> (8 * j));
+            }
+        }
+    }
+
+    uint16_t bytes_available_for_write = uart_available_for_write(&event_logger_state.uart_instance);
+    if (bytes_available_for_write > 1024) {
+        bytes_available_for_write  = 0;
+    }
+
+    // If we have room in UART FIFO, send along
+    if (bytes_available_for_write >= frame_length) {
+        uart_write_block(&event_logger_state.uart_instance, frame, frame_length);
+        return true;
+    }
+
+    // Otherwise, return false and we can try again next time
+    return false;
+}
+
+/**
+ * @brief Builds the text of an event logged with log_event_fmt()
+ *
+ * Each conversion in the format string takes the next argument word, which
+ * is passed to snprintf as an int or, for floating point conversions, as the
+ * float it holds.
+ *
+ * @param event A pointer to the event object (struct)
+ * @param text Buffer for the text
+ * @param text_len Size of the buffer
+ */
+static void event_logging_expand_message(BM_SYSTEM_EVENT *event,
+                                         char *text,
+                                         uint32_t text_len) {
+
+    const char *format = event_log_format_strings[event->format_id];
+    uint32_t arg = 0;
+    uint32_t n = 0;
+
+    while (*format && n < text_len - 1) {
+
+        if (*format != '%') {
+            text[n++] = *format++;
+            continue;
+        }
+
+        if (format[1] == '%') {
+            text[n++] = '%';
+            format += 2;
+            continue;
+        }
+
+        // Copy the conversion specification (flags, width, precision and type)
+        char spec[16];
+        uint32_t spec_len = 0;
+        do {
+            spec[spec_len++] = *format++;
+        } while (*format && strchr("diouxXcfFeEgGs", *format) == NULL && spec_len < sizeof(spec) - 2);
+        if (*format) {
+            spec[spec_len++] = *format++;
+        }
+        spec[spec_len] = 0;
+
+        uint32_t word = (arg < EVENT_LOG_MAX_ARGS) ? event->args[arg++] : 0;
+        int written;
+
+        switch (spec[spec_len - 1]) {
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                union {
+                    uint32_t w;
+                    float f;
+                } conv;
+                conv.w = word;
+                written = snprintf(&text[n], text_len - n, spec, (double)conv.f);
+                break;
+            }
+            case 's':
+                written = snprintf(&text[n], text_len - n, "?");
+                break;
+            default:
+                written = snprintf(&text[n], text_len - n, spec, (int)word);
+                break;
+        }
+
+        // snprintf returns the length it would have written if there had been room
+        if (written > 0) {
+            n += ((uint32_t)written < text_len - 1 - n) ? (uint32_t)written : text_len - 1 - n;
+        }
+    }
+
+    text[n] = 0;
 }
 
 /**
  * @brief Creates a message object (instance of struct)
  *
  * @param event_level level of event
- * @param message text string containing message
+ * @param message text string containing message (for EVENT_FMT_TEXT)
+ * @param format_id format ID from event_log_formats.h
+ * @param args argument words for the format (NULL for EVENT_FMT_TEXT)
  * @param event_source source (ARM, SHARC1, SHARC2)
  * @return True if successful
  */
-bool event_logging_add_local_event(BM_SYSTEM_EVENT_LEVEL event_level,
-                                   char *message,
-                                   BM_SYSTEM_EVENT_SOURCE event_source) {
-
-    strcpy(event_logger_state.event_log[event_logger_state.event_log_write_indx].message, message);
+static bool event_logging_add_local_event(BM_SYSTEM_EVENT_LEVEL event_level,
+                                          char *message,
+                                          uint32_t format_id,
+                                          uint32_t *args,
+                                          BM_SYSTEM_EVENT_SOURCE event_source) {
+
+    strncpy(event_logger_state.event_log[event_logger_state.event_log_write_indx].message, message, EVENT_LOG_MESSAGE_LEN - 1);
+    event_logger_state.event_log[event_logger_state.event_log_write_indx].message[EVENT_LOG_MESSAGE_LEN - 1] = 0;
+    event_logger_state.event_log[event_logger_state.event_log_write_indx].format_id = format_id;
+    if (args != NULL) {
+        memcpy(event_logger_state.event_log[event_logger_state.event_log_write_indx].args, args, sizeof(uint32_t) * EVENT_LOG_MAX_ARGS);
+    }
     event_logger_state.event_log[event_logger_state.event_log_write_indx].event_level = event_level;
     event_logger_state.event_log[event_logger_state.event_log_write_indx].event_source = event_source;
     uint64_t stamp = millis();
@@ -485,6 +785,9 @@ static void event_logging_make_timestamp(BM_SYSTEM_EVENT *event,
         millis_timestamp = (uint64_t)(emuclk2 / divider);
     }
 
+    // Raw timestamp for binary frames
+    event->timestamp_millis = (uint32_t)millis_timestamp;
+
     // Calculate days
     uint32_t days = (uint32_t)floor(((float)millis_timestamp) / (1000.0 * 60.0 * 60.0 * 24.0));
     millis_timestamp = millis_timestamp - (uint64_t)(days * 1000 * 60 * 60 * 24);
@@ -524,116 +827,190 @@ static void event_logging_make_timestamp(BM_SYSTEM_EVENT *event,
 #include <services/dma/adi_dma.h>
 #include <services/int/adi_sec.h>
 
-// Event queue and indexes for each SHARC core
-BM_SYSTEM_EVENT_SHARC event_queue[EVENT_LOG_QUEUE_LENGTH_SHARC];
-uint32_t event_queue_read_ptr = 0;
-uint32_t event_queue_write_ptr = 0;
+#include <sysreg.h>
+
+/*
+ * Event ring for this SHARC core.  It lives in this core's uncached L2
+ * (normally used by MCAPI, which is not used by this framework) so the ARM
+ * sees every write without any cache maintenance.
+ */
+#pragma alignment_region(EVENT_LOG_CACHE_LINE_BYTES)
+#pragma section("seg_l2_uncached")
+static BM_EVENT_LOG_RING event_ring;
+#pragma alignment_region_end
+
+// Ensures ring writes have completed before the head is moved
+#define EVENT_LOG_RING_SYNC()   asm volatile("sync;")
+
+/**
+ * @brief Claims the next records in the ring
+ *
+ * Interrupts are masked until the records are published, as events are logged
+ * from both the timer tick and the background loop.  If the ring is full, the
+ * event is counted as dropped so the ARM can report it.
+ *
+ * @param records number of records needed for the event
+ * @param head returns the head index of the first record
+ * @param interrupts_enabled returns whether interrupts were enabled
+ * @return Pointer to the first record or NULL if the ring is full
+ */
+static BM_SYSTEM_EVENT_SHARC *event_logging_claim_records(uint32_t records,
+                                                          uint32_t *head,
+                                                          uint32_t *interrupts_enabled) {
+
+    *interrupts_enabled = sysreg_read(sysreg_MODE1) & IRPTEN;
+    sysreg_bit_clr(sysreg_MODE1, IRPTEN);
 
-// Pointers to our shared memory structure
-char         *event_shared_message;
-uint32_t    *event_shared_emuclk;
-uint32_t    *event_shared_emuclk2;
-uint32_t    *event_shared_level;
-uint32_t    *event_shared_semaphore;
+    *head = event_ring.head;
+
+    if (*head - event_ring.tail > EVENT_LOG_RING_LENGTH_SHARC - records) {
+        event_ring.dropped++;
+        if (*interrupts_enabled) {
+            sysreg_bit_set(sysreg_MODE1, IRPTEN);
+        }
+        return NULL;
+    }
+
+    return &event_ring.record[*head & (EVENT_LOG_RING_LENGTH_SHARC - 1)].event;
+}
+
+/**
+ * @brief Timestamps claimed records and hands them to the ARM
+ *
+ * @param record pointer to the record returned by event_logging_claim_records()
+ * @param level is the level (info, debug, etc.) of the event
+ * @param records number of records claimed for the event
+ * @param head head index of the first record
+ * @param interrupts_enabled whether interrupts were enabled when the records were claimed
+ */
+static void event_logging_publish_records(BM_SYSTEM_EVENT_SHARC *record,
+                                          BM_SYSTEM_EVENT_LEVEL level,
+                                          uint32_t records,
+                                          uint32_t head,
+                                          uint32_t interrupts_enabled) {
+
+    uint64_t emuclk = __builtin_emuclk();
+    record->event_level   = (uint32_t)level;
+    record->event_emuclk  = (uint32_t)(0xFFFFFFFF & emuclk);
+    record->event_emuclk2 = (uint32_t)(0xFFFFFFFF & (emuclk >> 32));
+
+    // Publish the records
+    EVENT_LOG_RING_SYNC();
+    event_ring.head = head + records;
+
+    if (interrupts_enabled) {
+        sysreg_bit_set(sysreg_MODE1, IRPTEN);
+    }
+}
 
 /**
  * @brief Logs an event
  *
- * Logs an event based on the provided string and event level
+ * Logs an event based on the provided string and event level.  The event is
+ * written straight into the ring that the ARM reads from, so this never waits
+ * on the ARM.  If the ring is full, the event is dropped and counted so the
+ * ARM can report it.  The text takes one ring record per
+ * EVENT_LOG_RECORD_CHARS characters after the event itself, so
+ * log_event_fmt() should be preferred for anything logged often.  Messages
+ * longer than EVENT_LOG_MESSAGE_LEN - 1 are truncated.
  *
  * @param level is the level (info, debug, etc.) of the event
  * @param message is the contents of the message
  *
- * @return true if successful, false if not
+ * @return true if successful, false if the ring was full
  */
 bool log_event(BM_SYSTEM_EVENT_LEVEL level,
                char *message) {
 
-    if (strlen(message) > EVENT_LOG_MESSAGE_LEN) {
-        return false;
+    uint32_t head, interrupts_enabled;
+
+    uint32_t text_length = 0;
+    while (text_length < EVENT_LOG_MESSAGE_LEN - 1 && message[text_length] != 0) {
+        text_length++;
     }
+    uint32_t records = 1 + (text_length + EVENT_LOG_RECORD_CHARS - 1) / EVENT_LOG_RECORD_CHARS;
 
-    if ((event_queue_write_ptr + 1) % EVENT_LOG_QUEUE_LENGTH_SHARC == event_queue_read_ptr) {
+    BM_SYSTEM_EVENT_SHARC *record = event_logging_claim_records(records, &head, &interrupts_enabled);
+    if (record == NULL) {
         return false;
     }
 
-    strcpy(event_queue[event_queue_write_ptr].message, message);
-    event_queue[event_queue_write_ptr].event_level = level;
-    event_queue[event_queue_write_ptr].event_emuclk = __builtin_emuclk();
+    record->format_id = EVENT_FMT_TEXT;
+    record->args[0] = text_length;
 
-    event_queue_write_ptr++;
-    if (event_queue_write_ptr >= EVENT_LOG_QUEUE_LENGTH_SHARC) {
-        event_queue_write_ptr = 0;
+    // Pack the text into the records that follow, 4 characters to a word
+    for (uint32_t i = 0; i < text_length; i += 4) {
+        uint32_t word = 0;
+        for (uint32_t j = 0; j < 4 && i + j < text_length; j++) {
+            word |= ((uint32_t)(uint8_t)message[i + j]) << (8 * j);
+        }
+        event_ring.record[(head + 1 + i / EVENT_LOG_RECORD_CHARS) & (EVENT_LOG_RING_LENGTH_SHARC - 1)]
+            .text[(i % EVENT_LOG_RECORD_CHARS) / 4] = word;
     }
 
+    event_logging_publish_records(record, level, records, head, interrupts_enabled);
+
     return true;
 }
 
 /**
- * @brief Initialize event messages on a SHARC core
+ * @brief Logs an event using a format from event_log_formats.h
  *
- * Similar to the init function on the ARM core, this function sets pointers
- * to variables in shared L2 memory that are used to pass messages from
- * the SHARC cores to the ARM
+ * Only the format ID and the argument words are written to the ring; the
+ * text is built later by the ARM or the host.  This avoids the sprintf and
+ * string copy of log_event(), so it is cheap enough to use from the audio
+ * callback.
  *
- * @param shared_message pointer to shared string for message
- * @param shared_emuclk pointer to shared emuclk value
- * @param shared_emuclk2 pointer to shared emuclk value2
- * @param shared_level pointer to shared event level value
- * @param shared_semaphore pointer to shared semaphore value
- * @return True
+ * @param level is the level (info, debug, etc.) of the event
+ * @param format_id Format ID from event_log_formats.h
+ * @param ... Argument words for the format (use EVENT_LOG_FLOAT() for floats)
+ *
+ * @return true if successful, false if the ring was full or the format ID is invalid
  */
-bool event_logging_initialize_sharc_core(char *shared_message,
-                                         uint32_t *shared_emuclk,
-                                         uint32_t *shared_emuclk2,
-                                         uint32_t *shared_level,
-                                         uint32_t *shared_semaphore) {
-
-    // Set shared variables
-    event_shared_message = shared_message;
-    event_shared_emuclk  = shared_emuclk;
-    event_shared_emuclk2 = shared_emuclk2;
-    event_shared_level   = shared_level;
-    event_shared_semaphore = shared_semaphore;
+#pragma optimize_for_speed
+bool log_event_fmt(BM_SYSTEM_EVENT_LEVEL level,
+                   BM_EVENT_LOG_FORMAT_ID format_id,
+                   ...) {
+
+    uint32_t head, interrupts_enabled;
+    va_list arg_list;
+
+    if (format_id >= EVENT_LOG_FORMATS_COUNT) {
+        return false;
+    }
+
+    BM_SYSTEM_EVENT_SHARC *record = event_logging_claim_records(1, &head, &interrupts_enabled);
+    if (record == NULL) {
+        return false;
+    }
+
+    record->format_id = format_id;
+    va_start(arg_list, format_id);
+    for (uint32_t i = 0; i < event_log_format_args[format_id]; i++) {
+        record->args[i] = va_arg(arg_list, uint32_t);
+    }
+    va_end(arg_list);
+
+    event_logging_publish_records(record, level, 1, head, interrupts_enabled);
 
     return true;
 }
 
 /**
- * @brief Manages the flow of messages from SHARC to ARM
+ * @brief Initialize event messages on a SHARC core
  *
- * This function should be called periodically to move messages logged on
- * a SHARC core to the ARM.  It works well in the 1ms tick event provided
- * by the sysctrl_simple driver
+ * Similar to the init function on the ARM core, this function publishes the
+ * address of this core's event ring in a variable in shared L2 memory so the
+ * ARM can start collecting events.  Events logged before this is called are
+ * kept in the ring.
  *
+ * @param shared_ring pointer to shared variable for the ring address
  * @return True
  */
-bool event_logging_process_queue_sharc_core(void) {
+bool event_logging_initialize_sharc_core(BM_EVENT_LOG_RING * volatile *shared_ring) {
 
-    // If no new messages, return
-    if (event_queue_read_ptr == event_queue_write_ptr) {
-        return true;
-    }
-
-    // Don't send anything until the last message has been picked up
-    if (!(*event_shared_semaphore)) {
-
-        // terminate string just in case
-        event_queue[event_queue_read_ptr].message[EVENT_LOG_MESSAGE_LEN - 2] = 0;
+    *shared_ring = &event_ring;
 
-        // Copy the event from our queue into shared memory
-        memcpy(event_shared_message, event_queue[event_queue_read_ptr].message, EVENT_LOG_MESSAGE_LEN - 1);
-        (*event_shared_level)  = (uint32_t)event_queue[event_queue_read_ptr].event_level;
-        (*event_shared_emuclk)  = (uint32_t)(0xFFFFFFFF & event_queue[event_queue_read_ptr].event_emuclk);
-        (*event_shared_emuclk2) = (uint32_t)(0xFFFFFFFF & (event_queue[event_queue_read_ptr].event_emuclk >> 32));
-
-        // memcpy( (void *) event_queue_shared_event, (void *) &event_queue[event_queue_read_ptr], sizeof(BM_SYSTEM_EVENT_SHARC) );
-        event_queue_read_ptr++;
-        if (event_queue_read_ptr >= EVENT_LOG_QUEUE_LENGTH_SHARC) {
-            event_queue_read_ptr = 0;
-        }
-        *event_shared_semaphore = true;
-    }
     return true;
 }
 
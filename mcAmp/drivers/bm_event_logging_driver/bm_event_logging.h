@@ -13,12 +13,35 @@
 #include "drivers/bm_gpio_driver/bm_gpio.h"
 #include "drivers/bm_uart_driver/bm_uart.h"
 
+// Format strings for log_event_fmt()
+#include "common/event_log_formats.h"
+
 // Global event messaging parameters
 #define EVENT_LOG_MESSAGE_LEN        (128)
 #define EVENT_LOG_QUEUE_LENGTH       (128)
-#define EVENT_LOG_QUEUE_LENGTH_SHARC (16)
 #define EVENT_LOG_PRINT_DAYS         (false)
 
+// Maximum number of argument words for log_event_fmt()
+#define EVENT_LOG_MAX_ARGS           (4)
+
+/*
+ * Send events to the UART as binary frames rather than text.  Use
+ * tools/event_log_decoder.py on the host to turn them back into text.
+ * Each frame is:
+ *
+ *   sync (0xA5), source << 4 | level, format ID (16-bit), timestamp ms (32-bit),
+ *   then either the argument words (32-bit each, count from the format table)
+ *   or, for EVENT_FMT_TEXT, a length byte followed by the text.
+ *
+ * All multi-byte values are little endian.
+ */
+#define EVENT_LOG_BINARY_UART        (false)
+#define EVENT_LOG_BINARY_SYNC        (0xA5)
+
+// Records in each SHARC core's event ring (must be a power of two)
+#define EVENT_LOG_RING_LENGTH_SHARC  (64)
+#define EVENT_LOG_CACHE_LINE_BYTES   (64)
+
 // State and data structs
 typedef enum {
     EVENT_NONE = 0,
@@ -45,37 +68,75 @@ typedef struct
     uint8_t time_minutes;
     uint8_t time_hours;
     uint32_t time_days;
+    uint32_t timestamp_millis;
+    uint32_t format_id;
+    uint32_t args[EVENT_LOG_MAX_ARGS];
 } BM_SYSTEM_EVENT;
 
+/*
+ * Event record passed from a SHARC core to the ARM.  This is shared between
+ * the cores so it only uses 32-bit fields (the 64-bit emuclk is split).  The
+ * ARM builds the text from the format ID and argument words.
+ */
 typedef struct
 {
-    uint64_t event_emuclk;
+    uint32_t event_emuclk;
+    uint32_t event_emuclk2;
     uint32_t event_level;
-    char message[EVENT_LOG_MESSAGE_LEN];
+    uint32_t format_id;
+    uint32_t args[EVENT_LOG_MAX_ARGS];
 } BM_SYSTEM_EVENT_SHARC;
 
+#define EVENT_LOG_RECORD_WORDS       (4 + EVENT_LOG_MAX_ARGS)
+#define EVENT_LOG_RECORD_CHARS       (EVENT_LOG_RECORD_WORDS * 4)
+
+/*
+ * A slot in a SHARC core's event ring.  Events logged with log_event() as
+ * text (EVENT_FMT_TEXT) carry the text length in args[0], and the text
+ * follows in the next slots, packed 4 characters to a word with the first
+ * character in the low byte.
+ */
+typedef union
+{
+    BM_SYSTEM_EVENT_SHARC event;
+    uint32_t text[EVENT_LOG_RECORD_WORDS];
+} BM_EVENT_LOG_RING_RECORD;
+
+/*
+ * Single-producer / single-consumer ring that carries events from a SHARC
+ * core (producer) to the ARM (consumer).  Head and tail increase forever and
+ * are masked to index the records, so the ring is full when head - tail
+ * equals its length.  Each index sits on its own cache line as it is only
+ * written by one side.
+ */
+typedef struct
+{
+    // Written by the SHARC only
+    volatile uint32_t head;
+    volatile uint32_t dropped;
+    uint32_t producer_pad[EVENT_LOG_CACHE_LINE_BYTES / sizeof(uint32_t) - 2];
+
+    // Written by the ARM only
+    volatile uint32_t tail;
+    uint32_t consumer_pad[EVENT_LOG_CACHE_LINE_BYTES / sizeof(uint32_t) - 1];
+
+    BM_EVENT_LOG_RING_RECORD record[EVENT_LOG_RING_LENGTH_SHARC];
+} BM_EVENT_LOG_RING;
+
 typedef struct
 {
 
-    // Pointers into shared L2 memory for retrieving messages from SHARCs
-    char *sharc_core_1_shared_message;
-    char *sharc_core_2_shared_message;
-    uint32_t*sharc_core_1_shared_emuclk;
-    uint32_t*sharc_core_1_shared_emuclk2;
-    uint32_t *sharc_core_2_shared_emuclk;
-    uint32_t *sharc_core_2_shared_emuclk2;
-    uint32_t *sharc_core_1_shared_level;
-    uint32_t *sharc_core_2_shared_level;
-
-    // SHARC EMUCLK (cycle count) values
-    uint64_t sharc_core_1_emuclk;
-    uint64_t sharc_core_2_emuclk;
+    // Pointers into shared L2 memory where the SHARCs publish their event rings
+    BM_EVENT_LOG_RING * volatile *sharc_core_1_shared_ring;
+    BM_EVENT_LOG_RING * volatile *sharc_core_2_shared_ring;
+
+    // SHARC EMUCLK (cycle count) calibration values
     uint64_t sharc_core_1_emuclk_calib;
     uint64_t sharc_core_2_emuclk_calib;
 
-    // Shared semaphore to know when new messages ready
-    uint32_t *sharc_core1_shared_semaphore;
-    uint32_t *sharc_core2_shared_semaphore;
+    // Dropped counts from the SHARC rings that have already been reported
+    uint32_t sharc_core_1_ring_dropped;
+    uint32_t sharc_core_2_ring_dropped;
 
     // Call back for ERROR and FATAL events
     void (*error_handling_callback)(uint32_t, void *);
@@ -84,6 +145,9 @@ typedef struct
     bool send_events_to_uart;
     BM_UART uart_instance;
 
+    // Events stay queued while another user has the UART (see event_logging_hold_uart())
+    bool uart_held;
+
     // System clock frequency for calculating time stamps
     float core_clock_frequency_hz;
 
@@ -98,6 +162,18 @@ typedef struct
 
 extern BM_EVENT_LOGGER_STATE event_logger_state;
 
+// Passes a float to log_event_fmt() as a 32-bit argument word
+#define EVENT_LOG_FLOAT(x)  event_log_float_to_word((float)(x))
+
+static inline uint32_t event_log_float_to_word(float value) {
+    union {
+        float f;
+        uint32_t w;
+    } conv;
+    conv.f = value;
+    return conv.w;
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -106,17 +182,14 @@ extern "C" {
 bool log_event(BM_SYSTEM_EVENT_LEVEL level,
                char *message);
 
+// SHARC and ARM - log an event as a format ID and argument words (see event_log_formats.h)
+bool log_event_fmt(BM_SYSTEM_EVENT_LEVEL level,
+                   BM_EVENT_LOG_FORMAT_ID format_id,
+                   ...);
+
 // ARM only - Inializes event messaging on the ARM core
-void event_logging_initialize_arm(char *core_1_shared_message,
-                                  char *core_2_shared_message,
-                                  uint32_t *core_1_shared_emuclk,
-                                  uint32_t *core_2_shared_emuclk,
-                                  uint32_t *core_1_shared_emuclk2,
-                                  uint32_t *core_2_shared_emuclk2,
-                                  uint32_t *core_1_shared_level,
-                                  uint32_t *core_2_shared_level,
-                                  uint32_t *core_1_shared_semaphore,
-                                  uint32_t *core_2_shared_semaphore,
+void event_logging_initialize_arm(BM_EVENT_LOG_RING * volatile *core_1_shared_ring,
+                                  BM_EVENT_LOG_RING * volatile *core_2_shared_ring,
                                   float core_clock_freq_hz);
 
 // ARM only - connects messaging system to UART
@@ -130,15 +203,15 @@ bool event_logging_set_error_callback(void (*error_callback)(uint32_t, void *));
 // ARM only - polling function to move messages from SHARCs, and to UART
 void event_logging_poll_sharc_cores_for_new_message(void);
 
+// ARM only - lends the event log UART to another user (e.g. a bulk dump) and gives it back
+void event_logging_hold_uart(bool hold);
+bool event_logging_uart_held(void);
+bool event_logging_write_uart_raw(uint8_t *data, uint16_t length);
+uint16_t event_logging_uart_space(void);
+uint16_t event_logging_read_uart_raw(uint8_t *data, uint16_t max_length);
+
 // SHARC only - Initializes event messaging on a SHARC core
-bool event_logging_initialize_sharc_core(char *shared_event,
-                                         uint32_t *shared_emuclk,
-                                         uint32_t *shared_emuclk2,
-                                         uint32_t *shared_level,
-                                         uint32_t *shared_semaphore);
-
-// SHARC only - polling function to move messages to ARM
-bool event_logging_process_queue_sharc_core(void);
+bool event_logging_initialize_sharc_core(BM_EVENT_LOG_RING * volatile *shared_ring);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for inter-core message queues.
+ *
+ * Each queue carries fixed-size messages from one producer core to one
+ * consumer core.  Queues live in shared, uncached L2 (normally as fields of
+ * MULTICORE_DATA, declared with IPC_QUEUE()) so all three cores can reach
+ * them, and are set up by the ARM before the SHARC cores are started.
+ *
+ * The producer only writes head and the consumer only writes tail, so there
+ * is no locking and no read-modify-write of a word another core writes -
+ * unlike a flag that one core sets and another clears.  head and tail count
+ * messages forever and are masked to index the ring.  A message is copied
+ * in before head moves past it, and copied out before tail does, with a
+ * barrier in between so the other core never sees the index move first.
+ * A queue must only be pushed from one interrupt level on the producer and
+ * popped from one on the consumer.
+ *
+ * A consumer that wants to be told when messages arrive, rather than
+ * checking the queue, calls ipc_queue_enable_doorbell().  This installs a
+ * handler for one of the SEC interrupts from the trigger routing unit
+ * (INTR_TRU0_INTn) on the consumer core and stores the interrupt in the
+ * queue.  Every push then raises it through the SEC, the same way the audio
+ * frameworks raise their audio callback interrupt.  The handler should
+ * drain the queue; a push that arrives while it is running raises the
+ * interrupt again.
+ *
+ * @file       bm_ipc_queue.c
+ * @brief      single-producer, single-consumer message queues between cores
+ */
+#include <stddef.h>
+#include <sys/platform.h>
+#include <services/int/adi_int.h>
+
+#include "bm_ipc_queue.h"
+
+#if defined(CORE0)
+#define IPC_QUEUE_SYNC()            __sync_synchronize()
+#else
+#define IPC_QUEUE_SYNC()            asm volatile("sync;")
+#endif
+
+// Doorbells each core can have enabled
+#define IPC_QUEUE_MAX_DOORBELLS     (4)
+
+typedef struct
+{
+    BM_IPC_QUEUE *queue;
+    BM_IPC_QUEUE_DOORBELL_CALLBACK callback;
+    void *arg;
+} IPC_QUEUE_DOORBELL;
+
+static IPC_QUEUE_DOORBELL ipc_queue_doorbells[IPC_QUEUE_MAX_DOORBELLS];
+static uint32_t ipc_queue_doorbell_count = 0;
+
+/**
+ * @brief Returns a pointer to message n of the ring (n is masked)
+ */
+static inline uint32_t *ipc_queue_message(BM_IPC_QUEUE *queue, uint32_t n) {
+    return (uint32_t *)(queue + 1) + (n & (queue->capacity - 1)) * queue->message_words;
+}
+
+/**
+ * @brief Sets up an empty queue
+ *
+ * This should be called once (normally by the ARM before the SHARC cores
+ * start), before either core uses the queue.
+ *
+ * @param queue pointer to the queue declared with IPC_QUEUE()
+ * @param message_size sizeof() the message type (a whole number of 32-bit words)
+ * @param capacity number of messages the queue holds (a power of two)
+ * @return true if successful, false if the size or capacity is invalid
+ */
+bool ipc_queue_initialize(BM_IPC_QUEUE *queue,
+                          uint32_t message_size,
+                          uint32_t capacity) {
+
+    if (queue == NULL || message_size == 0 || message_size % sizeof(uint32_t)) {
+        return false;
+    }
+    if (capacity == 0 || (capacity & (capacity - 1))) {
+        return false;
+    }
+
+    queue->head = 0;
+    queue->tail = 0;
+    queue->message_words = message_size / sizeof(uint32_t);
+    queue->capacity = capacity;
+    queue->doorbell = 0;
+    queue->dropped = 0;
+
+    return true;
+}
+
+/**
+ * @brief Copies messages in and publishes them (no doorbell)
+ *
+ * @return number of messages pushed
+ */
+#pragma optimize_for_speed
+static uint32_t ipc_queue_write(BM_IPC_QUEUE *queue,
+                                const uint32_t *src,
+                                uint32_t count) {
+
+    uint32_t head = queue->head;
+    uint32_t space = queue->capacity - (head - queue->tail);
+    uint32_t words = queue->message_words;
+
+    if (count > space) {
+        queue->dropped += count - space;
+        count = space;
+    }
+
+    for (uint32_t n = 0; n < count; n++) {
+        uint32_t *dst = ipc_queue_message(queue, head + n);
+        for (uint32_t i = 0; i < words; i++) {
+            *dst++ = *src++;
+        }
+    }
+
+    // The messages are complete before head moves past them
+    IPC_QUEUE_SYNC();
+    queue->head = head + count;
+
+    return count;
+}
+
+/**
+ * @brief Rings the consumer's doorbell, if it has one
+ */
+static inline void ipc_queue_ring(BM_IPC_QUEUE *queue) {
+    uint32_t doorbell = queue->doorbell;
+    if (doorbell) {
+        *pREG_SEC0_RAISE = doorbell;
+    }
+}
+
+/**
+ * @brief Pushes a message (producer core only)
+ *
+ * @param queue pointer to the queue
+ * @param message message to copy in
+ * @return true if successful, false if the queue is full (the message is counted as dropped)
+ */
+bool ipc_queue_push(BM_IPC_QUEUE *queue, const void *message) {
+
+    if (!ipc_queue_write(queue, (const uint32_t *) message, 1)) {
+        return false;
+    }
+    ipc_queue_ring(queue);
+    return true;
+}
+
+/**
+ * @brief Pushes several messages with a single doorbell (producer core only)
+ *
+ * @param queue pointer to the queue
+ * @param messages array of messages to copy in
+ * @param count number of messages
+ * @return number of messages pushed (the rest are counted as dropped)
+ */
+uint32_t ipc_queue_push_batch(BM_IPC_QUEUE *queue,
+                              const void *messages,
+                              uint32_t count) {
+
+    uint32_t pushed = ipc_queue_write(queue, (const uint32_t *) messages, count);
+    if (pushed) {
+        ipc_queue_ring(queue);
+    }
+    return pushed;
+}
+
+/**
+ * @brief Pops up to max_count messages (consumer core only)
+ *
+ * @param queue pointer to the queue
+ * @param messages array the messages are copied into
+ * @param max_count size of the array in messages
+ * @return number of messages popped
+ */
+#pragma optimize_for_speed
+uint32_t ipc_queue_pop_batch(BM_IPC_QUEUE *queue,
+                             void *messages,
+                             uint32_t max_count) {
+
+    uint32_t tail = queue->tail;
+    uint32_t count = queue->head - tail;
+    uint32_t words = queue->message_words;
+    uint32_t *dst = (uint32_t *) messages;
+
+    if (count == 0) {
+        return 0;
+    }
+    if (count > max_count) {
+        count = max_count;
+    }
+
+    // Read head before the messages it covers
+    IPC_QUEUE_SYNC();
+
+    for (uint32_t n = 0; n < count; n++) {
+        const uint32_t *src = ipc_queue_message(queue, tail + n);
+        for (uint32_t i = 0; i < words; i++) {
+            *dst++ = *src++;
+        }
+    }
+
+    // The messages are copied out before the producer can reuse their slots
+    IPC_QUEUE_SYNC();
+    queue->tail = tail + count;
+
+    return count;
+}
+
+/**
+ * @brief Pops a message (consumer core only)
+ *
+ * @param queue pointer to the queue
+ * @param message filled in with the message
+ * @return true if a message was popped, false if the queue is empty
+ */
+bool ipc_queue_pop(BM_IPC_QUEUE *queue, void *message) {
+    return ipc_queue_pop_batch(queue, message, 1) == 1;
+}
+
+/**
+ * @brief Returns the number of messages waiting in the queue
+ *
+ * @param queue pointer to the queue
+ * @return messages pushed but not yet popped
+ */
+uint32_t ipc_queue_count(BM_IPC_QUEUE *queue) {
+    return queue->head - queue->tail;
+}
+
+/**
+ * @brief Handler for all doorbell interrupts on this core
+ */
+static void ipc_queue_doorbell_handler(uint32_t SID, void *pCBParam) {
+
+    IPC_QUEUE_DOORBELL *doorbell = (IPC_QUEUE_DOORBELL *) pCBParam;
+
+    doorbell->callback(doorbell->queue, doorbell->arg);
+
+    #if !defined(CORE0)
+    *pREG_SEC0_END = SID;
+    #endif
+}
+
+/**
+ * @brief Has pushes to a queue interrupt this core (consumer core only)
+ *
+ * Each queue needs its own interrupt, which must not be used for anything
+ * else (INTR_TRU0_INT4 is the audio callback on SHARC core 1).  Messages
+ * already in the queue don't raise the interrupt, so drain the queue after
+ * enabling its doorbell.
+ *
+ * @param queue pointer to the queue
+ * @param interrupt SEC interrupt to raise (e.g. INTR_TRU0_INT5)
+ * @param callback called from the interrupt, should drain the queue
+ * @param arg passed to the callback
+ * @return true if successful
+ */
+bool ipc_queue_enable_doorbell(BM_IPC_QUEUE *queue,
+                               uint32_t interrupt,
+                               BM_IPC_QUEUE_DOORBELL_CALLBACK callback,
+                               void *arg) {
+
+    if (ipc_queue_doorbell_count >= IPC_QUEUE_MAX_DOORBELLS || callback == NULL) {
+        return false;
+    }
+
+    IPC_QUEUE_DOORBELL *doorbell = &ipc_queue_doorbells[ipc_queue_doorbell_count];
+    doorbell->queue = queue;
+    doorbell->callback = callback;
+    doorbell->arg = arg;
+
+    if (adi_int_InstallHandler(interrupt,
+                               (ADI_INT_HANDLER_PTR) ipc_queue_doorbell_handler,
+                               doorbell,
+                               true) != ADI_INT_SUCCESS) {
+        return false;
+    }
+    ipc_queue_doorbell_count++;
+
+    // The producer rings from now on
+    IPC_QUEUE_SYNC();
+    queue->doorbell = interrupt;
+
+    return true;
+}
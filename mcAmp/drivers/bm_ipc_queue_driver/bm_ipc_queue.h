@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for inter-core message queues
+ *
+ */
+#ifndef _BM_IPC_QUEUE_H_
+#define _BM_IPC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Queue header.  The messages follow it in memory, so a queue is declared
+ * with IPC_QUEUE() rather than on its own.
+ */
+typedef struct
+{
+    volatile uint32_t head;          // messages pushed (written by the producer only)
+    volatile uint32_t tail;          // messages popped (written by the consumer only)
+    uint32_t message_words;          // size of each message in 32-bit words
+    uint32_t capacity;               // messages the queue holds (a power of two)
+    volatile uint32_t doorbell;      // SEC interrupt raised on push (0 if none, set by the consumer)
+    volatile uint32_t dropped;       // pushes lost because the queue was full (written by the producer only)
+    uint32_t pad[2];
+} BM_IPC_QUEUE;
+
+/*
+ * Declares a queue of capacity messages of message_type (e.g. as a field of
+ * MULTICORE_DATA).  Pass &x.queue to the functions below.  message_type
+ * must be a whole number of 32-bit words and capacity a power of two.
+ */
+#define IPC_QUEUE(message_type, capacity)                                     \
+    struct {                                                                  \
+        BM_IPC_QUEUE queue;                                                   \
+        message_type messages[capacity];                                      \
+    }
+
+// Handler called from the doorbell interrupt on the consumer core
+typedef void (*BM_IPC_QUEUE_DOORBELL_CALLBACK)(BM_IPC_QUEUE *queue, void *arg);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set-up (before either core uses the queue)
+bool ipc_queue_initialize(BM_IPC_QUEUE *queue,
+                          uint32_t message_size,
+                          uint32_t capacity);
+
+// Producer
+bool ipc_queue_push(BM_IPC_QUEUE *queue, const void *message);
+uint32_t ipc_queue_push_batch(BM_IPC_QUEUE *queue,
+                              const void *messages,
+                              uint32_t count);
+
+// Consumer
+bool ipc_queue_pop(BM_IPC_QUEUE *queue, void *message);
+uint32_t ipc_queue_pop_batch(BM_IPC_QUEUE *queue,
+                             void *messages,
+                             uint32_t max_count);
+uint32_t ipc_queue_count(BM_IPC_QUEUE *queue);
+
+bool ipc_queue_enable_doorbell(BM_IPC_QUEUE *queue,
+                               uint32_t interrupt,
+                               BM_IPC_QUEUE_DOORBELL_CALLBACK callback,
+                               void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_IPC_QUEUE_H_
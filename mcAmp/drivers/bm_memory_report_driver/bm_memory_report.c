@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for memory accounting.
+ *
+ * Most of the memory used by the framework is laid out at compile time (the
+ * reverb state, the delay lines, the stack arrays sized by
+ * MAX_AUDIO_BLOCK_SIZE, etc.), so raising channel counts, block sizes or
+ * delay lengths is only safe if we know how much room is left.  This driver
+ * reports that for each core and publishes it in MULTICORE_DATA.
+ *
+ * Memory use: the SHARC .ldf files reserve whatever is left at the end of
+ * each data memory (RESERVE_EXPAND into ldf_<memory>_unused) and export the
+ * start and end of each memory, so the space used by the application is the
+ * size of the memory minus the unused reservation.  Cached L2 also holds the
+ * system stack, which expands to fill the rest of that memory, so it is
+ * reported separately.  The ARM uses the toolchain's default linker script,
+ * so it reports its heap instead: the size comes from the heap bounds in the
+ * linker script (__HeapBase and __HeapLimit) and the use from mallinfo().
+ * The heap isn't reported if the linker script doesn't define its bounds.
+ *
+ * Stacks: memory_report_initialize() paints the unused part of the stack
+ * (below the caller, less a margin) with MEMORY_REPORT_STACK_PAINT.
+ * memory_report_update_stack() counts the painted words left at the far end
+ * of the stack to find the deepest the stack has been.  On the SHARC cores,
+ * interrupt handlers (the audio DMA interrupt, the 1ms tick, etc.) run on
+ * the system stack, so the high-water mark includes the deepest interrupt
+ * nesting seen since boot.  The ARM's stack is only measured if its linker
+ * script defines __StackLimit and __StackTop.
+ *
+ * A scan only reads the painted words, so it gets cheaper as the stack gets
+ * deeper, and is quick enough to run from the 1ms tick every few seconds.
+ *
+ * @file       bm_memory_report.c
+ * @brief      memory and stack usage reporting
+ */
+#include <stddef.h>
+#include <stdio.h>
+
+#if defined(CORE0)
+#include <malloc.h>
+#endif
+
+#include "bm_memory_report.h"
+
+// Event logging / error handling functionality
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+
+#if defined(CORE0)
+    #define MEMORY_REPORT_CORE       (0)
+    #define MEMORY_REPORT_CORE_NAME  "ARM"
+#elif defined(CORE1)
+    #define MEMORY_REPORT_CORE       (1)
+    #define MEMORY_REPORT_CORE_NAME  "SHARC core 1"
+#else
+    #define MEMORY_REPORT_CORE       (2)
+    #define MEMORY_REPORT_CORE_NAME  "SHARC core 2"
+#endif
+
+static const char *const memory_region_names[MEMORY_REGIONS] = {
+    "L1 block 0",
+    "L1 block 1",
+    "L1 block 2",
+    "L1 block 3",
+    "L2 (uncached)",
+    "L2 (cached)",
+    "SDRAM",
+    "heap"
+};
+
+#if defined(CORE0)
+
+// Stack and heap bounds, if the linker script provides them
+extern uint32_t __StackLimit __attribute__((weak));
+extern uint32_t __StackTop __attribute__((weak));
+extern uint32_t __HeapBase __attribute__((weak));
+extern uint32_t __HeapLimit __attribute__((weak));
+
+#define MEMORY_REPORT_STACK_START    ((uintptr_t) &__StackLimit)
+#define MEMORY_REPORT_STACK_END      ((uintptr_t) &__StackTop)
+
+#else
+
+// Symbols exported by app.ldf
+extern "asm" char ldf_block0_start;
+extern "asm" char ldf_block0_end;
+extern "asm" char ldf_block0_unused_length;
+extern "asm" char ldf_block1_start;
+extern "asm" char ldf_block1_end;
+extern "asm" char ldf_block1_unused_length;
+extern "asm" char ldf_block2_start;
+extern "asm" char ldf_block2_end;
+extern "asm" char ldf_block2_unused_length;
+extern "asm" char ldf_block3_start;
+extern "asm" char ldf_block3_end;
+extern "asm" char ldf_block3_unused_length;
+extern "asm" char ldf_l2_uncached_start;
+extern "asm" char ldf_l2_uncached_end;
+extern "asm" char ldf_l2_uncached_unused_length;
+extern "asm" char ldf_l2_cached_start;
+extern "asm" char ldf_l2_cached_end;
+extern "asm" char ldf_sdram_data_start;
+extern "asm" char ldf_sdram_data_end;
+extern "asm" char ldf_sdram_data_unused_length;
+extern "asm" char ldf_stack_space;
+extern "asm" char ldf_stack_end;
+
+#define MEMORY_REPORT_STACK_START    ((uintptr_t) &ldf_stack_space)
+#define MEMORY_REPORT_STACK_END      ((uintptr_t) &ldf_stack_end)
+
+/**
+ * Fills in the size and use of a memory from its .ldf symbols
+ */
+static void memory_report_region(volatile BM_MEMORY_REPORT *report,
+                                 BM_MEMORY_REGION region,
+                                 char *start,
+                                 char *end,
+                                 uint32_t unused) {
+
+    // MEMORY_END() is the last byte of the memory
+    uint32_t size = (uint32_t) (end - start) + 1;
+
+    report->region[region].size = size;
+    report->region[region].used = (unused < size) ? size - unused : size;
+}
+
+#endif
+
+/**
+ * Paints the unused part of the stack and records the size of each memory.
+ * Call this early in main(), before interrupts are enabled.
+ *
+ * @param report memory report for this core in MULTICORE_DATA
+ */
+void memory_report_initialize(volatile BM_MEMORY_REPORT *report) {
+
+    for (int i = 0; i < MEMORY_REGIONS; i++) {
+        report->region[i].size = 0;
+        report->region[i].used = 0;
+    }
+    report->stack_size = 0;
+    report->stack_peak = 0;
+
+    #if defined(CORE0)
+
+    // mallinfo().arena is only what has been claimed from the heap so far, not its size
+    uintptr_t heap_start = (uintptr_t) &__HeapBase;
+    uintptr_t heap_end = (uintptr_t) &__HeapLimit;
+    if (heap_start != 0 && heap_end > heap_start) {
+        struct mallinfo heap = mallinfo();
+        report->region[MEMORY_REGION_HEAP].size = heap_end - heap_start;
+        report->region[MEMORY_REGION_HEAP].used = heap.uordblks;
+    }
+
+    #else
+
+    memory_report_region(report, MEMORY_REGION_L1_BLOCK0, &ldf_block0_start,
+                         &ldf_block0_end, (uint32_t) &ldf_block0_unused_length);
+    memory_report_region(report, MEMORY_REGION_L1_BLOCK1, &ldf_block1_start,
+                         &ldf_block1_end, (uint32_t) &ldf_block1_unused_length);
+    memory_report_region(report, MEMORY_REGION_L1_BLOCK2, &ldf_block2_start,
+                         &ldf_block2_end, (uint32_t) &ldf_block2_unused_length);
+    memory_report_region(report, MEMORY_REGION_L1_BLOCK3, &ldf_block3_start,
+                         &ldf_block3_end, (uint32_t) &ldf_block3_unused_length);
+    memory_report_region(report, MEMORY_REGION_L2_UNCACHED, &ldf_l2_uncached_start,
+                         &ldf_l2_uncached_end, (uint32_t) &ldf_l2_uncached_unused_length);
+    memory_report_region(report, MEMORY_REGION_SDRAM, &ldf_sdram_data_start,
+                         &ldf_sdram_data_end, (uint32_t) &ldf_sdram_data_unused_length);
+
+    // The system stack (plus 8 bytes of padding) takes up the rest of cached L2
+    memory_report_region(report, MEMORY_REGION_L2_CACHED, &ldf_l2_cached_start,
+                         &ldf_l2_cached_end,
+                         (uint32_t) (&ldf_stack_end - &ldf_stack_space) + 8);
+
+    #endif
+
+    uintptr_t start = MEMORY_REPORT_STACK_START;
+    uintptr_t end = MEMORY_REPORT_STACK_END;
+    if (start == 0 || end <= start) {
+        return;
+    }
+    report->stack_size = end - start;
+
+    // The stack grows down, so everything below our own frame (less a margin) is unused
+    volatile uint32_t here;
+    uintptr_t paint_end = (uintptr_t) &here - MEMORY_REPORT_STACK_MARGIN;
+    for (volatile uint32_t *word = (volatile uint32_t *) ((start + 3) & ~3);
+         (uintptr_t) word < paint_end; word++) {
+        *word = MEMORY_REPORT_STACK_PAINT;
+    }
+}
+
+/**
+ * Logs how much of each memory this core uses
+ *
+ * @param report memory report for this core in MULTICORE_DATA
+ */
+void memory_report_log_regions(const volatile BM_MEMORY_REPORT *report) {
+
+    char message[128];
+
+    for (int i = 0; i < MEMORY_REGIONS; i++) {
+        uint32_t size = report->region[i].size;
+        if (size == 0) {
+            continue;
+        }
+        uint32_t used = report->region[i].used;
+        sprintf(message, "%s %s: %u of %u bytes used (%u%%)", MEMORY_REPORT_CORE_NAME,
+                memory_region_names[i], (unsigned) used, (unsigned) size,
+                (unsigned) ((100ULL * used) / size));
+        log_event(EVENT_INFO, message);
+    }
+
+    if (report->stack_size) {
+        sprintf(message, "%s stack: %u bytes", MEMORY_REPORT_CORE_NAME,
+                (unsigned) report->stack_size);
+        log_event(EVENT_INFO, message);
+    }
+    else {
+        sprintf(message, "%s stack: bounds unknown, high-water mark not tracked",
+                MEMORY_REPORT_CORE_NAME);
+        log_event(EVENT_INFO, message);
+    }
+}
+
+/**
+ * Finds the deepest the stack has been since boot and logs it if it has grown
+ *
+ * @param report memory report for this core in MULTICORE_DATA
+ * @return stack high-water mark in bytes (0 if the stack isn't tracked)
+ */
+uint32_t memory_report_update_stack(volatile BM_MEMORY_REPORT *report) {
+
+    if (report->stack_size == 0) {
+        return 0;
+    }
+
+    // Count the painted words the stack hasn't reached yet
+    uintptr_t start = (MEMORY_REPORT_STACK_START + 3) & ~3;
+    const volatile uint32_t *word = (const volatile uint32_t *) start;
+    const volatile uint32_t *last = (const volatile uint32_t *) MEMORY_REPORT_STACK_END;
+    while (word < last && *word == MEMORY_REPORT_STACK_PAINT) {
+        word++;
+    }
+
+    uint32_t peak = MEMORY_REPORT_STACK_END - (uintptr_t) word;
+    if (peak > report->stack_peak) {
+
+        uint32_t percent = (100ULL * peak) / report->stack_size;
+        uint32_t percent_before = (100ULL * report->stack_peak) / report->stack_size;
+        report->stack_peak = peak;
+
+        // Log a new peak when it crosses the next 10% (or the warning level)
+        if (percent / 10 != percent_before / 10 || percent >= MEMORY_REPORT_STACK_WARN_PERCENT) {
+            log_event_fmt((percent >= MEMORY_REPORT_STACK_WARN_PERCENT) ? EVENT_WARN : EVENT_INFO,
+                          EVENT_FMT_STACK_PEAK, MEMORY_REPORT_CORE, peak, report->stack_size, percent);
+        }
+    }
+
+    return report->stack_peak;
+}
+
+/**
+ * Returns the name of a memory region
+ */
+const char *memory_report_region_name(BM_MEMORY_REGION region) {
+
+    if (region >= MEMORY_REGIONS) {
+        return "unknown";
+    }
+    return memory_region_names[region];
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for memory accounting
+ *
+ */
+#ifndef _BM_MEMORY_REPORT_H_
+#define _BM_MEMORY_REPORT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Word written over the unused part of each stack at boot
+#define MEMORY_REPORT_STACK_PAINT        (0x5AC3A55A)
+
+// Stack left unpainted below the caller of memory_report_initialize() (bytes)
+#define MEMORY_REPORT_STACK_MARGIN       (256)
+
+// A warning is logged once a stack's high-water mark reaches this percentage
+#define MEMORY_REPORT_STACK_WARN_PERCENT (75)
+
+// Memories accounted for (a region is left at zero size on cores that don't use it)
+typedef enum
+{
+    MEMORY_REGION_L1_BLOCK0,         // SHARC L1
+    MEMORY_REGION_L1_BLOCK1,
+    MEMORY_REGION_L1_BLOCK2,
+    MEMORY_REGION_L1_BLOCK3,
+    MEMORY_REGION_L2_UNCACHED,       // SHARC uncached L2 (event ring, published status)
+    MEMORY_REGION_L2_CACHED,         // SHARC cached L2, not counting the system stack
+    MEMORY_REGION_SDRAM,             // SHARC SDRAM data
+    MEMORY_REGION_HEAP,              // ARM heap
+    MEMORY_REGIONS
+} BM_MEMORY_REGION;
+
+typedef struct
+{
+    uint32_t size;                   // bytes
+    uint32_t used;                   // bytes
+} BM_MEMORY_REGION_USAGE;
+
+// Memory use of one core, published in MULTICORE_DATA
+typedef struct
+{
+    BM_MEMORY_REGION_USAGE region[MEMORY_REGIONS];
+    uint32_t stack_size;             // bytes (0 if the stack bounds aren't known)
+    volatile uint32_t stack_peak;    // deepest the stack has been since boot, including interrupts (bytes)
+} BM_MEMORY_REPORT;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Call early in main() - paints the stack and fills in the memory sizes
+void memory_report_initialize(volatile BM_MEMORY_REPORT *report);
+
+// Logs how full each memory is (boot time)
+void memory_report_log_regions(const volatile BM_MEMORY_REPORT *report);
+
+// Scans the stack for the high-water mark, logging when it grows
+uint32_t memory_report_update_stack(volatile BM_MEMORY_REPORT *report);
+
+const char *memory_report_region_name(BM_MEMORY_REGION region);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_MEMORY_REPORT_H_
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for the metrics registry.
+ *
+ * Status values (dropped frames, effect quality tier, etc.) used to be
+ * fields added by hand to MULTICORE_DATA, so every new value changed the
+ * layout of a structure shared by all three cores.  Instead, each core now
+ * registers named counters, gauges and histograms at start-up and updates
+ * them through the handle returned, which points straight at the value in
+ * shared memory:
+ *
+ *     static BM_METRIC dropped_frames;
+ *     dropped_frames = metrics_counter("audio.dropped_frames");
+ *     ...
+ *     metric_inc(dropped_frames);
+ *
+ * Each core has its own region (see BM_METRICS_REGION) and is the only core
+ * that writes it, so there is no locking and no false sharing between
+ * cores.  The regions are in uncached memory, so updates are visible to the
+ * other cores straight away.  A metric's value is only written by the code
+ * that owns it - like the rest of the status in MULTICORE_DATA, a counter
+ * shouldn't be updated from two interrupt levels.
+ *
+ * Readers (normally the ARM) walk a core's metrics with metrics_count() and
+ * metrics_read(), or look one up with metrics_find().  The region's
+ * sequence number is odd while a metric is being registered and changes
+ * every time one is added, so a reader retries if its copy overlapped a
+ * registration.  Counters and gauges are single words so are always read
+ * whole.  A histogram's count is written after its bucket, so a reader
+ * retries if the count changed while it was copying the buckets.
+ *
+ * @file       bm_metrics.c
+ * @brief      named counters, gauges and histograms shared between cores
+ */
+#include <string.h>
+
+#include "bm_metrics.h"
+
+#if defined(CORE0)
+#define METRICS_CORE            (0)
+#define METRICS_SYNC()          __sync_synchronize()
+#elif defined(CORE1)
+#define METRICS_CORE            (1)
+#define METRICS_SYNC()          asm volatile("sync;")
+#else
+#define METRICS_CORE            (2)
+#define METRICS_SYNC()          asm volatile("sync;")
+#endif
+
+// A reader gives up after this many tries (only possible while metrics are being registered)
+#define METRICS_READ_RETRIES    (4)
+
+// Region size rounded up to whole cache lines
+#define METRICS_REGION_STRIDE   (((sizeof(BM_METRICS_REGION) + METRICS_CACHE_LINE - 1) \
+                                  / METRICS_CACHE_LINE) * METRICS_CACHE_LINE)
+
+// Handle given out once a region is full, so the hot path never has to check for NULL
+static volatile uint32_t metrics_scratch[2 + METRICS_HIST_BUCKETS];
+
+/**
+ * Returns the metrics region of a core
+ */
+static BM_METRICS_REGION *metrics_region(uint32_t core) {
+    return (BM_METRICS_REGION *) (METRICS_BUFFER_ADDRESS + core * METRICS_REGION_STRIDE);
+}
+
+/**
+ * @brief Clears this core's metrics region
+ *
+ * Call this early in main(), before any metrics are registered.  The region
+ * is cleared again if the core is restarted, so stale metrics from the last
+ * run are never read.
+ */
+void metrics_initialize(void) {
+
+    BM_METRICS_REGION *region = metrics_region(METRICS_CORE);
+
+    region->magic = 0;
+    region->sequence = 1;
+    METRICS_SYNC();
+
+    region->count = 0;
+    region->value_words = 0;
+    memset(region->descriptor, 0, sizeof(region->descriptor));
+    for (int i = 0; i < METRICS_VALUE_WORDS; i++) {
+        region->value[i] = 0;
+    }
+
+    region->magic = METRICS_MAGIC;
+    METRICS_SYNC();
+    region->sequence = 2;
+}
+
+/**
+ * Adds a metric to this core's region and returns a handle to its value
+ */
+static BM_METRIC metrics_register(const char *name,
+                                  BM_METRIC_TYPE type,
+                                  uint32_t words) {
+
+    BM_METRICS_REGION *region = metrics_region(METRICS_CORE);
+
+    if (region->magic != METRICS_MAGIC ||
+        region->count >= METRICS_MAX_PER_CORE ||
+        region->value_words + words > METRICS_VALUE_WORDS) {
+        return metrics_scratch;
+    }
+
+    region->sequence++;
+    METRICS_SYNC();
+
+    BM_METRIC_DESCRIPTOR *descriptor = &region->descriptor[region->count];
+    strncpy(descriptor->name, name, METRICS_NAME_LENGTH - 1);
+    descriptor->name[METRICS_NAME_LENGTH - 1] = 0;
+    descriptor->type = type;
+    descriptor->words = words;
+    descriptor->value_index = region->value_words;
+
+    BM_METRIC metric = &region->value[region->value_words];
+    for (uint32_t i = 0; i < words; i++) {
+        metric[i] = 0;
+    }
+    region->value_words += words;
+    region->count++;
+
+    METRICS_SYNC();
+    region->sequence++;
+
+    return metric;
+}
+
+/**
+ * @brief Registers a counter
+ *
+ * @param name metric name (truncated to METRICS_NAME_LENGTH - 1 characters)
+ * @return handle for metric_inc() / metric_add()
+ */
+BM_METRIC metrics_counter(const char *name) {
+    return metrics_register(name, METRIC_COUNTER, 1);
+}
+
+/**
+ * @brief Registers an integer gauge
+ *
+ * @param name metric name (truncated to METRICS_NAME_LENGTH - 1 characters)
+ * @return handle for metric_set()
+ */
+BM_METRIC metrics_gauge(const char *name) {
+    return metrics_register(name, METRIC_GAUGE, 1);
+}
+
+/**
+ * @brief Registers a floating-point gauge
+ *
+ * @param name metric name (truncated to METRICS_NAME_LENGTH - 1 characters)
+ * @return handle for metric_set_float()
+ */
+BM_METRIC metrics_gauge_float(const char *name) {
+    return metrics_register(name, METRIC_GAUGE_FLOAT, 1);
+}
+
+/**
+ * @brief Registers a histogram
+ *
+ * @param name metric name (truncated to METRICS_NAME_LENGTH - 1 characters)
+ * @param shift values below 2^(shift + 1) go in the first bucket
+ * @return handle for metric_observe()
+ */
+BM_METRIC metrics_histogram(const char *name, uint32_t shift) {
+
+    BM_METRIC metric = metrics_register(name, METRIC_HISTOGRAM, 2 + METRICS_HIST_BUCKETS);
+    metric[0] = shift;
+
+    return metric;
+}
+
+/**
+ * @brief Returns the number of metrics a core has registered
+ *
+ * @param core core number (0 = ARM, 1 and 2 = SHARC cores)
+ * @return number of metrics (0 until the core has set up its region)
+ */
+uint32_t metrics_count(uint32_t core) {
+
+    if (core >= METRICS_CORES) {
+        return 0;
+    }
+
+    BM_METRICS_REGION *region = metrics_region(core);
+    if (region->magic != METRICS_MAGIC) {
+        return 0;
+    }
+
+    return region->count;
+}
+
+/**
+ * @brief Reads a consistent copy of a metric
+ *
+ * @param core core number (0 = ARM, 1 and 2 = SHARC cores)
+ * @param index metric index from 0 to metrics_count(core) - 1
+ * @param value filled in with the metric's name, type and value
+ * @return false if there's no such metric or no consistent copy could be read
+ */
+bool metrics_read(uint32_t core, uint32_t index, BM_METRIC_VALUE *value) {
+
+    if (core >= METRICS_CORES) {
+        return false;
+    }
+
+    BM_METRICS_REGION *region = metrics_region(core);
+
+    for (int attempt = 0; attempt < METRICS_READ_RETRIES; attempt++) {
+
+        uint32_t sequence = region->sequence;
+        METRICS_SYNC();
+
+        if ((sequence & 1) || region->magic != METRICS_MAGIC) {
+            continue;
+        }
+        if (index >= region->count) {
+            return false;
+        }
+
+        const BM_METRIC_DESCRIPTOR *descriptor = &region->descriptor[index];
+        memcpy(value->name, descriptor->name, METRICS_NAME_LENGTH);
+        value->name[METRICS_NAME_LENGTH - 1] = 0;
+        value->type = (BM_METRIC_TYPE) descriptor->type;
+
+        const volatile uint32_t *words = &region->value[descriptor->value_index];
+        bool torn = false;
+
+        if (value->type == METRIC_HISTOGRAM) {
+            value->value.u = 0;
+            value->shift = words[0];
+            value->count = words[1];
+            METRICS_SYNC();
+            for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+                value->bucket[i] = words[2 + i];
+            }
+            METRICS_SYNC();
+            torn = (words[1] != value->count);
+        }
+        else {
+            value->value.u = words[0];
+            value->count = 0;
+            value->shift = 0;
+            memset(value->bucket, 0, sizeof(value->bucket));
+        }
+
+        METRICS_SYNC();
+        if (!torn && region->sequence == sequence) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Looks up a metric by name
+ *
+ * The handle returned can be read directly (e.g. *metric), and stays valid
+ * until the core that owns the metric is restarted.  Look metrics up once
+ * rather than on every read.
+ *
+ * @param core core number (0 = ARM, 1 and 2 = SHARC cores)
+ * @param name metric name
+ * @return handle to the metric's value, or NULL if the core hasn't registered it
+ */
+BM_METRIC metrics_find(uint32_t core, const char *name) {
+
+    uint32_t count = metrics_count(core);
+    BM_METRICS_REGION *region = metrics_region(core);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const BM_METRIC_DESCRIPTOR *descriptor = &region->descriptor[i];
+        if (strncmp(descriptor->name, name, METRICS_NAME_LENGTH - 1) == 0) {
+            return &region->value[descriptor->value_index];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for the metrics registry
+ *
+ */
+#ifndef _BM_METRICS_H_
+#define _BM_METRICS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The metric regions live in the 4KB of uncached L2 that MCAPI would use
+ * for the ARM (MCAPI isn't used - see multicore_shared_memory.c).  Like
+ * MULTICORE_DATA and the trace rings, they are placed at a fixed address
+ * rather than by the linker so all three cores can find them.
+ */
+#define METRICS_BUFFER_ADDRESS       (0x20081000)
+#define METRICS_BUFFER_SIZE          (0x1000)
+#define METRICS_MAGIC                (0x4D545243)    // "CRTM"
+
+#define METRICS_CORES                (3)
+#define METRICS_MAX_PER_CORE         (24)
+#define METRICS_VALUE_WORDS          (96)            // shared by all of a core's metrics
+#define METRICS_NAME_LENGTH          (24)            // including the terminating zero
+#define METRICS_HIST_BUCKETS         (8)
+#define METRICS_CACHE_LINE           (64)
+
+typedef enum
+{
+    METRIC_COUNTER,                  // uint32_t that only goes up (wraps)
+    METRIC_GAUGE,                    // uint32_t set to the current value
+    METRIC_GAUGE_FLOAT,              // float set to the current value
+    METRIC_HISTOGRAM                 // count of values in log2-spaced buckets
+} BM_METRIC_TYPE;
+
+/*
+ * Handle returned when a metric is registered.  It points straight at the
+ * metric's value in shared memory, so updating a counter or gauge is a
+ * single store.  A histogram's words are its bucket shift, the number of
+ * values and then METRICS_HIST_BUCKETS buckets; bucket n counts values from
+ * 2^(n + shift) to 2^(n + shift + 1) - 1, with smaller values in the first
+ * bucket and larger values in the last.
+ */
+typedef volatile uint32_t *BM_METRIC;
+
+typedef struct
+{
+    char name[METRICS_NAME_LENGTH];
+    uint8_t type;                    // BM_METRIC_TYPE
+    uint8_t words;                   // value words used by the metric
+    uint16_t value_index;            // first value word
+    uint32_t reserved;
+} BM_METRIC_DESCRIPTOR;
+
+/*
+ * Region written by one core.  sequence is odd while a metric is being
+ * registered.  The header, descriptors and values each start on a cache
+ * line and each core only writes its own region, so no two cores ever
+ * write the same cache line.
+ */
+typedef struct
+{
+    volatile uint32_t sequence;
+    volatile uint32_t magic;         // METRICS_MAGIC once the core has set up its region
+    volatile uint32_t count;         // metrics registered
+    uint32_t value_words;            // value words allocated
+    uint32_t pad[METRICS_CACHE_LINE / 4 - 4];
+
+    BM_METRIC_DESCRIPTOR descriptor[METRICS_MAX_PER_CORE];
+
+    volatile uint32_t value[METRICS_VALUE_WORDS];
+} BM_METRICS_REGION;
+
+// Consistent copy of one metric, filled in by metrics_read()
+typedef struct
+{
+    char name[METRICS_NAME_LENGTH];
+    BM_METRIC_TYPE type;
+    union {
+        uint32_t u;
+        float f;
+    } value;                         // counters and gauges
+    uint32_t count;                  // histograms: values observed
+    uint32_t shift;
+    uint32_t bucket[METRICS_HIST_BUCKETS];
+} BM_METRIC_VALUE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Clears this core's region - call early in main(), before any metrics are registered
+void metrics_initialize(void);
+
+// Registration (start-up only).  If the region is full, the handle points at a scratch area.
+BM_METRIC metrics_counter(const char *name);
+BM_METRIC metrics_gauge(const char *name);
+BM_METRIC metrics_gauge_float(const char *name);
+BM_METRIC metrics_histogram(const char *name, uint32_t shift);
+
+// Reading (any core)
+uint32_t metrics_count(uint32_t core);
+bool metrics_read(uint32_t core, uint32_t index, BM_METRIC_VALUE *value);
+BM_METRIC metrics_find(uint32_t core, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Hot path updates
+static inline void metric_inc(BM_METRIC metric) {
+    *metric += 1;
+}
+
+static inline void metric_add(BM_METRIC metric, uint32_t n) {
+    *metric += n;
+}
+
+static inline void metric_set(BM_METRIC metric, uint32_t value) {
+    *metric = value;
+}
+
+static inline void metric_set_float(BM_METRIC metric, float value) {
+    *(volatile float *) metric = value;
+}
+
+// Reading another core's counter or gauge (histograms need metrics_read())
+static inline uint32_t metric_get(BM_METRIC metric) {
+    return *metric;
+}
+
+static inline float metric_get_float(BM_METRIC metric) {
+    return *(volatile float *) metric;
+}
+
+static inline void metric_observe(BM_METRIC metric, uint32_t value) {
+
+    // The float exponent is floor(log2(value)); zero has an exponent of -127
+    union {
+        float f;
+        uint32_t u;
+    } v;
+    v.f = (float) value;
+    int32_t bucket = (int32_t) ((v.u >> 23) & 0xFF) - 127 - (int32_t) metric[0];
+
+    if (bucket < 0) {
+        bucket = 0;
+    }
+    else if (bucket >= METRICS_HIST_BUCKETS) {
+        bucket = METRICS_HIST_BUCKETS - 1;
+    }
+
+    // Count last so a reader can tell the buckets changed while it was copying them
+    metric[2 + bucket]++;
+    metric[1]++;
+}
+
+#endif // _BM_METRICS_H_
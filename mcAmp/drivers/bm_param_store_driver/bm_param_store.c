@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for parameter sets shared between cores.
+ *
+ * A store holds a set of parameters (a struct of 32-bit fields) that one
+ * core writes and any number of cores read, such as the pot values the ARM
+ * reads from the HADC for the SHARC cores.  Fields written straight into
+ * shared memory one at a time can be seen half updated - a reader may get
+ * the new value of one pot and the old value of the next - and each reader
+ * has to read every field from uncached L2 every block to see if anything
+ * changed.
+ *
+ * Instead, the writer keeps its own copy of the set, changes it and
+ * publishes the whole set at once.  The store holds two copies of the set
+ * and a version number.  Publishing copies the set into the copy that
+ * isn't current, then increments the version, which makes it current.  A
+ * reader remembers the version it last read, so checking for a new set is
+ * a single read of the version.  When the version has changed, the reader
+ * copies the current set out and reads the version again (a sequence
+ * lock).  If the version is unchanged nothing was published during the
+ * copy, so the set is whole.  Otherwise the writer may have started on the
+ * copy being read, and the read is repeated.
+ *
+ * Readers never wait for the writer.  A reader that still can't get a whole
+ * set after PARAM_STORE_READ_ATTEMPTS tries keeps the set it has and tries
+ * again next time, so a reader in an audio callback takes a bounded time.
+ * Only one core (and one interrupt level on it) may publish to a store.
+ *
+ * @file       bm_param_store.c
+ * @brief      versioned, double-buffered parameter sets read with a sequence lock
+ */
+#include <stddef.h>
+
+#include "bm_param_store.h"
+
+#if defined(CORE0)
+#define PARAM_STORE_SYNC()          __sync_synchronize()
+#else
+#define PARAM_STORE_SYNC()          asm volatile("sync;")
+#endif
+
+// Times a reader tries to copy a whole set before keeping the one it has
+#define PARAM_STORE_READ_ATTEMPTS   (2)
+
+/**
+ * @brief Returns a pointer to copy n (0 or 1) of the set
+ */
+static inline uint32_t *param_store_set(BM_PARAM_STORE *store, uint32_t n) {
+    return (uint32_t *)(store + 1) + (n & 1) * store->set_words;
+}
+
+/**
+ * @brief Copies a set word by word
+ */
+#pragma optimize_for_speed
+static inline void param_store_copy(uint32_t *dst, const uint32_t *src, uint32_t words) {
+    for (uint32_t i = 0; i < words; i++) {
+        dst[i] = src[i];
+    }
+}
+
+/**
+ * @brief Sets up a store with an initial set
+ *
+ * This should be called once by the writer (normally the ARM before the
+ * SHARC cores start), before any core reads the store.
+ *
+ * @param store pointer to the store declared with PARAM_STORE()
+ * @param set initial parameter set
+ * @param set_size sizeof() the parameter set (a whole number of 32-bit words)
+ * @return true if successful, false if the size is invalid
+ */
+bool param_store_initialize(BM_PARAM_STORE *store,
+                            const void *set,
+                            uint32_t set_size) {
+
+    if (store == NULL || set == NULL || set_size == 0 || set_size % sizeof(uint32_t)) {
+        return false;
+    }
+
+    store->set_words = set_size / sizeof(uint32_t);
+    param_store_copy(param_store_set(store, 0), (const uint32_t *) set, store->set_words);
+    param_store_copy(param_store_set(store, 1), (const uint32_t *) set, store->set_words);
+
+    PARAM_STORE_SYNC();
+    store->version = 0;
+
+    return true;
+}
+
+/**
+ * @brief Publishes a new parameter set (writer core only)
+ *
+ * @param store pointer to the store
+ * @param set the complete parameter set
+ */
+void param_store_publish(BM_PARAM_STORE *store, const void *set) {
+
+    uint32_t version = store->version + 1;
+
+    param_store_copy(param_store_set(store, version), (const uint32_t *) set, store->set_words);
+
+    // The set is complete before it becomes current
+    PARAM_STORE_SYNC();
+    store->version = version;
+}
+
+/**
+ * @brief Copies the current set out if it is newer than the one the reader has
+ *
+ * The set may be partly overwritten when this returns false, so read into
+ * a scratch copy and only use it when this returns true.
+ *
+ * @param store pointer to the store
+ * @param set filled in with the current set
+ * @param version version the reader last read (PARAM_STORE_NO_VERSION at first), updated on success
+ * @return true if a new, whole set was copied
+ */
+bool param_store_read(BM_PARAM_STORE *store, void *set, uint32_t *version) {
+
+    for (int attempt = 0; attempt < PARAM_STORE_READ_ATTEMPTS; attempt++) {
+
+        uint32_t before = store->version;
+        if (before == *version) {
+            return false;
+        }
+
+        // Read the version before the set it covers
+        PARAM_STORE_SYNC();
+        param_store_copy((uint32_t *) set, param_store_set(store, before), store->set_words);
+        PARAM_STORE_SYNC();
+
+        if (store->version == before) {
+            *version = before;
+            return true;
+        }
+    }
+
+    return false;
+}
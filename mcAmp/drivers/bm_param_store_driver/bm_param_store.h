@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for shared parameter stores
+ *
+ */
+#ifndef _BM_PARAM_STORE_H_
+#define _BM_PARAM_STORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Version a reader starts with, so its first read always takes the current set
+#define PARAM_STORE_NO_VERSION       (0xFFFFFFFF)
+
+/*
+ * Store header.  The two copies of the parameter set follow it in memory,
+ * so a store is declared with PARAM_STORE() rather than on its own.
+ */
+typedef struct
+{
+    volatile uint32_t version;       // sets published (written by the writer only), set (version & 1) is current
+    uint32_t set_words;              // size of the parameter set in 32-bit words
+    uint32_t pad[2];
+} BM_PARAM_STORE;
+
+/*
+ * Declares a store for a parameter set of set_type (e.g. as a field of
+ * MULTICORE_DATA).  Pass &x.store to the functions below.  set_type must
+ * be a whole number of 32-bit words.
+ */
+#define PARAM_STORE(set_type)                                                 \
+    struct {                                                                  \
+        BM_PARAM_STORE store;                                                 \
+        set_type sets[2];                                                     \
+    }
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Set-up (before any core reads the store)
+bool param_store_initialize(BM_PARAM_STORE *store,
+                            const void *set,
+                            uint32_t set_size);
+
+// Writer
+void param_store_publish(BM_PARAM_STORE *store, const void *set);
+
+// Readers
+bool param_store_read(BM_PARAM_STORE *store, void *set, uint32_t *version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_PARAM_STORE_H_
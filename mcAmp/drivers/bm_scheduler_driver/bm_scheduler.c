@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for a cooperative task scheduler on the ARM.
+ *
+ * Everything the ARM does after start-up (publishing HADC values, draining
+ * the SHARC event logs, push buttons, the control link, LEDs, reports) used
+ * to run either from the 1ms tick interrupt or one after another in the
+ * background loop, so a slow job held up all the others and the tick
+ * interrupt grew.  Instead, each job is added here as a task and
+ * scheduler_run() takes the place of the background loop.
+ *
+ * A task is either periodic (due every period_ms) or event-triggered (due
+ * when scheduler_signal() is called, typically from an interrupt).  Whenever
+ * a task finishes, the scheduler starts the highest priority task that is
+ * due; tasks with the same priority run in the order they were added.
+ * Tasks run to completion - nothing is preempted, so tasks share data
+ * without locks, but a task has to return promptly for the others to run
+ * on time.  A periodic task that falls a whole period behind skips the
+ * releases it missed rather than running back to back to catch up.
+ *
+ * Each task has a deadline, measured from when it became due to when it
+ * finished.  The scheduler counts the runs that missed it (per task, as the
+ * metric "task.<name>", and in total as "sched.misses") and keeps the
+ * longest latency and run time of each task.  Run times are measured with
+ * the trace timer (see bm_trace.c), so trace_initialize_arm() should be
+ * called first.  It starts the timer even when TRACE_ENABLED is false; each
+ * run is also recorded in the trace when it isn't.
+ *
+ * scheduler_signal() only increments a counter and stamps the time, so it
+ * can be called from any interrupt.  A task signalled several times before
+ * it runs runs once; a signal that arrives while it is running makes it run
+ * again.
+ *
+ * @file       bm_scheduler.c
+ * @brief      cooperative run-to-completion task scheduler for the ARM
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "bm_scheduler.h"
+
+#include "drivers/bm_event_logging_driver/bm_event_logging.h"
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+#include "drivers/bm_sysctrl_driver/bm_system_control.h"
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+// Run times below 2^(SCHEDULER_RUN_US_SHIFT + 1)us go in the first bucket of sched.run_us
+#define SCHEDULER_RUN_US_SHIFT       (4)
+
+struct BM_TASK
+{
+    char name[SCHEDULER_NAME_LENGTH];
+    BM_TASK_FUNCTION function;
+    void *arg;
+    uint32_t priority;
+    uint32_t period_ms;              // 0 for event-triggered tasks
+    uint32_t deadline_ms;
+
+    uint32_t next_release_ms;        // periodic tasks
+
+    volatile uint32_t signals;       // event-triggered tasks, incremented by scheduler_signal()
+    volatile uint32_t signal_ms;     // when the oldest signal still waiting arrived
+    uint32_t signals_handled;
+
+    // Statistics
+    uint32_t runs;
+    uint32_t deadline_misses;
+    uint32_t max_latency_ms;
+    uint32_t max_run_ticks;
+    uint64_t total_run_ticks;
+    uint32_t reported_misses;        // deadline_misses when last logged
+
+    BM_METRIC misses_metric;
+};
+
+static struct
+{
+    BM_TASK tasks[SCHEDULER_MAX_TASKS];
+    uint32_t task_count;
+    uint32_t ticks_per_us;
+    bool running;
+
+    uint32_t report_ms;
+
+    BM_METRIC misses;
+    BM_METRIC run_us;
+} scheduler;
+
+/**
+ * @brief Milliseconds since start-up (wraps after 49 days; all comparisons are of differences)
+ */
+static inline uint32_t scheduler_now_ms(void) {
+    return (uint32_t) millis();
+}
+
+/**
+ * @brief Sets up the scheduler
+ *
+ * @param timer_freq_hz frequency of the trace timer (used to measure run times)
+ * @return true if successful
+ */
+bool scheduler_initialize(uint32_t timer_freq_hz) {
+
+    if (timer_freq_hz < 1000000) {
+        return false;
+    }
+
+    scheduler.task_count = 0;
+    scheduler.ticks_per_us = timer_freq_hz / 1000000;
+    scheduler.running = false;
+    scheduler.report_ms = scheduler_now_ms();
+
+    scheduler.misses = metrics_counter("sched.misses");
+    scheduler.run_us = metrics_histogram("sched.run_us", SCHEDULER_RUN_US_SHIFT);
+
+    return true;
+}
+
+/**
+ * @brief Adds a task (shared by both kinds)
+ */
+static BM_TASK *scheduler_add(const char *name,
+                              BM_TASK_FUNCTION function,
+                              void *arg,
+                              uint32_t priority,
+                              uint32_t period_ms,
+                              uint32_t deadline_ms) {
+
+    if (function == NULL || scheduler.task_count >= SCHEDULER_MAX_TASKS) {
+        return NULL;
+    }
+
+    BM_TASK *task = &scheduler.tasks[scheduler.task_count];
+
+    strncpy(task->name, name, SCHEDULER_NAME_LENGTH - 1);
+    task->name[SCHEDULER_NAME_LENGTH - 1] = 0;
+    task->function = function;
+    task->arg = arg;
+    task->priority = priority;
+    task->period_ms = period_ms;
+    task->deadline_ms = deadline_ms;
+
+    task->next_release_ms = scheduler_now_ms();
+    task->signals = 0;
+    task->signal_ms = 0;
+    task->signals_handled = 0;
+
+    task->runs = 0;
+    task->deadline_misses = 0;
+    task->max_latency_ms = 0;
+    task->max_run_ticks = 0;
+    task->total_run_ticks = 0;
+    task->reported_misses = 0;
+
+    char metric_name[METRICS_NAME_LENGTH];
+    strcpy(metric_name, "task.");
+    strncat(metric_name, task->name, METRICS_NAME_LENGTH - 6);
+    task->misses_metric = metrics_counter(metric_name);
+
+    scheduler.task_count++;
+
+    return task;
+}
+
+/**
+ * @brief Adds a task that is due every period_ms (first straight away)
+ *
+ * @param name name for the statistics
+ * @param function called each time the task runs
+ * @param arg passed to function
+ * @param priority lower runs first (see TASK_PRIORITY_xxx)
+ * @param period_ms time between runs
+ * @param deadline_ms a run that finishes later than this after it was due is a miss
+ * @return the task, or NULL if there's no room
+ */
+BM_TASK *scheduler_add_periodic(const char *name,
+                                BM_TASK_FUNCTION function,
+                                void *arg,
+                                uint32_t priority,
+                                uint32_t period_ms,
+                                uint32_t deadline_ms) {
+
+    if (period_ms == 0) {
+        return NULL;
+    }
+
+    return scheduler_add(name, function, arg, priority, period_ms, deadline_ms);
+}
+
+/**
+ * @brief Adds a task that is due when scheduler_signal() is called
+ *
+ * @param name name for the statistics
+ * @param function called each time the task runs
+ * @param arg passed to function
+ * @param priority lower runs first (see TASK_PRIORITY_xxx)
+ * @param deadline_ms a run that finishes later than this after the signal is a miss
+ * @return the task, or NULL if there's no room
+ */
+BM_TASK *scheduler_add_event(const char *name,
+                             BM_TASK_FUNCTION function,
+                             void *arg,
+                             uint32_t priority,
+                             uint32_t deadline_ms) {
+
+    return scheduler_add(name, function, arg, priority, 0, deadline_ms);
+}
+
+/**
+ * @brief Makes an event-triggered task due
+ *
+ * Safe to call from interrupts (which don't nest on the ARM) and before
+ * scheduler_run().
+ *
+ * @param task task from scheduler_add_event() (NULL is ignored)
+ */
+void scheduler_signal(BM_TASK *task) {
+
+    if (task == NULL) {
+        return;
+    }
+
+    if (task->signals == task->signals_handled) {
+        task->signal_ms = scheduler_now_ms();
+    }
+    task->signals++;
+}
+
+/**
+ * @brief Runs the highest priority task that is due
+ *
+ * @return true if a task ran
+ */
+bool scheduler_run_once(void) {
+
+    uint32_t now = scheduler_now_ms();
+    BM_TASK *next = NULL;
+
+    for (uint32_t i = 0; i < scheduler.task_count; i++) {
+        BM_TASK *task = &scheduler.tasks[i];
+        bool due = task->period_ms ? (int32_t) (now - task->next_release_ms) >= 0
+                                   : task->signals != task->signals_handled;
+        if (due && (next == NULL || task->priority < next->priority)) {
+            next = task;
+        }
+    }
+
+    if (next == NULL) {
+        return false;
+    }
+
+    uint32_t release_ms;
+    if (next->period_ms) {
+        release_ms = next->next_release_ms;
+        next->next_release_ms += next->period_ms;
+        if ((int32_t) (now - next->next_release_ms) >= 0) {
+            next->next_release_ms = now + next->period_ms;
+        }
+    }
+    else {
+        release_ms = next->signal_ms;
+        next->signals_handled = next->signals;
+    }
+
+    uint32_t index = next - scheduler.tasks;
+    uint32_t start_ticks = *TRACE_TIMER_COUNT;
+    TRACE(TRACE_TASK_BEGIN, index);
+
+    next->function(next->arg);
+
+    TRACE(TRACE_TASK_END, index);
+    uint32_t run_ticks = *TRACE_TIMER_COUNT - start_ticks;
+    uint32_t finish_ms = scheduler_now_ms();
+
+    next->runs++;
+    next->total_run_ticks += run_ticks;
+    if (run_ticks > next->max_run_ticks) {
+        next->max_run_ticks = run_ticks;
+    }
+    if (now - release_ms > next->max_latency_ms) {
+        next->max_latency_ms = now - release_ms;
+    }
+    if (finish_ms - release_ms > next->deadline_ms) {
+        next->deadline_misses++;
+        metric_inc(next->misses_metric);
+        metric_inc(scheduler.misses);
+    }
+    metric_observe(scheduler.run_us, run_ticks / scheduler.ticks_per_us);
+
+    return true;
+}
+
+/**
+ * @brief Runs tasks as they become due (never returns)
+ */
+void scheduler_run(void) {
+
+    // Tasks added during start-up aren't late for the time it took
+    uint32_t now = scheduler_now_ms();
+    for (uint32_t i = 0; i < scheduler.task_count; i++) {
+        scheduler.tasks[i].next_release_ms = now;
+    }
+    scheduler.report_ms = now;
+
+    scheduler.running = true;
+
+    while (1) {
+        scheduler_run_once();
+    }
+}
+
+/**
+ * @brief Whether scheduler_run() has started (the 1ms tick leaves its work to the tasks from then on)
+ */
+bool scheduler_running(void) {
+    return scheduler.running;
+}
+
+/**
+ * @brief Number of tasks that have been added
+ */
+uint32_t scheduler_task_count(void) {
+    return scheduler.task_count;
+}
+
+/**
+ * @brief Reads the statistics of a task
+ *
+ * @param index task number (in the order they were added)
+ * @param stats filled in
+ * @return true if there is such a task
+ */
+bool scheduler_task_stats(uint32_t index, BM_TASK_STATS *stats) {
+
+    if (index >= scheduler.task_count) {
+        return false;
+    }
+
+    BM_TASK *task = &scheduler.tasks[index];
+
+    strcpy(stats->name, task->name);
+    stats->runs = task->runs;
+    stats->deadline_misses = task->deadline_misses;
+    stats->max_latency_ms = task->max_latency_ms;
+    stats->max_run_us = task->max_run_ticks / scheduler.ticks_per_us;
+    stats->mean_run_us = task->runs ? (uint32_t) (task->total_run_ticks / task->runs) / scheduler.ticks_per_us : 0;
+
+    return true;
+}
+
+/**
+ * @brief Logs the tasks that have missed deadlines since the last call
+ *
+ * Call it from a low priority task.  Tasks are numbered in the order they
+ * were added; their names are in the task.<name> metrics.
+ */
+void scheduler_log_stats(void) {
+
+    uint32_t now = scheduler_now_ms();
+    uint32_t seconds = (now - scheduler.report_ms + 500) / 1000;
+    scheduler.report_ms = now;
+
+    for (uint32_t i = 0; i < scheduler.task_count; i++) {
+        BM_TASK *task = &scheduler.tasks[i];
+        if (task->deadline_misses != task->reported_misses) {
+            log_event_fmt(EVENT_WARN, EVENT_FMT_TASK_DEADLINES,
+                          i,
+                          task->deadline_misses - task->reported_misses,
+                          seconds,
+                          task->max_run_ticks / scheduler.ticks_per_us);
+            task->reported_misses = task->deadline_misses;
+        }
+    }
+}
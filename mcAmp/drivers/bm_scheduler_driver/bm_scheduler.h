@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for the ARM task scheduler
+ *
+ */
+#ifndef _BM_SCHEDULER_H_
+#define _BM_SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCHEDULER_MAX_TASKS          (16)
+#define SCHEDULER_NAME_LENGTH        (16)    // including the terminating zero
+
+/*
+ * Suggested priorities (lower runs first).  Tasks with the same priority
+ * run in the order they were added.
+ */
+#define TASK_PRIORITY_REALTIME       (0)     // parameters the SHARC cores are waiting for
+#define TASK_PRIORITY_CONTROL        (1)     // push buttons, host messages
+#define TASK_PRIORITY_IO             (2)     // event log, bulk UART output
+#define TASK_PRIORITY_BACKGROUND     (3)     // LEDs, reports
+
+typedef void (*BM_TASK_FUNCTION)(void *arg);
+
+// Handle returned when a task is added (NULL if there is no room)
+typedef struct BM_TASK BM_TASK;
+
+// Run-time statistics of a task, filled in by scheduler_task_stats()
+typedef struct
+{
+    char name[SCHEDULER_NAME_LENGTH];
+    uint32_t runs;
+    uint32_t deadline_misses;        // runs that finished more than deadline_ms after they were due
+    uint32_t max_latency_ms;         // longest a task waited to start once due
+    uint32_t max_run_us;             // longest run
+    uint32_t mean_run_us;
+} BM_TASK_STATS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ARM only - set-up (before scheduler_run())
+bool scheduler_initialize(uint32_t timer_freq_hz);
+BM_TASK *scheduler_add_periodic(const char *name,
+                                BM_TASK_FUNCTION function,
+                                void *arg,
+                                uint32_t priority,
+                                uint32_t period_ms,
+                                uint32_t deadline_ms);
+BM_TASK *scheduler_add_event(const char *name,
+                             BM_TASK_FUNCTION function,
+                             void *arg,
+                             uint32_t priority,
+                             uint32_t deadline_ms);
+
+// Makes an event task ready (safe from interrupts)
+void scheduler_signal(BM_TASK *task);
+
+// Runs tasks forever (call at the end of main())
+void scheduler_run(void);
+bool scheduler_run_once(void);
+bool scheduler_running(void);
+
+// Statistics
+uint32_t scheduler_task_count(void);
+bool scheduler_task_stats(uint32_t index, BM_TASK_STATS *stats);
+void scheduler_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_SCHEDULER_H_
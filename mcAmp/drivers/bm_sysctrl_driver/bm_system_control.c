@@ -7,6 +7,23 @@
  *  1) Initializing the system clocks
  *  2) Providing a system "tick" for measuring duration and delays
  *  3) Support for the HADC
+ *
+ * The HADC runs a burst of HADC_SCANS_PER_TICK scans of all channels every
+ * tick.  Each tick, the results of the last burst are read out in one go
+ * (rather than a conversion at a time), the next burst is started and the
+ * converter carries on in the background.  The scans are then averaged
+ * (decimated) and filtered for each channel:
+ *
+ *  - a one-pole low-pass filter at the tick rate (the smoothing)
+ *  - hysteresis, so the value read only moves once the filtered value has
+ *    moved more than a set amount, then follows it.  Within the hysteresis
+ *    of either end, the value snaps to 0.0 or 1.0 so a pot turned all the
+ *    way still reads full scale.
+ *
+ * Both can be set per channel with hadc_set_filter().  A channel's value
+ * only changes when the pot (or input) really moves, and hadc_read_changes()
+ * returns the channels that changed, so code using the values only needs
+ * to do anything when one of them does, without its own deadband.
  */
 #include <math.h>
 #include <stddef.h>
@@ -22,12 +39,19 @@
 #include <services/pwr/adi_pwr.h>
 #include <services/tmr/adi_tmr.h>
 
+#if !defined(CORE0)
+#include <sysreg.h>
+#endif
+
 #include <cdefSC589.h>
 #include <defSC589.h>
 #include <sruSC589.h>
 
 #include "bm_system_control.h"
 
+// Cross-core binary trace
+#include "drivers/bm_trace_driver/bm_trace.h"
+
 //****************************************************************************
 // System tick resources (HADC sampling and delay function support)
 //****************************************************************************
@@ -48,19 +72,88 @@ bool this_core_reads_hadc = false;
 #define HADC_CHANNEL_MASK       (0xFF80)
 #define HADC_CHANNEL_MASK_INV   (0x7F)
 
+// Scans of all channels converted each tick (averaged into one value per channel)
+#define HADC_SCANS_PER_TICK     (8)
+
+// Default filtering (a time constant of about 20ms, and a step of 1/256 of full scale)
+#define HADC_DEFAULT_SMOOTHING  (0.05)
+#define HADC_DEFAULT_HYSTERESIS (1.0 / 256.0)
+
 ADI_HADC_HANDLE hadc_handle;
 uint8_t hadc_instance_memory[ADI_HADC_MEM_SIZE];
 
-// Channels for converted data
+// Each burst of scans, and the average of the last burst for each channel
+static uint16_t hadc_scans[HADC_SCANS_PER_TICK * HADC_CHANNELS];
 uint16_t hadc_channeldata_raw[HADC_CHANNELS] = {0};
-uint16_t hadc_channeldata_raw_last[HADC_CHANNELS] = {8192};
 
-static float hadc_channeldata_float[HADC_CHANNELS]={0.0};
-static float hadc_channeldata_float_pre[HADC_CHANNELS]={0.0};
+// Low-pass filtered values, and the values read (with hysteresis)
+static float hadc_channeldata_filtered[HADC_CHANNELS] = {0.0};
+static float hadc_channeldata_float[HADC_CHANNELS] = {0.0};
+
+// Filtering for each channel (see hadc_set_filter())
+static float hadc_smoothing[HADC_CHANNELS];
+static float hadc_hysteresis[HADC_CHANNELS];
 
+// Bit n is set when channel n has changed since hadc_read_changes() was last called
+static volatile uint32_t hadc_changed = 0;
 
 void (*one_ms_tick_callback)(void) = NULL;
 
+/**
+ * @brief      Reads the last burst of HADC scans and updates the channel values
+ *
+ * The burst should be done by now since we're in a 1KHz loop.  The next
+ * burst is started straight away so we're never waiting for the HADC.
+ */
+static void hadc_process_scans(void) {
+
+    ADI_HADC_RESULT result_HADC;
+    int i, scan;
+
+    // Get converted data (HADC_SCANS_PER_TICK scans of every channel)
+    result_HADC = adi_hadc_GetConvertedData(hadc_handle, HADC_CHANNEL_MASK_INV, hadc_scans);
+    if (ADI_HADC_SUCCESS != result_HADC) {
+        // handle HADC errors here
+    }
+
+    // Kick off the next burst for next time through the timer loop
+    result_HADC = adi_hadc_StartConversion(hadc_handle, true);
+    if (ADI_HADC_SUCCESS != result_HADC) {
+        // handle HADC errors here
+    }
+
+    for (i = 0; i < HADC_CHANNELS; i++) {
+
+        // Decimate the burst to one value
+        uint32_t sum = 0;
+        for (scan = 0; scan < HADC_SCANS_PER_TICK; scan++) {
+            sum += hadc_scans[scan * HADC_CHANNELS + i];
+        }
+        hadc_channeldata_raw[i] = sum / HADC_SCANS_PER_TICK;
+
+        // Low-pass filter it (normalized from 0.0 - 1.0)
+        float cur_val = ((float)hadc_channeldata_raw[i]) * (1.0 / HADC_MAX);
+        hadc_channeldata_filtered[i] += hadc_smoothing[i] * (cur_val - hadc_channeldata_filtered[i]);
+
+        // Only move the value read once the filtered value has moved past the hysteresis
+        float value = hadc_channeldata_filtered[i];
+        if (value < hadc_hysteresis[i]) {
+            value = 0.0;
+        }
+        else if (value > 1.0 - hadc_hysteresis[i]) {
+            value = 1.0;
+        }
+        else if (fabsf(value - hadc_channeldata_float[i]) < hadc_hysteresis[i]) {
+            continue;
+        }
+
+        if (value != hadc_channeldata_float[i]) {
+            hadc_channeldata_float[i] = value;
+            hadc_changed |= (1 << i);
+        }
+    }
+}
+
 /**
  * @brief      This is a simple "tick" interrupt handler that is triggered once
  *             every millisecond.  It supports the delay() function and also
@@ -74,8 +167,6 @@ static void systemtimer_handler(void *pCBParam,
                                 uint32_t Event,
                                 void *pArg) {
 
-    int i;
-
     switch (Event)
     {
         case ADI_TMR_EVENT_DATA_INT:
@@ -83,36 +174,11 @@ static void systemtimer_handler(void *pCBParam,
             // Increment our ticks using a big, unsigned 64-bit int.  This is
             // used to support the delay() and millis() functions
             system_milliticks++;
+            TRACE(TRACE_TICK, (uint32_t)system_milliticks);
 
             // If this core is responsible for managing the HADCs, do that!
             if (this_core_reads_hadc) {
-
-                // Normalize our last set of conversions (from 0.0 - 1.0)
-                for (i = 0; i < HADC_CHANNELS; i++) {
-
-                    // Add some hysteresis to remove noise when they POTs aren't changing
-					float cur_val = ((float)hadc_channeldata_raw[i]) * (1.0 / HADC_MAX);
-					hadc_channeldata_float_pre[i] += 0.01*(cur_val - hadc_channeldata_float_pre[i]);
-					hadc_channeldata_float[i] = floor(hadc_channeldata_float_pre[i]*1000.0)*.001;
-
-                }
-
-                // Wait until the conversion sequence to is complete (although it
-                // should be done by now since we're in a 1KHz loop
-                ADI_HADC_RESULT result_HADC;
-
-                // Get converted data
-                result_HADC = adi_hadc_GetConvertedData(hadc_handle, HADC_CHANNEL_MASK_INV, hadc_channeldata_raw);
-                if (ADI_HADC_SUCCESS != result_HADC) {
-                    // handle HADC errors here
-                }
-
-                // Kick off the next conversion for next time through the timer
-                // loop (so we're not wasting time waiting)
-                result_HADC = adi_hadc_StartConversion(hadc_handle, true);
-                if (ADI_HADC_SUCCESS != result_HADC) {
-                    // handle HADC errors here
-                }
+                hadc_process_scans();
             }
 
             // If a user callback has been set for the 1ms tick event, call it
@@ -203,6 +269,11 @@ BM_SYSCTRL_RESULT simple_sysctrl_init(uint32_t ext_oscillator_freq,
 
     // If this core is responsible for initializing and polling the HADCs
     if (control_hadc) {
+
+        for (int i = 0; i < HADC_CHANNELS; i++) {
+            hadc_smoothing[i] = HADC_DEFAULT_SMOOTHING;
+            hadc_hysteresis[i] = HADC_DEFAULT_HYSTERESIS;
+        }
         this_core_reads_hadc = true;
 
         // Open the HADC driver
@@ -219,11 +290,12 @@ BM_SYSCTRL_RESULT simple_sysctrl_init(uint32_t ext_oscillator_freq,
             return SYSCTRL_HADC_INIT_ERROR;
         }
 
-        if (adi_hadc_SetNumConversions(hadc_handle, 1) != ADI_HADC_SUCCESS) {
+        // Each start converts a burst of scans, read out together on the next tick
+        if (adi_hadc_SetNumConversions(hadc_handle, HADC_SCANS_PER_TICK) != ADI_HADC_SUCCESS) {
             return SYSCTRL_HADC_INIT_ERROR;
         }
 
-        // Kick off first conversion
+        // Kick off first burst
         if (adi_hadc_StartConversion(hadc_handle, true) != ADI_HADC_SUCCESS) {
             return SYSCTRL_HADC_INIT_ERROR;
         }
@@ -359,3 +431,56 @@ uint16_t hadc_read(uint8_t pin) {
 
     return hadc_channeldata_raw[pin];
 }
+
+/**
+ * @brief      Sets the filtering for an HADC channel
+ *
+ * @param[in]  pin         The HADC pin
+ * @param[in]  smoothing   Low-pass filter coefficient per 1ms tick (0.0 - 1.0, 1.0 is no filtering)
+ * @param[in]  hysteresis  Distance the filtered value must move before the value read follows (0.0 - 0.5)
+ */
+void hadc_set_filter(uint8_t pin, float smoothing, float hysteresis) {
+
+    if (pin >= HADC_CHANNELS) return;
+
+    if (smoothing > 0.0 && smoothing <= 1.0) {
+        hadc_smoothing[pin] = smoothing;
+    }
+    if (hysteresis >= 0.0 && hysteresis < 0.5) {
+        hadc_hysteresis[pin] = hysteresis;
+    }
+}
+
+/**
+ * @brief      Returns the HADC channels whose value has changed
+ *
+ * This clears the changes, so it should only be called from one place (on
+ * the ARM, the "hadc" scheduler task).  The tick interrupt can set new bits
+ * at any time, so the bits are read and cleared in one atomic step; a change
+ * that arrives during the call is returned by the next call instead of
+ * being lost.
+ *
+ * @return     Bit n is set if hadc_read_float(n) has changed since the last call
+ */
+uint32_t hadc_read_changes(void) {
+
+    #if defined(CORE0)
+
+    return __sync_fetch_and_and(&hadc_changed, 0);
+
+    #else
+
+    uint32_t interrupts_enabled = sysreg_read(sysreg_MODE1) & IRPTEN;
+    sysreg_bit_clr(sysreg_MODE1, IRPTEN);
+
+    uint32_t changed = hadc_changed;
+    hadc_changed = 0;
+
+    if (interrupts_enabled) {
+        sysreg_bit_set(sysreg_MODE1, IRPTEN);
+    }
+
+    return changed;
+
+    #endif
+}
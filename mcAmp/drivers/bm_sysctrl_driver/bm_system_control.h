@@ -39,6 +39,10 @@ void simple_sysctrl_set_1ms_callback(void (*tick_callback)(void));
 // Reads HADC captured values
 uint16_t hadc_read(uint8_t);
 float hadc_read_float(uint8_t pin);
+uint32_t hadc_read_changes(void);
+
+// Sets the filtering for an HADC channel
+void hadc_set_filter(uint8_t pin, float smoothing, float hysteresis);
 
 // Delay and timing functions
 uint64_t millis(void);
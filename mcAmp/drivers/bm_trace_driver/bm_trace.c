@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver for binary tracing.
+ *
+ * The event log shows what happened but not how the three cores interleave
+ * in time.  This driver keeps a fixed-size ring of binary trace records for
+ * each core in shared, uncached L2.  Each record is a timestamp, an event ID
+ * (see common/trace_events.h) and a payload word.  Records are written with
+ * plain stores - there is no formatting, no locking between cores and
+ * nothing is ever waited on - so trace points can be left in interrupt
+ * handlers and the audio path.
+ *
+ * Timestamps come from a GP timer that the ARM runs continuously from
+ * SCLK0, so records from all three cores share one time base.  The rings
+ * overwrite their oldest records; to look at a window of time, freeze the
+ * trace (trace_freeze(), or set TRACE_FREEZE_ON_OVERRUN to freeze when a
+ * frame is dropped), save TRACE_BUFFER_SIZE bytes from TRACE_BUFFER_ADDRESS
+ * with the debugger and convert them with tools/trace_export.py.  The
+ * exporter merges the three rings into Chrome trace / Perfetto JSON.
+ *
+ * A record is claimed by moving the ring's head and is complete once its
+ * sequence word (written last) matches its position in the ring.  Each ring
+ * only has one writer core, so interrupts are masked for the few
+ * instructions it takes to move the head, as trace points are hit from
+ * several interrupt levels.  The ARM doesn't use an exclusive (LDREX/STREX)
+ * atomic add, as exclusive accesses to uncached L2 may never succeed.
+ *
+ * The rings are at a fixed address, so a core only starts tracing once it
+ * has checked that address against its linker symbols: the ARM checks that
+ * its stack and heap are clear of it and the SHARC cores check that their
+ * .ldf files reserve it (trace_initialize_sharc_core()).
+ *
+ * @file       bm_trace.c
+ * @brief      cross-core binary trace buffers
+ */
+#include <sys/platform.h>
+
+#include "bm_trace.h"
+
+#if defined(CORE0)
+#include <services/tmr/adi_tmr.h>
+
+static ADI_TMR_HANDLE trace_timer_handle;
+static uint8_t trace_timer_memory[ADI_TMR_MEMORY];
+
+/**
+ * @brief Handler for the trace timer (it only interrupts when it wraps)
+ */
+static void trace_timer_handler(void *pCBParam,
+                                uint32_t Event,
+                                void *pArg) {
+}
+
+/**
+ * @brief Runs the trace timer freely over its full 32-bit range
+ *
+ * The scheduler times tasks with this timer too, so it is started even when
+ * tracing is compiled out or the trace rings can't be used.
+ *
+ * @return true if successful
+ */
+static bool trace_timer_start(void) {
+
+    if (adi_tmr_Open(TRACE_TIMER_ID,
+                     trace_timer_memory,
+                     ADI_TMR_MEMORY,
+                     trace_timer_handler,
+                     NULL,
+                     &trace_timer_handle) != ADI_TMR_SUCCESS) {
+        return false;
+    }
+
+    if (adi_tmr_SetMode(trace_timer_handle, ADI_TMR_MODE_CONTINUOUS_PWMOUT) != ADI_TMR_SUCCESS ||
+        adi_tmr_SetIRQMode(trace_timer_handle, ADI_TMR_IRQMODE_PERIOD) != ADI_TMR_SUCCESS ||
+        adi_tmr_SetPeriod(trace_timer_handle, 0xFFFFFFFF) != ADI_TMR_SUCCESS ||
+        adi_tmr_SetWidth(trace_timer_handle, 0x7FFFFFFF) != ADI_TMR_SUCCESS ||
+        adi_tmr_SetDelay(trace_timer_handle, 1) != ADI_TMR_SUCCESS ||
+        adi_tmr_Enable(trace_timer_handle, true) != ADI_TMR_SUCCESS) {
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+#if (TRACE_ENABLED)
+
+#if defined(CORE0)
+#define TRACE_CORE              (0)
+#define TRACE_SYNC()            __sync_synchronize()
+#else
+#include <sysreg.h>
+#if defined(CORE1)
+#define TRACE_CORE              (1)
+#else
+#define TRACE_CORE              (2)
+#endif
+#define TRACE_SYNC()            asm volatile("sync;")
+#endif
+
+// Trace rings for all three cores
+static BM_TRACE_BUFFERS *const trace_buffers = (BM_TRACE_BUFFERS *) TRACE_BUFFER_ADDRESS;
+
+// Set once this core has checked that the trace rings are clear of anything it links
+static bool trace_region_checked = false;
+
+/**
+ * @brief Records a trace event for this core
+ *
+ * Events are ignored until the ARM has set up the trace rings and while the
+ * trace is frozen.
+ *
+ * @param id event ID from common/trace_events.h
+ * @param payload event-specific payload word
+ */
+#pragma optimize_for_speed
+void trace_event(BM_TRACE_EVENT_ID id, uint32_t payload) {
+
+    if (!trace_region_checked || trace_buffers->magic != TRACE_MAGIC || trace_buffers->frozen) {
+        return;
+    }
+
+    BM_TRACE_RING *ring = &trace_buffers->ring[TRACE_CORE];
+
+    // Claim the next record
+    #if defined(CORE0)
+    uint32_t cpsr;
+    asm volatile("mrs %0, cpsr\n\tcpsid i" : "=r"(cpsr) : : "memory");
+    uint32_t head = ring->head;
+    ring->head = head + 1;
+    asm volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
+    #else
+    uint32_t interrupts_enabled = sysreg_read(sysreg_MODE1) & IRPTEN;
+    sysreg_bit_clr(sysreg_MODE1, IRPTEN);
+    uint32_t head = ring->head;
+    ring->head = head + 1;
+    if (interrupts_enabled) {
+        sysreg_bit_set(sysreg_MODE1, IRPTEN);
+    }
+    #endif
+
+    BM_TRACE_RECORD *record = &ring->record[head & (TRACE_RECORDS_PER_CORE - 1)];
+    record->timestamp = *TRACE_TIMER_COUNT;
+    record->event     = (uint32_t)id;
+    record->payload   = payload;
+
+    // Publish the record
+    TRACE_SYNC();
+    record->sequence  = head + 1;
+}
+
+/**
+ * @brief Stops recording on all cores so the current window can be saved
+ */
+void trace_freeze(void) {
+
+    if (!trace_region_checked || trace_buffers->magic != TRACE_MAGIC || trace_buffers->frozen) {
+        return;
+    }
+
+    trace_event(TRACE_FROZEN, TRACE_CORE);
+    TRACE_SYNC();
+    trace_buffers->frozen = true;
+}
+
+/**
+ * @brief Starts recording again after trace_freeze()
+ */
+void trace_resume(void) {
+    trace_buffers->frozen = false;
+}
+
+/**
+ * The code below is only compiled on the ARM processor not on the SHARC cores
+ */
+#if defined(CORE0)
+
+// Stack and heap bounds, if the linker script provides them
+extern uint32_t __StackLimit __attribute__((weak));
+extern uint32_t __StackTop __attribute__((weak));
+extern uint32_t __HeapBase __attribute__((weak));
+extern uint32_t __HeapLimit __attribute__((weak));
+
+/**
+ * @brief Checks whether a region from the linker script overlaps the trace rings
+ *
+ * @param start start of the region (0 if the linker script doesn't define it)
+ * @param end end of the region (0 if the linker script doesn't define it)
+ * @return true if the region overlaps the trace rings
+ */
+static bool trace_region_overlaps(uintptr_t start,
+                                  uintptr_t end) {
+
+    if (start == 0 || end == 0) {
+        return false;
+    }
+
+    return (start < TRACE_BUFFER_ADDRESS + TRACE_BUFFER_SIZE) && (end > TRACE_BUFFER_ADDRESS);
+}
+
+/**
+ * @brief Clears the trace rings and starts the trace timer
+ *
+ * This should be called by the ARM before the SHARC cores are started.
+ *
+ * @param timer_freq_hz frequency of the clock driving the GP timers (SCLK0)
+ * @return true if successful, false if the timer couldn't be set up or the
+ *         rings overlap the ARM's stack or heap (the timer still runs then)
+ */
+bool trace_initialize_arm(uint32_t timer_freq_hz) {
+
+    // Start the timer first, the scheduler needs it even if the rings can't be used
+    if (!trace_timer_start()) {
+        return false;
+    }
+
+    if (sizeof(BM_TRACE_BUFFERS) > TRACE_BUFFER_SIZE) {
+        return false;
+    }
+
+    // The ARM's stack and heap are the only things it could have placed in uncached L2
+    if (trace_region_overlaps((uintptr_t) &__StackLimit, (uintptr_t) &__StackTop) ||
+        trace_region_overlaps((uintptr_t) &__HeapBase, (uintptr_t) &__HeapLimit)) {
+        return false;
+    }
+    trace_region_checked = true;
+
+    trace_buffers->magic = 0;
+    TRACE_SYNC();
+
+    for (int i = 0; i < TRACE_CORES; i++) {
+        trace_buffers->ring[i].head = 0;
+        for (int j = 0; j < TRACE_RECORDS_PER_CORE; j++) {
+            trace_buffers->ring[i].record[j].sequence = 0;
+        }
+    }
+    trace_buffers->timer_freq_hz = timer_freq_hz;
+    trace_buffers->records_per_core = TRACE_RECORDS_PER_CORE;
+    trace_buffers->frozen = false;
+
+    // Let the other cores start recording
+    TRACE_SYNC();
+    trace_buffers->magic = TRACE_MAGIC;
+
+    return true;
+}
+
+#else
+
+// Trace memory reserved by app.ldf
+extern "asm" char ldf_trace_buffers;
+extern "asm" char ldf_trace_buffers_length;
+
+/**
+ * @brief Checks that this core's .ldf file reserves the trace rings
+ *
+ * Nothing is traced from this core until this has been called, so records
+ * are never written over anything the linker placed at TRACE_BUFFER_ADDRESS.
+ *
+ * @return true if the trace memory is reserved, false if tracing is disabled on this core
+ */
+bool trace_initialize_sharc_core(void) {
+
+    if ((uintptr_t) &ldf_trace_buffers != TRACE_BUFFER_ADDRESS ||
+        (uint32_t) &ldf_trace_buffers_length < TRACE_BUFFER_SIZE) {
+        return false;
+    }
+
+    trace_region_checked = true;
+
+    return true;
+}
+
+#endif  // CORE0
+
+#else
+
+// Keep calls that aren't made through TRACE() in place when tracing is compiled out
+bool trace_initialize_arm(uint32_t timer_freq_hz) {
+    #if defined(CORE0)
+    return trace_timer_start();
+    #else
+    return true;
+    #endif
+}
+
+bool trace_initialize_sharc_core(void) {
+    return true;
+}
+
+void trace_event(BM_TRACE_EVENT_ID id, uint32_t payload) {
+}
+
+void trace_freeze(void) {
+}
+
+void trace_resume(void) {
+}
+
+#endif  // TRACE_ENABLED
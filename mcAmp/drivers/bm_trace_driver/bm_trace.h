@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * Bare-Metal ("BM") device driver header file for binary tracing
+ *
+ */
+#ifndef _BM_TRACE_H_
+#define _BM_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Event IDs for trace_event()
+#include "common/trace_events.h"
+
+// Set to false to compile all trace points out
+#define TRACE_ENABLED                (true)
+
+// Stop recording on all cores when a SHARC core drops an audio frame
+#define TRACE_FREEZE_ON_OVERRUN      (false)
+
+// Records in each core's trace ring (must be a power of two)
+#define TRACE_RECORDS_PER_CORE       (256)
+#define TRACE_CORES                  (3)
+
+/*
+ * The trace rings live in the 16KB of uncached L2 after the MCAPI areas.
+ * Like MULTICORE_DATA, they are placed at a fixed address rather than by the
+ * linker so all three cores (and a debugger) can find them.  The SHARC .ldf
+ * files reserve this memory (ldf_trace_buffers) and each core checks at
+ * start-up that nothing it links is placed there before it starts tracing.
+ */
+#define TRACE_BUFFER_ADDRESS         (0x20084000)
+#define TRACE_BUFFER_SIZE            (0x4000)
+#define TRACE_MAGIC                  (0x45435254)    // "TRCE"
+
+/*
+ * GP timer used as the common time base.  The ARM runs it continuously
+ * from SCLK0 and every core reads its count, so timestamps from all three
+ * cores can be compared directly.  The count wraps every 2^32 ticks (about
+ * 38 seconds at 112.5 MHz).
+ */
+#define TRACE_TIMER_ID               (7)
+#define TRACE_TIMER_COUNT            (pREG_TIMER0_TMR7_CNT)
+
+// One trace event.  sequence is written last, so a record is complete once it matches its slot.
+typedef struct
+{
+    uint32_t timestamp;              // trace timer count
+    uint32_t event;                  // BM_TRACE_EVENT_ID
+    uint32_t payload;
+    volatile uint32_t sequence;      // index of the record in the ring + 1
+} BM_TRACE_RECORD;
+
+/*
+ * Ring written by one core.  head increases forever and is masked to index
+ * the records, so the oldest records are overwritten once the ring is full.
+ * As each ring only has one writer core, no lock is shared between cores.
+ * Within a core, trace points are hit from several interrupt levels, so
+ * each core masks its interrupts (IRQs on the ARM, IRPTEN on the SHARCs)
+ * for the few instructions it takes to move the head.
+ */
+typedef struct
+{
+    volatile uint32_t head;
+    uint32_t pad[3];
+    BM_TRACE_RECORD record[TRACE_RECORDS_PER_CORE];
+} BM_TRACE_RING;
+
+typedef struct
+{
+    volatile uint32_t magic;         // TRACE_MAGIC once the ARM has set up the rings
+    uint32_t timer_freq_hz;
+    uint32_t records_per_core;
+    volatile uint32_t frozen;        // recording stops on all cores while this is set
+    uint32_t pad[4];
+    BM_TRACE_RING ring[TRACE_CORES]; // ARM, SHARC core 1, SHARC core 2
+} BM_TRACE_BUFFERS;
+
+#if (TRACE_ENABLED)
+#define TRACE(id, payload)           trace_event(id, payload)
+#else
+#define TRACE(id, payload)           ((void) 0)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool trace_initialize_arm(uint32_t timer_freq_hz);
+bool trace_initialize_sharc_core(void);
+
+void trace_event(BM_TRACE_EVENT_ID id, uint32_t payload);
+
+void trace_freeze(void);
+void trace_resume(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BM_TRACE_H_
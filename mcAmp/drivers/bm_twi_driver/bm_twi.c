@@ -6,6 +6,9 @@
 
 #include "bm_twi.h"
 
+// Cross-core binary trace
+#include "drivers/bm_trace_driver/bm_trace.h"
+
 /**
  * @brief      Initialize an instance of the TWI driver
  *
@@ -167,6 +170,8 @@ BM_TWI_RESULT twi_write(BM_TWI *device,
         *device->pREG_TWI_MSTRADDR = device->address;
     }
 
+    TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
     // load 8-bit TX data register with value to transmit
     (*device->pREG_TWI_TXDATA8) = value;
 
@@ -178,6 +183,7 @@ BM_TWI_RESULT twi_write(BM_TWI *device,
     // wait for transmission to complete
     while (!((*device->pREG_TWI_ISTAT) & BITM_TWI_ISTAT_MCOMP)) {
         if (timeoutTimer-- == 0) {
+            TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
             return TWI_SIMPLE_TIMEOUT;
         }
     }
@@ -185,6 +191,7 @@ BM_TWI_RESULT twi_write(BM_TWI *device,
     // Clear completion status bit
     (*device->pREG_TWI_ISTAT) |= BITM_TWI_ISTAT_MCOMP;
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -213,6 +220,8 @@ BM_TWI_RESULT twi_write_r(BM_TWI *device,
         *device->pREG_TWI_MSTRADDR = device->address;
     }
 
+    TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
     // Load 8-bit TX data register with value to transmit
     (*device->pREG_TWI_TXDATA8) = value;
 
@@ -232,12 +241,14 @@ BM_TWI_RESULT twi_write_r(BM_TWI *device,
             // Flush the FIFO
             (*device->pREG_TWI_FIFOCTL) = 1;
             (*device->pREG_TWI_FIFOCTL) = 0;
+            TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
             return TWI_SIMPLE_TIMEOUT;
         }
     }
 
     (*device->pREG_TWI_ISTAT) |= BITM_TWI_ISTAT_MCOMP;
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -290,6 +301,8 @@ BM_TWI_RESULT twi_write_block_r(BM_TWI *device,
 
     // We need to do things manually in case block size is greater than 255 (max supported in HW)
     else {
+        TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
         for (i = 0; i < count - 1; i++) {
             // Load value into TX register
             (*device->pREG_TWI_TXDATA8) = values[i];
@@ -308,6 +321,7 @@ BM_TWI_RESULT twi_write_block_r(BM_TWI *device,
                     (*device->pREG_TWI_FIFOCTL) = 1;
                     (*device->pREG_TWI_FIFOCTL) = 0;
 
+                    TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
                     return TWI_SIMPLE_TIMEOUT;
                 }
             }
@@ -329,12 +343,14 @@ BM_TWI_RESULT twi_write_block_r(BM_TWI *device,
                 (*device->pREG_TWI_FIFOCTL) = 1;
                 (*device->pREG_TWI_FIFOCTL) = 0;
 
+                TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
                 return TWI_SIMPLE_TIMEOUT;
             }
         }
         (*device->pREG_TWI_ISTAT) |= BITM_TWI_ISTAT_MCOMP;
     }
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -372,6 +388,8 @@ BM_TWI_RESULT twi_read(BM_TWI *device,
         *device->pREG_TWI_MSTRADDR = device->address;
     }
 
+    TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
     // Enable master transmitter
     (*device->pREG_TWI_MSTRCTL)  =   BITM_TWI_MSTRCTL_DIR | // receive mode
                                    (1 << 6) | // set count to a 1
@@ -381,6 +399,7 @@ BM_TWI_RESULT twi_read(BM_TWI *device,
     // wait for transmission to complete
     while (!((*device->pREG_TWI_ISTAT) & BITM_TWI_ISTAT_MCOMP)) {
         if (timeoutTimer-- == 0) {
+            TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
             return TWI_SIMPLE_TIMEOUT;
         }
     }
@@ -390,6 +409,7 @@ BM_TWI_RESULT twi_read(BM_TWI *device,
 
     *device->pREG_TWI_FIFOCTL |= (1<<1);
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -417,6 +437,8 @@ BM_TWI_RESULT twi_read_r(BM_TWI *device,
         *device->pREG_TWI_MSTRADDR = device->address;
     }
 
+    TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
     // Enable master transmitter
     (*device->pREG_TWI_MSTRCTL)  =    BITM_TWI_MSTRCTL_DIR | // receive mode
                                    (1 << 6) | // set count to a 1
@@ -427,6 +449,7 @@ BM_TWI_RESULT twi_read_r(BM_TWI *device,
     // wait for transmission to complete
     while (!((*device->pREG_TWI_ISTAT) & BITM_TWI_ISTAT_MCOMP)) {
         if (timeoutTimer-- == 0) {
+            TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
             return TWI_SIMPLE_TIMEOUT;
         }
     }
@@ -435,6 +458,7 @@ BM_TWI_RESULT twi_read_r(BM_TWI *device,
 
     *value = (*device->pREG_TWI_RXDATA8);
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -463,6 +487,8 @@ BM_TWI_RESULT twi_read_block_r(BM_TWI *device,
         *device->pREG_TWI_MSTRADDR = device->address;
     }
 
+    TRACE(TRACE_TWI_BEGIN, *device->pREG_TWI_MSTRADDR);
+
     int i;
     for (i = 0; i < count - 1; i++) {
 
@@ -475,6 +501,7 @@ BM_TWI_RESULT twi_read_block_r(BM_TWI *device,
         timeoutTimer = TWI_TIMEOUT_COUNT;
         while (!((*device->pREG_TWI_ISTAT) & BITM_TWI_ISTAT_RXSERV)) {
             if (timeoutTimer-- == 0) {
+                TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
                 return TWI_SIMPLE_TIMEOUT;
             }
         }
@@ -491,6 +518,7 @@ BM_TWI_RESULT twi_read_block_r(BM_TWI *device,
     timeoutTimer = TWI_TIMEOUT_COUNT;
     while (!((*device->pREG_TWI_ISTAT) & BITM_TWI_ISTAT_MCOMP)) {
         if (timeoutTimer-- == 0) {
+            TRACE(TRACE_TWI_END, TWI_SIMPLE_TIMEOUT);
             return TWI_SIMPLE_TIMEOUT;
         }
     }
@@ -498,6 +526,7 @@ BM_TWI_RESULT twi_read_block_r(BM_TWI *device,
 
     values[count - 1] = (*device->pREG_TWI_RXDATA8);
 
+    TRACE(TRACE_TWI_END, TWI_SIMPLE_SUCCESS);
     return TWI_SIMPLE_SUCCESS;
 }
 
@@ -9,6 +9,52 @@
 #include <services/int/adi_int.h>
 #include <sys/platform.h>
 
+#if defined(CORE0)
+#include <runtime/cache/adi_cache.h>
+#else
+#include <sys/cache.h>
+#include <sysreg.h>
+#endif
+
+/*
+ * SHARC L1 addresses must be converted to the multiprocessor space before
+ * being given to DMA (see AUDIO_DMA_MP_OFFSET in bm_audio_flow.h)
+ */
+#if defined(CORE1)
+#define UART_DMA_MP_OFFSET      (0x28000000)
+#elif defined(CORE2)
+#define UART_DMA_MP_OFFSET      (0x28800000)
+#else
+#define UART_DMA_MP_OFFSET      (0)
+#endif
+#define UART_DMA_L1_ADDR_MASK   (0xFFC00000)
+
+/*
+ * The TX buffer is written from the background loop, the 1ms tick and the
+ * TX DMA interrupt, so interrupts are masked while a write updates it.
+ */
+static inline uint32_t uart_interrupts_disable(void) {
+    #if defined(CORE0)
+    uint32_t cpsr;
+    asm volatile("mrs %0, cpsr\n\tcpsid i" : "=r"(cpsr) : : "memory");
+    return cpsr;
+    #else
+    uint32_t interrupts_enabled = sysreg_read(sysreg_MODE1) & IRPTEN;
+    sysreg_bit_clr(sysreg_MODE1, IRPTEN);
+    return interrupts_enabled;
+    #endif
+}
+
+static inline void uart_interrupts_restore(uint32_t state) {
+    #if defined(CORE0)
+    asm volatile("msr cpsr_c, %0" : : "r"(state) : "memory");
+    #else
+    if (state) {
+        sysreg_bit_set(sysreg_MODE1, IRPTEN);
+    }
+    #endif
+}
+
 // Static function prototypes
 static BM_UART_RESULT uart_read_from_tx_buffer(BM_UART *device, uint8_t *val);
 static BM_UART_RESULT uart_write_to_rx_buffer(BM_UART *device, uint8_t val);
@@ -17,6 +63,7 @@ static bool uart_check_tx_status(BM_UART *device);
 static uint8_t uart_read_rx_value(BM_UART *device);
 static void uart_write_tx_value(BM_UART *device, uint8_t val);
 static void uart_clear_tx_interrupt(BM_UART *device);
+static void uart_tx_dma_start(BM_UART *device);
 
 /**
  * @brief      Custom handler for any FIFO errors
@@ -56,11 +103,10 @@ static void uart_status_handler(uint32_t SID,
                                 void *device_ptr) {
 
     static int uart_words_received = 0,
-               uart_words_transmitted = 0,
                uart_fifo_overruns = 0;
 
     BM_UART_RESULT result;
-    uint8_t curRxVal, nextTxVal = 0;
+    uint8_t curRxVal;
 
     BM_UART *device = (BM_UART *)device_ptr;
 
@@ -110,6 +156,11 @@ static void uart_status_handler(uint32_t SID,
      ********************************************************************************
      */
 
+    #if !(UART_TX_USE_DMA)
+
+    static int uart_words_transmitted = 0;
+    uint8_t nextTxVal = 0;
+
     // Clear the TX interrupt if it's set
     uart_clear_tx_interrupt(device);
 
@@ -127,6 +178,37 @@ static void uart_status_handler(uint32_t SID,
             uart_words_transmitted++;
         }
     }
+
+    #endif
+}
+
+/**
+ * @brief      Handler for the UART TX DMA completion interrupt
+ *
+ * Frees the chunk that has just been sent and starts DMA on the next one.  If
+ * there is nothing left to send, transmit requests are masked until the next
+ * write (see uart_tx_dma_start()).
+ *
+ * @param[in]  SID         The interrupt id
+ * @param      device_ptr  The pointer to the device driver instance
+ */
+static void uart_tx_dma_handler(uint32_t SID,
+                                void *device_ptr) {
+
+    BM_UART *device = (BM_UART *)device_ptr;
+
+    // Clear the DMA interrupt
+    *device->pREG_DMA_TX_STAT = BITM_DMA_STAT_IRQDONE;
+
+    // Release the bytes that have been sent
+    uint16_t readptr = device->tx_buffer_readptr + device->tx_dma_length;
+    if (readptr >= UART_BUFFER_SIZE) {
+        readptr -= UART_BUFFER_SIZE;
+    }
+    device->tx_buffer_readptr = readptr;
+    device->tx_dma_length = 0;
+
+    uart_tx_dma_start(device);
 }
 
 /**
@@ -154,6 +236,12 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
         device->pREG_UART_IMSK_CLR  = (volatile uint32_t *)pREG_UART0_IMSK_CLR;
         device->pREG_UART_IMSK_SET  = (volatile uint32_t *)pREG_UART0_IMSK_SET;
         device->pREG_UART_STAT      = (volatile uint32_t *)pREG_UART0_STAT;
+
+        device->pREG_DMA_TX_CFG       = (volatile uint32_t *)pREG_DMA20_CFG;
+        device->pREG_DMA_TX_ADDRSTART = (volatile uint32_t *)pREG_DMA20_ADDRSTART;
+        device->pREG_DMA_TX_XCNT      = (volatile uint32_t *)pREG_DMA20_XCNT;
+        device->pREG_DMA_TX_XMOD      = (volatile uint32_t *)pREG_DMA20_XMOD;
+        device->pREG_DMA_TX_STAT      = (volatile uint32_t *)pREG_DMA20_STAT;
     }
 
     // Control registers for UART1
@@ -166,6 +254,12 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
         device->pREG_UART_IMSK_CLR  = (volatile uint32_t *)pREG_UART1_IMSK_CLR;
         device->pREG_UART_IMSK_SET  = (volatile uint32_t *)pREG_UART1_IMSK_SET;
         device->pREG_UART_STAT      = (volatile uint32_t *)pREG_UART1_STAT;
+
+        device->pREG_DMA_TX_CFG       = (volatile uint32_t *)pREG_DMA34_CFG;
+        device->pREG_DMA_TX_ADDRSTART = (volatile uint32_t *)pREG_DMA34_ADDRSTART;
+        device->pREG_DMA_TX_XCNT      = (volatile uint32_t *)pREG_DMA34_XCNT;
+        device->pREG_DMA_TX_XMOD      = (volatile uint32_t *)pREG_DMA34_XMOD;
+        device->pREG_DMA_TX_STAT      = (volatile uint32_t *)pREG_DMA34_STAT;
     }
 
     // Control registers for UART2
@@ -178,6 +272,12 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
         device->pREG_UART_IMSK_CLR  = (volatile uint32_t *)pREG_UART2_IMSK_CLR;
         device->pREG_UART_IMSK_SET  = (volatile uint32_t *)pREG_UART2_IMSK_SET;
         device->pREG_UART_STAT      = (volatile uint32_t *)pREG_UART2_STAT;
+
+        device->pREG_DMA_TX_CFG       = (volatile uint32_t *)pREG_DMA37_CFG;
+        device->pREG_DMA_TX_ADDRSTART = (volatile uint32_t *)pREG_DMA37_ADDRSTART;
+        device->pREG_DMA_TX_XCNT      = (volatile uint32_t *)pREG_DMA37_XCNT;
+        device->pREG_DMA_TX_XMOD      = (volatile uint32_t *)pREG_DMA37_XMOD;
+        device->pREG_DMA_TX_STAT      = (volatile uint32_t *)pREG_DMA37_STAT;
     }
 
     else {
@@ -190,7 +290,12 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
     device->config     = config;
 
     // Set BAUD rate from presets
-    *device->pREG_UART_CLK = baud;
+    if (baud & UART_BAUD_DIVIDE_BY_ONE) {
+        *device->pREG_UART_CLK = (baud & ~UART_BAUD_DIVIDE_BY_ONE) | BITM_UART_CLK_EDBO;
+    }
+    else {
+        *device->pREG_UART_CLK = baud;
+    }
 
     // Configure parity, start/stop bits and word length, enable
     *device->pREG_UART_CTL |= (uint32_t)((config << 8) & 0x0000FF00);
@@ -201,11 +306,28 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
     device->rx_buffer_writeptr = 0;
     device->tx_buffer_readptr = 0;
     device->tx_buffer_writeptr = 0;
+    device->tx_dma_length = 0;
+
+    #if (UART_TX_USE_DMA)
+
+    // Stop the TX DMA channel in case it was left running
+    *device->pREG_DMA_TX_CFG = 0;
+    *device->pREG_DMA_TX_STAT = BITM_DMA_STAT_IRQDONE | BITM_DMA_STAT_IRQERR;
+
+    // Interrupt after every word is received.  Transmit requests (ETBEI) only go to the
+    // TX DMA channel while it has a chunk to send (see uart_tx_dma_start()).
+    *device->pREG_UART_IMSK_CLR = BITM_UART_IMSK_CLR_ERXS | BITM_UART_IMSK_CLR_ERBFI | BITM_UART_IMSK_CLR_ETFI | BITM_UART_IMSK_CLR_ELSI |
+                                  BITM_UART_IMSK_CLR_ETXS | BITM_UART_IMSK_CLR_ETBEI;
+    *device->pREG_UART_IMSK_SET = BITM_UART_IMSK_SET_ERXS | BITM_UART_IMSK_SET_ERBFI | BITM_UART_IMSK_SET_ELSI;
+
+    #else
 
     // Use this configuration to interrupt after every word is received (e.g. MIDI mode)
     *device->pREG_UART_IMSK_CLR = BITM_UART_IMSK_CLR_ERXS | BITM_UART_IMSK_CLR_ERBFI | BITM_UART_IMSK_CLR_ETFI |  BITM_UART_IMSK_CLR_ELSI;
     *device->pREG_UART_IMSK_SET = BITM_UART_IMSK_SET_ERXS | BITM_UART_IMSK_SET_ERBFI | BITM_UART_IMSK_SET_ETFI | BITM_UART_IMSK_SET_ELSI;
 
+    #endif
+
     //  Set up interrupts
     if (device->device_num == 0) {
         adi_int_InstallHandler(INTR_UART0_STAT,  (ADI_INT_HANDLER_PTR)uart_status_handler, (void *)device, true);
@@ -216,6 +338,19 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
     else if (device->device_num == 2) {
         adi_int_InstallHandler(INTR_UART2_STAT,  (ADI_INT_HANDLER_PTR)uart_status_handler, (void *)device, true);
     }
+
+    #if (UART_TX_USE_DMA)
+    if (device->device_num == 0) {
+        adi_int_InstallHandler(INTR_UART0_TXDMA, (ADI_INT_HANDLER_PTR)uart_tx_dma_handler, (void *)device, true);
+    }
+    else if (device->device_num == 1) {
+        adi_int_InstallHandler(INTR_UART1_TXDMA, (ADI_INT_HANDLER_PTR)uart_tx_dma_handler, (void *)device, true);
+    }
+    else if (device->device_num == 2) {
+        adi_int_InstallHandler(INTR_UART2_TXDMA, (ADI_INT_HANDLER_PTR)uart_tx_dma_handler, (void *)device, true);
+    }
+    #endif
+
     return UART_SUCCESS;
 }
 
@@ -231,8 +366,11 @@ BM_UART_RESULT uart_initialize(BM_UART *device,
 BM_UART_RESULT uart_write_byte(BM_UART *device,
                                uint8_t tx_byte) {
 
+    uint32_t interrupts = uart_interrupts_disable();
+
     // First check if write buffer is full
     if (((device->tx_buffer_writeptr + 1) % UART_BUFFER_SIZE) == device->tx_buffer_readptr) {
+        uart_interrupts_restore(interrupts);
         return UART_TX_FIFO_FULL;
     }
 
@@ -242,6 +380,15 @@ BM_UART_RESULT uart_write_byte(BM_UART *device,
     // wrap pointer if necessary
     if (device->tx_buffer_writeptr >= UART_BUFFER_SIZE) device->tx_buffer_writeptr = 0;
 
+    #if (UART_TX_USE_DMA)
+
+    // if DMA is idle, start it (otherwise this will get sent after the current chunk)
+    if (device->tx_dma_length == 0) {
+        uart_tx_dma_start(device);
+    }
+
+    #else
+
     // if the TX register is empty, move an transmit byte in there from our buffer
     // (otherwise this will get sent when byte being the currently transmitted is done)
     if ((*device->pREG_UART_STAT & BITM_UART_STAT_TEMT) != 0) {
@@ -253,6 +400,10 @@ BM_UART_RESULT uart_write_byte(BM_UART *device,
         if (device->tx_buffer_readptr >= UART_BUFFER_SIZE) device->tx_buffer_readptr = 0;
     }
 
+    #endif
+
+    uart_interrupts_restore(interrupts);
+
     return UART_SUCCESS;
 }
 
@@ -269,6 +420,33 @@ BM_UART_RESULT uart_write_byte(BM_UART *device,
 BM_UART_RESULT uart_write_block(BM_UART *device,
                                 uint8_t *tx_bytes,
                                 uint16_t len) {
+
+    #if (UART_TX_USE_DMA)
+
+    uint32_t interrupts = uart_interrupts_disable();
+
+    // Copy the whole block into the TX buffer, then start DMA once
+    if (len > uart_available_for_write(device)) {
+        uart_interrupts_restore(interrupts);
+        return UART_TX_FIFO_FULL;
+    }
+
+    uint16_t writeptr = device->tx_buffer_writeptr;
+    for (int i = 0; i < len; i++) {
+        device->tx_buffer[writeptr++] = tx_bytes[i];
+        if (writeptr >= UART_BUFFER_SIZE) writeptr = 0;
+    }
+    device->tx_buffer_writeptr = writeptr;
+
+    // if DMA is idle, start it (otherwise this will get sent after the current chunk)
+    if (device->tx_dma_length == 0) {
+        uart_tx_dma_start(device);
+    }
+
+    uart_interrupts_restore(interrupts);
+
+    #else
+
     int i;
 
     for (i = 0; i < len; i++) {
@@ -282,6 +460,8 @@ BM_UART_RESULT uart_write_block(BM_UART *device,
         }
     }
 
+    #endif
+
     return UART_SUCCESS;
 }
 
@@ -354,6 +534,9 @@ uint16_t uart_available(BM_UART *device) {
 /**
  * @brief     Checks to see the number of bytes available in the transmit FIFO / buffer
  *
+ * One slot is always kept free, as a full buffer would have the write pointer
+ * back on the read pointer and look empty.
+ *
  * @param      device  The pointer to the driver instance
  *
  * @return     The number of bytes available for writing in the TX FIFO
@@ -361,10 +544,10 @@ uint16_t uart_available(BM_UART *device) {
 uint16_t uart_available_for_write(BM_UART *device) {
 
     if (device->tx_buffer_writeptr == device->tx_buffer_readptr) {
-        return UART_BUFFER_SIZE;
+        return UART_BUFFER_SIZE - 1;
     }
     else if (device->tx_buffer_writeptr > device->tx_buffer_readptr) {
-        return UART_BUFFER_SIZE - (device->tx_buffer_writeptr - device->tx_buffer_readptr);
+        return UART_BUFFER_SIZE - 1 - (device->tx_buffer_writeptr - device->tx_buffer_readptr);
     }
     else if (device->tx_buffer_readptr > device->tx_buffer_writeptr) {
         return (device->tx_buffer_readptr - device->tx_buffer_writeptr - 1);
@@ -478,6 +661,58 @@ static void uart_write_tx_value(BM_UART *device,
     (*device->pREG_UART_THR) = val;
 }
 
+/**
+ * @brief      Starts TX DMA on the next contiguous chunk of the TX buffer
+ *
+ * Sends everything from the read pointer to the write pointer, or to the end
+ * of the buffer if the data wraps (the rest is sent as the next chunk).  The
+ * read pointer isn't moved until the chunk has been sent, so the space stays
+ * reserved while DMA is reading it.
+ *
+ * The UART only sends transmit requests (ETBEI) while a chunk is being sent.
+ * With the channel stopped, an empty transmit register would otherwise keep
+ * raising the TX DMA interrupt, so ETBEI is masked again once the buffer is
+ * empty.
+ *
+ * @param      device  The pointer to the driver instance
+ */
+static void uart_tx_dma_start(BM_UART *device) {
+
+    uint16_t readptr = device->tx_buffer_readptr;
+    uint16_t writeptr = device->tx_buffer_writeptr;
+
+    if (readptr == writeptr) {
+        *device->pREG_UART_IMSK_CLR = BITM_UART_IMSK_CLR_ETBEI;
+        return;
+    }
+
+    uint16_t length = (writeptr > readptr) ? (writeptr - readptr) : (UART_BUFFER_SIZE - readptr);
+    uint8_t *chunk = &device->tx_buffer[readptr];
+
+    // Make sure DMA sees what was written through the data cache
+    flush_data_buffer(chunk, chunk + length - 1, ADI_FLUSH_DATA_NOINV);
+
+    uint32_t addr = (uint32_t)chunk;
+    if ((addr & UART_DMA_L1_ADDR_MASK) == 0) {
+        addr |= UART_DMA_MP_OFFSET;
+    }
+
+    device->tx_dma_length = length;
+
+    *device->pREG_DMA_TX_ADDRSTART = addr;
+    *device->pREG_DMA_TX_XCNT = length;
+    *device->pREG_DMA_TX_XMOD = 1;
+    *device->pREG_DMA_TX_CFG = ((0 << BITP_DMA_CFG_WNR) & BITM_DMA_CFG_WNR) |       // memory read, UART write
+                               ENUM_DMA_CFG_MSIZE01 |                               // 1 byte memory transfer size
+                               ENUM_DMA_CFG_PSIZE01 |                               // 1 byte peripheral transfer size
+                               ENUM_DMA_CFG_XCNT_INT |                              // interrupt when the chunk is sent
+                               ENUM_DMA_CFG_STOP |                                  // stop after this chunk
+                               BITM_DMA_CFG_EN;
+
+    // Let the UART request the chunk's bytes
+    *device->pREG_UART_IMSK_SET = BITM_UART_IMSK_SET_ETBEI;
+}
+
 /**
  * @brief     Clears the UART TX interrupt
  *
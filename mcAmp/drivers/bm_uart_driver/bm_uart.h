@@ -9,6 +9,13 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/*
+ * Rates above 921600 use the UART's divide-by-one mode (EDBO) so the divisor
+ * isn't limited to multiples of 16.  This flag marks those rates and is
+ * turned into the EDBO bit when the clock register is written.
+ */
+#define UART_BAUD_DIVIDE_BY_ONE     (0x10000)
+
 // BAUD settings are based on a 112.5MHz SCLK0
 typedef enum _BM_UART_BAUD_RATE {
     UART_BAUD_RATE_110     = 63920,
@@ -31,6 +38,9 @@ typedef enum _BM_UART_BAUD_RATE {
     UART_BAUD_RATE_256000  = 27,
     UART_BAUD_RATE_460800  = 15,
     UART_BAUD_RATE_921600  = 8,
+    UART_BAUD_RATE_1000000 = UART_BAUD_DIVIDE_BY_ONE | 112,  // 1,004,464 Baud
+    UART_BAUD_RATE_2000000 = UART_BAUD_DIVIDE_BY_ONE | 56,   // 2,008,929 Baud
+    UART_BAUD_RATE_3000000 = UART_BAUD_DIVIDE_BY_ONE | 38,   // 2,960,526 Baud
     UART_BAUD_RATE_FASTEST = 1   // 112.5MHz/(16 * 1) = 7,031,250 Baud
 } BM_UART_BAUD_RATE;
 
@@ -52,6 +62,13 @@ typedef enum _BM_UART_PERIPHERAL_NUMBER {
 // Size of the UART TX and RX buffers / FIFOs
 #define UART_BUFFER_SIZE        (1024)
 
+/*
+ * Transmit with peripheral DMA rather than one interrupt per byte.  The TX
+ * buffer is handed to DMA in contiguous chunks and the DMA completion
+ * interrupt starts the next chunk, so there is one interrupt per chunk.
+ */
+#define UART_TX_USE_DMA         (true)
+
 // Results from UART operations
 typedef enum
 {
@@ -76,6 +93,13 @@ typedef struct _BM_UART
     volatile uint32_t *pREG_UART_IMSK_CLR;
     volatile uint32_t *pREG_UART_IMSK_SET;
 
+    // pointers into the TX DMA channel registers
+    volatile uint32_t *pREG_DMA_TX_CFG;
+    volatile uint32_t *pREG_DMA_TX_ADDRSTART;
+    volatile uint32_t *pREG_DMA_TX_XCNT;
+    volatile uint32_t *pREG_DMA_TX_XMOD;
+    volatile uint32_t *pREG_DMA_TX_STAT;
+
     // UART receive buffer
     uint8_t rx_buffer[UART_BUFFER_SIZE];
     uint16_t rx_buffer_readptr;
@@ -83,8 +107,11 @@ typedef struct _BM_UART
 
     // UART transmit buffer
     uint8_t tx_buffer[UART_BUFFER_SIZE];
-    uint16_t tx_buffer_readptr;
-    uint16_t tx_buffer_writeptr;
+    volatile uint16_t tx_buffer_readptr;
+    volatile uint16_t tx_buffer_writeptr;
+
+    // Length of the chunk DMA is sending (0 when DMA is idle)
+    volatile uint16_t tx_dma_length;
 
     // initialization parameter
     uint8_t device_num;
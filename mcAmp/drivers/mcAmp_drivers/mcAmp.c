@@ -52,6 +52,8 @@ typedef struct mcAmp_amps_t
 } mcAmp_amps_t;
 
 /*------------------------------------------- STATIC VARIABLES -------------------------------------------------------*/
+
+static uint32_t mutedAmps = 0U;                 /**< Bit n set when amp n has been muted because it is idle. */
 /*------------------------------------------- GLOBAL VARIABLES -------------------------------------------------------*/
 
 BM_TWI mcAmpTwiH;
@@ -79,13 +81,15 @@ static void detectAmps(
 static void setInitValues(
     void);
 
+static void setAmpMute(
+    uint8_t ampNo,
+    ma12040p_mute_t mute);
+
 /*------------------------------------------- STATIC FUNCTIONS -------------------------------------------------------*/
 
 /* i2c initialisation */
 static void i2cInit(void)
 {
-    char msg[128] = {0};
-
     // initialise i2c
     if (twi_initialize(&mcAmpTwiH, MCAMP_I2C_MUX_DEV_ADDR, TWI_TYPICAL_SCLK0_FREQ, TWI2) != TWI_SIMPLE_SUCCESS)
     {
@@ -97,9 +101,8 @@ static void i2cInit(void)
 
     log_event(EVENT_INFO, "McAmp: I2C initialised");
 
-    sprintf(msg, "McAmp: I2C Config, Bus: %d, Addr: 0x%.2x, Speed: %.3f KHz",
-            TWI2, MCAMP_I2C_MUX_DEV_ADDR, (double)MCAMP_I2C_SPEED / 1000.0);
-    log_event(EVENT_INFO, msg);
+    log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_I2C_CONFIG, TWI2, MCAMP_I2C_MUX_DEV_ADDR,
+                  EVENT_LOG_FLOAT((float)MCAMP_I2C_SPEED / 1000.0F));
 }
 
 /* set the i2c mux bus number */
@@ -134,7 +137,6 @@ static void setI2cMuxBus(
 static void detectAmps(void)
 {
     uint8_t i, j, regVal;
-    char msg[128] = {0U};
 
     for (i = 0U; i < MCAMP_N_BUSSES; i++)
     {
@@ -161,13 +163,11 @@ static void detectAmps(void)
                 amps.ampsConn[amps.nDevices].devAddr = MA12040P_DEVADDR_1 + j;
                 amps.nDevices++;
 
-                sprintf(msg, "McAmp: MA12040P amp found. I2C Mux Bus: %d; Device Address: 0x%.2x", i, MA12040P_DEVADDR_1 + j);
-                log_event(EVENT_INFO, msg);
+                log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_AMP_FOUND, i, MA12040P_DEVADDR_1 + j);
             }
             else
             {
-                sprintf(msg, "McAmp: MA12040P amp not found. I2C Mux Bus: %d; Device Address: 0x%.2x", i, MA12040P_DEVADDR_1 + j);
-                log_event(EVENT_WARN, msg);
+                log_event_fmt(EVENT_WARN, EVENT_FMT_MCAMP_AMP_NOT_FOUND, i, MA12040P_DEVADDR_1 + j);
             }
         }
 
@@ -181,7 +181,6 @@ static void detectAmps(void)
 
 static void setInitValues(void)
 {
-    char msg[128];
     uint8_t i, j;
     MA12040P_RESULT ret = MA12040P_SUCCESS;
 
@@ -190,20 +189,16 @@ static void setInitValues(void)
         setI2cMuxBus(amps.ampsConn[i].i2cBusNo);
         twi_set_temporary_address(&mcAmpTwiH, amps.ampsConn[i].devAddr);
 
-        sprintf(msg, "McAmp: Bus %d, DevAddr 0x%x - initialising params", amps.ampsConn[i].i2cBusNo,
-                amps.ampsConn[i].devAddr);
-        log_event(EVENT_INFO, msg);
+        log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_AMP_INIT, amps.ampsConn[i].i2cBusNo, amps.ampsConn[i].devAddr);
 
         // master volume
         if (MA12040P_SUCCESS == ma12040p_setMasterVolume(&mcAmpTwiH, mcAmpConfig.volumeDb))
         {
-            sprintf(msg, "\t master volume level: %.2f dBFS", mcAmpConfig.volumeDb);
-            log_event(EVENT_INFO, msg);
+            log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_VOLUME, EVENT_LOG_FLOAT(mcAmpConfig.volumeDb));
         }
         else
         {
-            sprintf(msg, "\t error setting up master volume level at %.2f dBFS", mcAmpConfig.volumeDb);
-            log_event(EVENT_WARN, msg);
+            log_event_fmt(EVENT_WARN, EVENT_FMT_MCAMP_VOLUME_ERROR, EVENT_LOG_FLOAT(mcAmpConfig.volumeDb));
         }
 
         // limiter attack time
@@ -256,13 +251,12 @@ static void setInitValues(void)
 
             if (MA12040P_SUCCESS == ret)
             {
-                sprintf(msg, "\t limiter threshold level: %.2f dBFS", mcAmpConfig.limiterThresholdDb);
-                log_event(EVENT_INFO, msg);
+                log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_LIMITER, EVENT_LOG_FLOAT(mcAmpConfig.limiterThresholdDb));
             }
             else
             {
-                sprintf(msg, "\t error setting limiter threshold level at %.2f dBFS", mcAmpConfig.limiterThresholdDb);
-                log_event(EVENT_WARN, msg);
+                log_event_fmt(EVENT_WARN, EVENT_FMT_MCAMP_LIMITER_ERROR,
+                              EVENT_LOG_FLOAT(mcAmpConfig.limiterThresholdDb));
             }
         }
 
@@ -289,9 +283,8 @@ static void setInitValues(void)
         if (MA12040P_SUCCESS != ma12040p_setVlaEnable(&mcAmpTwiH, MA12040P_ENABLE))
         {
             ret = MA12040P_ERROR;
-            sprintf(msg, "McAmp: error enabling VLA's on bus %d, devAddr 0x%x", amps.ampsConn[i].i2cBusNo,
-                    amps.ampsConn[i].devAddr);
-            log_event(EVENT_WARN, msg);
+            log_event_fmt(EVENT_WARN, EVENT_FMT_MCAMP_VLA_ERROR, amps.ampsConn[i].i2cBusNo,
+                          amps.ampsConn[i].devAddr);
         }
 
         twi_restore_address(&mcAmpTwiH);
@@ -305,6 +298,33 @@ static void setInitValues(void)
     setI2cMuxBus(0U);
 }
 
+/* mute or unmute a single amp */
+static void setAmpMute(
+    uint8_t ampNo,
+    ma12040p_mute_t mute)
+{
+    setI2cMuxBus(amps.ampsConn[ampNo].i2cBusNo);
+    twi_set_temporary_address(&mcAmpTwiH, amps.ampsConn[ampNo].devAddr);
+
+    if (MA12040P_SUCCESS != ma12040p_setMasterMute(&mcAmpTwiH, mute))
+    {
+        log_event_fmt(EVENT_WARN, (MA12040P_MUTE == mute) ? EVENT_FMT_MCAMP_MUTE_ERROR : EVENT_FMT_MCAMP_UNMUTE_ERROR,
+                      amps.ampsConn[ampNo].i2cBusNo, amps.ampsConn[ampNo].devAddr);
+    }
+
+    // track the requested state even on error so a failing amp isn't retried every loop
+    if (MA12040P_MUTE == mute)
+    {
+        mutedAmps |= (1U << ampNo);
+    }
+    else
+    {
+        mutedAmps &= ~(1U << ampNo);
+    }
+
+    twi_restore_address(&mcAmpTwiH);
+}
+
 /*------------------------------------------- GLOBAL FUNCTIONS -------------------------------------------------------*/
 
 /* initialise */
@@ -336,3 +356,49 @@ void mcAmp_enable(
 
     log_event(EVENT_INFO, "McAmp: enabled amps");
 }
+
+/* mute idle amps and unmute amps that have audio again */
+void mcAmp_updateIdle(
+    uint32_t idleMask)
+{
+    uint8_t i;
+    uint32_t unmute, mute;
+
+    if (0U == amps.nDevices)
+    {
+        return;
+    }
+
+    // amp n drives channels (n * MCAMP_N_CHANNELS_PER_AMP) + 1 to (n + 1) * MCAMP_N_CHANNELS_PER_AMP
+    idleMask &= (1U << amps.nDevices) - 1U;
+
+    unmute = mutedAmps & ~idleMask;
+    mute = idleMask & ~mutedAmps;
+
+    if ((0U == unmute) && (0U == mute))
+    {
+        return;
+    }
+
+    // unmute first so resumed audio is delayed as little as possible
+    for (i = 0U; i < amps.nDevices; i++)
+    {
+        if (unmute & (1U << i))
+        {
+            setAmpMute(i, MA12040P_UNMUTE);
+        }
+    }
+
+    for (i = 0U; i < amps.nDevices; i++)
+    {
+        if (mute & (1U << i))
+        {
+            setAmpMute(i, MA12040P_MUTE);
+        }
+    }
+
+    // reset the i2c mux bus to default
+    setI2cMuxBus(0U);
+
+    log_event_fmt(EVENT_INFO, EVENT_FMT_MCAMP_IDLE_MUTED, mutedAmps);
+}
@@ -26,6 +26,24 @@ extern "C" {
 
 #define MCAMP_I2C_SPEED                         (100000U)
 
+#define MCAMP_N_CHANNELS                        (20U)
+#define MCAMP_N_CHANNELS_PER_AMP                (4U)
+
+// an amp is muted once all of its channels have been below the threshold for the hangover time
+#define MCAMP_IDLE_THRESHOLD_DB                 (-90.0F)
+#define MCAMP_IDLE_HANGOVER_MS                  (2000.0F)
+
+// channel test (push button 1) - each channel plays its own tone, listened to on the line inputs
+#define MCAMP_TEST_TONE_LEVEL_DB                (-20.0F)
+#define MCAMP_TEST_FIRST_FREQ_HZ                (400.0F)
+#define MCAMP_TEST_FREQ_SPACING_HZ              (200.0F)
+#define MCAMP_TEST_WINDOW_MS                    (20.0F)
+#define MCAMP_TEST_N_INPUTS                     (2U)
+
+// output EQ on each channel (run by SHARC core 1, coefficients uploaded over the control link)
+#define MCAMP_EQ_STAGES                         (2U)
+#define MCAMP_EQ_COEFFS_PER_STAGE               (5U)    // b0, b1, b2, a1, a2
+
 /*------------------------------------------- TYPEDEFS ---------------------------------------------------------------*/
 /*------------------------------------------- EXPORTED VARIABLES -----------------------------------------------------*/
 /*------------------------------------------- GLOBAL FUNCTION PROTOTYPES ---------------------------------------------*/
@@ -36,6 +54,9 @@ void mcAmp_init(
 void mcAmp_enable(
     void);
 
+void mcAmp_updateIdle(
+    uint32_t idleMask);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,9 @@
 // Drivers for quick configuration of the SRU on the SHARC Audio Module board
 #include "drivers/bm_sru_driver/bm_sru.h"
 
+// The ARM's background work runs as scheduler tasks
+#include "drivers/bm_scheduler_driver/bm_scheduler.h"
+
 // ADAU I2C driver
 BM_ADAU_DEVICE adau1966_instance;
 BM_ADAU_DEVICE adau1977_instance;
@@ -86,11 +89,16 @@ void gpio_initialize(void) {
  * @brief      1ms tick event callback
  *
  * The framework has an optional 1ms tick event which includes a callback
- * for additional light weight processing.
+ * for additional light weight processing.  Once the scheduler is running,
+ * the event logs are drained by a task instead, so the tick stays short.
  *
  */
 void ms_tick_event_callback() {
 
+    if (scheduler_running()) {
+        return;
+    }
+
     // Check to see if there are any event messages from the SHARC cores
     event_logging_poll_sharc_cores_for_new_message();
 }
@@ -104,8 +112,6 @@ void ms_tick_event_callback() {
  */
 void audioframework_initialize(void) {
 
-    char message[128];
-
     /**
      * Set system-wide audio parameters in our shared memory structure between cores.
      * While sample rate is set initially via pre-processor variables, there may be
@@ -116,12 +122,9 @@ void audioframework_initialize(void) {
     multicore_data->core_clock_frequency = CORE_CLOCK_FREQ_HZ;
 
     log_event(EVENT_INFO, "System Configuration:");
-    sprintf(message, "  Processor cores running at %'.2f MHz", (double)CORE_CLOCK_FREQ_HZ / 1000000.0);
-    log_event(EVENT_INFO, message);
-    sprintf(message, "  Audio sample rate set to %'.2f KHz", (double)AUDIO_SAMPLE_RATE / 1000.0);
-    log_event(EVENT_INFO, message);
-    sprintf(message, "  Audio block size (per channel) set to %d samples / frame", AUDIO_BLOCK_SIZE);
-    log_event(EVENT_INFO, message);
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_CORE_CLOCK, EVENT_LOG_FLOAT(CORE_CLOCK_FREQ_HZ / 1000000.0));
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_SAMPLE_RATE, EVENT_LOG_FLOAT(AUDIO_SAMPLE_RATE / 1000.0));
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_BLOCK_SIZE, AUDIO_BLOCK_SIZE);
 
     // Initialize GPIO
     gpio_initialize();
@@ -241,6 +244,23 @@ void audioframework_wait_for_sharcs(void) {
     #endif
 }
 
+/**
+ * @brief      Runs audioframework_background_loop() from the scheduler
+ */
+static void audioframework_background_task(void *arg) {
+    audioframework_background_loop();
+}
+
+/**
+ * @brief      Adds the framework's background work to the ARM scheduler
+ *
+ * @return true if successful
+ */
+bool audioframework_add_tasks(void) {
+    return scheduler_add_periodic("framework", audioframework_background_task, NULL,
+                                  TASK_PRIORITY_BACKGROUND, 10, 50) != NULL;
+}
+
 void audioframework_background_loop(void) {
 
     /**
@@ -252,10 +272,8 @@ void audioframework_background_loop(void) {
      * sampling rate than what is defined in the audio_system_config.h file.
      *
      * At this point, the ARM doesn't need to do much.  There is a 1 ms timer loop that runs
-     * as part of drivers/sysctrl_simple that enables the Arduino-style delay() function
-     * and it also copies the values of the HADC (housekeeping ADC) into the shared memory
-     * structure.  In the case of the Audio Project Fin, this ensures that the values of the 3
-     * pots on that board are always reflected and current in our shared memory structure.
+     * as part of drivers/sysctrl_simple that enables the Arduino-style delay() function.
+     * This function runs every 10 ms as the "framework" task.
      *
      */
 
@@ -25,5 +25,6 @@
 void audioframework_initialize(void);
 void audioframework_wait_for_sharcs(void);
 void audioframework_background_loop(void);
+bool audioframework_add_tasks(void);
 
 #endif    //_AUDIO_FRAMEWORK_16CH_SAM_AND_AUTOMOTIVE_FIN_ARM_H
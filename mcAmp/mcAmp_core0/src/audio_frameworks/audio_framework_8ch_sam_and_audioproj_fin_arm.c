@@ -50,6 +50,12 @@
 // Simple event logging / error handling functionality
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
+// Named metrics published by the SHARC cores
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+// The ARM's background work runs as scheduler tasks
+#include "drivers/bm_scheduler_driver/bm_scheduler.h"
+
 #include "../callback_midi_message.h"
 #include "../callback_pushbuttons.h"
 
@@ -171,25 +177,46 @@ void gpio_initialize(void) {
 	#endif
 }
 
+#if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+/**
+ * @brief      Publishes the HADC values to the SHARC cores when they change
+ *
+ * When an HADC value has moved, copy the latest values into our copy of the shared
+ * parameters and publish them together so SHARC cores can access too.  The HADC
+ * values are filtered with hysteresis, so the SHARC cores skip blocks with no changes.
+ */
+static void audioframework_publish_hadc(void *arg) {
+
+	if (hadc_read_changes()) {
+		shared_parameters.audioproj_fin_pot_hadc0 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC0);
+		shared_parameters.audioproj_fin_pot_hadc1 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC1);
+		shared_parameters.audioproj_fin_pot_hadc2 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC2);
+		shared_parameters.audioproj_fin_aux_hadc3 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC3);
+		shared_parameters.audioproj_fin_aux_hadc4 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC4);
+		shared_parameters.audioproj_fin_aux_hadc5 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC5);
+		shared_parameters.audioproj_fin_aux_hadc6 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC6);
+		shared_parameters_publish();
+	}
+}
+#endif
+
 /**
  * @brief      1ms tick event callback
  *
  * The framework has an optional 1ms tick event which includes a callback
- * for additional light weight processing.
+ * for additional light weight processing.  Once the scheduler is running,
+ * this work is done by the tasks from audioframework_add_tasks() instead,
+ * so the tick stays short.
  *
  */
 void ms_tick_event_callback(void) {
 
+	if (scheduler_running()) {
+		return;
+	}
+
     #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
-		// Copy the latest read vales from the HADC into our shared memory struct
-		// so SHARC cores can access too
-		multicore_data->audioproj_fin_pot_hadc0 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC0);
-		multicore_data->audioproj_fin_pot_hadc1 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC1);
-		multicore_data->audioproj_fin_pot_hadc2 = hadc_read_float(SAM_AUDIOPROJ_FIN_POT_HADC2);
-		multicore_data->audioproj_fin_aux_hadc3 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC3);
-		multicore_data->audioproj_fin_aux_hadc4 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC4);
-		multicore_data->audioproj_fin_aux_hadc5 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC5);
-		multicore_data->audioproj_fin_aux_hadc6 = hadc_read_float(SAM_AUDIOPROJ_FIN_AUX_HADC6);
+	audioframework_publish_hadc(NULL);
     #endif
 
 	// Check to see if there are any event messages from the SHARC cores
@@ -205,8 +232,6 @@ void ms_tick_event_callback(void) {
  */
 void audioframework_initialize(void) {
 
-    char message[128];
-
     /**
      * Set system-wide audio parameters in our shared memory structure between cores.
      * While sample rate is set initially via pre-processor variables, there may be
@@ -218,12 +243,9 @@ void audioframework_initialize(void) {
     multicore_data->core_clock_frequency = CORE_CLOCK_FREQ_HZ;
 
     log_event(EVENT_INFO, "System Configuration:");
-    sprintf(message, "  Processor cores running at %'.2f MHz", (double)CORE_CLOCK_FREQ_HZ / 1000000.0);
-    log_event(EVENT_INFO, message);
-    sprintf(message, "  Audio sample rate set to %'.2f KHz", (double)AUDIO_SAMPLE_RATE / 1000.0);
-    log_event(EVENT_INFO, message);
-    sprintf(message, "  Audio block size (per channel) set to %d samples / frame", AUDIO_BLOCK_SIZE);
-    log_event(EVENT_INFO, message);
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_CORE_CLOCK, EVENT_LOG_FLOAT(CORE_CLOCK_FREQ_HZ / 1000000.0));
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_SAMPLE_RATE, EVENT_LOG_FLOAT(AUDIO_SAMPLE_RATE / 1000.0));
+    log_event_fmt(EVENT_INFO, EVENT_FMT_SYSTEM_BLOCK_SIZE, AUDIO_BLOCK_SIZE);
 
     // Initialize GPIO
     gpio_initialize();
@@ -545,6 +567,34 @@ void audioframework_wait_for_sharcs(void) {
     #endif
 }
 
+/**
+ * @brief      Runs audioframework_background_loop() from the scheduler
+ */
+static void audioframework_background_task(void *arg) {
+    audioframework_background_loop();
+}
+
+/**
+ * @brief      Adds the framework's background work to the ARM scheduler
+ *
+ * @return true if successful
+ */
+bool audioframework_add_tasks(void) {
+
+    bool success = true;
+
+    #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+    // The pots are read every 1ms, so a change should reach the SHARC cores within a couple of blocks
+    success &= scheduler_add_periodic("hadc", audioframework_publish_hadc, NULL,
+                                      TASK_PRIORITY_REALTIME, 1, 2) != NULL;
+    #endif
+
+    success &= scheduler_add_periodic("framework", audioframework_background_task, NULL,
+                                      TASK_PRIORITY_BACKGROUND, 10, 50) != NULL;
+
+    return success;
+}
+
 void audioframework_background_loop(void) {
 
     /**
@@ -556,10 +606,11 @@ void audioframework_background_loop(void) {
      * sampling rate than what is defined in the audio_system_config.h file.
      *
      * At this point, the ARM doesn't need to do much.  There is a 1 ms timer loop that runs
-     * as part of drivers/sysctrl_simple that enables the Arduino-style delay() function
-     * and it also copies the values of the HADC (housekeeping ADC) into the shared memory
-     * structure.  In the case of the Audio Project Fin, this ensures that the values of the 3
-     * pots on that board are always reflected and current in our shared memory structure.
+     * as part of drivers/sysctrl_simple that enables the Arduino-style delay() function,
+     * and the "hadc" task copies the values of the HADC (housekeeping ADC) into the shared
+     * memory structure.  In the case of the Audio Project Fin, this ensures that the values of
+     * the 3 pots on that board are always reflected and current in our shared memory structure.
+     * This function runs every 10 ms as the "framework" task.
      *
      */
 
@@ -581,25 +632,34 @@ void audioframework_background_loop(void) {
     }
     // If the Audio Project Fin is attached, make a basic VU meter
     #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
-    	if (multicore_data->audio_in_amplitude > -20.0) {
+    	static BM_METRIC audio_in_amplitude_metric = NULL;
+    	if (audio_in_amplitude_metric == NULL) {
+    		audio_in_amplitude_metric = metrics_find(1, "audio.in_amplitude_db");
+    		if (audio_in_amplitude_metric == NULL) {
+    			return;
+    		}
+    	}
+    	float audio_in_amplitude = metric_get_float(audio_in_amplitude_metric);
+
+    	if (audio_in_amplitude > -20.0) {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU4, GPIO_HIGH);
     	} else {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU4, GPIO_LOW);
     	}
 
-    	if (multicore_data->audio_in_amplitude > -30.0) {
+    	if (audio_in_amplitude > -30.0) {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU3, GPIO_HIGH);
     	} else {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU3, GPIO_LOW);
     	}
 
-    	if (multicore_data->audio_in_amplitude > -40.0) {
+    	if (audio_in_amplitude > -40.0) {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU2, GPIO_HIGH);
     	} else {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU2, GPIO_LOW);
     	}
 
-    	if (multicore_data->audio_in_amplitude > -50.0) {
+    	if (audio_in_amplitude > -50.0) {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU1, GPIO_HIGH);
     	} else {
     		gpio_write(GPIO_AUDIOPROJ_FIN_LED_VU1, GPIO_LOW);
@@ -88,5 +88,6 @@
 void audioframework_initialize(void);
 void audioframework_wait_for_sharcs(void);
 void audioframework_background_loop(void);
+bool audioframework_add_tasks(void);
 
 #endif    //_AUDIO_FRAMEWORK_8CH_SAM_AND_AUDIOPROJ_FIN_ARM_H
@@ -35,6 +35,9 @@
 // Delay function and system management
 #include "drivers/bm_sysctrl_driver/bm_system_control.h"
 
+// The ARM's background work runs as scheduler tasks
+#include "drivers/bm_scheduler_driver/bm_scheduler.h"
+
 /**
  * @brief      ARM audio framework initialization function
  *
@@ -57,14 +60,29 @@ void audioframework_initialize(void) {
 }
 
 /**
- * @brief background loop for providing any framework processing
+ * @brief background loop for providing any framework processing (runs once a second)
  */
 void audioframework_background_loop(void) {
 
     // Toggle the ARM core LED
     gpio_toggle(GPIO_SHARC_SAM_LED10);
+}
 
-    delay(1000);
+/**
+ * @brief runs audioframework_background_loop() from the scheduler
+ */
+static void audioframework_background_task(void *arg) {
+    audioframework_background_loop();
+}
+
+/**
+ * @brief adds the framework's background work to the ARM scheduler
+ *
+ * @return true if successful
+ */
+bool audioframework_add_tasks(void) {
+    return scheduler_add_periodic("framework", audioframework_background_task, NULL,
+                                  TASK_PRIORITY_BACKGROUND, 1000, 50) != NULL;
 }
 
 /**
@@ -66,5 +66,6 @@
 void audioframework_initialize(void);
 void audioframework_background_loop(void);
 void audioframework_wait_for_sharcs(void);
+bool audioframework_add_tasks(void);
 
 #endif    //_AUDIO_FRAMEWORK_A2B_BYPASS_SC589_ARM_H
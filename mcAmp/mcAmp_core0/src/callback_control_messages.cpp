@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ *
+ * These are the hooks for the messages a host PC sends over the control link
+ * (see common/control_protocol.h for the messages and
+ * drivers/bm_control_link_driver for the link itself).
+ *
+ * Parameters are reached by id rather than by address, so the host doesn't
+ * need to know how they are stored.  Presets are owned by the SHARC cores,
+ * so setting one sends the core a message, the same way the push buttons
+ * step through them.  The mcAmp output EQ is published to SHARC core 1
+ * through a parameter store: coefficients are uploaded into a copy here and
+ * only published, as a whole, when the upload is committed.
+ */
+
+#include <string.h>
+
+// Define your audio system parameters in this file
+#include "common/audio_system_config.h"
+
+// Structure containing shared variables between the three cores
+#include "common/multicore_shared_memory.h"
+
+// Messages and parameter ids of the control link
+#include "common/control_protocol.h"
+
+// Named metrics shared between the cores
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+#include "callback_control_messages.h"
+
+// The EQ SHARC core 1 is running (as last published) and the one being uploaded
+static MCAMP_EQ_SET control_eq;
+static MCAMP_EQ_SET control_eq_upload;
+
+#define CONTROL_EQ_WORDS    (MCAMP_N_CHANNELS * MCAMP_EQ_STAGES * MCAMP_EQ_COEFFS_PER_STAGE)
+
+// Little-endian fields (the payload isn't aligned)
+static inline uint16_t control_get_u16(const uint8_t *p) {
+    return p[0] | (uint16_t) p[1] << 8;
+}
+
+static inline uint32_t control_get_u32(const uint8_t *p) {
+    return p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+static inline void control_put_u32(uint8_t *p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = value >> 24;
+}
+
+static inline uint32_t control_float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Asks a SHARC core to change to a preset
+ *
+ * @param queue IPC_QUEUE_ARM_TO_SHARC1 or IPC_QUEUE_ARM_TO_SHARC2
+ * @param preset preset to change to
+ * @return reply status
+ */
+static uint8_t control_send_preset(BM_IPC_QUEUE *queue, uint32_t preset) {
+
+    IPC_MESSAGE message;
+    message.type = IPC_MESSAGE_PRESET_SET;
+    message.arg = preset;
+
+    // The push buttons send to the same queues, also from a task, so nothing else can be pushing now
+    return ipc_queue_push(queue, &message) ? CONTROL_LINK_STATUS_OK : CONTROL_STATUS_BUSY;
+}
+
+/**
+ * @brief Whether a queue has room for more preset changes
+ *
+ * @param queue IPC_QUEUE_ARM_TO_SHARC1 or IPC_QUEUE_ARM_TO_SHARC2
+ * @param count preset changes about to be sent
+ * @return reply status
+ */
+static uint8_t control_preset_room(BM_IPC_QUEUE *queue, uint32_t count) {
+
+    // Only tasks push to these queues, so the room can't shrink before control_send_preset()
+    return (ipc_queue_count(queue) + count <= queue->capacity) ?
+            CONTROL_LINK_STATUS_OK : CONTROL_STATUS_BUSY;
+}
+
+/**
+ * @brief Which Faust host parameter an id is (FAUST_HOST_PARAMS if it isn't one)
+ */
+static uint32_t control_faust_host_param(uint16_t id) {
+
+    if (id >= CONTROL_PARAM_FAUST_HOST && id < CONTROL_PARAM_FAUST_HOST + FAUST_HOST_PARAMS) {
+        return id - CONTROL_PARAM_FAUST_HOST;
+    }
+    return FAUST_HOST_PARAMS;
+}
+
+/**
+ * @brief Checks that a parameter can be set to a value
+ *
+ * @return reply status
+ */
+static uint8_t control_param_check(uint16_t id, uint32_t value) {
+
+    switch (id) {
+
+    case CONTROL_PARAM_EFFECTS_PRESET:
+    case CONTROL_PARAM_REVERB_PRESET:
+        return (value < multicore_data->total_effects_presets) ?
+                CONTROL_LINK_STATUS_OK : CONTROL_STATUS_BAD_VALUE;
+
+    case CONTROL_PARAM_MCAMP_EQ_ENABLE:
+        return (value >> MCAMP_N_CHANNELS) ? CONTROL_STATUS_BAD_VALUE : CONTROL_LINK_STATUS_OK;
+
+    case CONTROL_PARAM_TOTAL_PRESETS:
+    case CONTROL_PARAM_MCAMP_AMPS_IDLE:
+    case CONTROL_PARAM_SAMPLE_RATE:
+    case CONTROL_PARAM_BLOCK_SIZE:
+    case CONTROL_PARAM_CORE1_LOAD_MHZ:
+    case CONTROL_PARAM_CORE2_LOAD_MHZ:
+        return CONTROL_STATUS_READ_ONLY;
+
+    default:
+        if (control_faust_host_param(id) < FAUST_HOST_PARAMS) {
+            // Any finite float (the zone clamps it to its own range)
+            return ((value >> 23) & 0xFF) != 0xFF ? CONTROL_LINK_STATUS_OK : CONTROL_STATUS_BAD_VALUE;
+        }
+        return CONTROL_STATUS_BAD_PARAM;
+    }
+}
+
+/**
+ * @brief Sets a parameter (already checked)
+ *
+ * @param eq_changed set if the EQ needs publishing
+ * @param shared_changed set if the shared parameters need publishing
+ * @return reply status
+ */
+static uint8_t control_param_set(uint16_t id, uint32_t value, bool *eq_changed, bool *shared_changed) {
+
+    switch (id) {
+
+    case CONTROL_PARAM_EFFECTS_PRESET:
+        return control_send_preset(IPC_QUEUE_ARM_TO_SHARC1, value);
+
+    case CONTROL_PARAM_REVERB_PRESET:
+        return control_send_preset(IPC_QUEUE_ARM_TO_SHARC2, value);
+
+    case CONTROL_PARAM_MCAMP_EQ_ENABLE:
+        control_eq.enabled = value;
+        *eq_changed = true;
+        return CONTROL_LINK_STATUS_OK;
+
+    default:
+        if (control_faust_host_param(id) < FAUST_HOST_PARAMS) {
+            uint32_t n = control_faust_host_param(id);
+            memcpy(&shared_parameters.faust_host_params[n], &value, sizeof(float));
+            shared_parameters.faust_host_params_set |= 1U << n;
+            *shared_changed = true;
+            return CONTROL_LINK_STATUS_OK;
+        }
+        return CONTROL_STATUS_BAD_PARAM;
+    }
+}
+
+/**
+ * @brief Reads a parameter
+ *
+ * @return true if the parameter exists
+ */
+static bool control_param_get(uint16_t id, uint32_t *value) {
+
+    switch (id) {
+
+    case CONTROL_PARAM_EFFECTS_PRESET:
+        *value = multicore_data->effects_preset;
+        return true;
+
+    case CONTROL_PARAM_REVERB_PRESET:
+        *value = multicore_data->reverb_preset;
+        return true;
+
+    case CONTROL_PARAM_TOTAL_PRESETS:
+        *value = multicore_data->total_effects_presets;
+        return true;
+
+    case CONTROL_PARAM_MCAMP_EQ_ENABLE:
+        *value = control_eq.enabled;
+        return true;
+
+    case CONTROL_PARAM_MCAMP_AMPS_IDLE:
+        *value = multicore_data->mcamp_amps_idle;
+        return true;
+
+    case CONTROL_PARAM_SAMPLE_RATE:
+        *value = multicore_data->audio_sample_rate;
+        return true;
+
+    case CONTROL_PARAM_BLOCK_SIZE:
+        *value = multicore_data->audio_block_size;
+        return true;
+
+    case CONTROL_PARAM_CORE1_LOAD_MHZ:
+        *value = control_float_bits(multicore_data->sharc_core1_cpu_load_mhz);
+        return true;
+
+    case CONTROL_PARAM_CORE2_LOAD_MHZ:
+        *value = control_float_bits(multicore_data->sharc_core2_cpu_load_mhz);
+        return true;
+
+    default:
+        if (control_faust_host_param(id) < FAUST_HOST_PARAMS) {
+            *value = control_float_bits(shared_parameters.faust_host_params[control_faust_host_param(id)]);
+            return true;
+        }
+        return false;
+    }
+}
+
+/**
+ * @brief Sets a group of parameters, checking them all first
+ *
+ * The group is applied all or nothing: values, and room in the SHARC queues
+ * for any preset changes, are checked before anything is set.
+ */
+static uint8_t control_param_set_message(const uint8_t *payload, uint16_t length) {
+
+    if (length == 0 || length % 6) {
+        return CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+
+    uint32_t effects_presets = 0;
+    uint32_t reverb_presets = 0;
+
+    for (uint16_t i = 0; i < length; i += 6) {
+        uint16_t id = control_get_u16(&payload[i]);
+        uint8_t status = control_param_check(id, control_get_u32(&payload[i + 2]));
+        if (status != CONTROL_LINK_STATUS_OK) {
+            return status;
+        }
+        effects_presets += (id == CONTROL_PARAM_EFFECTS_PRESET);
+        reverb_presets += (id == CONTROL_PARAM_REVERB_PRESET);
+    }
+
+    uint8_t room = control_preset_room(IPC_QUEUE_ARM_TO_SHARC1, effects_presets);
+    if (room == CONTROL_LINK_STATUS_OK) {
+        room = control_preset_room(IPC_QUEUE_ARM_TO_SHARC2, reverb_presets);
+    }
+    if (room != CONTROL_LINK_STATUS_OK) {
+        return room;
+    }
+
+    uint8_t result = CONTROL_LINK_STATUS_OK;
+    bool eq_changed = false;
+    bool shared_changed = false;
+
+    for (uint16_t i = 0; i < length; i += 6) {
+        uint8_t status = control_param_set(control_get_u16(&payload[i]),
+                                           control_get_u32(&payload[i + 2]),
+                                           &eq_changed,
+                                           &shared_changed);
+        if (status != CONTROL_LINK_STATUS_OK) {
+            result = status;
+        }
+    }
+
+    if (eq_changed) {
+        param_store_publish(PARAM_STORE_MCAMP_EQ, &control_eq);
+    }
+    if (shared_changed) {
+        shared_parameters_publish();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Reads a group of parameters
+ */
+static uint8_t control_param_get_message(const uint8_t *payload, uint16_t length,
+                                         uint8_t *reply, uint16_t *reply_length) {
+
+    if (length == 0 || length % 2 || length * 2 > CONTROL_LINK_MAX_PAYLOAD) {
+        return CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+
+    for (uint16_t i = 0; i < length; i += 2) {
+        uint32_t value;
+        if (!control_param_get(control_get_u16(&payload[i]), &value)) {
+            return CONTROL_STATUS_BAD_PARAM;
+        }
+        control_put_u32(&reply[i * 2], value);
+    }
+    *reply_length = length * 2;
+
+    return CONTROL_LINK_STATUS_OK;
+}
+
+/**
+ * @brief Writes part of a coefficient table into the upload copy
+ */
+static uint8_t control_coeff_write_message(const uint8_t *payload, uint16_t length) {
+
+    if (length < 4 || (length - 4) % 4) {
+        return CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+    if (payload[0] != CONTROL_TABLE_MCAMP_EQ) {
+        return CONTROL_STATUS_BAD_TABLE;
+    }
+
+    uint32_t first = control_get_u16(&payload[2]);
+    uint32_t words = (length - 4) / 4;
+    if (first + words > CONTROL_EQ_WORDS) {
+        return CONTROL_STATUS_BAD_RANGE;
+    }
+
+    float *table = &control_eq_upload.coefficients[0][0][0];
+    for (uint32_t i = 0; i < words; i++) {
+        uint32_t bits = control_get_u32(&payload[4 + i * 4]);
+        memcpy(&table[first + i], &bits, sizeof(float));
+    }
+
+    return CONTROL_LINK_STATUS_OK;
+}
+
+/**
+ * @brief Publishes an uploaded coefficient table
+ */
+static uint8_t control_coeff_commit_message(const uint8_t *payload, uint16_t length) {
+
+    if (length != 1) {
+        return CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+    if (payload[0] != CONTROL_TABLE_MCAMP_EQ) {
+        return CONTROL_STATUS_BAD_TABLE;
+    }
+
+    memcpy(control_eq.coefficients, control_eq_upload.coefficients, sizeof(control_eq.coefficients));
+    param_store_publish(PARAM_STORE_MCAMP_EQ, &control_eq);
+
+    return CONTROL_LINK_STATUS_OK;
+}
+
+/**
+ * @brief Reads as many of a core's metrics as fit in a reply
+ */
+static uint8_t control_metrics_read_message(const uint8_t *payload, uint16_t length,
+                                            uint8_t *reply, uint16_t *reply_length) {
+
+    if (length != 2) {
+        return CONTROL_LINK_STATUS_BAD_LENGTH;
+    }
+    if (payload[0] >= METRICS_CORES) {
+        return CONTROL_STATUS_BAD_VALUE;
+    }
+
+    uint32_t core = payload[0];
+    uint32_t count = metrics_count(core);
+    uint16_t used = 0;
+
+    reply[used++] = count;
+
+    for (uint32_t index = payload[1];
+         index < count && used + CONTROL_METRIC_BYTES <= CONTROL_LINK_MAX_PAYLOAD;
+         index++) {
+
+        BM_METRIC_VALUE metric;
+        if (!metrics_read(core, index, &metric)) {
+            break;
+        }
+
+        memcpy(&reply[used], metric.name, METRICS_NAME_LENGTH);
+        used += METRICS_NAME_LENGTH;
+        reply[used++] = metric.type;
+        control_put_u32(&reply[used], metric.value.u);
+        used += 4;
+        control_put_u32(&reply[used], metric.count);
+        used += 4;
+        control_put_u32(&reply[used], metric.shift);
+        used += 4;
+        for (int i = 0; i < METRICS_HIST_BUCKETS; i++) {
+            control_put_u32(&reply[used], metric.bucket[i]);
+            used += 4;
+        }
+    }
+    *reply_length = used;
+
+    return CONTROL_LINK_STATUS_OK;
+}
+
+/**
+ * @brief Publishes the initial mcAmp EQ and starts the control link
+ *
+ * Call this once the event log is connected to the UART and before the
+ * SHARC cores are started.
+ *
+ * @return true if successful
+ */
+bool control_messages_setup_arm(void) {
+
+    // Every stage passes audio straight through until coefficients are uploaded
+    memset(&control_eq, 0, sizeof(control_eq));
+    for (int ch = 0; ch < MCAMP_N_CHANNELS; ch++) {
+        for (int stage = 0; stage < MCAMP_EQ_STAGES; stage++) {
+            control_eq.coefficients[ch][stage][0] = 1.0;
+        }
+    }
+    control_eq_upload = control_eq;
+
+    if (!param_store_initialize(PARAM_STORE_MCAMP_EQ, &control_eq, sizeof(MCAMP_EQ_SET))) {
+        return false;
+    }
+
+    return control_link_initialize(control_messages_handler_arm);
+}
+
+/**
+ * @brief Handles a message from the host
+ *
+ * @param type message type (CONTROL_MSG_...)
+ * @param payload message payload
+ * @param length payload length
+ * @param reply filled in with the reply payload
+ * @param reply_length set to the reply payload length
+ * @return reply status
+ */
+uint8_t control_messages_handler_arm(uint8_t type,
+                                     const uint8_t *payload,
+                                     uint16_t length,
+                                     uint8_t *reply,
+                                     uint16_t *reply_length) {
+
+    switch (type) {
+
+    case CONTROL_MSG_PARAM_SET:
+        return control_param_set_message(payload, length);
+
+    case CONTROL_MSG_PARAM_GET:
+        return control_param_get_message(payload, length, reply, reply_length);
+
+    case CONTROL_MSG_COEFF_WRITE:
+        return control_coeff_write_message(payload, length);
+
+    case CONTROL_MSG_COEFF_COMMIT:
+        return control_coeff_commit_message(payload, length);
+
+    case CONTROL_MSG_METRICS_READ:
+        return control_metrics_read_message(payload, length, reply, reply_length);
+
+    default:
+        return CONTROL_LINK_STATUS_BAD_TYPE;
+    }
+}
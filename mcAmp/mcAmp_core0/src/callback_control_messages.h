@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2018-2019 Analog Devices, Inc.  All rights reserved.
+ */
+#ifndef _CALLBACK_CONTROL_MESSAGES_H
+#define _CALLBACK_CONTROL_MESSAGES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Publishes the initial mcAmp EQ and starts the control link (before the SHARC cores are started)
+bool control_messages_setup_arm(void);
+
+// Handles a message from the host (called by control_link_poll())
+uint8_t control_messages_handler_arm(uint8_t type,
+                                     const uint8_t *payload,
+                                     uint16_t length,
+                                     uint8_t *reply,
+                                     uint16_t *reply_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif     // _CALLBACK_CONTROL_MESSAGES_H
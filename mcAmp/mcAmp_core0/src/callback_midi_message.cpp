@@ -50,19 +50,27 @@ bool midi_setup_arm(void) {
  */
 void midi_rx_callback_arm(void) {
 
-    uint8_t val;
+    uint8_t val[32];
+    uint16_t len = 0;
 
     // Keep reading bytes from MIDI FIFO until we have processed all of them
     while (uart_available(&midi_uart_arm)) {
 
-        // Replace the uart_read_byte() / uart_write_byte() functions below with any custom code
-        // This code just passes the received MIDI byte back to MIDI out
+        // Replace the uart_read_byte() / uart_write_block() functions below with any custom code
+        // This code just passes the received MIDI bytes back to MIDI out
 
         // Read the new byte
-        uart_read_byte(&midi_uart_arm, &val);
+        uart_read_byte(&midi_uart_arm, &val[len++]);
 
-        // Write that byte back to MIDI TX
-        uart_write_byte(&midi_uart_arm, val);
+        // Write the bytes back to MIDI TX as a block so they go out in one DMA transfer
+        if (len == sizeof(val)) {
+            uart_write_block(&midi_uart_arm, val, len);
+            len = 0;
+        }
+    }
+
+    if (len) {
+        uart_write_block(&midi_uart_arm, val, len);
     }
 }
 
@@ -17,132 +17,262 @@
 // Audio processing framework support
 #include "audio_framework_selector.h"
 
+// The presses are handled by a task rather than in the GPIO interrupts
+#include "drivers/bm_scheduler_driver/bm_scheduler.h"
+
 #include "callback_pushbuttons.h"
 
+// Worst case from a press to its messages being queued for the SHARC cores
+#define PUSHBUTTON_DEADLINE_MS   (10)
+
+typedef enum {
+    PUSHBUTTON_SAM_PB1 = 0,
+    PUSHBUTTON_SAM_PB2,
+    PUSHBUTTON_EXTERNAL_1,
+    PUSHBUTTON_EXTERNAL_2,
+    PUSHBUTTON_EXTERNAL_3,
+    PUSHBUTTON_EXTERNAL_4,
+    PUSHBUTTON_COUNT
+} PUSHBUTTON;
+
+// Presses counted by the GPIO interrupts, and how many of them the task has handled
+static volatile uint32_t pushbutton_presses[PUSHBUTTON_COUNT];
+static uint32_t pushbutton_presses_handled[PUSHBUTTON_COUNT];
+
+static BM_TASK *pushbutton_task = NULL;
+
 /**
- * @brief Call back for push button (PB1) on SHARC Audio Module board
+ * @brief Sends a message to a SHARC core
  *
- * @param data_object event attributes
+ * @param queue IPC_QUEUE_ARM_TO_SHARC1 or IPC_QUEUE_ARM_TO_SHARC2
+ * @param type message type (IPC_MESSAGE_TYPE)
+ * @param arg message argument
  */
-void pushbutton_callback_sam_pb1(void  *data_object) {
+static void pushbutton_send(BM_IPC_QUEUE *queue, IPC_MESSAGE_TYPE type, int32_t arg) {
 
-    // Add custom code here
+    IPC_MESSAGE message;
+    message.type = type;
+    message.arg = arg;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->sharc_sam_pb_1_pressed = true;
+    // A press is simply lost if a SHARC core has stopped taking messages
+    ipc_queue_push(queue, &message);
 }
 
 /**
- * @brief Call back for push button (PB2) on SHARC Audio Module board
+ * @brief Lets both SHARC cores know that a push button has been pressed
  *
- * @param data_object event attributes
+ * @param button button that was pressed
  */
-void pushbutton_callback_sam_pb2(void  *data_object) {
+static void pushbutton_send_pressed(IPC_BUTTON button) {
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC1, IPC_MESSAGE_BUTTON, button);
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC2, IPC_MESSAGE_BUTTON, button);
+}
+
+/**
+ * @brief Handles a press of push button (PB1) on SHARC Audio Module board
+ */
+static void pushbutton_pressed_sam_pb1(void) {
+
+    // Add custom code here
+
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_SAM_PB1);
+}
+
+/**
+ * @brief Handles a press of push button (PB2) on SHARC Audio Module board
+ */
+static void pushbutton_pressed_sam_pb2(void) {
 
     // Add custom code here
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->sharc_sam_pb_2_pressed = true;
+    // Let the SHARCs know that a PB has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_SAM_PB2);
 }
 
 #if    (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
 
 /**
- * @brief Call back for PB1/SW1 on SHARC Audio Module Audio Project Fin
- *
- * @param data_object event attributes
+ * @brief Handles a press of PB1/SW1 on SHARC Audio Module Audio Project Fin
  */
-void pushbutton_callback_external_1(void  *data_object) {
+static void pushbutton_pressed_external_1(void) {
 
 
     // If SW is controlling an on-off state, set LED to reflect state
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_1_state = !multicore_data->audioproj_fin_sw_1_state;
 
-    // Update our multicore structure to let the SHARCs know that a SW has been pressed
-    multicore_data->audioproj_fin_sw_1_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_1_core2_pressed = true;
+    // Let the SHARCs know that a SW has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_AUDIOPROJ_FIN_SW1);
 
-    // Decrement our reverb effect
-    multicore_data->reverb_preset--;
-    if (multicore_data->reverb_preset >= multicore_data->total_effects_presets) {
-    	multicore_data->reverb_preset = multicore_data->total_effects_presets - 1;
-    }
+    // Decrement our reverb effect (SHARC core 2 owns the preset and wraps it around)
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC2, IPC_MESSAGE_PRESET_STEP, -1);
 
     // Add custom code here
 }
 
 /**
- * @brief Call back for PB2/SW2 on SHARC Audio Module Audio Project Fin
- *
- * @param data_object event attributes
+ * @brief Handles a press of PB2/SW2 on SHARC Audio Module Audio Project Fin
  */
-void pushbutton_callback_external_2(void  *data_object) {
+static void pushbutton_pressed_external_2(void) {
 
     // If SW is controlling an on-off state, set LED to reflect state
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_2_state = !multicore_data->audioproj_fin_sw_2_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_2_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_2_core2_pressed = true;
+    // Let the SHARCs know that a SW has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_AUDIOPROJ_FIN_SW2);
 
-    // Increment our reverb effect
-    multicore_data->reverb_preset++;
-    if (multicore_data->reverb_preset >= multicore_data->total_effects_presets) {
-    	multicore_data->reverb_preset = 0;
-    }
+    // Increment our reverb effect (SHARC core 2 owns the preset and wraps it around)
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC2, IPC_MESSAGE_PRESET_STEP, 1);
 
     // Add custom code here
 }
 
 /**
- * @brief Call back for PB3/SW3 on SHARC Audio Module Audio Project Fin
- *
- * @param data_object event attributes
+ * @brief Handles a press of PB3/SW3 on SHARC Audio Module Audio Project Fin
  */
-void pushbutton_callback_external_3(void  *data_object) {
+static void pushbutton_pressed_external_3(void) {
 
     // If SW is controlling an on-off state, set LED to reflect state
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_3_state = !multicore_data->audioproj_fin_sw_3_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_3_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_3_core2_pressed = true;
+    // Let the SHARCs know that a SW has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_AUDIOPROJ_FIN_SW3);
 
-    // Decrement our current effect
-    multicore_data->effects_preset--;
-    if (multicore_data->effects_preset >= multicore_data->total_effects_presets) {
-    	multicore_data->effects_preset = multicore_data->total_effects_presets - 1;
-    }
+    // Decrement our current effect (SHARC core 1 owns the preset and wraps it around)
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC1, IPC_MESSAGE_PRESET_STEP, -1);
 
     // Add custom code here
 
 }
 
 /**
- * @brief Call back for PB4/SW4 on SHARC Audio Module Audio Project Fin
- *
- * @param data_object event attributes
+ * @brief Handles a press of PB4/SW4 on SHARC Audio Module Audio Project Fin
  */
-void pushbutton_callback_external_4(void  *data_object) {
+static void pushbutton_pressed_external_4(void) {
 
     // If SW is controlling an on-off state, set LED to reflect state
 	// Remove this code if SW will be used to trigger an event rather than toggle a state
     multicore_data->audioproj_fin_sw_4_state = !multicore_data->audioproj_fin_sw_4_state;
 
-    // Update our multicore structure to let the SHARCs know that a PB has been pressed
-    multicore_data->audioproj_fin_sw_4_core1_pressed = true;
-    multicore_data->audioproj_fin_sw_4_core2_pressed = true;
+    // Let the SHARCs know that a SW has been pressed
+    pushbutton_send_pressed(IPC_BUTTON_AUDIOPROJ_FIN_SW4);
 
-    // Increment our current effect
-    multicore_data->effects_preset++;
-    if (multicore_data->effects_preset >= multicore_data->total_effects_presets) {
-    	multicore_data->effects_preset = 0;
-    }
+    // Increment our current effect (SHARC core 1 owns the preset and wraps it around)
+    pushbutton_send(IPC_QUEUE_ARM_TO_SHARC1, IPC_MESSAGE_PRESET_STEP, 1);
 
     // Add custom code here
 
 }
 #endif
+
+/**
+ * @brief Handles the presses counted since the task last ran
+ *
+ * Runs from the scheduler, so the messages to the SHARC cores are all
+ * pushed from the background level (a queue may only be pushed from one
+ * interrupt level) and the GPIO interrupts stay short.
+ */
+static void pushbutton_task_function(void *arg) {
+
+    for (int button = 0; button < PUSHBUTTON_COUNT; button++) {
+        while (pushbutton_presses_handled[button] != pushbutton_presses[button]) {
+            pushbutton_presses_handled[button]++;
+
+            switch (button) {
+                case PUSHBUTTON_SAM_PB1:    pushbutton_pressed_sam_pb1();       break;
+                case PUSHBUTTON_SAM_PB2:    pushbutton_pressed_sam_pb2();       break;
+                #if (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+                case PUSHBUTTON_EXTERNAL_1: pushbutton_pressed_external_1();    break;
+                case PUSHBUTTON_EXTERNAL_2: pushbutton_pressed_external_2();    break;
+                case PUSHBUTTON_EXTERNAL_3: pushbutton_pressed_external_3();    break;
+                case PUSHBUTTON_EXTERNAL_4: pushbutton_pressed_external_4();    break;
+                #endif
+                default:                                                        break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Counts a press (from a GPIO interrupt) and wakes the task
+ */
+static void pushbutton_count_press(PUSHBUTTON button) {
+    pushbutton_presses[button]++;
+    scheduler_signal(pushbutton_task);
+}
+
+/**
+ * @brief Adds the task that handles push button presses
+ *
+ * @return true if successful
+ */
+bool pushbuttons_add_task(void) {
+
+    pushbutton_task = scheduler_add_event("buttons",
+                                          pushbutton_task_function,
+                                          NULL,
+                                          TASK_PRIORITY_CONTROL,
+                                          PUSHBUTTON_DEADLINE_MS);
+
+    return pushbutton_task != NULL;
+}
+
+/**
+ * @brief Call back for push button (PB1) on SHARC Audio Module board
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_sam_pb1(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_SAM_PB1);
+}
+
+/**
+ * @brief Call back for push button (PB2) on SHARC Audio Module board
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_sam_pb2(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_SAM_PB2);
+}
+
+#if    (SAM_AUDIOPROJ_FIN_BOARD_PRESENT)
+
+/**
+ * @brief Call back for PB1/SW1 on SHARC Audio Module Audio Project Fin
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_external_1(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_EXTERNAL_1);
+}
+
+/**
+ * @brief Call back for PB2/SW2 on SHARC Audio Module Audio Project Fin
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_external_2(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_EXTERNAL_2);
+}
+
+/**
+ * @brief Call back for PB3/SW3 on SHARC Audio Module Audio Project Fin
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_external_3(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_EXTERNAL_3);
+}
+
+/**
+ * @brief Call back for PB4/SW4 on SHARC Audio Module Audio Project Fin
+ *
+ * @param data_object event attributes
+ */
+void pushbutton_callback_external_4(void  *data_object) {
+    pushbutton_count_press(PUSHBUTTON_EXTERNAL_4);
+}
+#endif
@@ -4,10 +4,14 @@
 #ifndef _CALLBACK_PUSHBUTTONS_H
 #define _CALLBACK_PUSHBUTTONS_H
 
+#include <stdbool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+bool pushbuttons_add_task(void);
+
 void SHARC_SAM_pb1_callback(void *data_object);
 void SHARC_SAM_pb2_callback(void *data_object);
 
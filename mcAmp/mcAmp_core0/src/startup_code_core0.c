@@ -22,12 +22,34 @@
 // Simple event logging / error handling functionality
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
+// Cross-core binary trace
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+// On-target audio capture (sent to the PC over the event log UART)
+#include "drivers/bm_audio_capture_driver/bm_audio_capture.h"
+
+// Memory use and stack high-water mark reporting
+#include "drivers/bm_memory_report_driver/bm_memory_report.h"
+
+// Named metrics shared between the cores
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+// Cooperative task scheduler that runs the ARM's background work
+#include "drivers/bm_scheduler_driver/bm_scheduler.h"
+
 // Audio processing framework support
 #include "audio_framework_selector.h"
 
 // And our call backs from processing UART / MIDI messages
 #include "callback_midi_message.h"
 
+// Push button presses are handled by a task
+#include "callback_pushbuttons.h"
+
+// Messages from the host over the control link (shares the event log UART)
+#include "callback_control_messages.h"
+#include "drivers/bm_control_link_driver/bm_control_link.h"
+
 /**
  * @brief If any FATAL or ERROR events are reported, this function gets called as an interrupt
  */
@@ -51,8 +73,64 @@ void event_logging_error_callback(uint32_t event, void *obj) {
     }
 }
 
+/**
+ * @brief Task: copies event messages from the SHARC cores to the event log
+ */
+static void task_poll_sharc_event_logs(void *arg) {
+    event_logging_poll_sharc_cores_for_new_message();
+}
+
+/**
+ * @brief Task: sends any finished audio capture to the PC
+ */
+static void task_dump_audio_capture(void *arg) {
+    audio_capture_dump_arm(multicore_data->sharc_core1_capture);
+}
+
+/**
+ * @brief Task: handles parameter changes and coefficient uploads from the PC
+ */
+static void task_poll_control_link(void *arg) {
+    control_link_poll();
+}
+
+/**
+ * @brief Task: checks how deep the ARM's stack has been and which tasks have been late
+ */
+static void task_report(void *arg) {
+    memory_report_update_stack(&multicore_data->arm_memory);
+    scheduler_log_stats();
+}
+
+/**
+ * @brief Adds the ARM's own background tasks (the framework adds its own)
+ *
+ * @return true if successful
+ */
+static bool add_background_tasks(void) {
+
+    bool success = true;
+
+    success &= scheduler_add_periodic("event log", task_poll_sharc_event_logs, NULL,
+                                      TASK_PRIORITY_IO, 1, 10) != NULL;
+    success &= scheduler_add_periodic("control link", task_poll_control_link, NULL,
+                                      TASK_PRIORITY_CONTROL, 2, 20) != NULL;
+    success &= scheduler_add_periodic("capture", task_dump_audio_capture, NULL,
+                                      TASK_PRIORITY_IO, 5, 50) != NULL;
+    success &= scheduler_add_periodic("report", task_report, NULL,
+                                      TASK_PRIORITY_BACKGROUND, 5000, 100) != NULL;
+
+    return success;
+}
+
 int main(int argc, const char *argv[]) {
 
+    // Paint the stack before anything (including interrupts) has used it
+    memory_report_initialize(&multicore_data->arm_memory);
+
+    // Clear the ARM's metrics region
+    metrics_initialize();
+
     /**
      * Initialize managed drivers and/or services that have been added to
      * the project.
@@ -83,16 +161,8 @@ int main(int argc, const char *argv[]) {
     }
 
     // Initialize event log
-    event_logging_initialize_arm((char *)&multicore_data->sharc_core1_event_message,
-                                 (char *)&multicore_data->sharc_core2_event_message,
-                                 (uint32_t *)&multicore_data->sharc_core1_event_emuclk,
-                                 (uint32_t *)&multicore_data->sharc_core2_event_emuclk,
-                                 (uint32_t *)&multicore_data->sharc_core1_event_emuclk2,
-                                 (uint32_t *)&multicore_data->sharc_core2_event_emuclk2,
-                                 (uint32_t *)&multicore_data->sharc_core1_event_level,
-                                 (uint32_t *)&multicore_data->sharc_core2_event_level,
-                                 (uint32_t *)&multicore_data->sharc_core1_new_message_ready,
-                                 (uint32_t *)&multicore_data->sharc_core2_new_message_ready,
+    event_logging_initialize_arm(&multicore_data->sharc_core1_event_ring,
+                                 &multicore_data->sharc_core2_event_ring,
                                  (float)CORE_CLOCK_FREQ_HZ);
 
     // Send logged events to UART0 (p8 connector on the SHARC Audio Module)
@@ -116,14 +186,58 @@ int main(int argc, const char *argv[]) {
         log_event(EVENT_FATAL, "Structure defined in multicore_shared_memory.h file is too big");
     }
 
+    // Report how full the ARM's memory is (the SHARC cores report their own)
+    memory_report_log_regions(&multicore_data->arm_memory);
+
+    // Set up the trace rings and their timer before the SHARC cores start tracing
+    if (!trace_initialize_arm(SCK0_CLOCK_FREQ_HZ)) {
+        log_event(EVENT_WARN, "Unable to start the binary trace timer, tracing is disabled");
+    }
+
+    // Task run times are measured with the trace timer
+    if (!scheduler_initialize(SCK0_CLOCK_FREQ_HZ)) {
+        log_event(EVENT_FATAL, "Unable to set up the ARM task scheduler");
+    }
+
+    // The push button interrupts (set up by the framework) signal this task
+    if (!pushbuttons_add_task()) {
+        log_event(EVENT_FATAL, "Unable to add the push button task");
+    }
+
+    // Publish the first set of shared parameters before the framework's 1ms tick starts updating them
+    if (!initialize_shared_parameters()) {
+        log_event(EVENT_FATAL, "Unable to set up the parameters shared with the SHARC cores");
+    }
+
     // Initialize our selected the audio framework
     audioframework_initialize();
+    if (!audioframework_add_tasks()) {
+        log_event(EVENT_FATAL, "Unable to add the audio framework's tasks");
+    }
 
     // Initialize the effects presets
     multicore_data->total_effects_presets = 10;
     multicore_data->effects_preset = 0;
     multicore_data->reverb_preset = 0;
 
+    // Empty the queues the cores send push button presses and preset changes through
+    if (!initialize_shared_memory_queues()) {
+        log_event(EVENT_FATAL, "Unable to set up the queues between the cores");
+    }
+
+    // Publish the initial mcAmp output EQ and listen for the host on the event log UART
+    if (!control_messages_setup_arm()) {
+        log_event(EVENT_FATAL, "Unable to set up the mcAmp EQ and the control link");
+    }
+
+    // SHARC core 1 publishes its audio capture once it has been set up
+    multicore_data->sharc_core1_capture = NULL;
+
+    // The spectrum analysis starts on SHARC core 1 and moves to core 2 if it has more headroom
+    multicore_data->sharc_core1_spectrum = NULL;
+    multicore_data->sharc_core2_spectrum = NULL;
+    multicore_data->stft_analyzer_core = 1;
+
     #if defined(MIDI_UART_MANAGED_BY_ARM_CORE) && (MIDI_UART_MANAGED_BY_ARM_CORE)
     if (midi_setup_arm()) {
         log_event(EVENT_INFO, "SHARC Core 1 is configured to process MIDI");
@@ -142,8 +256,9 @@ int main(int argc, const char *argv[]) {
     // Wait for both SHARC cores to init and start processing audio
     audioframework_wait_for_sharcs();
 
-    // Call any background housekeeping functions here
-    while (1) {
-        audioframework_background_loop();
+    // Run the background housekeeping tasks from here on
+    if (!add_background_tasks()) {
+        log_event(EVENT_FATAL, "Unable to add the ARM's background tasks");
     }
+    scheduler_run();
 }
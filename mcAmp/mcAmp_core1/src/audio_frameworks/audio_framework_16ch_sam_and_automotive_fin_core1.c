@@ -50,6 +50,12 @@
 // Structure containing shared variables between the three cores
 #include "common/multicore_shared_memory.h"
 
+// Cross-core binary trace
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+// Named metrics shared with the ARM
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
 // Hooks into user processing functions
 #include "../callback_audio_processing.h"
 
@@ -72,6 +78,9 @@ int section("seg_l1_block1") sport4_dma_tx_1_buffer[AUDIO_CHANNELS * AUDIO_BLOCK
 // Floating-point buffers that we will process / operate on
 // These are aligned to 32-byte boundaries so we can use fast DMAs to move them around
 #pragma align 32
+// Blocks dropped because the previous block hadn't finished processing
+static BM_METRIC dropped_audio_frames;
+
 float automotive_audiochannels_out[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};    // Audio to DACs
 #pragma align 32
 float automotive_audiochannels_in[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0};     // Audio from ADCs
@@ -265,6 +274,9 @@ volatile bool last_audio_frame_completed = true;
 uint32_t audio_blocks_processed_count = 0;
 uint32_t audio_blocks_new_events_count = 0;
 
+// Samples received by the end of the block passed to the audio callback
+static volatile uint32_t audio_block_end_sample = 0;
+
 // Cycle counter used for benchmarking our code
 uint64_t cycle_cntr;
 
@@ -344,6 +356,8 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
 
     // Clear DMA interrupt
     *pREG_DMA11_STAT |= BITM_DMA_STAT_IRQDONE;
+    TRACE(TRACE_SPORT_ISR_BEGIN, audio_blocks_new_events_count);
+
     // Get the configuration of the SPORT / DMA combo driving interrupts
     SPORT_DMA_CONFIG *sport_dma_cfg = (SPORT_DMA_CONFIG *)arg;
 
@@ -408,6 +422,7 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
           BITM_DMA_CFG_WNR |                                 // Write mode
           (0x2 << BITP_DMA_CFG_MSIZE) |
           0;
+    TRACE(TRACE_MDMA_TO_CORE2, audio_blocks_new_events_count);
 
     // And then route the audio we received from core 2 to the right output buffers
     processaudio_output_routing();
@@ -477,6 +492,7 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
           (0x2 << BITP_DMA_CFG_MSIZE) |
           (0x1 << BITP_DMA_CFG_INT) |                        // Generate an interrupt when complete
           0;
+    TRACE(TRACE_MDMA_FROM_CORE2, audio_blocks_new_events_count);
 
     /*
      ********************************************************************************
@@ -505,7 +521,15 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
         }
 
         // Update dropped audio frame counter
-        multicore_data->sharc_core1_dropped_audio_frames++;
+        metric_inc(dropped_audio_frames);
+        TRACE(TRACE_FRAME_DROPPED, *dropped_audio_frames);
+
+        // Keep the trace leading up to the dropped frame
+        #if (TRACE_FREEZE_ON_OVERRUN)
+        trace_freeze();
+        #endif
+
+        TRACE(TRACE_SPORT_ISR_END, audio_blocks_new_events_count);
 
         // Don't trigger the software interrupt for audio processing on this block
         return;
@@ -514,9 +538,14 @@ void audioframework_dma_handler(uint32_t iid, void *arg){
         // Set to false as we begin processing this new audio frame
         last_audio_frame_completed = false;
 
+        // Let the callback know which samples it's processing (for timestamped events)
+        audio_block_end_sample = audio_blocks_new_events_count * AUDIO_BLOCK_SIZE;
+
         // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
         *pREG_SEC0_RAISE = INTR_TRU0_INT4;
     }
+
+    TRACE(TRACE_SPORT_ISR_END, audio_blocks_new_events_count);
 }
 
 /**
@@ -546,6 +575,10 @@ void audioframework_audiocallback_handler(uint32_t iid) {
 
     // Clear the pending software interrupt
     *pREG_SEC0_END = INTR_TRU0_INT4;
+    TRACE(TRACE_CALLBACK_BEGIN, audio_blocks_processed_count);
+
+    // Pick up any parameters the ARM has published since the last block
+    shared_parameters_refresh();
 
     // Call user audio processing
     processaudio_callback();
@@ -562,11 +595,51 @@ void audioframework_audiocallback_handler(uint32_t iid) {
 
     // Increment our counter containing number of blocks processed
     audio_blocks_processed_count++;
+    TRACE(TRACE_CALLBACK_END, audio_blocks_processed_count);
 
     // Set flag that last audio frame has completed
     last_audio_frame_completed = true;
 }
 
+/**
+ * @brief      Returns the number of samples received since audio started
+ *
+ * This combines the number of blocks received with the progress of the
+ * receive DMA through the current block, so it can be used to timestamp
+ * events (e.g. MIDI bytes) to within a sample from any interrupt.  If the
+ * DMA has just finished a block but its interrupt hasn't run yet (because
+ * the caller is a higher priority interrupt), the position is up to a block
+ * behind.
+ *
+ * @return     Sample position
+ */
+uint32_t audioframework_sample_position(void) {
+
+    volatile uint32_t *blocks_received = &audio_blocks_new_events_count;
+    uint32_t blocks, frames;
+
+    // Read again if the DMA interrupt ran in between
+    do {
+        blocks = *blocks_received;
+        frames = audioflow_get_rx_frames(&SPR4_Automotive_16CH_Config);
+    } while (blocks != *blocks_received);
+
+    return blocks * AUDIO_BLOCK_SIZE + frames;
+}
+
+/**
+ * @brief      Returns the sample position at the start of the block being processed
+ *
+ * Call this from the audio callback.  Events stamped with
+ * audioframework_sample_position() before the end of this block (this value
+ * plus AUDIO_BLOCK_SIZE) are due in this block.
+ *
+ * @return     Sample position
+ */
+uint32_t audioframework_block_start_sample(void) {
+    return audio_block_end_sample - AUDIO_BLOCK_SIZE;
+}
+
 /**
  * @brief      SHARC Core 1 audio framework initialization
  *
@@ -586,8 +659,8 @@ void audioframework_initialize() {
     // Clear peak MIPS
     multicore_data->sharc_core1_cpu_load_mhz_peak = 0;
 
-    // Clear dropped frame counter
-    multicore_data->sharc_core1_dropped_audio_frames = 0;
+    // Count dropped frames (the counter starts at zero)
+    dropped_audio_frames = metrics_counter("audio.dropped_frames");
 
     // Initialize peripherals and DMA to configure audio data I/O flow
     audioflow_init_sport_dma(&SPR4_Automotive_16CH_Config);
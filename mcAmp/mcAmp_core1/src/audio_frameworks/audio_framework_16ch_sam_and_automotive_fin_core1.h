@@ -157,6 +157,10 @@ extern float *audiochannel_automotive_7_right_out;
 void audioframework_initialize(void);
 void audioframework_start(void);
 
+// Sample positions used to timestamp events (e.g. MIDI) to within a sample
+uint32_t audioframework_sample_position(void);
+uint32_t audioframework_block_start_sample(void);
+
 #ifdef __cplusplus
 }
 #endif
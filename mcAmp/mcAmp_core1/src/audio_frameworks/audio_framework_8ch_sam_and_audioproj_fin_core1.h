@@ -191,6 +191,10 @@ extern uint32_t audio_blocks_processed_count;
 void audioframework_initialize(void);
 void audioframework_start(void);
 
+// Sample positions used to timestamp events (e.g. MIDI) to within a sample
+uint32_t audioframework_sample_position(void);
+uint32_t audioframework_block_start_sample(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,8 @@
 #ifndef _AUDIO_FRAMEWORK_FAUST_EXTENSION_H
 #define _AUDIO_FRAMEWORK_FAUST_EXTENSION_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,6 +36,9 @@ void faust_initialize(void);
 // Performs block-based processing
 void Faust_audio_processing(void);
 
+// Counts a push button press sent from the ARM (IPC_BUTTON)
+void faust_button_pressed(uint32_t button);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,46 @@
 // Prototypes for this file
 #include "callback_audio_processing.h"
 
+// Channel counts and idle thresholds for the multichannel amps
+#include "drivers/mcAmp_drivers/mcAmp.h"
+
+// Records the S/PDIF inputs and mcAmp outputs to SDRAM for the ARM to send to the PC
+#include "drivers/bm_audio_capture_driver/bm_audio_capture.h"
+
+// Tones and Goertzel detectors that check the wiring, level and latency of each mcAmp channel
+#include "audio_processing/audio_elements/channel_test.h"
+
+// Spectrum of the audio sent on for processing, computed on whichever SHARC core has more headroom
+#include "audio_processing/audio_elements/stft_analyzer.h"
+
+// Output EQ on each mcAmp channel, with coefficients uploaded over the control link
+#include "audio_processing/audio_elements/biquad_cascade.h"
+
+// MIDI events received by SHARC core 1
+#include "callback_midi_message.h"
+
+// Audio kept from before and recorded after a capture is triggered (see bm_audio_capture.c)
+#define AUDIO_CAPTURE_PRE_TRIGGER_MS    (200)
+#define AUDIO_CAPTURE_POST_TRIGGER_MS   (100)
+
+// Silence detection on each mcAmp output channel, used to mute idle amps
+static SILENCE_DETECTOR mcamp_silence[MCAMP_N_CHANNELS];
+
+// Output EQ on each mcAmp channel, run from the last set the ARM published
+static MCAMP_EQ_SET mcamp_eq;
+static MCAMP_EQ_SET mcamp_eq_next;
+static uint32_t mcamp_eq_version = PARAM_STORE_NO_VERSION;
+static BIQUAD_CASCADE mcamp_eq_filters[MCAMP_N_CHANNELS];
+
+// Checks each mcAmp output channel against the line inputs (started by push button 1)
+static CHANNEL_TEST mcamp_test;
+
+// Push button 1 presses (counted by the doorbell interrupt, handled in the background loop)
+static volatile uint32_t mcamp_test_presses = 0;
+static uint32_t mcamp_test_presses_handled = 0;
+
+static void processaudio_arm_messages(BM_IPC_QUEUE *queue, void *arg);
+
 /*
  *
  * Available Processing Power
@@ -195,6 +235,66 @@ void processaudio_setup(void) {
 	// Initialize the audio effects in the audio_processing/ folder
 	audio_effects_setup_core1();
 
+	// Detect when the channels driven by each amp go quiet
+	for (int i = 0; i < MCAMP_N_CHANNELS; i++) {
+		silence_detector_setup(&mcamp_silence[i], MCAMP_IDLE_THRESHOLD_DB,
+		MCAMP_IDLE_HANGOVER_MS, AUDIO_BLOCK_SIZE, AUDIO_SAMPLE_RATE);
+	}
+	multicore_data->mcamp_amps_idle = 0;
+
+	// Each channel's EQ runs from its row of the coefficients (all off until the ARM publishes some)
+	mcamp_eq.enabled = 0;
+	for (int i = 0; i < MCAMP_N_CHANNELS; i++) {
+		biquad_cascade_setup(&mcamp_eq_filters[i], &mcamp_eq.coefficients[i][0][0],
+				MCAMP_EQ_STAGES);
+	}
+
+	// Give each mcAmp channel its own tone for the channel test
+	if (channel_test_setup(&mcamp_test, MCAMP_N_CHANNELS, MCAMP_TEST_N_INPUTS,
+			MCAMP_TEST_TONE_LEVEL_DB, MCAMP_TEST_FIRST_FREQ_HZ,
+			MCAMP_TEST_FREQ_SPACING_HZ, MCAMP_TEST_WINDOW_MS, AUDIO_BLOCK_SIZE,
+			AUDIO_SAMPLE_RATE) != CHANNEL_TEST_OK) {
+		log_event(EVENT_WARN, "Unable to set up the mcAmp channel test");
+	}
+
+	// Handle push buttons and preset changes from the ARM as they arrive
+	if (!ipc_queue_enable_doorbell(IPC_QUEUE_ARM_TO_SHARC1,
+			IPC_DOORBELL_SHARC1, processaudio_arm_messages, NULL)) {
+		log_event(EVENT_WARN, "Unable to enable the ARM message doorbell");
+	}
+	processaudio_arm_messages(IPC_QUEUE_ARM_TO_SHARC1, NULL);
+
+	// Capture the S/PDIF inputs and every mcAmp output around the first overrun
+	// (or a call to audio_capture_trigger())
+	BM_AUDIO_CAPTURE_STATUS * capture = audio_capture_initialize(
+			AUDIO_SAMPLE_RATE, AUDIO_BLOCK_SIZE);
+
+	float * capture_channels[] = { audiochannel_spdif_0_left_in,
+			audiochannel_spdif_0_right_in, mcamp_ch1, mcamp_ch2, mcamp_ch3,
+			mcamp_ch4, mcamp_ch5, mcamp_ch6, mcamp_ch7, mcamp_ch8, mcamp_ch9,
+			mcamp_ch10, mcamp_ch11, mcamp_ch12, mcamp_ch13, mcamp_ch14,
+			mcamp_ch15, mcamp_ch16, mcamp_ch17, mcamp_ch18, mcamp_ch19,
+			mcamp_ch20 };
+	for (int i = 0; i < sizeof(capture_channels) / sizeof(float *); i++) {
+		audio_capture_add_channel(capture_channels[i]);
+	}
+
+	if (audio_capture_arm(
+			AUDIO_CAPTURE_TRIGGER_OVERRUN | AUDIO_CAPTURE_TRIGGER_MANUAL,
+			AUDIO_CAPTURE_PRE_TRIGGER_MS, AUDIO_CAPTURE_POST_TRIGGER_MS)
+			!= AUDIO_CAPTURE_SUCCESS) {
+		log_event(EVENT_WARN, "Unable to arm the audio capture");
+	}
+	multicore_data->sharc_core1_capture = capture;
+
+	// Analyze the audio sent on for processing (core 2 analyzes the same audio when the analysis moves there)
+	multicore_data->sharc_core1_spectrum = stft_analyzer_setup(
+			STFT_ANALYZER_SIZE, STFT_ANALYZER_HOP, AUDIO_BLOCK_SIZE,
+			AUDIO_SAMPLE_RATE);
+	if (STFT_ANALYZER_ENABLED && multicore_data->sharc_core1_spectrum == NULL) {
+		log_event(EVENT_WARN, "Unable to set up the spectrum analyzer");
+	}
+
 	// *******************************************************************************
 	// Add any custom setup code here
 	// *******************************************************************************
@@ -221,30 +321,233 @@ void processaudio_setup(void) {
  * is 300,000 cycles or 300,000/32 or 9,375 per sample of audio
  */
 
+/*
+ * Handles the messages from the ARM (called from the doorbell interrupt).  This
+ * core owns effects_preset, so preset changes from the push buttons and the control
+ * link are made here.
+ */
+static void processaudio_arm_messages(BM_IPC_QUEUE *queue, void *arg) {
+
+	IPC_MESSAGE message;
+
+	while (ipc_queue_pop(queue, &message)) {
+
+		switch (message.type) {
+
+		case IPC_MESSAGE_BUTTON:
+			// Push button 1 starts the mcAmp channel test
+			if (message.arg == IPC_BUTTON_SAM_PB1) {
+				mcamp_test_presses++;
+			}
+#if (USE_FAUST_ALGORITHM_CORE1)
+			faust_button_pressed(message.arg);
+#endif
+			break;
+
+		case IPC_MESSAGE_PRESET_STEP:
+			if (multicore_data->total_effects_presets) {
+				uint32_t total = multicore_data->total_effects_presets;
+				multicore_data->effects_preset = (multicore_data->effects_preset
+						+ total + message.arg) % total;
+			}
+			break;
+
+		case IPC_MESSAGE_PRESET_SET:
+			if ((uint32_t) message.arg < multicore_data->total_effects_presets) {
+				multicore_data->effects_preset = message.arg;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+/*
+ * Runs the output EQ on the mcAmp channels that have it enabled.  A new set of
+ * coefficients published by the ARM takes effect at the start of a block; the
+ * filter state is kept, and cleared for channels that have just been enabled.
+ */
+#pragma optimize_for_speed
+static void processaudio_mcamp_eq(void) {
+
+	float * mcamp_channels[MCAMP_N_CHANNELS] = { mcamp_ch1, mcamp_ch2,
+			mcamp_ch3, mcamp_ch4, mcamp_ch5, mcamp_ch6, mcamp_ch7, mcamp_ch8,
+			mcamp_ch9, mcamp_ch10, mcamp_ch11, mcamp_ch12, mcamp_ch13,
+			mcamp_ch14, mcamp_ch15, mcamp_ch16, mcamp_ch17, mcamp_ch18,
+			mcamp_ch19, mcamp_ch20 };
+
+	if (param_store_read(PARAM_STORE_MCAMP_EQ, &mcamp_eq_next, &mcamp_eq_version)) {
+		uint32_t turned_on = mcamp_eq_next.enabled & ~mcamp_eq.enabled;
+		mcamp_eq = mcamp_eq_next;
+		for (int ch = 0; ch < MCAMP_N_CHANNELS; ch++) {
+			if (turned_on & (1 << ch)) {
+				biquad_cascade_reset(&mcamp_eq_filters[ch]);
+			}
+		}
+	}
+
+	uint32_t enabled = mcamp_eq.enabled;
+	for (int ch = 0; enabled && ch < MCAMP_N_CHANNELS; ch++) {
+		if (enabled & (1 << ch)) {
+			biquad_cascade_read(&mcamp_eq_filters[ch], mcamp_channels[ch],
+					mcamp_channels[ch], AUDIO_BLOCK_SIZE);
+		}
+	}
+}
+
+/*
+ * Checks each mcAmp output channel for silence and flags an amp as idle once all
+ * of its channels have been silent for MCAMP_IDLE_HANGOVER_MS.  The amps are
+ * muted / unmuted over I2C by mcAmp_updateIdle() from the background loop, as
+ * the I2C transfers take far too long to run in the callback.
+ *
+ * An amp is flagged as busy again in the first block that has audio on any of
+ * its channels, so the background loop starts unmuting it straight away.  The
+ * audio is always passed through untouched, so everything after the amp's own
+ * unmute is heard; nothing here holds the channels silent.
+ */
+#pragma optimize_for_speed
+static void processaudio_mcamp_idle(void) {
+
+	float * mcamp_channels[MCAMP_N_CHANNELS] = { mcamp_ch1, mcamp_ch2,
+			mcamp_ch3, mcamp_ch4, mcamp_ch5, mcamp_ch6, mcamp_ch7, mcamp_ch8,
+			mcamp_ch9, mcamp_ch10, mcamp_ch11, mcamp_ch12, mcamp_ch13,
+			mcamp_ch14, mcamp_ch15, mcamp_ch16, mcamp_ch17, mcamp_ch18,
+			mcamp_ch19, mcamp_ch20 };
+
+	// Keep every amp on during the channel test, even while its channels are silent
+	if (channel_test_running(&mcamp_test)) {
+		for (int ch = 0; ch < MCAMP_N_CHANNELS; ch++) {
+			silence_detector_reset(&mcamp_silence[ch]);
+		}
+		multicore_data->mcamp_amps_idle = 0;
+		return;
+	}
+
+	uint32_t amps_idle = 0;
+	for (int amp = 0; amp < MCAMP_N_CHANNELS / MCAMP_N_CHANNELS_PER_AMP;
+			amp++) {
+
+		bool idle = true;
+		for (int ch = amp * MCAMP_N_CHANNELS_PER_AMP;
+				ch < (amp + 1) * MCAMP_N_CHANNELS_PER_AMP; ch++) {
+			idle &= silence_detector_read(&mcamp_silence[ch],
+					mcamp_channels[ch], AUDIO_BLOCK_SIZE);
+		}
+		if (idle) {
+			amps_idle |= (1 << amp);
+		}
+	}
+
+	multicore_data->mcamp_amps_idle = amps_idle;
+}
+
+/*
+ * While the channel test is running, replaces the mcAmp outputs with its tones
+ * and listens for them on the line inputs.  Does nothing otherwise.
+ */
+#pragma optimize_for_speed
+static void processaudio_mcamp_test(void) {
+
+	float * mcamp_channels[MCAMP_N_CHANNELS] = { mcamp_ch1, mcamp_ch2,
+			mcamp_ch3, mcamp_ch4, mcamp_ch5, mcamp_ch6, mcamp_ch7, mcamp_ch8,
+			mcamp_ch9, mcamp_ch10, mcamp_ch11, mcamp_ch12, mcamp_ch13,
+			mcamp_ch14, mcamp_ch15, mcamp_ch16, mcamp_ch17, mcamp_ch18,
+			mcamp_ch19, mcamp_ch20 };
+
+	float * test_inputs[MCAMP_TEST_N_INPUTS] = { audiochannel_0_left_in,
+			audiochannel_0_right_in };
+
+	channel_test_process(&mcamp_test, mcamp_channels, test_inputs,
+			AUDIO_BLOCK_SIZE);
+}
+
+/*
+ * Reports the results of the last channel test, a line at a time as there is
+ * room in the event log.
+ */
+static void processaudio_mcamp_test_report(void) {
+
+	static uint32_t reported_runs = 0;
+	static uint32_t channel = 0;
+	static uint32_t heard = 0;
+
+	if (mcamp_test.runs == reported_runs) {
+		return;
+	}
+
+	if (channel < MCAMP_N_CHANNELS) {
+		const CHANNEL_TEST_RESULT * r = channel_test_result(&mcamp_test,
+				channel);
+		bool logged;
+		if (r->found) {
+			logged = log_event_fmt(EVENT_INFO, EVENT_FMT_CHANNEL_TEST_HEARD,
+					channel + 1, r->input, EVENT_LOG_FLOAT(r->level_db),
+					EVENT_LOG_FLOAT(r->latency_samples));
+		} else {
+			logged = log_event_fmt(EVENT_WARN, EVENT_FMT_CHANNEL_TEST_MISSING,
+					channel + 1, EVENT_LOG_FLOAT(r->frequency));
+		}
+		if (logged) {
+			heard += r->found ? 1 : 0;
+			channel++;
+		}
+		return;
+	}
+
+	if (log_event_fmt(heard == MCAMP_N_CHANNELS ? EVENT_INFO : EVENT_WARN,
+			EVENT_FMT_CHANNEL_TEST_SUMMARY, heard, MCAMP_N_CHANNELS,
+			EVENT_LOG_FLOAT(channel_test_result(&mcamp_test, 0)->frequency),
+			EVENT_LOG_FLOAT(channel_test_result(&mcamp_test,
+					MCAMP_N_CHANNELS - 1)->frequency))) {
+		reported_runs = mcamp_test.runs;
+		channel = 0;
+		heard = 0;
+	}
+}
+
 // When debugging audio algorithms, helpful to comment out this pragma for more linear single stepping.
 #pragma optimize_for_speed
 void processaudio_callback(void) {
 
+	// Start each block with an empty scratch arena for the audio elements
+	scratch_arena_reset();
+
+	// Time this block and the nodes within it
+	CYCLE_PROFILE_BLOCK_START();
+
+#if (MIDI_UART_MANAGED_BY_SHARC1_CORE)
+	// Apply the MIDI events that arrived while this block was being received
+	midi_process_events_sharc1();
+#endif
+
 	if (false) {
 
 		// Copy incoming audio buffers to the effects input buffers
+		CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
 		copy_buffer(audiochannel_0_left_in, audio_effects_left_in,
 				AUDIO_BLOCK_SIZE);
 		copy_buffer(audiochannel_0_right_in, audio_effects_right_in,
 				AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE_NODE_END();
 
 		// Process audio effects
 		audio_effects_process_audio_core1();
 
 		// Copy processed audio back to input buffers
+		CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
 		copy_buffer(audio_effects_left_out, audiochannel_0_left_in,
 				AUDIO_BLOCK_SIZE);
 		copy_buffer(audio_effects_right_out, audiochannel_0_right_in,
 				AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE_NODE_END();
 
 	}
 
 	// Otherwise, perform our C-based block processing here!
+	CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
 	for (int i = 0; i < AUDIO_BLOCK_SIZE; i++) {
 
 		// *******************************************************************************
@@ -343,7 +646,25 @@ void processaudio_callback(void) {
 
 #endif
 	}
+	CYCLE_PROFILE_NODE_END();
 
+	// Keep the spectrum analyzer's overlap ring filled, and run its share of the FFT if it's on this core
+	stft_analyzer_process(audiochannel_0_left_out, AUDIO_BLOCK_SIZE,
+			multicore_data->stft_analyzer_core == 1);
+
+	// Equalize the mcAmp outputs
+	CYCLE_PROFILE(PROFILE_NODE_MCAMP_EQ, processaudio_mcamp_eq());
+
+	// Replace the mcAmp outputs with test tones while the channel test is running
+	processaudio_mcamp_test();
+
+	// Let the amp driver know which amps only have silence to play
+	CYCLE_PROFILE(PROFILE_NODE_MCAMP_IDLE, processaudio_mcamp_idle());
+
+	// Copy this block to the capture ring (the MDMA runs in the background)
+	CYCLE_PROFILE(PROFILE_NODE_AUDIO_CAPTURE, audio_capture_block());
+
+	CYCLE_PROFILE_BLOCK_END();
 }
 
 #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
@@ -423,6 +744,19 @@ void processaudio_output_routing(void) {
  */
 void processaudio_background_loop(void) {
 
+	// Prepare any incoming effects preset outside of the audio callback
+	audio_effects_background_core1();
+
+	// Push button 1 starts the mcAmp channel test
+	if (mcamp_test_presses_handled != mcamp_test_presses) {
+		mcamp_test_presses_handled = mcamp_test_presses;
+		if (!channel_test_running(&mcamp_test)) {
+			log_event(EVENT_INFO, "Channel test: playing a tone on each mcAmp channel...");
+			channel_test_start(&mcamp_test);
+		}
+	}
+	processaudio_mcamp_test_report();
+
 	// *******************************************************************************
 	// Add any custom background processing here
 	// *******************************************************************************
@@ -434,4 +768,10 @@ void processaudio_background_loop(void) {
  * to complete (essentially exceeding the available computational resources of this core).
  */
 void processaudio_mips_overflow(void) {
+
+	// Shed load (step the effects down a quality tier) for the next block
+	audio_effects_overrun_core1();
+
+	// Keep the audio around the overrun if the capture is waiting for one
+	audio_capture_report_overrun();
 }
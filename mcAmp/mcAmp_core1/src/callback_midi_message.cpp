@@ -21,11 +21,29 @@
 // Event logging / error handling / functionality
 #include "drivers/bm_event_logging_driver/bm_event_logging.h"
 
+// Structure containing shared variables between the three cores
+#include "common/multicore_shared_memory.h"
+
+// Sample positions for timestamping MIDI events
+#include "audio_framework_selector.h"
+
+// MIDI stream parser and event queue
+#include "audio_processing/audio_elements/midi_parser.h"
+
+// Control changes and notes are applied by the effects at their sample offset
+#include "audio_processing/audio_effects_selector.h"
+
 #include "callback_midi_message.h"
 
+// General purpose controllers 1 - 3 (CC 16 - 18) set the effect controls, like the pots
+#define MIDI_CC_EFFECT_CONTROL_FIRST    (16)
+
 // Create an instance of our MIDI UART driver
 BM_UART midi_uart_sharc1;
 
+// Parses bytes in the UART interrupt and queues events for the audio callback
+static MIDI_PARSER midi_parser_sharc1;
+
 /**
  * @brief Sets up MIDI on the SHARC Core 1
  *
@@ -33,6 +51,8 @@ BM_UART midi_uart_sharc1;
  */
 bool midi_setup_sharc1(void) {
 
+    midi_parser_setup(&midi_parser_sharc1);
+
     if (uart_initialize(&midi_uart_sharc1, UART_BAUD_RATE_MIDI, UART_SERIAL_8N1, UART_AUDIOPROJ_DEVICE_MIDI)
         != UART_SUCCESS) {
         return false;
@@ -46,22 +66,80 @@ bool midi_setup_sharc1(void) {
 
 /**
  * @brief Callback when new MIDI bytes arrive
+ *
+ * This runs in the UART interrupt, so it only parses the bytes and queues
+ * the events; they are handled in the audio callback by midi_process_events_sharc1().
  */
 void midi_rx_callback_sharc1(void) {
 
     uint8_t val;
 
+    // Bytes read together arrived within a few samples of each other
+    uint32_t now = audioframework_sample_position();
+
     // Keep reading bytes from MIDI FIFO until we have processed all of them
     while (uart_available(&midi_uart_sharc1)) {
+        uart_read_byte(&midi_uart_sharc1, &val);
+        midi_parser_byte(&midi_parser_sharc1, val, now);
+    }
+}
 
-        // Replace the uart_read_byte() / uart_write_byte() functions below with any custom code
-        // This code just passes the received MIDI byte back to MIDI out
+/**
+ * @brief Handles a MIDI event in the audio callback
+ *
+ * Replace the code below with any custom handling.  By default, program
+ * changes select the effects preset (as the push buttons do), controllers
+ * 16 - 18 set the controls the pots normally set, and notes are played by
+ * presets that have a synth.  Controls and notes are applied at their
+ * offset in the block.
+ *
+ * @param event MIDI event
+ * @param offset Sample in the current block at which the event is due
+ */
+static void midi_event_sharc1(const MIDI_EVENT *event, uint32_t offset) {
+
+    switch (event->type) {
+
+        case MIDI_EVENT_NOTE_ON:
+            audio_effects_post_note_core1(event->data1, event->data2 * (1.0 / 127.0), offset);
+            break;
+
+        case MIDI_EVENT_NOTE_OFF:
+            audio_effects_post_note_core1(event->data1, 0.0, offset);
+            break;
+
+        case MIDI_EVENT_CONTROL_CHANGE:
+            if (event->data1 >= MIDI_CC_EFFECT_CONTROL_FIRST
+                && event->data1 < MIDI_CC_EFFECT_CONTROL_FIRST + EFFECT_CONTROLS) {
+                audio_effects_post_control_core1(event->data1 - MIDI_CC_EFFECT_CONTROL_FIRST,
+                                                 event->value * (1.0 / 16383.0), offset);
+            }
+            break;
+
+        case MIDI_EVENT_PROGRAM_CHANGE:
+            if (multicore_data->total_effects_presets) {
+                multicore_data->effects_preset = event->data1 % multicore_data->total_effects_presets;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
 
-        // Read the new byte
-        uart_read_byte(&midi_uart_sharc1, &val);
+/**
+ * @brief Handles the MIDI events that arrived during the last block
+ *
+ * Call this once per block from the audio callback.  Each event is handled
+ * with its offset into the block, one block after it arrived.
+ */
+void midi_process_events_sharc1(void) {
+
+    MIDI_EVENT event;
+    uint32_t block_start = audioframework_block_start_sample();
 
-        // Write that byte back to MIDI TX
-        uart_write_byte(&midi_uart_sharc1, val);
+    while (midi_parser_next_event(&midi_parser_sharc1, block_start + AUDIO_BLOCK_SIZE, &event)) {
+        midi_event_sharc1(&event, midi_event_offset(&event, block_start, AUDIO_BLOCK_SIZE));
     }
 }
 
@@ -24,6 +24,9 @@ bool midi_setup_sharc1(void);
 // MIDI callback for received event
 void midi_rx_callback_sharc1(void);
 
+// Handles queued MIDI events (call once per block from the audio callback)
+void midi_process_events_sharc1(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,6 +31,27 @@
 // Include the audio framework
 #include "audio_framework_selector.h"
 
+// Per-block scratch memory used by the audio elements
+#include "audio_processing/audio_elements/scratch_arena.h"
+
+// Placement of audio element state in L1 / L2 / SDRAM
+#include "audio_processing/audio_elements/memory_placement.h"
+
+// Per-node cycle counts for the audio callback
+#include "audio_processing/audio_elements/cycle_profiler.h"
+
+// Memory use and stack high-water mark reporting
+#include "drivers/bm_memory_report_driver/bm_memory_report.h"
+
+// Named metrics shared with the ARM
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+// Cross-core binary trace rings
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+// Spectrum analysis that runs on whichever SHARC core has more headroom
+#include "audio_processing/audio_elements/stft_analyzer.h"
+
 // And our call backs from processing audio blocks and MIDI messages
 #include "callback_audio_processing.h"
 #include "callback_midi_message.h"
@@ -42,43 +63,168 @@
  */
 char __argv_string[] = "";
 
+#if (CYCLE_PROFILER_ENABLED)
+/**
+ * @brief Reports the slowest profiled node and the cause of the last overrun
+ */
+static void cycle_profiler_report(void) {
+
+    static CYCLE_PROFILER_SNAPSHOT snapshot;
+    static uint32_t overruns = 0;
+
+    if (!cycle_profiler_read_snapshot(multicore_data->sharc_core1_profile, &snapshot)) {
+        return;
+    }
+
+    uint32_t slowest = 0;
+    for (int i = 1; i < CYCLE_PROFILER_MAX_NODES; i++) {
+        if (snapshot.node[i].max_cycles > snapshot.node[slowest].max_cycles) {
+            slowest = i;
+        }
+    }
+    if (snapshot.node[slowest].runs) {
+        log_event_fmt(EVENT_INFO, EVENT_FMT_SHARC_PROFILE_SLOWEST, 1, slowest,
+                      snapshot.node[slowest].max_cycles, snapshot.node[slowest].mean_cycles);
+    }
+
+    if (snapshot.overruns != overruns) {
+        overruns = snapshot.overruns;
+        log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_PROFILE_OVERRUN, 1, snapshot.overrun_node,
+                      snapshot.overrun_cycles, overruns);
+    }
+}
+#endif
+
+#if (USE_BOTH_CORES_TO_PROCESS_AUDIO) && (STFT_ANALYZER_ENABLED)
+/**
+ * @brief Moves the spectrum analysis to the other SHARC core if it has more headroom
+ */
+static void stft_analyzer_balance(void) {
+
+    uint32_t core = multicore_data->stft_analyzer_core;
+    STFT_ANALYZER_SPECTRUM *spectrum = (core == 2) ? multicore_data->sharc_core2_spectrum :
+                                                     multicore_data->sharc_core1_spectrum;
+
+    // Leave the analysis where it is until both cores have set it up
+    if (multicore_data->sharc_core1_spectrum == NULL || multicore_data->sharc_core2_spectrum == NULL) {
+        return;
+    }
+
+    uint32_t next = stft_analyzer_choose_core(core, spectrum->load_mhz,
+                                              multicore_data->sharc_core1_cpu_load_mhz,
+                                              multicore_data->sharc_core2_cpu_load_mhz);
+    if (next != core) {
+        multicore_data->stft_analyzer_core = next;
+        log_event_fmt(EVENT_INFO, EVENT_FMT_STFT_MOVED, 1, next,
+                      EVENT_LOG_FLOAT(multicore_data->sharc_core1_cpu_load_mhz),
+                      EVENT_LOG_FLOAT(multicore_data->sharc_core2_cpu_load_mhz));
+    }
+}
+#endif
+
 /**
  * @brief callback for 1ms timer event
  * @details Use 1ms timer event to manage the event logging system
  */
 void timer_tick_callback(void) {
 
-    char message[128];
+    static BM_METRIC dropped_audio_frames_metric = NULL;
+    static BM_METRIC quality_tier_metric = NULL;
     static uint32_t dropped_audio_frames = 0;
+    static uint32_t quality_tier = 0;
     static uint32_t second_counter = 1;
     float cpu_speed = CORE_CLOCK_FREQ_HZ/1000000;
 
-    // If we have any messages queued up, send them
-    event_logging_process_queue_sharc_core();
-
     // This is also a good place to alert us if we're dropping audio frames because our
     // callback processing is taking too long.
     if (second_counter % 1000 == 0) {
-        if (multicore_data->sharc_core1_dropped_audio_frames != dropped_audio_frames) {
-            sprintf(message, "SHARC core 1 dropped %d audio frame(s) in the last second",
-                    multicore_data->sharc_core1_dropped_audio_frames - dropped_audio_frames);
-            log_event(EVENT_WARN, message);
-            dropped_audio_frames = multicore_data->sharc_core1_dropped_audio_frames;
+        if (dropped_audio_frames_metric == NULL) {
+            dropped_audio_frames_metric = metrics_find(1, "audio.dropped_frames");
+        }
+        if (dropped_audio_frames_metric && *dropped_audio_frames_metric != dropped_audio_frames) {
+            log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_DROPPED_FRAMES, 1,
+                          *dropped_audio_frames_metric - dropped_audio_frames);
+            dropped_audio_frames = *dropped_audio_frames_metric;
         }
     }
 
+    // Let us know when load shedding changes the quality of the effects
+    if (second_counter % 1000 == 0) {
+        if (quality_tier_metric == NULL) {
+            quality_tier_metric = metrics_find(1, "effects.quality_tier");
+        }
+        if (quality_tier_metric && *quality_tier_metric != quality_tier) {
+            quality_tier = *quality_tier_metric;
+            log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_QUALITY_TIER, 1, quality_tier);
+        }
+    }
+
+    // Keep the spectrum analysis on the SHARC core with the most headroom
+    #if (USE_BOTH_CORES_TO_PROCESS_AUDIO) && (STFT_ANALYZER_ENABLED)
+    if (second_counter % 1000 == 0 && multicore_data->sharc_core2_processing_audio) {
+        stft_analyzer_balance();
+    }
+    #endif
+
     if (second_counter % 5000 == 0) {
-        sprintf(message, "SHARC core 1 processing peak load: %.2f MHz of %.1f MHz", multicore_data->sharc_core1_cpu_load_mhz_peak, cpu_speed);
+        log_event_fmt(EVENT_INFO, EVENT_FMT_SHARC_PEAK_LOAD, 1,
+                      EVENT_LOG_FLOAT(multicore_data->sharc_core1_cpu_load_mhz_peak), EVENT_LOG_FLOAT(cpu_speed));
         multicore_data->sharc_core1_cpu_load_mhz_peak = 0.0;
-        log_event(EVENT_INFO, message);
+
+        log_event_fmt(scratch_arena_failures() ? EVENT_WARN : EVENT_INFO, EVENT_FMT_SHARC_SCRATCH_PEAK, 1,
+                      scratch_arena_peak_words(), scratch_arena_size_words(), scratch_arena_failures());
+
+        #if (CYCLE_PROFILER_ENABLED)
+        cycle_profiler_report();
+        #endif
+
+        // Logged when the stack reaches a new depth (this tick runs on the same stack)
+        memory_report_update_stack(&multicore_data->sharc_core1_memory);
     }
 
     second_counter++;
 }
 
 
+/**
+ * @brief Reports how the memory placement pools were used by the effect setup routines
+ */
+static void memory_placement_report(void) {
+
+    char message[128];
+    MEM_ALLOC_RECORD record;
+
+    for (int i = 0; i < MEM_TIERS; i++) {
+        sprintf(message, "SHARC core 1 %s pool: %d of %d words used by %d object(s)",
+                mem_tier_name((MEM_TIER) i), mem_tier_used_words((MEM_TIER) i),
+                mem_tier_size_words((MEM_TIER) i), mem_tier_objects((MEM_TIER) i));
+        log_event(EVENT_INFO, message);
+    }
+
+    // Flag anything that didn't end up in the tier it asked for
+    for (int i = 0; i < mem_alloc_records(); i++) {
+        if (mem_alloc_record(i, &record) && record.fallback) {
+            sprintf(message, "SHARC core 1: %s placed in %s (pool for requested tier full)",
+                    record.name ? record.name : "object", mem_tier_name(record.tier));
+            log_event(EVENT_WARN, message);
+        }
+    }
+
+    if (mem_alloc_failures()) {
+        sprintf(message, "SHARC core 1: %d buffer allocation(s) failed - all memory pools full",
+                mem_alloc_failures());
+        log_event(EVENT_ERROR, message);
+    }
+}
+
 int main(void){
 
+    // Paint the stack before anything (including interrupts) has used it
+    memory_report_initialize(&multicore_data->sharc_core1_memory);
+
+    // Clear this core's metrics before the framework and effects register theirs
+    metrics_initialize();
+
     adi_initComponents();
 
     // Initialize 1ms housekeeping tick
@@ -98,11 +244,12 @@ int main(void){
     simple_sysctrl_set_1ms_callback(timer_tick_callback);
 
     // Set up event logging
-    event_logging_initialize_sharc_core(     (char *)multicore_data->sharc_core1_event_message,
-                                             (uint32_t *)&multicore_data->sharc_core1_event_emuclk,
-                                             (uint32_t *)&multicore_data->sharc_core1_event_emuclk2,
-                                             (uint32_t *)&multicore_data->sharc_core1_event_level,
-                                             (uint32_t *)&multicore_data->sharc_core1_new_message_ready);
+    event_logging_initialize_sharc_core(&multicore_data->sharc_core1_event_ring);
+
+    // Only trace once we know the linker has kept the trace rings clear
+    if (!trace_initialize_sharc_core()) {
+        log_event(EVENT_WARN, "Trace memory isn't reserved in app.ldf, tracing is disabled on SHARC Core 1");
+    }
 
     log_event(EVENT_INFO, "SHARC Core 1 is running");
 
@@ -125,6 +272,12 @@ int main(void){
     // Set up our audio processing algorithms in our audio processing callback
     processaudio_setup();
 
+    // Report where the effect buffers were placed
+    memory_placement_report();
+
+    // And how full each memory is
+    memory_report_log_regions(&multicore_data->sharc_core1_memory);
+
     // Start Audio Framework
     audioframework_start();
     log_event(EVENT_INFO, "Starting audio DMAs");
@@ -145,5 +298,8 @@ int main(void){
 
         // Call our optional background audio processing loop
         processaudio_background_loop();
+
+        // Mute amps whose channels have gone silent, and unmute them when audio returns
+        mcAmp_updateIdle(multicore_data->mcamp_amps_idle);
     }
 }
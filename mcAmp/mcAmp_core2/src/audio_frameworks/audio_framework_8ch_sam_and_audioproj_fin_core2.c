@@ -28,6 +28,12 @@
 // Simple multi-core data sharing scheme
 #include "common/multicore_shared_memory.h"
 
+// Cross-core binary trace
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+// Named metrics shared with the ARM
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
 // Simple gpio functionality
 #include "drivers/bm_gpio_driver/bm_gpio.h"
 
@@ -47,6 +53,9 @@
 #define    SPDIF_DMA_CHANNELS         (2)
 #define    SPDIF_DMA_CHANNEL_MASK     (0x3)
 
+// Blocks dropped because the previous block hadn't finished processing
+static BM_METRIC dropped_audio_frames;
+
 float AudioChannels_From_SHARC_Core1[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0}; // Audio to SHARC 2
 float AudioChannels_To_SHARC_Core1[AUDIO_CHANNELS * AUDIO_BLOCK_SIZE] = {0}; // Audio to SHARC 2
 
@@ -89,6 +98,7 @@ void audioframework_dma_handler(void) {
 
     // Clear DMA transfer status
     *pREG_DMA19_STAT |= BITM_DMA_STAT_IRQDONE;
+    TRACE(TRACE_MDMA_ISR_BEGIN, audio_blocks_new_events_count);
 
     // Capture a processor cycle count for benchmarking purposes.
     cycle_cntr = audioflow_get_cpu_cycle_counter();
@@ -118,7 +128,15 @@ void audioframework_dma_handler(void) {
         }
 
         // Update dropped audio frame counter
-        multicore_data->sharc_core2_dropped_audio_frames++;
+        metric_inc(dropped_audio_frames);
+        TRACE(TRACE_FRAME_DROPPED, *dropped_audio_frames);
+
+        // Keep the trace leading up to the dropped frame
+        #if (TRACE_FREEZE_ON_OVERRUN)
+        trace_freeze();
+        #endif
+
+        TRACE(TRACE_MDMA_ISR_END, audio_blocks_new_events_count);
 
         // Don't trigger the software interrupt for audio processing on this block
         return;
@@ -131,6 +149,8 @@ void audioframework_dma_handler(void) {
         // Raise lower priority interrupt to kick off AudioFramework_AudioCallback_Handler
         *pREG_SEC0_RAISE = INTR_SOFT6;
     }
+
+    TRACE(TRACE_MDMA_ISR_END, audio_blocks_new_events_count);
 }
 
 /**
@@ -158,6 +178,10 @@ void audioframework_audiocallback_handler(uint32_t iid) {
 
     // Clear the pending software interrupt
     *pREG_SEC0_END = INTR_SOFT6;
+    TRACE(TRACE_CALLBACK_BEGIN, audio_blocks_processed_count);
+
+    // Pick up any parameters the ARM has published since the last block
+    shared_parameters_refresh();
 
     // If we're using Faust, run the Faust audio processing before our callback
     #if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
@@ -179,6 +203,7 @@ void audioframework_audiocallback_handler(uint32_t iid) {
 
     // Increment our counter containing number of blocks processed
     audio_blocks_processed_count++;
+    TRACE(TRACE_CALLBACK_END, audio_blocks_processed_count);
 
     // Set flag that last audio frame has completed
     last_audio_frame_completed = true;
@@ -194,8 +219,8 @@ void audioframework_initialize() {
     // Clear peak MIPS
     multicore_data->sharc_core2_cpu_load_mhz_peak = 0;
 
-    // Clear dropped audio frame counter
-    multicore_data->sharc_core2_dropped_audio_frames = 0;
+    // Count dropped frames (the counter starts at zero)
+    dropped_audio_frames = metrics_counter("audio.dropped_frames");
 
     // Set pointers in shared memory structure so SHARC Core 1 knows where to MDMA data to / from
     multicore_data->sharc_core2_audio_in  = AudioChannels_From_SHARC_Core1;
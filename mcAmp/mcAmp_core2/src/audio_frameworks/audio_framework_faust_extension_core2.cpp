@@ -5,6 +5,9 @@
  *
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 // Define your audio system parameters in this file
 #include "common/audio_system_config.h"
 #include "../callback_audio_processing.h"
@@ -19,11 +22,33 @@
 
 #include "audio_framework_faust_extension_core2.h"
 
+// Binds the Faust UI zones to the pots, switches and host parameters
+#include "audio_processing/audio_elements/zone_binding.h"
+
 #include "../Faust/samFaustDSP.h"
 
+// Faust UI interface (the zones are found by building the Faust program's user interface)
+#include "faust/gui/UI.h"
+
+// Audio Project Fin controls, and the MIDI CCs Faust programs have mapped them to
+#define FAUST_POTS                  (3)
+#define FAUST_SWITCHES              (4)
+#define FAUST_POT_FIRST_CC          (0x02)
+#define FAUST_SWITCH_FIRST_CC       (0x66)
+
+// Time constant of a slider gliding to a new value
+#define FAUST_ZONE_SMOOTHING_MS     (20.0)
+
 // Faust object
 samFaustDSP *aSamFaustDSP;
 
+// Faust zones driven directly by the controls, and the control values last passed on
+static ZONE_BINDING faust_zones;
+static float faust_pots_last[FAUST_POTS] = {-1.0, -1.0, -1.0};
+static bool faust_sw_state[FAUST_SWITCHES];
+static float faust_host_params_last[FAUST_HOST_PARAMS];
+static uint32_t faust_host_params_seen;
+
 // Input and output buffers for Faust
 float audioChannel_faust_0_left_in[AUDIO_BLOCK_SIZE];
 float audioChannel_faust_0_right_in[AUDIO_BLOCK_SIZE];
@@ -44,8 +69,6 @@ float audioChannel_faust_3_left_out[AUDIO_BLOCK_SIZE];
 float audioChannel_faust_3_right_out[AUDIO_BLOCK_SIZE];
 
 // Function prototypes
-static void faust_handle_pot(int MIDI_Value, int MIDI_Controller);
-static void faust_handle_pushbutton(bool enable, int MIDI_Controller);
 static void faust_core2_process_midi(uint8_t val);
 static void faust_midi_rx_callback(void);
 
@@ -54,6 +77,134 @@ static void faust_midi_rx_callback(void);
 static BM_UART midi_uart;
 #endif
 
+// MIDI messages from SHARC core 1 handled per block
+#define FAUST_MIDI_MESSAGES_PER_BLOCK   (IPC_QUEUE_CAPACITY)
+
+// Audio Project Fin switch presses (counted by the doorbell interrupt, handled in the Faust callback)
+static volatile uint32_t faust_sw_presses[FAUST_SWITCHES];
+static uint32_t faust_sw_presses_handled[FAUST_SWITCHES];
+
+/*
+ * Binds zones to controls as the Faust program describes its user interface.
+ * Faust declares a zone's metadata just before adding the zone, so the
+ * metadata is held until then.  A zone is bound by
+ *
+ *   [pot:n]        Audio Project Fin pot n (0 to 2), scaled onto the zone's range
+ *   [switch:n]     Audio Project Fin switch n (1 to 4), toggles between the zone's min and max
+ *   [host:n]       host parameter n (CONTROL_PARAM_FAUST_HOST + n), in the zone's units
+ *   [midi:ctrl c]  the CCs the pots (2 to 4) and switches (102 to 105) used to be sent as
+ *
+ * and [scale:log] scales a pot logarithmically.  Sliders glide to new
+ * values; buttons, check boxes and number entries jump.
+ */
+class FaustZoneUI : public UI {
+
+public:
+
+    FaustZoneUI(ZONE_BINDING *binding) : binding(binding) {
+        pending_reset();
+    }
+
+    void openTabBox(const char *label) {}
+    void openHorizontalBox(const char *label) {}
+    void openVerticalBox(const char *label) {}
+    void closeBox() {}
+
+    void addButton(const char *label, FAUSTFLOAT *zone) {
+        bind(zone, 0.0, 1.0, false);
+    }
+    void addCheckButton(const char *label, FAUSTFLOAT *zone) {
+        bind(zone, 0.0, 1.0, false);
+    }
+    void addVerticalSlider(const char *label, FAUSTFLOAT *zone, FAUSTFLOAT init,
+                           FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) {
+        bind(zone, min, max, true);
+    }
+    void addHorizontalSlider(const char *label, FAUSTFLOAT *zone, FAUSTFLOAT init,
+                             FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) {
+        bind(zone, min, max, true);
+    }
+    void addNumEntry(const char *label, FAUSTFLOAT *zone, FAUSTFLOAT init,
+                     FAUSTFLOAT min, FAUSTFLOAT max, FAUSTFLOAT step) {
+        bind(zone, min, max, false);
+    }
+
+    // Outputs aren't controlled
+    void addHorizontalBargraph(const char *label, FAUSTFLOAT *zone, FAUSTFLOAT min, FAUSTFLOAT max) {
+        pending_reset();
+    }
+    void addVerticalBargraph(const char *label, FAUSTFLOAT *zone, FAUSTFLOAT min, FAUSTFLOAT max) {
+        pending_reset();
+    }
+    void addSoundfile(const char *label, const char *filename, Soundfile **sf_zone) {}
+
+    void declare(FAUSTFLOAT *zone, const char *key, const char *value) {
+
+        if (zone == NULL) {
+            return;
+        }
+        if (zone != pending_zone) {
+            pending_reset();
+            pending_zone = zone;
+        }
+
+        if (strcmp(key, "pot") == 0) {
+            pending_bind(ZONE_SOURCE_POT, atoi(value), FAUST_POTS, 0);
+        }
+        else if (strcmp(key, "switch") == 0) {
+            pending_bind(ZONE_SOURCE_SWITCH, atoi(value), FAUST_SWITCHES + 1, 1);
+        }
+        else if (strcmp(key, "host") == 0) {
+            pending_bind(ZONE_SOURCE_HOST, atoi(value), FAUST_HOST_PARAMS, 0);
+        }
+        else if (strcmp(key, "midi") == 0 && strncmp(value, "ctrl ", 5) == 0 && !pending_bound) {
+            int cc = atoi(&value[5]);
+            if (cc >= FAUST_POT_FIRST_CC && cc < FAUST_POT_FIRST_CC + FAUST_POTS) {
+                pending_bind(ZONE_SOURCE_POT, cc - FAUST_POT_FIRST_CC, FAUST_POTS, 0);
+            }
+            else if (cc >= FAUST_SWITCH_FIRST_CC && cc < FAUST_SWITCH_FIRST_CC + FAUST_SWITCHES) {
+                pending_bind(ZONE_SOURCE_SWITCH, cc - FAUST_SWITCH_FIRST_CC + 1, FAUST_SWITCHES + 1, 1);
+            }
+        }
+        else if (strcmp(key, "scale") == 0 && strcmp(value, "log") == 0) {
+            pending_scale = ZONE_SCALE_LOG;
+        }
+    }
+
+private:
+
+    ZONE_BINDING *binding;
+
+    FAUSTFLOAT *pending_zone;
+    bool pending_bound;
+    ZONE_SOURCE pending_source;
+    uint32_t pending_index;
+    ZONE_SCALE pending_scale;
+
+    void pending_reset(void) {
+        pending_zone = NULL;
+        pending_bound = false;
+        pending_scale = ZONE_SCALE_LINEAR;
+    }
+
+    // An explicit [pot], [switch] or [host] replaces a [midi:ctrl] binding
+    void pending_bind(ZONE_SOURCE source, int index, int end, int first) {
+        if (index >= first && index < end) {
+            pending_bound = true;
+            pending_source = source;
+            pending_index = index;
+        }
+    }
+
+    void bind(FAUSTFLOAT *zone, float min, float max, bool smooth) {
+        if (zone == pending_zone && pending_bound) {
+            zone_binding_add(binding, zone, pending_source, pending_index,
+                             min, max, pending_scale, smooth);
+        }
+        pending_reset();
+    }
+};
+
 /**
  * @brief      Faust engine init for Core 2
  *
@@ -83,6 +234,11 @@ void faust_initialize(){
                                         audioChannel_faust_3_left_in,
                                         audioChannel_faust_3_right_in);
 
+    // Find the zones the controls drive
+    zone_binding_setup(&faust_zones, AUDIO_SAMPLE_RATE, AUDIO_BLOCK_SIZE, FAUST_ZONE_SMOOTHING_MS);
+    FaustZoneUI zone_ui(&faust_zones);
+    aSamFaustDSP->buildUserInterface(&zone_ui);
+
 	#if !USE_FAUST_ALGORITHM_CORE1
 
 		// Initialize the MIDI / UART interface
@@ -104,131 +260,88 @@ void faust_initialize(){
  * @brief      Faust audio callback
  *
  * Performs all of the Faust audio processing for the current block of audio.
- * Also manages POTs and PB reads.
+ * Also passes the POTs, PBs and host parameters on to the zones they drive.
  *
  */
 void Faust_audio_processing(){
 
 	/**
-	 * If core 1 is also being used for Faust, core 1 will pass along MIDI bytes
-	 * via the fifo in our shared memory structure.  If core 1 is not being used for
-	 * Faust, core 2 will connect to the UART directly.  In this case, new MIDI
-	 * bytes will come in via the faust_midi_rx_callback() routine.
+	 * If core 1 is also being used for Faust, core 1 will pass along the MIDI
+	 * messages it parses via a queue in our shared memory structure.  If core 1
+	 * is not being used for Faust, core 2 will connect to the UART directly.  In
+	 * this case, new MIDI bytes will come in via the faust_midi_rx_callback() routine.
 	 */
 	#if USE_FAUST_ALGORITHM_CORE1
 
-		// check the FIFO for any new bytes.  When read pointer = write pointer, FIFO is empty.
-		if (multicore_data->sh1_sh2_fifo_write_ptr != multicore_data->sh1_sh2_fifo_read_ptr) {
+		// Take everything that has arrived since the last block
+		IPC_MESSAGE midi_messages[FAUST_MIDI_MESSAGES_PER_BLOCK];
+		uint32_t midi_message_count = ipc_queue_pop_batch(IPC_QUEUE_SHARC1_TO_SHARC2,
+				midi_messages, FAUST_MIDI_MESSAGES_PER_BLOCK);
 
-			uint8_t midi_byte = multicore_data->sh1_sh2_byte_fifo[multicore_data->sh1_sh2_fifo_read_ptr++];
-
-			// Wrap the read pointer if necessary
-			if (multicore_data->sh1_sh2_fifo_read_ptr >= SH1_SH2_BYTE_FIFO_SIZE) {
-				multicore_data->sh1_sh2_fifo_read_ptr = 0;
+		for (uint32_t i = 0; i < midi_message_count; i++) {
+			if (midi_messages[i].type != IPC_MESSAGE_MIDI) {
+				continue;
 			}
 
-			faust_core2_process_midi(midi_byte);
+			uint32_t midi_message = midi_messages[i].arg;
+			uint8_t status = midi_message & 0xFF;
+
+			faust_core2_process_midi(status);
+			faust_core2_process_midi((midi_message >> 8) & 0x7F);
+			if ((status & 0xF0) != 0xC0 && (status & 0xF0) != 0xD0) {
+				faust_core2_process_midi((midi_message >> 16) & 0x7F);
+			}
 		}
 
 	#endif
 
-    // Process this block of audio
-    static float lastPotValue0 = -1.0;
-    static float lastPotValue1 = -1.0;
-    static float lastPotValue2 = -1.0;
-    static bool enablePB1 = false;
-    static bool enablePB2 = false;
-    static bool enablePB3 = false;
-    static bool enablePB4 = false;
-
-    // If we're using FAUST, handle the pots and pbs
-
-    // pots are always on CC-2,3,4
-
-    float epsilon = 1.0 / 50.0;
-
-    // lock the value of the pot.
-    float currentPotValue0 = multicore_data->audioproj_fin_pot_hadc0;
-    // if it changed then send MIDI to the samFaustDSP object
-    if ((currentPotValue0 >= (lastPotValue0 + epsilon)) || (currentPotValue0 <= (lastPotValue0 - epsilon))) {
-        lastPotValue0 = currentPotValue0;
-        int MIDIValue = 127.0 * currentPotValue0;
-        faust_handle_pot(MIDIValue, 0x02);
+    // Pots go straight to their zones (the ARM filters them with hysteresis, so any change is a real move)
+    float pots[FAUST_POTS] = { shared_parameters.audioproj_fin_pot_hadc0,
+                               shared_parameters.audioproj_fin_pot_hadc1,
+                               shared_parameters.audioproj_fin_pot_hadc2 };
+    for (int pot = 0; pot < FAUST_POTS; pot++) {
+        if (pots[pot] != faust_pots_last[pot]) {
+            faust_pots_last[pot] = pots[pot];
+            zone_binding_input(&faust_zones, ZONE_SOURCE_POT, pot, pots[pot]);
+        }
     }
 
-    // lock the value of the pot.
-    float currentPotValue1 = multicore_data->audioproj_fin_pot_hadc1;
-    // if it changed then send MIDI to the samFaustDSP object
-    if ((currentPotValue1 >= (lastPotValue1 + epsilon)) || (currentPotValue1 <= (lastPotValue1 - epsilon))) {
-        lastPotValue1 = currentPotValue1;
-        int MIDIValue = 127.0 * currentPotValue1;
-        faust_handle_pot(MIDIValue, 0x03);
+    // Each press of a switch toggles its zones
+    for (int sw = 0; sw < FAUST_SWITCHES; sw++) {
+        while (faust_sw_presses_handled[sw] != faust_sw_presses[sw]) {
+            faust_sw_presses_handled[sw]++;
+            faust_sw_state[sw] = !faust_sw_state[sw];
+            zone_binding_input(&faust_zones, ZONE_SOURCE_SWITCH, sw + 1, faust_sw_state[sw] ? 1.0 : 0.0);
+        }
     }
 
-    // lock the value of the pot.
-    float currentPotValue2 = multicore_data->audioproj_fin_pot_hadc2;
-    // if it changed then send MIDI to the samFaustDSP object
-    if ((currentPotValue2 >= (lastPotValue2 + epsilon)) || (currentPotValue2 <= (lastPotValue2 - epsilon))) {
-        lastPotValue2 = currentPotValue2;
-        int MIDIValue = 127.0 * currentPotValue2;
-        faust_handle_pot(MIDIValue, 0x04);
-    }
-
-    // push buttons are always CC-102(66H), 103(67H), 104(68H), 105(69H)
-    if (multicore_data->audioproj_fin_sw_1_core2_pressed) {
-        multicore_data->audioproj_fin_sw_1_core2_pressed = false;
-        enablePB1 = !enablePB1;
-        faust_handle_pushbutton(enablePB1, 0x66);
-    }
-
-    if (multicore_data->audioproj_fin_sw_2_core2_pressed) {
-        multicore_data->audioproj_fin_sw_2_core2_pressed = false;
-        enablePB2 = !enablePB2;
-        faust_handle_pushbutton(enablePB2, 0x67);
-    }
-
-    if (multicore_data->audioproj_fin_sw_3_core2_pressed) {
-        multicore_data->audioproj_fin_sw_3_core2_pressed = false;
-        enablePB3 = !enablePB3;
-        faust_handle_pushbutton(enablePB3, 0x68);
+    // Host parameters, once the host has set them
+    for (int n = 0; n < FAUST_HOST_PARAMS; n++) {
+        if ((shared_parameters.faust_host_params_set >> n) & 1) {
+            float value = shared_parameters.faust_host_params[n];
+            if (!((faust_host_params_seen >> n) & 1) || value != faust_host_params_last[n]) {
+                faust_host_params_seen |= 1U << n;
+                faust_host_params_last[n] = value;
+                zone_binding_input(&faust_zones, ZONE_SOURCE_HOST, n, value);
+            }
+        }
     }
 
-    if (multicore_data->audioproj_fin_sw_4_core2_pressed) {
-        multicore_data->audioproj_fin_sw_4_core2_pressed = false;
-        enablePB4 = !enablePB4;
-        faust_handle_pushbutton(enablePB4, 0x69);
-    }
+    // Move the zones towards their new values
+    zone_binding_update(&faust_zones);
 
     // run the FAUST call back
     aSamFaustDSP->processAudioCallback();
 }
 
-static void faust_handle_pot(int MIDI_Value, int MIDI_Controller){
-    int type    = 0xB0;                  // MIDI continuous controller
-    int channel = 0;                     // always on channel 1
-    int data1   = MIDI_Controller;      // MIDI Controller Assigned to POT0
-    int data2   = (MIDI_Value & 0x7F);      // The value of the slider is formed into a 7-bit MIDI data byte
-    aSamFaustDSP->propagateMidi(3, 0.0, type, channel, data1, data2);
-}
-
-static void faust_handle_pushbutton(bool enable, int MIDI_Controller){
-    //  Data needed to convert PB to on/off midi messages
-
-    int PB_ToggleValue;
+/*
+ *     @brief      Counts a press of an Audio Project Fin switch (IPC_BUTTON)
+ */
+void faust_button_pressed(uint32_t button) {
 
-    if (enable) {
-        PB_ToggleValue = 127;
-    }
-    else {
-        PB_ToggleValue = 0;
+    if (button >= IPC_BUTTON_AUDIOPROJ_FIN_SW1 && button <= IPC_BUTTON_AUDIOPROJ_FIN_SW4) {
+        faust_sw_presses[button - IPC_BUTTON_AUDIOPROJ_FIN_SW1]++;
     }
-
-    // form the MIDI message
-    int type    = 0xB0;              // MIDI continuous controller
-    int channel = 0;                 // always on channel 1
-    int data1   = MIDI_Controller;  // MIDI Controller Assigned to POT0
-    int data2   = (PB_ToggleValue & 0x7F);  // The value of the button is formed into a 7-bit MIDI data byte
-    aSamFaustDSP->propagateMidi(3, 0.0, type, channel, data1, data2);
 }
 
 static void faust_core2_process_midi(uint8_t val) {
@@ -23,6 +23,11 @@
 // Prototypes for this file
 #include "callback_audio_processing.h"
 
+// Spectrum of the audio from SHARC Core 1, computed here when this core has more headroom
+#include "audio_processing/audio_elements/stft_analyzer.h"
+
+static void processaudio_arm_messages(BM_IPC_QUEUE *queue, void *arg);
+
 /*
  *
  * Available Processing Power
@@ -113,6 +118,45 @@
  *  audio that was processed before the callback.
  */
 
+/*
+ * Handles the messages from the ARM (called from the doorbell interrupt).  This
+ * core owns reverb_preset, so preset changes from the push buttons and the control
+ * link are made here.
+ */
+static void processaudio_arm_messages(BM_IPC_QUEUE *queue, void *arg) {
+
+	IPC_MESSAGE message;
+
+	while (ipc_queue_pop(queue, &message)) {
+
+		switch (message.type) {
+
+		case IPC_MESSAGE_BUTTON:
+#if defined(USE_FAUST_ALGORITHM_CORE2) && USE_FAUST_ALGORITHM_CORE2
+			faust_button_pressed(message.arg);
+#endif
+			break;
+
+		case IPC_MESSAGE_PRESET_STEP:
+			if (multicore_data->total_effects_presets) {
+				uint32_t total = multicore_data->total_effects_presets;
+				multicore_data->reverb_preset = (multicore_data->reverb_preset
+						+ total + message.arg) % total;
+			}
+			break;
+
+		case IPC_MESSAGE_PRESET_SET:
+			if ((uint32_t) message.arg < multicore_data->total_effects_presets) {
+				multicore_data->reverb_preset = message.arg;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
 /*
  * Place any initialization code here for your audio processing algorithms
  */
@@ -121,6 +165,21 @@ void processaudio_setup(void) {
 	// Initialize the audio effects in the audio_processing/ folder
 	audio_effects_setup_core2();
 
+	// Analyze the audio from SHARC Core 1 (the same audio core 1 analyzes when the analysis is there)
+	multicore_data->sharc_core2_spectrum = stft_analyzer_setup(
+			STFT_ANALYZER_SIZE, STFT_ANALYZER_HOP, AUDIO_BLOCK_SIZE,
+			AUDIO_SAMPLE_RATE);
+	if (STFT_ANALYZER_ENABLED && multicore_data->sharc_core2_spectrum == NULL) {
+		log_event(EVENT_WARN, "Unable to set up the spectrum analyzer");
+	}
+
+	// Handle push buttons and preset changes from the ARM as they arrive
+	if (!ipc_queue_enable_doorbell(IPC_QUEUE_ARM_TO_SHARC2,
+			IPC_DOORBELL_SHARC2, processaudio_arm_messages, NULL)) {
+		log_event(EVENT_WARN, "Unable to enable the ARM message doorbell");
+	}
+	processaudio_arm_messages(IPC_QUEUE_ARM_TO_SHARC2, NULL);
+
     // *******************************************************************************
     // Add any custom setup code here
     // *******************************************************************************
@@ -152,21 +211,36 @@ void processaudio_callback(void) {
 
     int i;
 
+	// Start each block with an empty scratch arena for the audio elements
+	scratch_arena_reset();
+
+	// Time this block and the nodes within it
+	CYCLE_PROFILE_BLOCK_START();
+
+	// Keep the spectrum analyzer's overlap ring filled, and run its share of the FFT if it's on this core
+	stft_analyzer_process(audiochannel_0_left_in, AUDIO_BLOCK_SIZE,
+			multicore_data->stft_analyzer_core == 2);
+
 	if (true) {
 
 		// Copy incoming audio buffers to the effects input buffers
+		CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
 		copy_buffer(audiochannel_0_left_in,  audio_effects_left_in, AUDIO_BLOCK_SIZE);
 		copy_buffer(audiochannel_0_right_in, audio_effects_right_in, AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE_NODE_END();
 
 		// Process audio effects
 		audio_effects_process_audio_core2();
 
 		// Copy processed audio back to input buffers
+		CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
 		copy_buffer(audio_effects_left_out, audiochannel_0_left_in, AUDIO_BLOCK_SIZE);
 		copy_buffer(audio_effects_right_out, audiochannel_0_right_in, AUDIO_BLOCK_SIZE);
+		CYCLE_PROFILE_NODE_END();
 
 	}
 
+    CYCLE_PROFILE_NODE_START(PROFILE_NODE_ROUTING);
     for (i = 0; i < AUDIO_BLOCK_SIZE; i++) {
 
         // *******************************************************************************
@@ -221,6 +295,9 @@ void processaudio_callback(void) {
 
         #endif
     }
+    CYCLE_PROFILE_NODE_END();
+
+    CYCLE_PROFILE_BLOCK_END();
 }
 
 /*
@@ -241,6 +318,9 @@ void processaudio_background_loop(void) {
  * to complete (essentially exceeding the available computational resources of this core).
  */
 void processaudio_mips_overflow(void) {
+
+	// Shed load (step the effects down a quality tier) for the next block
+	audio_effects_overrun_core2();
 }
 
 #endif
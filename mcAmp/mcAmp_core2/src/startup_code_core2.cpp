@@ -22,37 +22,146 @@
 
 #include "callback_audio_processing.h"
 
+// Per-block scratch memory used by the audio elements
+#include "audio_processing/audio_elements/scratch_arena.h"
+
+// Placement of audio element state in L1 / L2 / SDRAM
+#include "audio_processing/audio_elements/memory_placement.h"
+
+// Per-node cycle counts for the audio callback
+#include "audio_processing/audio_elements/cycle_profiler.h"
+
+// Memory use and stack high-water mark reporting
+#include "drivers/bm_memory_report_driver/bm_memory_report.h"
+
+// Named metrics shared with the ARM
+#include "drivers/bm_metrics_driver/bm_metrics.h"
+
+// Cross-core binary trace rings
+#include "drivers/bm_trace_driver/bm_trace.h"
+
+#if (CYCLE_PROFILER_ENABLED)
+/**
+ * @brief Reports the slowest profiled node and the cause of the last overrun
+ */
+static void cycle_profiler_report(void) {
+
+    static CYCLE_PROFILER_SNAPSHOT snapshot;
+    static uint32_t overruns = 0;
+
+    if (!cycle_profiler_read_snapshot(multicore_data->sharc_core2_profile, &snapshot)) {
+        return;
+    }
+
+    uint32_t slowest = 0;
+    for (int i = 1; i < CYCLE_PROFILER_MAX_NODES; i++) {
+        if (snapshot.node[i].max_cycles > snapshot.node[slowest].max_cycles) {
+            slowest = i;
+        }
+    }
+    if (snapshot.node[slowest].runs) {
+        log_event_fmt(EVENT_INFO, EVENT_FMT_SHARC_PROFILE_SLOWEST, 2, slowest,
+                      snapshot.node[slowest].max_cycles, snapshot.node[slowest].mean_cycles);
+    }
+
+    if (snapshot.overruns != overruns) {
+        overruns = snapshot.overruns;
+        log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_PROFILE_OVERRUN, 2, snapshot.overrun_node,
+                      snapshot.overrun_cycles, overruns);
+    }
+}
+#endif
+
 void timer_tick_callback(void) {
-    char message[128];
+    static BM_METRIC dropped_audio_frames_metric = NULL;
+    static BM_METRIC quality_tier_metric = NULL;
     static uint32_t dropped_audio_frames = 0;
+    static uint32_t quality_tier = 0;
     static uint32_t second_counter = 1;
     float cpu_speed = CORE_CLOCK_FREQ_HZ/1000000;
 
-    // If we have any messages queued up, send them
-    event_logging_process_queue_sharc_core();
-
     // This is also a good place to alert us if we're dropping audio frames because our
     // callback processing is taking too long.
     if (second_counter % 1000 == 0) {
-        if (multicore_data->sharc_core2_dropped_audio_frames != dropped_audio_frames) {
-            sprintf(message, "SHARC core 2 dropped %d audio frame(s) in the last second",
-                    multicore_data->sharc_core2_dropped_audio_frames - dropped_audio_frames);
-            log_event(EVENT_WARN, message);
-            dropped_audio_frames = multicore_data->sharc_core2_dropped_audio_frames;
+        if (dropped_audio_frames_metric == NULL) {
+            dropped_audio_frames_metric = metrics_find(2, "audio.dropped_frames");
+        }
+        if (dropped_audio_frames_metric && *dropped_audio_frames_metric != dropped_audio_frames) {
+            log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_DROPPED_FRAMES, 2,
+                          *dropped_audio_frames_metric - dropped_audio_frames);
+            dropped_audio_frames = *dropped_audio_frames_metric;
+        }
+    }
+    // Let us know when load shedding changes the quality of the effects
+    if (second_counter % 1000 == 0) {
+        if (quality_tier_metric == NULL) {
+            quality_tier_metric = metrics_find(2, "effects.quality_tier");
+        }
+        if (quality_tier_metric && *quality_tier_metric != quality_tier) {
+            quality_tier = *quality_tier_metric;
+            log_event_fmt(EVENT_WARN, EVENT_FMT_SHARC_QUALITY_TIER, 2, quality_tier);
         }
     }
+
     if (second_counter % 5000 == 0) {
-        sprintf(message, "SHARC core 2 processing peak load: %.2f MHz of %.1f MHz", multicore_data->sharc_core2_cpu_load_mhz_peak, cpu_speed);
+        log_event_fmt(EVENT_INFO, EVENT_FMT_SHARC_PEAK_LOAD, 2,
+                      EVENT_LOG_FLOAT(multicore_data->sharc_core2_cpu_load_mhz_peak), EVENT_LOG_FLOAT(cpu_speed));
         multicore_data->sharc_core2_cpu_load_mhz_peak = 0.0;
-        log_event(EVENT_INFO, message);
+
+        log_event_fmt(scratch_arena_failures() ? EVENT_WARN : EVENT_INFO, EVENT_FMT_SHARC_SCRATCH_PEAK, 2,
+                      scratch_arena_peak_words(), scratch_arena_size_words(), scratch_arena_failures());
+
+        #if (CYCLE_PROFILER_ENABLED)
+        cycle_profiler_report();
+        #endif
+
+        // Logged when the stack reaches a new depth (this tick runs on the same stack)
+        memory_report_update_stack(&multicore_data->sharc_core2_memory);
     }
 
     second_counter++;
 }
 
 
+/**
+ * @brief Reports how the memory placement pools were used by the effect setup routines
+ */
+static void memory_placement_report(void) {
+
+    char message[128];
+    MEM_ALLOC_RECORD record;
+
+    for (int i = 0; i < MEM_TIERS; i++) {
+        sprintf(message, "SHARC core 2 %s pool: %d of %d words used by %d object(s)",
+                mem_tier_name((MEM_TIER) i), mem_tier_used_words((MEM_TIER) i),
+                mem_tier_size_words((MEM_TIER) i), mem_tier_objects((MEM_TIER) i));
+        log_event(EVENT_INFO, message);
+    }
+
+    // Flag anything that didn't end up in the tier it asked for
+    for (int i = 0; i < mem_alloc_records(); i++) {
+        if (mem_alloc_record(i, &record) && record.fallback) {
+            sprintf(message, "SHARC core 2: %s placed in %s (pool for requested tier full)",
+                    record.name ? record.name : "object", mem_tier_name(record.tier));
+            log_event(EVENT_WARN, message);
+        }
+    }
+
+    if (mem_alloc_failures()) {
+        sprintf(message, "SHARC core 2: %d buffer allocation(s) failed - all memory pools full",
+                mem_alloc_failures());
+        log_event(EVENT_ERROR, message);
+    }
+}
+
 int main(void){
 
+    // Paint the stack before anything (including interrupts) has used it
+    memory_report_initialize(&multicore_data->sharc_core2_memory);
+
+    // Clear this core's metrics before the framework and effects register theirs
+    metrics_initialize();
+
     adi_initComponents();
 
     // Initialize 1ms housekeeping tick
@@ -72,11 +181,12 @@ int main(void){
     simple_sysctrl_set_1ms_callback(timer_tick_callback);
 
     // Set up event logging
-    event_logging_initialize_sharc_core(     (char *)multicore_data->sharc_core2_event_message,
-                                             (uint32_t *)&multicore_data->sharc_core2_event_emuclk,
-                                             (uint32_t *)&multicore_data->sharc_core2_event_emuclk2,
-                                             (uint32_t *)&multicore_data->sharc_core2_event_level,
-                                             (uint32_t *)&multicore_data->sharc_core2_new_message_ready);
+    event_logging_initialize_sharc_core(&multicore_data->sharc_core2_event_ring);
+
+    // Only trace once we know the linker has kept the trace rings clear
+    if (!trace_initialize_sharc_core()) {
+        log_event(EVENT_WARN, "Trace memory isn't reserved in app.ldf, tracing is disabled on SHARC Core 2");
+    }
 
     // If we're using a multicore framework, get audio going over here.
     #if (USE_BOTH_CORES_TO_PROCESS_AUDIO)
@@ -90,6 +200,12 @@ int main(void){
 		// Set up our audio processing algorithms in our audio processing callback
 		processaudio_setup();
 
+		// Report where the effect buffers were placed
+		memory_placement_report();
+
+		// And how full each memory is
+		memory_report_log_regions(&multicore_data->sharc_core2_memory);
+
 		// Kick off audio processing
 		audioframework_start();
 		log_event(EVENT_INFO, "Starting audio DMAs");
@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Saves audio captures sent by the ARM over the event log UART as WAV files.
+
+SHARC core 1 records the channels tapped in processaudio_setup() into SDRAM
+and, once a capture is triggered, the ARM sends it over UART0 (see
+bm_audio_capture.c).  Read the UART directly:
+
+    capture_receive.py --port /dev/ttyUSB0
+
+or pull the captures out of a raw recording of the UART:
+
+    capture_receive.py --file uart.bin
+
+Everything outside the captures (the event log) is passed through to
+stdout.  Each capture is saved as 32-bit float WAV; when there is more than
+one, they are numbered (capture.wav, capture_1.wav, ...).
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# Matches AUDIO_CAPTURE_DUMP_MARKER in bm_audio_capture.h
+MARKER = re.compile(rb"\r\n<AUDIO CAPTURE (\d+) BYTES>\r\n")
+MARKER_MAX_LEN = 40
+
+
+def output_name(base, index):
+    """Returns the file name for the index'th capture of the session."""
+    if index == 0:
+        return base
+    root, ext = os.path.splitext(base)
+    return "%s_%d%s" % (root, index, ext)
+
+
+def receive(stream, output, out, follow=False):
+    """Copies text to out and saves each capture found in a byte stream.
+
+    With follow set, empty reads (serial port timeouts) don't end receiving.
+    """
+    buf = bytearray()
+    captures = 0
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            if follow:
+                continue
+            break
+        buf.extend(chunk)
+
+        while True:
+            m = MARKER.search(buf)
+            if not m:
+                # Pass the text through, keeping enough back for a marker split across reads
+                keep = min(len(buf), MARKER_MAX_LEN)
+                out.write(bytes(buf[:len(buf) - keep]))
+                out.flush()
+                del buf[:len(buf) - keep]
+                break
+
+            out.write(bytes(buf[:m.start()]))
+            length = int(m.group(1))
+            if len(buf) < m.end() + length:
+                del buf[:m.start()]
+                break
+
+            name = output_name(output, captures)
+            with open(name, 'wb') as f:
+                f.write(buf[m.end():m.end() + length])
+            captures += 1
+            sys.stderr.write("capture_receive: saved %d bytes to %s\n" % (length, name))
+            del buf[:m.end() + length]
+
+    out.write(bytes(buf))
+    out.flush()
+    return captures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help="serial port connected to the ARM UART")
+    source.add_argument('--file', help="raw recording of the UART output ('-' for stdin)")
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--output', default="capture.wav", help="WAV file to write (default: capture.wav)")
+    args = parser.parse_args()
+
+    if args.port:
+        import serial
+        stream = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.file == '-':
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.file, 'rb')
+
+    try:
+        receive(stream, args.output, sys.stdout.buffer, follow=bool(args.port))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
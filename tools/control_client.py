@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+"""
+Sets parameters, uploads EQ coefficients and reads metrics over the control link.
+
+The control link shares UART0 with the event log (see bm_control_link.c
+and common/control_protocol.h).  Messages are COBS framed with a CRC-16 and
+sent several at a time, so a whole EQ table goes out in a few frames:
+
+    control_client.py --port /dev/ttyUSB0 get 0x0001 0x0003
+    control_client.py --port /dev/ttyUSB0 set 0x0001=2 0x0010=0xFFFFF
+    control_client.py --port /dev/ttyUSB0 eq coefficients.txt --enable 0xFFFFF
+    control_client.py --port /dev/ttyUSB0 metrics --core 1
+
+An EQ file has one second order section per line, channel 1 stage 1 first,
+as "b0 b1 b2 a1 a2" or as a row of a SciPy sos array "b0 b1 b2 a0 a1 a2"
+(divided through by a0).  Blank lines and anything after a '#' are ignored.
+Event log text received while waiting for replies is passed through to
+stderr with --log.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+# Matches bm_control_link.h
+MAX_PAYLOAD = 240
+WINDOW = 4
+SYNC = 0x00
+NAK = 0x7F
+REPLY = 0x80
+
+# Matches common/control_protocol.h
+PARAM_SET = 0x01
+PARAM_GET = 0x02
+COEFF_WRITE = 0x03
+COEFF_COMMIT = 0x04
+METRICS_READ = 0x05
+
+STATUS = {
+    0: "ok",
+    1: "unknown message type",
+    2: "bad message length",
+    16: "unknown parameter",
+    17: "parameter is read only",
+    18: "bad value",
+    19: "unknown table",
+    20: "past the end of the table",
+    21: "a SHARC core isn't taking messages",
+}
+
+PARAMS = {
+    0x0001: "effects_preset",
+    0x0002: "reverb_preset",
+    0x0003: "total_presets",
+    0x0010: "mcamp_eq_enable",
+    0x0011: "mcamp_amps_idle",
+    0x0020: "sample_rate",
+    0x0021: "block_size",
+    0x0022: "core1_load_mhz",
+    0x0023: "core2_load_mhz",
+}
+FAUST_HOST_PARAMS = 8
+PARAMS.update((0x0100 + n, "faust_host%d" % n) for n in range(FAUST_HOST_PARAMS))
+FLOAT_PARAMS = (0x0022, 0x0023) + tuple(range(0x0100, 0x0100 + FAUST_HOST_PARAMS))
+
+TABLE_MCAMP_EQ = 0
+MCAMP_N_CHANNELS = 20
+MCAMP_EQ_STAGES = 2
+
+METRIC_TYPES = ("counter", "gauge", "gauge", "histogram")
+METRIC = struct.Struct("<24sB3I8I")
+
+
+class LinkError(Exception):
+    pass
+
+
+def crc16(data):
+    """CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_index = 0
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(byte)
+            code += 1
+            if code == 0xFF:
+                out[code_index] = code
+                code_index = len(out)
+                out.append(0)
+                code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(data):
+            return None
+        out += data[i:i + code - 1]
+        i += code - 1
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+class ControlLink:
+    """Go-back-N sender for the control link."""
+
+    def __init__(self, port, timeout=0.25, retries=10, log=None):
+        self.port = port
+        self.timeout = timeout
+        self.retries = retries
+        self.log = log
+        self.seq = 0
+        self.window = WINDOW
+        self.max_payload = MAX_PAYLOAD
+        self.rx = bytearray()
+
+    def _send(self, seq, msg_type, payload):
+        frame = bytes([seq, msg_type]) + payload
+        frame += struct.pack("<H", crc16(frame))
+        self.port.write(b"\x00" + cobs_encode(frame) + b"\x00")
+
+    def _receive(self):
+        """Returns the replies that have arrived as (seq, type, status, payload)."""
+        self.rx += self.port.read(max(1, self.port.in_waiting))
+        replies = []
+        while True:
+            end = self.rx.find(b"\x00")
+            if end < 0:
+                break
+            chunk = bytes(self.rx[:end])
+            del self.rx[:end + 1]
+            if not chunk:
+                continue
+            frame = cobs_decode(chunk)
+            if (frame is None or len(frame) < 5 or not frame[1] & REPLY
+                    or crc16(frame[:-2]) != struct.unpack("<H", frame[-2:])[0]):
+                if self.log:
+                    self.log.write(chunk.decode("latin-1"))
+                    self.log.flush()
+                continue
+            replies.append((frame[0], frame[1], frame[2], frame[3:-2]))
+        return replies
+
+    def sync(self):
+        """Starts a session; the target's window and max payload replace the defaults."""
+        self.seq = (self.seq + 1) & 0xFF
+        for _ in range(self.retries):
+            self._send(self.seq, SYNC, b"")
+            deadline = time.monotonic() + self.timeout
+            while time.monotonic() < deadline:
+                for seq, msg_type, status, payload in self._receive():
+                    if seq == self.seq and msg_type == SYNC | REPLY and len(payload) >= 4:
+                        version, window, max_payload = struct.unpack("<BBH", payload[:4])
+                        self.window = min(window, WINDOW)
+                        self.max_payload = min(max_payload, MAX_PAYLOAD)
+                        self.seq = (self.seq + 1) & 0xFF
+                        return version
+        raise LinkError("no reply from the target")
+
+    def transact(self, messages):
+        """Sends (type, payload) messages in order and returns their (status, payload) replies."""
+        count = len(messages)
+        replies = [None] * count
+        base = 0
+        sent = 0
+        retries = self.retries
+        progress = time.monotonic()
+
+        while base < count:
+            while sent < count and sent - base < self.window:
+                msg_type, payload = messages[sent]
+                self._send((self.seq + sent) & 0xFF, msg_type, payload)
+                sent += 1
+
+            for seq, msg_type, status, payload in self._receive():
+                index = base + ((seq - self.seq - base) & 0xFF)
+                if msg_type == NAK | REPLY:
+                    # Something went missing - send everything unacknowledged again
+                    sent = base
+                elif base <= index < sent and msg_type == messages[index][0] | REPLY:
+                    replies[index] = (status, payload)
+
+            while base < count and replies[base] is not None:
+                base += 1
+                retries = self.retries
+                progress = time.monotonic()
+
+            if base < count and time.monotonic() - progress > self.timeout:
+                retries -= 1
+                if retries == 0:
+                    raise LinkError("no reply from the target")
+                sent = base
+                progress = time.monotonic()
+
+        self.seq = (self.seq + count) & 0xFF
+        return replies
+
+
+def check(reply):
+    status, payload = reply
+    if status:
+        raise LinkError(STATUS.get(status, "status %d" % status))
+    return payload
+
+
+def param_id(text):
+    for pid, name in PARAMS.items():
+        if text == name:
+            return pid
+    return int(text, 0)
+
+
+def param_value(pid, text):
+    if pid in FLOAT_PARAMS:
+        return struct.unpack("<I", struct.pack("<f", float(text)))[0]
+    return int(text, 0)
+
+
+def format_value(pid, value):
+    if pid in FLOAT_PARAMS:
+        return "%g" % struct.unpack("<f", struct.pack("<I", value))[0]
+    return "%d (0x%X)" % (value, value)
+
+
+def cmd_get(link, args):
+    ids = [param_id(p) for p in args.params]
+    per_message = link.max_payload // 4
+    messages = [(PARAM_GET, b"".join(struct.pack("<H", pid) for pid in ids[i:i + per_message]))
+                for i in range(0, len(ids), per_message)]
+    values = []
+    for reply in link.transact(messages):
+        payload = check(reply)
+        values += struct.unpack("<%dI" % (len(payload) // 4), payload)
+    for pid, value in zip(ids, values):
+        print("%-18s %s" % (PARAMS.get(pid, "0x%04X" % pid), format_value(pid, value)))
+
+
+def cmd_set(link, args):
+    fields = b""
+    for item in args.assignments:
+        name, _, text = item.partition("=")
+        pid = param_id(name)
+        fields += struct.pack("<HI", pid, param_value(pid, text))
+    if len(fields) > link.max_payload:
+        raise LinkError("too many parameters for one message")
+    check(link.transact([(PARAM_SET, fields)])[0])
+
+
+def read_sections(path):
+    sections = []
+    with open(path) as f:
+        for line in f:
+            values = [float(v) for v in line.split("#")[0].replace(",", " ").split()]
+            if not values:
+                continue
+            if len(values) == 6:
+                a0 = values[3]
+                values = [values[0] / a0, values[1] / a0, values[2] / a0, values[4] / a0, values[5] / a0]
+            if len(values) != 5:
+                raise LinkError("%s: each section needs 5 or 6 coefficients" % path)
+            sections.append(values)
+    if len(sections) != MCAMP_N_CHANNELS * MCAMP_EQ_STAGES:
+        raise LinkError("%s: expected %d sections (%d channels x %d stages), found %d"
+                        % (path, MCAMP_N_CHANNELS * MCAMP_EQ_STAGES, MCAMP_N_CHANNELS,
+                           MCAMP_EQ_STAGES, len(sections)))
+    return [c for section in sections for c in section]
+
+
+def cmd_eq(link, args):
+    words = read_sections(args.file)
+    per_message = (link.max_payload - 4) // 4
+    messages = []
+    for first in range(0, len(words), per_message):
+        chunk = words[first:first + per_message]
+        messages.append((COEFF_WRITE, struct.pack("<BBH%df" % len(chunk), TABLE_MCAMP_EQ, 0, first, *chunk)))
+    messages.append((COEFF_COMMIT, bytes([TABLE_MCAMP_EQ])))
+    if args.enable is not None:
+        messages.append((PARAM_SET, struct.pack("<HI", 0x0010, int(args.enable, 0))))
+
+    start = time.monotonic()
+    for reply in link.transact(messages):
+        check(reply)
+    sys.stderr.write("control_client: sent %d coefficients in %d messages (%.0f ms)\n"
+                     % (len(words), len(messages), (time.monotonic() - start) * 1000))
+
+
+def cmd_metrics(link, args):
+    index = 0
+    while True:
+        payload = check(link.transact([(METRICS_READ, bytes([args.core, index]))])[0])
+        total = payload[0]
+        entries = payload[1:]
+        if not entries:
+            break
+        for offset in range(0, len(entries) - METRIC.size + 1, METRIC.size):
+            name, mtype, value, count, shift, *buckets = METRIC.unpack_from(entries, offset)
+            name = name.split(b"\x00")[0].decode()
+            kind = METRIC_TYPES[mtype] if mtype < len(METRIC_TYPES) else "?"
+            if mtype == 2:
+                print("%-24s %-9s %g" % (name, kind, struct.unpack("<f", struct.pack("<I", value))[0]))
+            elif mtype == 3:
+                print("%-24s %-9s n=%d shift=%d %s" % (name, kind, count, shift, buckets))
+            else:
+                print("%-24s %-9s %d" % (name, kind, value))
+            index += 1
+        if index >= total:
+            break
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--port', required=True, help="serial port connected to the ARM UART")
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--timeout', type=float, default=0.25, help="seconds to wait for a reply before sending again")
+    parser.add_argument('--log', action='store_true', help="pass event log text through to stderr")
+    commands = parser.add_subparsers(dest='command', required=True)
+
+    get = commands.add_parser('get', help="read parameters")
+    get.add_argument('params', nargs='+', help="parameter names or ids")
+    get.set_defaults(func=cmd_get)
+
+    set_ = commands.add_parser('set', help="set parameters (all in one message)")
+    set_.add_argument('assignments', nargs='+', help="name=value or id=value")
+    set_.set_defaults(func=cmd_set)
+
+    eq = commands.add_parser('eq', help="upload and commit the mcAmp output EQ")
+    eq.add_argument('file', help="coefficient file")
+    eq.add_argument('--enable', help="channel mask to enable once committed (e.g. 0xFFFFF)")
+    eq.set_defaults(func=cmd_eq)
+
+    metrics = commands.add_parser('metrics', help="read a core's metrics")
+    metrics.add_argument('--core', type=int, default=0, help="0 = ARM, 1 and 2 = SHARC cores")
+    metrics.set_defaults(func=cmd_metrics)
+
+    args = parser.parse_args()
+
+    import serial
+    port = serial.Serial(args.port, args.baud, timeout=0.01)
+    link = ControlLink(port, timeout=args.timeout, log=sys.stderr if args.log else None)
+
+    try:
+        link.sync()
+        args.func(link, args)
+    except LinkError as e:
+        sys.stderr.write("control_client: %s\n" % e)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
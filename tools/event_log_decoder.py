@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Decodes binary event log frames from the ARM UART back into text.
+
+Build the firmware with EVENT_LOG_BINARY_UART set to true in
+bm_event_logging.h, then either read the UART directly:
+
+    event_log_decoder.py --port /dev/ttyUSB0
+
+or decode a raw capture:
+
+    event_log_decoder.py --file capture.bin
+
+The format strings are read from mcAmp/common/event_log_formats.h, so the
+decoder must be run against the same version of that file as the firmware.
+See EVENT_LOG_BINARY_UART in bm_event_logging.h for the frame layout.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+HEADER_LEN = 8
+
+LEVELS = ["", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"]
+SOURCES = ["ARM", "SHARC CORE 1", "SHARC CORE 2"]
+
+DEFAULT_FORMATS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               "..", "mcAmp", "common", "event_log_formats.h")
+
+FORMAT_ENTRY = re.compile(r'X\(\s*(\w+)\s*,\s*(\d+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+CONVERSION = re.compile(r"%([-+ #0']*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z)?([diouxXcfFeEgGs%])")
+
+
+def load_formats(path):
+    """Returns a list of (id name, argument count, format) in ID order."""
+    with open(path) as f:
+        text = f.read()
+    formats = []
+    for name, args, fmt in FORMAT_ENTRY.findall(text):
+        fmt = fmt.replace('\\t', '\t').replace('\\n', '\n').replace('\\"', '"').replace('\\\\', '\\')
+        formats.append((name, int(args), fmt))
+    if not formats:
+        raise ValueError("no formats found in " + path)
+    return formats
+
+
+def expand(fmt, words):
+    """Builds the text for a format and its raw 32-bit argument words."""
+    words = list(words)
+
+    def convert(m):
+        flags, width, precision, _, conv = m.groups()
+        if conv == '%':
+            return '%'
+        word = words.pop(0) if words else 0
+        spec = '%' + flags.replace("'", '') + width + ('.' + precision if precision is not None else '')
+        if conv in 'fFeEgG':
+            return (spec + conv) % struct.unpack('<f', struct.pack('<I', word))[0]
+        if conv == 's':
+            return '?'
+        if conv == 'c':
+            return chr(word & 0xFF)
+        if conv in 'di':
+            word = struct.unpack('<i', struct.pack('<I', word))[0]
+            conv = 'd'
+        elif conv == 'u':
+            conv = 'd'
+        return (spec + conv) % word
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def timestamp(ms):
+    hours, ms = divmod(ms, 3600000)
+    minutes, ms = divmod(ms, 60000)
+    seconds, ms = divmod(ms, 1000)
+    return "%02d:%02d:%02d.%03d" % (hours % 24, minutes, seconds, ms)
+
+
+def decode(stream, formats, out, follow=False):
+    """Reads frames from a byte stream, resynchronising on the sync byte.
+
+    With follow set, empty reads (serial port timeouts) don't end decoding.
+    """
+    buf = bytearray()
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            if follow:
+                continue
+            break
+        buf.extend(chunk)
+
+        while True:
+            start = buf.find(bytes([SYNC]))
+            if start < 0:
+                buf.clear()
+                break
+            del buf[:start]
+            if len(buf) < HEADER_LEN:
+                break
+
+            source_level, format_id, ms = struct.unpack_from('<BHI', buf, 1)
+            source, level = source_level >> 4, source_level & 0x0F
+            if format_id >= len(formats) or source >= len(SOURCES) or level >= len(LEVELS):
+                # Not a real frame - skip this sync byte
+                del buf[:1]
+                continue
+
+            name, nargs, fmt = formats[format_id]
+            if format_id == 0:
+                if len(buf) < HEADER_LEN + 1:
+                    break
+                length = HEADER_LEN + 1 + buf[HEADER_LEN]
+                if len(buf) < length:
+                    break
+                text = buf[HEADER_LEN + 1:length].decode('ascii', errors='replace')
+            else:
+                length = HEADER_LEN + 4 * nargs
+                if len(buf) < length:
+                    break
+                text = expand(fmt, struct.unpack_from('<%dI' % nargs, buf, HEADER_LEN))
+
+            out.write("%s [%s - %s]  %s\n" % (timestamp(ms), LEVELS[level], SOURCES[source], text))
+            out.flush()
+            del buf[:length]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--port', help="serial port connected to the ARM UART")
+    source.add_argument('--file', help="raw capture of the UART output ('-' for stdin)")
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--formats', default=DEFAULT_FORMATS, help="path to event_log_formats.h")
+    args = parser.parse_args()
+
+    formats = load_formats(args.formats)
+
+    if args.port:
+        import serial
+        stream = serial.Serial(args.port, args.baud, timeout=0.1)
+    elif args.file == '-':
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.file, 'rb')
+
+    try:
+        decode(stream, formats, sys.stdout, follow=bool(args.port))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
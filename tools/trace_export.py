@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Converts a dump of the binary trace buffers into Chrome trace JSON.
+
+Freeze the trace on the target (trace_freeze(), or TRACE_FREEZE_ON_OVERRUN
+in bm_trace.h), save TRACE_BUFFER_SIZE bytes from TRACE_BUFFER_ADDRESS with
+the debugger as raw binary, then:
+
+    trace_export.py --dump trace.bin --output trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.  Each
+core is drawn as its own track on a common time line.
+
+The event names are read from mcAmp/common/trace_events.h, so the exporter
+must be run against the same version of that file as the firmware.  See
+bm_trace.h for the buffer layout.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+TRACE_MAGIC = 0x45435254
+HEADER_LEN = 32
+RING_HEADER_LEN = 16
+RECORD_LEN = 16
+CORES = ["ARM", "SHARC core 1", "SHARC core 2"]
+
+DEFAULT_EVENTS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                              "..", "mcAmp", "common", "trace_events.h")
+
+EVENT_ENTRY = re.compile(r"X\(\s*(\w+)\s*,\s*'([BEi])'\s*,\s*\"((?:[^\"\\]|\\.)*)\"\s*\)")
+
+
+def load_events(path):
+    """Returns a list of (id name, phase, name) in ID order."""
+    with open(path) as f:
+        text = f.read()
+    events = EVENT_ENTRY.findall(text)
+    if not events:
+        raise ValueError("no events found in " + path)
+    return events
+
+
+def read_ring(data, offset, records_per_core):
+    """Returns the complete records of one ring as (sequence, timestamp, event, payload), oldest first."""
+    head, = struct.unpack_from('<I', data, offset)
+    offset += RING_HEADER_LEN
+
+    records = []
+    for slot in range(records_per_core):
+        timestamp, event, payload, sequence = struct.unpack_from('<4I', data, offset + slot * RECORD_LEN)
+
+        # Only keep records that were completely written in the last pass over the ring
+        if sequence == 0 or sequence > head or head - sequence >= records_per_core:
+            continue
+        if (sequence - 1) % records_per_core != slot:
+            continue
+        records.append((sequence, timestamp, event, payload))
+
+    records.sort()
+    return records
+
+
+def export(data, events):
+    """Builds the Chrome trace events for a dump of the trace buffers."""
+    if len(data) < HEADER_LEN:
+        raise ValueError("dump is too short")
+
+    magic, timer_freq_hz, records_per_core, frozen = struct.unpack_from('<4I', data, 0)
+    if magic != TRACE_MAGIC:
+        raise ValueError("trace buffers not found (magic 0x%08X)" % magic)
+    ring_len = RING_HEADER_LEN + records_per_core * RECORD_LEN
+    if len(data) < HEADER_LEN + len(CORES) * ring_len:
+        raise ValueError("dump is too short for %d records per core" % records_per_core)
+
+    rings = [read_ring(data, HEADER_LEN + core * ring_len, records_per_core)
+             for core in range(len(CORES))]
+
+    # All cores read the same 32-bit timer, so times are measured back from
+    # the newest record on any core (the window is far shorter than a wrap)
+    newest = None
+    for records in rings:
+        if not records:
+            continue
+        last = records[-1][1]
+        if newest is None or ((last - newest) & 0xFFFFFFFF) < 0x80000000:
+            newest = last
+    if newest is None:
+        return []
+
+    trace = []
+    for core, name in enumerate(CORES):
+        trace.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core,
+                      "args": {"name": name}})
+
+    for core, records in enumerate(rings):
+        for sequence, timestamp, event, payload in records:
+            age = (newest - timestamp) & 0xFFFFFFFF
+            if age >= 0x80000000:
+                age = 0
+            entry = {"pid": 0, "tid": core, "ts": -age * 1e6 / timer_freq_hz,
+                     "args": {"payload": payload}}
+            if event < len(events):
+                _, phase, label = events[event]
+                entry["name"] = label
+                entry["ph"] = phase
+            else:
+                entry["name"] = "unknown event %d" % event
+                entry["ph"] = 'i'
+            if entry["ph"] == 'i':
+                entry["s"] = 't'
+            trace.append(entry)
+
+    # Chrome's viewer expects non-negative times
+    start = min(e["ts"] for e in trace if "ts" in e)
+    for e in trace:
+        if "ts" in e:
+            e["ts"] -= start
+    return trace
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument('--dump', required=True, help="raw dump of the trace buffers")
+    parser.add_argument('--output', help="JSON file to write (default: stdout)")
+    parser.add_argument('--events', default=DEFAULT_EVENTS, help="path to trace_events.h")
+    args = parser.parse_args()
+
+    events = load_events(args.events)
+    with open(args.dump, 'rb') as f:
+        data = f.read()
+
+    try:
+        trace = export(data, events)
+    except ValueError as e:
+        sys.exit("trace_export: " + str(e))
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    json.dump({"traceEvents": trace, "displayTimeUnit": "ns"}, out, indent=1)
+    out.write("\n")
+
+
+if __name__ == '__main__':
+    main()